@@ -6,6 +6,7 @@
 #include "bot.h"
 #include "clients.h"
 #include "chat.h"
+#include "profiler.h"
 #include "waypoint_navigator.h"
 #include "schedule.h"
 #include "server_plugin.h"
@@ -24,6 +25,14 @@ extern int iMainBufferSize;
 //----------------------------------------------------------------------------------------------------------------
 float CBot::m_fTimeIntervalCheckUsingMachines = 0.5f;
 int CBot::m_iCheckEntitiesPerFrame = 4;
+float CBot::m_fSightDistanceSqr = (float)CUtil::iMaxMapSize * CUtil::iMaxMapSize;
+
+static const float fFovHorizontal = 37.5f;              // Giving 75 degree of view horizontally.
+static const float fFovVertical = fFovHorizontal * 3/4; // Normal monitor has 4:3 aspect ratio.
+
+// Angle between view direction and player inside field of view is not more than fFovHorizontal + fFovVertical,
+// so this cone (1 degree wider to not to miss anyone) has all players that can be seen.
+float CBot::m_fSightConeCosSqr = SQR( cosf( DEG2RAD(fFovHorizontal + fFovVertical + 1.0f) ) );
 
 //----------------------------------------------------------------------------------------------------------------
 CBot::CBot( edict_t* pEdict, TPlayerIndex iIndex, TBotIntelligence iIntelligence ):
@@ -35,15 +44,18 @@ CBot::CBot( edict_t* pEdict, TPlayerIndex iIndex, TBotIntelligence iIntelligence
 #else
 	m_bDebugging(false),
 #endif
-	m_bDontBreakObjects(false), m_bDontThrowObjects(false)
+	m_bTest(false), m_bDontBreakObjects(false), m_bDontThrowObjects(false),
+	m_fSightTime(0.0f)
 {
+	sight_t cSight = { -1.0f, ESightHidden };
+	m_aSights.resize( CPlayers::Size(), cSight );
+
 	for ( TEntityType i=0; i < EEntityTypeTotal; ++i )
 	{
 		int iSize = CItems::GetItems(i).size() >> 4;
 		if ( iSize == 0 )
 			iSize = 2;
-		m_aNearItems[i].reserve( iSize );
-		m_aNearestItems[i].reserve( 4 );
+		m_aNearItems[i].reserve( iSize ); // Allocates only if there are a lot of items.
 	}
 }
 
@@ -186,6 +198,9 @@ void CBot::Respawned()
 	m_aAvoidAreas.clear();
 
 	m_iNextCheckPlayer = 0;
+	for ( int i = 0; i < m_aSights.size(); ++i )
+		m_aSights[i].fTime = -1.0f;
+	m_fSightTime = 0.0f;
 	m_aNearPlayers.reset();
 	m_aSeenEnemies.reset();
 	m_pCurrentEnemy = NULL;
@@ -241,8 +256,8 @@ void CBot::Respawned()
 	Vector vFoot = m_pController->GetLocalOrigin();
 	for ( TEntityType iType = 0; iType < EEntityTypeObject; ++iType )
 	{
-		good::vector<TEntityIndex>& aNear = m_aNearItems[iType];
-		good::vector<TEntityIndex>& aNearest = m_aNearestItems[iType];
+		near_items_t& aNear = m_aNearItems[iType];
+		near_items_t& aNearest = m_aNearestItems[iType];
 
 		const good::vector<CEntity>& aItems = CItems::GetItems(iType);
 		if ( aItems.size() == 0)
@@ -277,6 +292,7 @@ void CBot::PlayerDisconnect( int iPlayerIndex, CPlayer* pPlayer )
 {
 	m_aNearPlayers.reset(iPlayerIndex);
 	m_aSeenEnemies.reset(iPlayerIndex);
+	m_aSights[iPlayerIndex].fTime = -1.0f;
 
 	if ( pPlayer == m_pCurrentEnemy )
 	{
@@ -441,6 +457,13 @@ void CBot::EndPerformingChatRequest( bool bSayGoodbye )
 	}
 }
 
+//----------------------------------------------------------------------------------------------------------------
+const good::string& CBot::GetTaskName() const
+{
+	static good::string sNoTask("none");
+	return sNoTask;
+}
+
 //----------------------------------------------------------------------------------------------------------------
 void CBot::PreThink()
 {
@@ -659,7 +682,7 @@ void CBot::ApplyPathFlags()
 		{
 			m_vForward = wNext.vOrigin;
 
-			CWaypointPath* pCurrentPath = CWaypoints::GetPath(iCurrentWaypoint, iNextWaypoint);
+			const CWaypointPath* pCurrentPath = CWaypoints::GetNavPath(iCurrentWaypoint, iNextWaypoint);
 			DebugAssert( pCurrentPath );
 
 			m_bLadderMove = FLAG_ALL_SET(FPathLadder, pCurrentPath->iFlags);
@@ -696,7 +719,7 @@ void CBot::DoPathAction()
 
 	if ( CWaypoint::IsValid(iNextWaypoint) && (iCurrentWaypoint != iNextWaypoint) )
 	{
-		CWaypointPath* pCurrentPath = CWaypoints::GetPath(iCurrentWaypoint, iNextWaypoint);
+		const CWaypointPath* pCurrentPath = CWaypoints::GetNavPath(iCurrentWaypoint, iNextWaypoint);
 		DebugAssert( pCurrentPath );
 
 		if ( FLAG_ALL_SET(FPathBreak, pCurrentPath->iFlags) )
@@ -736,7 +759,7 @@ void CBot::PickItem( const CEntity& cItem, TEntityType iEntityType, TEntityIndex
 		break;
 	case EEntityTypeWeapon:
 	{
-		TWeaponId iWeaponId = CWeapons::GetIdFromWeaponName(cItem.pItemClass->sClassName);
+		TWeaponId iWeaponId = CWeapons::GetIdFromWeaponNameId(cItem.pItemClass->iNameId);
 		DebugAssert( iWeaponId >= 0 );
 		m_aWeapons[iWeaponId].AddWeapon();
 
@@ -797,23 +820,87 @@ void CBot::Speak( bool bTeamSay )
 
 
 //----------------------------------------------------------------------------------------------------------------
-bool CBot::IsVisible( CPlayer* pPlayer ) const
+void CBot::UpdateSight()
 {
-	// First check if other player is in bot's view cone.
-	static const float fFovHorizontal = 37.5f;              // Giving 75 degree of view horizontally.
-	static const float fFovVertical = fFovHorizontal * 3/4; // Normal monitor has 4:3 aspect ratio.
+	m_fSightTime = CBotrixPlugin::fTime;
+	AngleVectors(m_cCmd.viewangles, &m_vSightForward);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CBot::IsVisible( int iPlayerIndex, CPlayer* pPlayer )
+{
+	sight_t& cSight = m_aSights[iPlayerIndex];
+	if ( cSight.fTime == CBotrixPlugin::fTime )
+	{
+		BOTRIX_PROFILE_COUNT(EProfileCountSightCached, 1);
+		return cSight.iSight == ESightVisible;
+	}
+	cSight.fTime = CBotrixPlugin::fTime;
+
+	if ( m_fSightTime != CBotrixPlugin::fTime )
+		UpdateSight();
+
 	Vector vAim(pPlayer->GetHead());
 	vAim -= m_vHead;
 
-	QAngle angPlayer;
-	VectorAngles(vAim, angPlayer);
+	float fDistanceSqr = vAim.LengthSqr();
+	if ( fDistanceSqr > m_fSightDistanceSqr )
+	{
+		BOTRIX_PROFILE_COUNT(EProfileCountSightDistance, 1);
+		cSight.iSight = ESightFar;
+		return false;
+	}
 
-	CUtil::GetAngleDifference(angPlayer, m_cCmd.viewangles, angPlayer);
-	if ( (-fFovHorizontal <= angPlayer.x) && (angPlayer.x <= fFovHorizontal) &&
-		 (-fFovVertical <= angPlayer.y) && (angPlayer.y <= fFovVertical) )
-		 return CUtil::IsVisible( m_vHead, pPlayer->GetHead() );
-	else
+	// Check if other player is in bot's view cone: cosine of angle to player is dot / |vAim|, compare squares.
+	float fDot = DotProduct(vAim, m_vSightForward);
+	bool bInView = (fDot > 0.0f) && ( SQR(fDot) >= m_fSightConeCosSqr * fDistanceSqr );
+	if ( bInView )
+	{
+		// Player is in cone, check field of view.
+		QAngle angPlayer;
+		VectorAngles(vAim, angPlayer);
+
+		CUtil::GetAngleDifference(angPlayer, m_cCmd.viewangles, angPlayer);
+		bInView = (-fFovHorizontal <= angPlayer.x) && (angPlayer.x <= fFovHorizontal) &&
+		          (-fFovVertical <= angPlayer.y) && (angPlayer.y <= fFovVertical);
+	}
+	if ( !bInView )
+	{
+		BOTRIX_PROFILE_COUNT(EProfileCountSightView, 1);
+		cSight.iSight = ESightOutOfView;
+		return false;
+	}
+
+	if ( !CPvs::IsVisible(m_iCluster, pPlayer->GetCluster()) )
+	{
+		BOTRIX_PROFILE_COUNT(EProfileCountSightPvs, 1);
+		cSight.iSight = ESightOutOfPvs;
 		return false;
+	}
+
+	BOTRIX_PROFILE_COUNT(EProfileCountSightRays, 1);
+	cSight.iSight = CUtil::IsVisible(m_vHead, pPlayer->GetHead()) ? ESightVisible : ESightHidden;
+	return cSight.iSight == ESightVisible;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CBot::IsVisibleRay( const Vector& vSrc, const Vector& vDest )
+{
+	if ( vSrc.DistToSqr(vDest) > m_fSightDistanceSqr )
+	{
+		BOTRIX_PROFILE_COUNT(EProfileCountSightDistance, 1);
+		return false;
+	}
+
+	int iSrcCluster = (vSrc == m_vHead) ? m_iCluster : CPvs::GetCluster(vSrc);
+	if ( !CPvs::IsVisible(iSrcCluster, CPvs::GetCluster(vDest)) )
+	{
+		BOTRIX_PROFILE_COUNT(EProfileCountSightPvs, 1);
+		return false;
+	}
+
+	BOTRIX_PROFILE_COUNT(EProfileCountSightRays, 1);
+	return CUtil::IsVisible(vSrc, vDest);
 }
 
 
@@ -843,6 +930,8 @@ float CBot::GetEndLookTime()
 	VectorAngles(vDestinationAim, angNeeded);
 
 	CUtil::GetAngleDifference(m_cCmd.viewangles, angNeeded, angNeeded);
+	if ( !angNeeded.IsValid() )
+		return aEndAimTime[m_iIntelligence][iEndAimSize-1];
 
 	int iPitch = abs( (int)angNeeded.x );
 	int iYaw = abs( (int)angNeeded.y );
@@ -855,6 +944,8 @@ float CBot::GetEndLookTime()
 
 	if ( iPitch < iYaw)
 		iPitch = iYaw; // iPitch = MAX2( iPitch, iYaw );
+	if ( iPitch >= iEndAimSize )
+		iPitch = iEndAimSize-1; // Angles out of [-180..+180) if view angles were far from it.
 
 	float fAimTime = aEndAimTime[m_iIntelligence][iPitch];
 	DebugAssert( fAimTime < 2.0f );
@@ -867,6 +958,8 @@ float CBot::GetEndLookTime()
 //----------------------------------------------------------------------------------------------------------------
 void CBot::UpdateWorld()
 {
+	UpdateSight();
+
 	// Update picked items.
 	if ( m_aPickedItems.size() )
 	{
@@ -894,10 +987,10 @@ void CBot::UpdateWorld()
 		if ( aItems.size() == 0)
 			continue;
 
-		good::vector<TEntityIndex>& aNearest = m_aNearestItems[iType];
+		near_items_t& aNearest = m_aNearestItems[iType];
 		int iNearestSize = aNearest.size();
 
-		good::vector<TEntityIndex>& aNear = m_aNearItems[iType];
+		near_items_t& aNear = m_aNearItems[iType];
 		int iNearSize = aNear.size();
 
 		// Update nearest items.
@@ -962,6 +1055,7 @@ void CBot::UpdateWorld()
 		if ( iCheckTo > aItems.size() )
 			iCheckTo = aItems.size();
 		
+		BOTRIX_PROFILE_COUNT(EProfileCountItemsScanned, iCheckTo - m_iNextNearItem[iType]);
 		for ( int i = m_iNextNearItem[iType]; i < iCheckTo; ++i )
 		{
 			const CEntity* pItem = &aItems[i];
@@ -1055,7 +1149,7 @@ void CBot::CheckEnemy( int iPlayerIndex, CPlayer* pPlayer, bool bCheckVisibility
 
 	bool bEnemyChanged = false;
 
-	if ( pPlayer->IsAlive() && ( !bCheckVisibility || IsVisible(pPlayer) ) ) // Currently seeing this player.
+	if ( pPlayer->IsAlive() && ( !bCheckVisibility || IsVisible(iPlayerIndex, pPlayer) ) ) // Currently seeing this player.
 	{
 		m_aSeenEnemies.set(iPlayerIndex);
 
@@ -1099,7 +1193,7 @@ void CBot::CheckEnemy( int iPlayerIndex, CPlayer* pPlayer, bool bCheckVisibility
 				{
 					Vector vSrc(m_vHead);
 					vSrc.z -= CUtil::iPlayerEyeLevel - CUtil::iPlayerEyeLevelCrouched;
-					m_bAttackDuck = CUtil::IsVisible( vSrc, m_pCurrentEnemy->GetHead()); // Duck, if enemy is visible while ducking.
+					m_bAttackDuck = IsVisibleRay( vSrc, m_pCurrentEnemy->GetHead() ); // Duck, if enemy is visible while ducking.
 				}
 			}
 			//else if ( m_iIntelligence >= EBotSmart ) // Bot is smart.
@@ -1122,7 +1216,7 @@ void CBot::EnemyAim()
 	Vector vEnemyCenter;
 	m_pCurrentEnemy->GetCenter( vEnemyCenter );
 
-	if ( !m_bShootAtHead && CUtil::IsVisible(m_vHead, vEnemyCenter) )
+	if ( !m_bShootAtHead && IsVisibleRay(m_vHead, vEnemyCenter) )
 		m_vLook = vEnemyCenter;
 	else
 		m_vLook = m_pCurrentEnemy->GetHead();
@@ -1137,13 +1231,18 @@ void CBot::EnemyAim()
 	// Take player's speed into account.
 	if ( m_iIntelligence >= EBotNormal )
 	{
+		static const float fMaxVelocity = 3500.0f; // sv_maxvelocity, faster move is teleport or respawn.
+
 		Vector vInc( m_pCurrentEnemy->GetHead() );
 		vInc -= m_pCurrentEnemy->GetPreviousHead();
 	
-		float fFramesLeft = m_fEndAimTime * CBotrixPlugin::iFPS; // How many frames left to aim?
-		vInc *= fFramesLeft;
-		 
-		m_vLook += vInc;
+		if ( vInc.LengthSqr() <= SQR(fMaxVelocity / CBotrixPlugin::iFPS) )
+		{
+			float fFramesLeft = m_fEndAimTime * CBotrixPlugin::iFPS; // How many frames left to aim?
+			vInc *= fFramesLeft;
+			 
+			m_vLook += vInc;
+		}
 	}
 	
 	m_fEndAimTime += CBotrixPlugin::fTime;
@@ -1349,6 +1448,8 @@ void CBot::CheckSideLook( bool bIsMoving, bool bNewDestination )
 //----------------------------------------------------------------------------------------------------------------
 bool CBot::ResolveStuckMove()
 {
+	BOTRIX_PROFILE_COUNT(EProfileCountStuckMoves, 1);
+
 	TWaypointId iPrevCurrWaypoint = iCurrentWaypoint;
 
 	// Reset waypoint.
@@ -1519,6 +1620,7 @@ bool CBot::NavigatorMove()
 		m_pNavigator.Stop();
 
 		DebugAssert( CWaypoint::IsValid(iCurrentWaypoint) && CWaypoint::IsValid(m_iDestinationWaypoint) && (m_iDestinationWaypoint != iCurrentWaypoint) );
+		BOTRIX_PROFILE_COUNT(EProfileCountNavSearches, 1);
 		m_bMoveFailure = !m_pNavigator.SearchSetup( iCurrentWaypoint, m_iDestinationWaypoint, m_aAvoidAreas );
 		iPrevWaypoint = iCurrentWaypoint;
 	}
@@ -1667,6 +1769,12 @@ void CBot::PerformMove( TWaypointId iPrevCurrentWaypoint, Vector const& vPrevOri
 			m_bNeedAim = false;
 		}
 
+		if ( !m_cCmd.viewangles.IsValid() )
+		{
+			m_cCmd.viewangles = angOld; // Don't let NaN get to engine, stop aiming.
+			m_bNeedAim = false;
+		}
+
 		CUtil::DeNormalizeAngle(m_cCmd.viewangles.x);
 		CUtil::DeNormalizeAngle(m_cCmd.viewangles.y);
 		
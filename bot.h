@@ -19,6 +19,7 @@
 #include "weapon.h"
 
 #include "good/bitset.h"
+#include "good/small_vector.h"
 
 
 #define BotMessage(...)             { if ( m_bDebugging ) CUtil::Message(NULL, __VA_ARGS__); }
@@ -72,6 +73,9 @@ public: // Methods.
 	/// Emulate console command for bot.
 	void ConsoleCommand(const char* szFormat, ...);
 
+	/// Get waypoint bot is moving to.
+	TWaypointId GetDestinationWaypoint() const { return m_iDestinationWaypoint; }
+
 	/// Use say command.
 	void Say(bool bTeamOnly, const char* szFormat, ...);
 
@@ -108,6 +112,9 @@ public: // Methods.
 	/// Called when 30 seconds has passed.
 	virtual void EndPerformingChatRequest( bool bSayGoodbye );
 
+	/// Get name of current task, for reports.
+	virtual const good::string& GetTaskName() const;
+
 
 private:
 	// Called every frame to evaluate next move. Note that this method is private, use Move() method in subclasses.
@@ -158,8 +165,15 @@ protected: // Methods.
 	/// Say current chat.
 	void Speak( bool bTeamSay );
 
-	// Return true if entity is inside bot's view cone.
-	bool IsVisible( CPlayer* pPlayer ) const;
+	// Update sight for this frame: forward vector of view cone.
+	void UpdateSight();
+
+	// Return true if player is inside bot's view cone and is visible. Cheap checks go first: distance, view cone
+	// and PVS, ray is traced only if all of them pass. Result is reused by next checks of this player in same frame.
+	bool IsVisible( int iPlayerIndex, CPlayer* pPlayer );
+
+	// Return true if vDest is visible from vSrc. Checks distance and PVS before tracing a ray.
+	bool IsVisibleRay( const Vector& vSrc, const Vector& vDest );
 
 	// Move failure is produced when current waypoint is invalid or when using navigator,
 	// there is no path from current to next waypoint.
@@ -171,7 +185,7 @@ protected: // Methods.
 				m_bMoveFailure = true;
 			else if ( m_bNeedMove && m_bUseNavigatorToMove && m_pNavigator.SearchEnded() && !m_bDestinationChanged &&
 			        ( !CWaypoint::IsValid(iNextWaypoint) || 
-					( (iCurrentWaypoint != iNextWaypoint) && !CWaypoints::HasPath(iCurrentWaypoint, iNextWaypoint) ) ) )
+					( (iCurrentWaypoint != iNextWaypoint) && (CWaypoints::GetNavPath(iCurrentWaypoint, iNextWaypoint) == NULL) ) ) )
 				m_bMoveFailure = true;
 		}
 		return m_bMoveFailure;
@@ -315,6 +329,23 @@ protected: // Members.
 
 	static float m_fTimeIntervalCheckUsingMachines;                // After this interval will check if health/armor is incrementing (when using health/armor machine).
 	static int m_iCheckEntitiesPerFrame;                           // How much near items check per frame (to know if bot is stucked with objects or picked up item).
+	static float m_fSightDistanceSqr;                              // Bot doesn't see players farther than this (squared distance).
+	static float m_fSightConeCosSqr;                               // Squared cosine of half angle of cone around bot's view angles.
+
+	// Result of sight check of one player.
+	enum TSights
+	{
+		ESightFar = 0,                                             // Player is too far.
+		ESightOutOfView,                                           // Player is outside of view cone.
+		ESightOutOfPvs,                                            // Player is outside of PVS.
+		ESightHidden,                                              // Ray to player is blocked.
+		ESightVisible,                                             // Player is visible.
+	};
+	typedef struct
+	{
+		float fTime;                                               // Time of frame of this result.
+		int iSight;                                                // Result of sight check (TSights).
+	} sight_t;
 
 	IBotController* m_pController;                                 // Bot controller (used to apply bot's command).
 	CBotCmd m_cCmd;                                                // Bot's command (virtual keyboard, used to move bot around and fire weapons).
@@ -349,8 +380,9 @@ protected: // Members.
 	CWaypointNavigator m_pNavigator;                               // Waypoint navigator.
 	good::vector<TAreaId> m_aAvoidAreas;                           // Array of areas waypoint navigator must avoid.
 
-	good::vector<TEntityIndex> m_aNearestItems[EEntityTypeTotal];  // Nearest items from m_aNearItems that are checked every frame (to know if bot picked them up).
-	good::vector<TEntityIndex> m_aNearItems[EEntityTypeTotal];     // Items in close range.
+	typedef good::small_vector<TEntityIndex, 8> near_items_t;      // Few items are near, so they are stored inside bot.
+	near_items_t m_aNearestItems[EEntityTypeTotal];                // Nearest items from m_aNearItems that are checked every frame (to know if bot picked them up).
+	near_items_t m_aNearItems[EEntityTypeTotal];                   // Items in close range.
 	int m_iNextNearItem[EEntityTypeTotal];                         // Next item to check if close (index in array CItems::GetItems()).
 
 	good::bitset m_aNearPlayers;                                   // Bitset of players near (to know if bot can stuck with them).
@@ -358,6 +390,10 @@ protected: // Members.
 	good::bitset m_aEnemies;                                       // Bitset of enemies that bot can't see right now, but it knows they are there.
 	int m_iNextCheckPlayer;                                        // Next player to check if close.
 
+	float m_fSightTime;                                            // Time of frame when sight was updated.
+	Vector m_vSightForward;                                        // Forward vector of bot's view angles.
+	good::vector<sight_t> m_aSights;                               // Sight check results of players in current frame.
+
 	CPlayer* m_pCurrentEnemy;                                      // Current enemy.
 	float m_fDistanceSqrToEnemy;                                   // If m_pCurrentEnemy is not NULL, squared distance to it.
 	
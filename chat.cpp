@@ -1,9 +1,13 @@
 #include <stdlib.h> // rand()
 
+#include "tier0/platform.h" // Plat_FloatTime()
+
+#include "good/arena.h"
 #include "good/string_buffer.h"
 
 #include "chat.h"
 #include "players.h"
+#include "profiler.h"
 #include "source_engine.h"
 #include "type2string.h"
 
@@ -62,11 +66,23 @@ TChatVariable CChat::iPlayerVar = EChatVariableInvalid;
 good::vector<CPhrase> CChat::m_aMatchPhrases[EBotChatTotal]; // Phrases for commands used for matching.
 good::vector<CPhrase> CChat::m_aPhrases[EBotChatTotal];      // Phrases for commands used for generation of commands.
 
-good::vector<StringVector> CChat::m_aSynonims;               // Available synonims.
-
 StringVector CChat::m_aVariables;                            // Available variable names ($player, $door, $button, etc).
 good::vector<StringVector> CChat::m_aVariableValues;         // Available variable values (1, 2, opened, closed, weapon_...).
 
+good::string_pool CChat::m_cWordNames;                       // Pool of words and their synonims.
+good::vector<TChatWord> CChat::m_aNameWords;                 // Word number for each id in m_cWordNames.
+StringVector CChat::m_aWords;                                // Word for each word number (first synonim).
+good::vector< good::vector<int> > CChat::m_aWordPhrases;     // Compiled phrases that contain each word.
+good::hash_map<good::string, CChat::CWordValues> CChat::m_cValueWords; // Variable values by their text.
+good::vector< good::vector<int> > CChat::m_aVariablePhrases; // Compiled phrases that contain each variable.
+good::vector< good::pair<TBotChat, int> > CChat::m_aCompiledPhrases; // Command and phrase index of each compiled phrase.
+good::vector<int> CChat::m_aPhraseStamps;                    // To not check same phrase twice in ChatFromText().
+good::vector<int> CChat::m_aPhraseSlots;                     // Index in span phrases of ChatsFromText(), valid if phrase is stamped.
+int CChat::m_iPhraseStamp = 0;                               // Current stamp for ChatFromText().
+int CChat::m_iMatchCost = 0;                                 // Comparisons of spoken and phrase words made by last ChatsFromText().
+int CChat::m_iMaxPhraseSize = 0;                             // Max amount of words in a phrase.
+bool CChat::m_bCompiled = false;                             // False if Compile() must be called before matching.
+
 
 //----------------------------------------------------------------------------------------------------------------
 void CChat::Init()
@@ -81,23 +97,62 @@ void CChat::Terminate()
 }
 
 //----------------------------------------------------------------------------------------------------------------
-const good::string& CChat::GetSynonim( const good::string& sSentence )
+const good::string& CChat::GetSynonim( const good::string& sWord )
+{
+	TChatWord iWord = GetWord(sWord);
+	return ( iWord == EChatWordInvalid ) ? sWord : m_aWords[iWord];
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+TChatWord CChat::AddWord( const good::string& sWord )
 {
-	for ( int iWord = 0; iWord < m_aSynonims.size(); ++iWord )
+	int iName = m_cWordNames.intern(sWord);
+	if ( iName == m_aNameWords.size() )
+		m_aNameWords.push_back(EChatWordInvalid);
+
+	TChatWord iWord = m_aNameWords[iName];
+	if ( iWord == EChatWordInvalid )
 	{
-		StringVector& aSynonims = m_aSynonims[iWord];
+		iWord = m_aWords.size();
+		m_aWords.push_back( m_cWordNames[iName] ); // Doesn't own memory, pool does.
+		m_aWordPhrases.push_back( good::vector<int>() );
+		m_aNameWords[iName] = iWord;
+	}
+	return iWord;
+}
 
-		// Check if sentence starts with some of this synonims.
-		for ( int iSynonim = 0; iSynonim < aSynonims.size(); ++iSynonim )
+
+//----------------------------------------------------------------------------------------------------------------
+void CChat::AddWordValue( TChatVariable iVar, TChatVariableValue iValue )
+{
+	const good::string& sValue = m_aVariableValues[iVar][iValue];
+	if ( sValue.size() == 0 )
+		return;
+
+	good::hash_map<good::string, CWordValues>::iterator it = m_cValueWords.find(sValue);
+	if ( it == m_cValueWords.end() )
+		it = m_cValueWords.insert( good::pair<good::string, CWordValues>( sValue.duplicate(), CWordValues() ) );
+	it->second.push_back( CWordValue(iVar, iValue) );
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+void CChat::RemoveWordValue( TChatVariable iVar, TChatVariableValue iValue )
+{
+	good::hash_map<good::string, CWordValues>::iterator it = m_cValueWords.find( m_aVariableValues[iVar][iValue] );
+	if ( it == m_cValueWords.end() )
+		return;
+
+	CWordValues& aValues = it->second;
+	for ( int i = 0; i < aValues.size(); ++i )
+		if ( (aValues[i].first == iVar) && (aValues[i].second == iValue) )
 		{
-			const good::string& sSynonim = aSynonims[iSynonim];
-			bool bBigger = sSentence.size() >  sSynonim.size();
-			bool bEqual  = sSentence.size() == sSynonim.size();
-			if ( ( (bBigger && (sSentence[sSynonim.size()] == ' ')) || bEqual ) && sSentence.starts_with(sSynonim) )
-				return sSynonim;
+			aValues.erase(i);
+			break;
 		}
-	}
-	return sSentence;
+	if ( aValues.size() == 0 )
+		m_cValueWords.erase(it); // So names of players that left don't stay.
 }
 
 
@@ -116,7 +171,16 @@ void CChat::AddSynonims( const good::string& sKey, const good::string& sValue )
 
 	ChatMessage( "  %s", CTypeToString::StringVectorToString(aSynonims).c_str() );
 
-	m_aSynonims.push_back(aSynonims);
+	// All synonims share number of first word.
+	TChatWord iWord = AddWord(aSynonims[0]);
+	for ( int i = 1; i < aSynonims.size(); ++i )
+	{
+		int iName = m_cWordNames.intern(aSynonims[i]);
+		if ( iName == m_aNameWords.size() )
+			m_aNameWords.push_back(iWord);
+		else if ( m_aNameWords[iName] == EChatWordInvalid )
+			m_aNameWords[iName] = iWord;
+	}
 }
 
 
@@ -425,50 +489,194 @@ bool CChat::AddChat( const good::string& sKey, const good::string& sValue )
 	return true;
 }
 
-	
+
 //----------------------------------------------------------------------------------------------------------------
-float CChat::ChatFromText( const good::string& sText, CBotChat& cCommand )
+void CChat::Compile()
+{
+	m_aCompiledPhrases.clear();
+	m_iMaxPhraseSize = 0;
+	for ( int i = 0; i < m_aWordPhrases.size(); ++i )
+		m_aWordPhrases[i].clear();
+	m_aVariablePhrases.resize( m_aVariables.size() );
+	for ( int i = 0; i < m_aVariablePhrases.size(); ++i )
+		m_aVariablePhrases[i].clear();
+
+	for ( TBotChat iCommand = 0; iCommand < EBotChatTotal; ++iCommand )
+	{
+		for ( int iPhrase = 0; iPhrase < m_aMatchPhrases[iCommand].size(); ++iPhrase )
+		{
+			int iCompiled = m_aCompiledPhrases.size();
+			m_aCompiledPhrases.push_back( good::pair<TBotChat, int>(iCommand, iPhrase) );
+
+			CPhrase& cPhrase = m_aMatchPhrases[iCommand][iPhrase];
+			cPhrase.iTotalRequired = 0;
+			if ( m_iMaxPhraseSize < cPhrase.aWords.size() )
+				m_iMaxPhraseSize = cPhrase.aWords.size();
+			for ( int iWord = 0; iWord < cPhrase.aWords.size(); ++iWord )
+			{
+				CPhraseWord& cWord = cPhrase.aWords[iWord];
+				good::vector<int>* pPhrases = NULL;
+
+				if ( cWord.sWord.starts_with('$') )
+				{
+					good::pair<TChatVariable, int> pair = GetVariableAndIndex( cWord.sWord );
+					cWord.iWord = EChatWordInvalid;
+					cWord.iVar = pair.first;
+					cWord.iVarIndex = pair.second;
+					if ( cWord.iVar == EChatVariableInvalid )
+						ChatError( "Error, unknown chat variable %s.", cWord.sWord.c_str() );
+					else
+						pPhrases = &m_aVariablePhrases[cWord.iVar];
+				}
+				else
+				{
+					cWord.iWord = AddWord( cWord.sWord );
+					cWord.iVar = EChatVariableInvalid;
+					pPhrases = &m_aWordPhrases[cWord.iWord];
+				}
+
+				if ( pPhrases && ( (pPhrases->size() == 0) || (pPhrases->back() != iCompiled) ) )
+					pPhrases->push_back(iCompiled);
+
+				if ( !cWord.bOptional )
+					cPhrase.iTotalRequired++; // Count amount of required words in this phrase.
+			}
+		}
+	}
+
+	m_aPhraseStamps.clear();
+	m_aPhraseStamps.resize( m_aCompiledPhrases.size(), 0 );
+	m_aPhraseSlots.resize( m_aCompiledPhrases.size(), 0 );
+	m_iPhraseStamp = 0;
+	m_bCompiled = true;
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+float CChat::MatchPhrase( const CPhrase& cPhrase, const CSpokenWord* aWords, int iSize, CChatVariablesMap& cMatchMap, int& iFound )
+{
+	static good::vector<bool> cFounded; // To know if word is in the matching phrase.
+	cFounded.resize( iSize );
+	memset( cFounded.data(), false, sizeof(bool) * cFounded.size() );
+
+	cMatchMap.clear();
+	iFound = 0;
+	int iRequired = 0, iOrdered = 0, iPrevPos = 0;
+
+	for ( int iWord = 0; iWord < cPhrase.aWords.size(); ++iWord )
+	{
+		const CPhraseWord& cPhraseWord = cPhrase.aWords[iWord];
+
+		// Check if word in match phrase occurres in spoken sentence.
+		int iWordIndex = -1;
+		if ( cPhraseWord.iVar == EChatVariableInvalid )
+		{
+			if ( cPhraseWord.iWord != EChatWordInvalid )
+				for ( int i = 0; i < iSize; ++i )
+					if ( !cFounded[i] && (cPhraseWord.iWord == aWords[i].iWord) )
+					{
+						iWordIndex = i;
+						break;
+					}
+		}
+		else
+		{
+			// First spoken word that is a value of this variable. Use first value if there are equal ones.
+			TChatVariableValue iValue = EChatVariableValueInvalid;
+			for ( int i = 0; (i < iSize) && (iValue == EChatVariableValueInvalid); ++i )
+			{
+				if ( cFounded[i] || (aWords[i].pValues == NULL) )
+					continue;
+				const CWordValues& aValues = *aWords[i].pValues;
+				for ( int j = 0; j < aValues.size(); ++j )
+					if ( (aValues[j].first == cPhraseWord.iVar) &&
+					     ( (iValue == EChatVariableValueInvalid) || (aValues[j].second < iValue) ) )
+					{
+						iWordIndex = i;
+						iValue = aValues[j].second;
+					}
+			}
+			if ( iValue != EChatVariableValueInvalid )
+				cMatchMap.push_back( CChatVarValue(cPhraseWord.iVar, cPhraseWord.iVarIndex, iValue) );
+		}
+
+		if ( iWordIndex != -1 )
+		{
+			iFound++;
+			cFounded[iWordIndex] = true;
+
+			if ( !cPhraseWord.bOptional )
+				iRequired++;
+
+			if ( iPrevPos <= iWordIndex )
+				iOrdered++;
+
+			iPrevPos = iWordIndex;
+		}
+	}
+
+	m_iMatchCost += cPhrase.aWords.size() * iSize;
+	return PhraseImportance( cPhrase, iSize, iFound, iRequired, iOrdered );
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+float CChat::PhraseImportance( const CPhrase& cPhrase, int iSize, int iFound, int iRequired, int iOrdered )
+{
+	int iTotalRequired = cPhrase.iTotalRequired;
+	int iOptionals = iFound-iRequired;
+	int iTotalOptionals = cPhrase.aWords.size() - iTotalRequired;
+	int iExtra = iSize - iFound;
+
+	// Give more importance to requiered words (not optionals), and less to optionals and words order.
+	float fImportance = 0.0f;
+	fImportance += 6*( (iTotalRequired) ? iRequired / (float)iTotalRequired : 0 );    // + Ratio of matched requered words.
+	fImportance += 1*( (iTotalOptionals) ? iOptionals / (float)iTotalOptionals : 1 ); // + Ratio of matched optional words.
+	fImportance += 3*( iOrdered / (float)cPhrase.aWords.size() );                     // + Ratio of matched ordered words.
+	//fImportance += (chrEnd == cPhrase.chrPhraseEnd) ? 1 : 0;                          // + 1 if ends with same symbol as matching phrase (. ? !).
+
+	fImportance -= 4*( iExtra / (iTotalRequired ? iTotalRequired : 1) );             // - Ratio of not matched words.
+	return fImportance;
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+void CChat::GetSpokenWords( const good::string& sText, good::vector<CSpokenWord>& aWords, good::vector<int>& aSentenceStart )
 {
 	good::string_buffer sbBuffer(szMainBuffer, iMainBufferSize, false);
 	sbBuffer = sText;
 	sbBuffer.trim();
 	sbBuffer.lower_case();
 
-	cCommand.iBotChat = EBotChatUnknown;
-	cCommand.iDirectedTo = -1;
+	aWords.clear();
+	aSentenceStart.clear();
 	if ( sbBuffer.size() == 0 )
-		return 0.0f;
+		return;
 
 	if ( !sbBuffer.ends_with('.') && !sbBuffer.ends_with('!') && !sbBuffer.ends_with('?') )
 		sbBuffer.append('.');
 
-	StringVector aPhrases[1]; // TODO: multiple commands in one sentence.
-	int iCurrentPhrase = 0, iBegin = 0;
-	char chrEnd;
+	int iBegin = 0, iSentenceStart = 0;
 
-	// Replace player's names and synonims.
+	// Get numbers of spoken words, synonims have same number. Unknown words are kept to count them as extra.
 	for ( int iPos = 0; iPos < sbBuffer.size(); ++iPos )
 	{
-		bool bWord = false, bEnd = false, bComma = false;
+		bool bWord = false, bEnd = false;
 		switch ( sbBuffer[iPos] )
 		{
 		case ' ':
 		case '\t':
 		case '\n':
 		case '\r':
-			bWord = true;
-			break;
-
 		case ',':  // Don't mind commas.
 		case ';':
-			bWord = bComma = true;
+			bWord = true;
 			break;
 
 		case '.':
 		case '?':
 		case '!':
 			bWord = bEnd = true;
-			chrEnd = sbBuffer[iPos];
 			break;
 		}
 
@@ -476,161 +684,361 @@ float CChat::ChatFromText( const good::string& sText, CBotChat& cCommand )
 		{
 			if ( iPos - iBegin > 0 ) // At least one character in the word.
 			{
-				// Check for synonims.
 				szMainBuffer[iPos] = 0;
 				good::string sCurr( &szMainBuffer[iBegin], false, false, iPos - iBegin );
-				const good::string& sSynonim = GetSynonim(sCurr);
-
-				aPhrases[iCurrentPhrase].push_back( good::string(sSynonim) ); // Don't copy string, we will just use it for matching.
+				good::hash_map<good::string, CWordValues>::const_iterator it = m_cValueWords.find(sCurr);
+				CSpokenWord cWord = { GetWord(sCurr), (it == m_cValueWords.end()) ? NULL : &it->second };
+				aWords.push_back( cWord );
+				aSentenceStart.push_back( iSentenceStart );
 			}
 			iBegin = iPos+1;
 		}
 
 		if ( bEnd )
-			break;
+			iSentenceStart = aWords.size();
 	}
+}
 
-	StringVector& aWords = aPhrases[0]; // TODO: detect 2+ commands in one sentence.
-	
-	good::vector<bool> cFounded; // To know if word is in the matching phrase.
-	cFounded.resize( aWords.size() );
 
-	CChatVariablesMap cMatchMap(4);
+//----------------------------------------------------------------------------------------------------------------
+float CChat::MatchWords( const CSpokenWord* aWords, int iSize, CBotChat& cCommand, int& iFound )
+{
+	iFound = 0;
+	cCommand.iBotChat = EBotChatUnknown;
+	cCommand.iDirectedTo = -1;
+	cCommand.cMap.clear();
 
-	if ( aWords.size() == 0 )
-		return 0.0f;
+	// Get phrases that have at least one of spoken words or variable values. Phrase without any match can't get
+	// more than 1 point of importance (all words optional), so it can't be better than any candidate phrase.
+	static good::vector<int> aCandidates;
+	aCandidates.clear();
 
-	// Search in all commands for match.
-	int iBestFound, iBestRequired, iBestOrdered;
-	int iBestPhrase, iBestTotalRequired;
+	NewPhraseStamp();
+	for ( int i = 0; i < iSize; ++i )
+	{
+		if ( aWords[i].iWord != EChatWordInvalid )
+		{
+			const good::vector<int>& aPhrases = m_aWordPhrases[ aWords[i].iWord ];
+			for ( int j = 0; j < aPhrases.size(); ++j )
+				if ( m_aPhraseStamps[ aPhrases[j] ] != m_iPhraseStamp )
+				{
+					m_aPhraseStamps[ aPhrases[j] ] = m_iPhraseStamp;
+					aCandidates.push_back( aPhrases[j] );
+				}
+		}
+
+		if ( aWords[i].pValues == NULL )
+			continue;
+		const CWordValues& aValues = *aWords[i].pValues;
+		for ( int v = 0; v < aValues.size(); ++v )
+		{
+			const good::vector<int>& aVarPhrases = m_aVariablePhrases[ aValues[v].first ];
+			for ( int j = 0; j < aVarPhrases.size(); ++j )
+				if ( m_aPhraseStamps[ aVarPhrases[j] ] != m_iPhraseStamp )
+				{
+					m_aPhraseStamps[ aVarPhrases[j] ] = m_iPhraseStamp;
+					aCandidates.push_back( aVarPhrases[j] );
+				}
+		}
+	}
+
+	// Search in candidate phrases for best match.
+	static CChatVariablesMap cMatchMap(4);
+	int iBestCompiled = -1;
 	float fBestImportance = 0.0f; // Number from 0 to 10, represents how good matching is.
 
-	for ( TBotChat iCommand = 0; iCommand < EBotChatTotal; ++iCommand )
+	for ( int i = 0; i < aCandidates.size(); ++i )
 	{
-		for ( int iPhrase = 0; iPhrase < m_aMatchPhrases[iCommand].size(); ++iPhrase )
+		int iCompiled = aCandidates[i];
+		const good::pair<TBotChat, int>& cCompiled = m_aCompiledPhrases[iCompiled];
+		int iPhraseFound;
+		float fImportance = MatchPhrase( m_aMatchPhrases[cCompiled.first][cCompiled.second], aWords, iSize, cMatchMap, iPhraseFound );
+
+		// On tie prefer first command / phrase.
+		if ( (fBestImportance < fImportance) || ( (fBestImportance == fImportance) && (iCompiled < iBestCompiled) ) )
 		{
-			cMatchMap.clear();
-			int iFound = 0, iRequired = 0, iOrdered = 0, iTotalRequired = 0, iPrevPos = 0;
+			fBestImportance = fImportance;
+			iBestCompiled = iCompiled;
+			iFound = iPhraseFound;
+			cCommand.iBotChat = cCompiled.first;
+
+			cCommand.cMap.clear();
+			for ( int j = 0; j < cMatchMap.size(); ++j )
+				cCommand.cMap.push_back( cMatchMap[j] );
+		}
+	}
+
+	if ( fBestImportance > 0.0f )
+		SetDirectedTo(cCommand);
+	return fBestImportance;
+}
 
-			// Set all cFounded to false.
-			memset( cFounded.data(), false, sizeof(bool) * cFounded.size() );
 
-			CPhrase& currPhrase = m_aMatchPhrases[iCommand][iPhrase];
-			for ( int iWord = 0; iWord < currPhrase.aWords.size(); ++iWord )
+//----------------------------------------------------------------------------------------------------------------
+void CChat::NewPhraseStamp()
+{
+	if ( ++m_iPhraseStamp <= 0 ) // Overflow.
+	{
+		memset( m_aPhraseStamps.data(), 0, sizeof(int) * m_aPhraseStamps.size() );
+		m_iPhraseStamp = 1;
+	}
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+void CChat::AddSpanWord( CSpanPhrase& cSpan, int* aPositions, const CSpokenWord& cWord, int iPos )
+{
+	const good::pair<TBotChat, int>& cCompiled = m_aCompiledPhrases[cSpan.iCompiled];
+	const CPhrase& cPhrase = m_aMatchPhrases[cCompiled.first][cCompiled.second];
+
+	// As in MatchPhrase(), spoken word goes to first phrase word that it matches and that has no spoken word yet.
+	// Added word is after all others, so phrase words that already have spoken words keep them.
+	for ( int iWord = 0; iWord < cPhrase.aWords.size(); ++iWord )
+	{
+		m_iMatchCost++;
+		const CPhraseWord& cPhraseWord = cPhrase.aWords[iWord];
+		if ( aPositions[iWord] != -1 )
+			continue;
+
+		bool bMatch = false;
+		if ( cPhraseWord.iVar == EChatVariableInvalid )
+			bMatch = (cPhraseWord.iWord != EChatWordInvalid) && (cPhraseWord.iWord == cWord.iWord);
+		else if ( cWord.pValues )
+			for ( int i = 0; (i < cWord.pValues->size()) && !bMatch; ++i )
+				bMatch = ( (*cWord.pValues)[i].first == cPhraseWord.iVar );
+		if ( !bMatch )
+			continue;
+
+		aPositions[iWord] = iPos;
+		cSpan.iFound++;
+		if ( !cPhraseWord.bOptional )
+			cSpan.iRequired++;
+
+		// Count matched words in order again, as word before the new one may not be in order anymore.
+		cSpan.iOrdered = 0;
+		int iPrevPos = 0;
+		for ( int i = 0; i < cPhrase.aWords.size(); ++i )
+			if ( aPositions[i] != -1 )
 			{
-				const CPhraseWord& cPhraseWord = currPhrase.aWords[iWord];
+				if ( iPrevPos <= aPositions[i] )
+					cSpan.iOrdered++;
+				iPrevPos = aPositions[i];
+			}
+		return;
+	}
+}
 
-				// Check if word is a chat variable.
-				TChatVariable iVar = EChatVariableInvalid;
-				int iVarNumber = 0;
-				if ( cPhraseWord.sWord.starts_with('$') )
-				{
-					good::pair<TChatVariable, int> pair = GetVariableAndIndex( cPhraseWord.sWord );
-					iVar = pair.first;
-					iVarNumber = pair.second;
-					DebugAssert( iVar != EChatVariableInvalid );
-				}
 
-				// Check if word in match phrase occurres in spoken sentence.
-				int iWordIndex = -1;
-				if ( iVar == EChatVariableInvalid )
+//----------------------------------------------------------------------------------------------------------------
+void CChat::SetDirectedTo( CBotChat& cCommand )
+{
+	for ( int i=0; i < cCommand.cMap.size(); ++i )
+	{
+		CChatVarValue& cVar = cCommand.cMap[i];
+		if ( cVar.iVar == iPlayerVar )
+			if ( (cVar.iVarIndex == 0) || (cVar.iVarIndex == 1) ) // $player or $player1.
+				cCommand.iDirectedTo = cVar.iValue;
+	}
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+float CChat::ChatFromText( const good::string& sText, CBotChat& cCommand )
+{
+	BOTRIX_PROFILE_SCOPE(EProfileChat);
+	BOTRIX_PROFILE_COUNT(EProfileCountChatMatched, 1);
+
+	if ( !m_bCompiled )
+		Compile();
+
+	static good::vector<CSpokenWord> aWords;
+	static good::vector<int> aSentenceStart;
+	GetSpokenWords( sText, aWords, aSentenceStart );
+
+	// Use only first sentence.
+	int iSize = 0;
+	while ( (iSize < aWords.size()) && (aSentenceStart[iSize] == 0) )
+		iSize++;
+
+	float fImportance = 0.0f;
+	int iFound;
+	if ( iSize > 0 )
+		fImportance = MatchWords( aWords.data(), iSize, cCommand, iFound );
+
+	if ( fImportance <= 0.0f )
+	{
+		cCommand.iBotChat = EBotChatUnknown;
+		cCommand.iDirectedTo = -1;
+		ChatMessage( "No match found." );
+	}
+	return fImportance;
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+int CChat::ChatsFromText( const good::string& sText, good::vector<CBotChat>& aCommands )
+{
+	BOTRIX_PROFILE_SCOPE(EProfileChat);
+	BOTRIX_PROFILE_COUNT(EProfileCountChatMatched, 1);
+
+	if ( !m_bCompiled )
+		Compile();
+
+	m_iMatchCost = 0;
+	static good::vector<CSpokenWord> aWords;
+	static good::vector<int> aSentenceStart;
+	GetSpokenWords( sText, aWords, aSentenceStart );
+
+	int iSize = aWords.size();
+	if ( iSize == 0 )
+		return 0;
+
+	// Temporaries are taken from arena of current frame and released at end of this function.
+	good::arena_scope cScope;
+
+	// Score spans. Span of words [i, j) gets importance and amount of matched words of its best phrase. Span grows
+	// from word i one word at a time, and only phrases that have the added word (or its variable value) are updated.
+	int iMaxSpan = 2 * m_iMaxPhraseSize;
+	good::vector< float, good::frame_allocator<float> > aSpanImportance(iSize * iMaxSpan);
+	good::vector< int, good::frame_allocator<int> > aSpanFound(iSize * iMaxSpan);
+	aSpanImportance.resize(iSize * iMaxSpan, 0.0f);
+	aSpanFound.resize(iSize * iMaxSpan, 0);
+
+	good::vector< CSpanPhrase, good::frame_allocator<CSpanPhrase> > aPhrases( m_aCompiledPhrases.size() );
+	good::vector< int, good::frame_allocator<int> > aPositions( m_aCompiledPhrases.size() * m_iMaxPhraseSize ); // Spoken word of each phrase word.
+	good::vector< int, good::frame_allocator<int> > aTouched( m_aCompiledPhrases.size() );
+
+	for ( int i = 0; i < iSize; ++i )
+	{
+		NewPhraseStamp();
+		aPhrases.clear();
+		aPositions.clear();
+
+		int iEnd = MIN2(iSize, i + iMaxSpan);
+		for ( int j = i + 1; (j <= iEnd) && (aSentenceStart[j-1] == aSentenceStart[i]); ++j )
+		{
+			const CSpokenWord& cWord = aWords[j-1];
+
+			// Phrases that have added word or one of its values.
+			aTouched.clear();
+			if ( cWord.iWord != EChatWordInvalid )
+			{
+				const good::vector<int>& aWordPhrases = m_aWordPhrases[cWord.iWord];
+				for ( int p = 0; p < aWordPhrases.size(); ++p )
+					aTouched.push_back( aWordPhrases[p] );
+			}
+			if ( cWord.pValues )
+				for ( int v = 0; v < cWord.pValues->size(); ++v )
 				{
-					for ( int i = 0; i < aWords.size(); ++i )
-						if ( !cFounded[i] && (cPhraseWord.sWord == aWords[i]) )
-						{
-							iWordIndex = i;
-							break;
-						}
+					const good::vector<int>& aVarPhrases = m_aVariablePhrases[ (*cWord.pValues)[v].first ];
+					for ( int p = 0; p < aVarPhrases.size(); ++p )
+						aTouched.push_back( aVarPhrases[p] );
 				}
-				else
+
+			for ( int p = 0; p < aTouched.size(); ++p )
+			{
+				int iCompiled = aTouched[p];
+				if ( m_aPhraseStamps[iCompiled] != m_iPhraseStamp )
 				{
-					const StringVector& cValues = m_aVariableValues[iVar];
-					TChatVariableValue iValue = EChatVariableValueInvalid;
-					for ( int i = 0; i < aWords.size(); ++i )
-						if ( !cFounded[i] )
-							for ( StringVector::const_iterator it = cValues.begin(); it != cValues.end(); ++it )
-								if ( *it == aWords[i] )
-								{
-									iWordIndex = i;
-									iValue = it - cValues.begin();
-									goto found; // Break twice.
-								}
-				found:
-					if ( iValue != EChatVariableValueInvalid )
-						cMatchMap.push_back( CChatVarValue(iVar, iVarNumber, iValue) );
+					m_aPhraseStamps[iCompiled] = m_iPhraseStamp;
+					m_aPhraseSlots[iCompiled] = aPhrases.size();
+					CSpanPhrase cSpan = { iCompiled, 0, 0, 0, 0 };
+					aPhrases.push_back(cSpan);
+					aPositions.resize(aPositions.size() + m_iMaxPhraseSize, -1);
 				}
 
-				if ( !cPhraseWord.bOptional )
-					iTotalRequired++; // Count amount of required words in this phrase.
+				int iSlot = m_aPhraseSlots[iCompiled];
+				if ( aPhrases[iSlot].iStep == j ) // Phrase has both word and its value.
+					continue;
+				aPhrases[iSlot].iStep = j;
+				AddSpanWord( aPhrases[iSlot], &aPositions[iSlot * m_iMaxPhraseSize], cWord, j - 1 - i );
+			}
 
-				if ( iWordIndex != -1 )
+			// Best phrase for the span. On tie prefer first command / phrase, as MatchWords() does.
+			float fBestImportance = 0.0f;
+			int iBestCompiled = -1, iBestFound = 0;
+			for ( int p = 0; p < aPhrases.size(); ++p )
+			{
+				const CSpanPhrase& cSpan = aPhrases[p];
+				const good::pair<TBotChat, int>& cCompiled = m_aCompiledPhrases[cSpan.iCompiled];
+				float fImportance = PhraseImportance( m_aMatchPhrases[cCompiled.first][cCompiled.second], j - i,
+				                                      cSpan.iFound, cSpan.iRequired, cSpan.iOrdered );
+				if ( (fBestImportance < fImportance) || ( (fBestImportance == fImportance) && (cSpan.iCompiled < iBestCompiled) ) )
 				{
-					iFound++;
-					cFounded[iWordIndex] = true;
-					
-					if ( !currPhrase.aWords[iWord].bOptional )
-						iRequired++;
-
-					if ( iPrevPos <= iWordIndex )
-						iOrdered++;
-
-					iPrevPos = iWordIndex;
+					fBestImportance = fImportance;
+					iBestCompiled = cSpan.iCompiled;
+					iBestFound = cSpan.iFound;
 				}
 			}
+			aSpanImportance[i * iMaxSpan + j - i - 1] = fBestImportance;
+			aSpanFound[i * iMaxSpan + j - i - 1] = iBestFound;
+		}
+	}
+
+	// aBest[j] is best value for first j words, aFrom[j] is start of last request span ending at word j, or -1 if
+	// word j-1 doesn't belong to any request. Value of request span is importance ratio for each matched word, minus
+	// 1 for each not matched word, so that unrelated words are left out of requests.
+	good::vector< float, good::frame_allocator<float> > aBest(iSize + 1);
+	good::vector< int, good::frame_allocator<int> > aFrom(iSize + 1);
+	aBest.resize(iSize + 1);
+	aFrom.resize(iSize + 1);
+	aBest[0] = 0.0f;
+	aFrom[0] = -1;
+
+	for ( int j = 1; j <= iSize; ++j )
+	{
+		aBest[j] = aBest[j-1]; // Skip word j-1.
+		aFrom[j] = -1;
+
+		// Check longer spans first, so on tie there are less requests.
+		for ( int i = MAX2( aSentenceStart[j-1], j - iMaxSpan ); i < j; ++i )
+		{
+			float fImportance = aSpanImportance[i * iMaxSpan + j - i - 1];
+			if ( fImportance < CHAT_REQUEST_IMPORTANCE )
+				continue;
 
-			int iOptionals = iFound-iRequired;
-			int iTotalOptionals = currPhrase.aWords.size() - iTotalRequired;
-			int iExtra = aWords.size() - iFound;
-			int iLeft = currPhrase.aWords.size() - iFound;
-
-			// Give more importance to requiered words (not optionals), and less to optionals and words order.
-			float fImportance = 0.0f;
-			//fImportance = (float)iFound/currPhrase.aWords.size() - (float)(iExtra+iLeft)/( aWords.size() + currPhrase.aWords.size() );
-			//fImportance *= 10.0f;
-			fImportance += 6*( (iTotalRequired) ? iRequired / (float)iTotalRequired : 0 );    // + Ratio of matched requered words.
-			fImportance += 1*( (iTotalOptionals) ? iOptionals / (float)iTotalOptionals : 1 ); // + Ratio of matched optional words.
-			fImportance += 3*( iOrdered / (float)currPhrase.aWords.size() );                  // + Ratio of matched ordered words.
-			//fImportance += (chrEnd == currPhrase.chrPhraseEnd) ? 1 : 0;                       // + 1 if ends with same symbol as matching phrase (. ? !).
-
-			fImportance -= 4*( iExtra / iTotalRequired );                               // - Ratio of not matched words.
-
-			if ( fBestImportance < fImportance )
-			{  
-				fBestImportance = fImportance;
-				iBestFound = iFound;
-				iBestRequired = iRequired;
-				iBestTotalRequired = iTotalRequired;
-				iBestOrdered = iOrdered;
-				cCommand.iBotChat = iCommand;
-				iBestPhrase = iPhrase;
-
-				cCommand.cMap.clear();
-				for ( int i=0; i < cMatchMap.size(); ++i )
-					cCommand.cMap.push_back( cMatchMap[i] );
+			int iFound = aSpanFound[i * iMaxSpan + j - i - 1];
+			float fValue = aBest[i] + fImportance / 10.0f * iFound - (j - i - iFound);
+			if ( aBest[j] < fValue )
+			{
+				aBest[j] = fValue;
+				aFrom[j] = i;
 			}
 		}
 	}
 
-	if ( fBestImportance > 0.0f )
+	// Get spans of requests going back from last word.
+	good::vector< good::pair<int, int>, good::frame_allocator< good::pair<int, int> > > aSpans(iSize);
+	for ( int j = iSize; j > 0; )
 	{
-		const CPhrase& cPhrase = m_aMatchPhrases[cCommand.iBotChat][iBestPhrase];
-		//ChatMessage( "Chat match: %s", PhraseToString(cPhrase).c_str() );
-		//ChatMessage( "Matching (from 0 to 10): %f.", fBestImportance );
-
-		// Get $player/$player1 from chat variables, this is where chat is directed to.
-		for ( int i=0; i < cCommand.cMap.size(); ++i )
+		if ( aFrom[j] < 0 )
+			j--;
+		else
 		{
-			CChatVarValue& cVar = cCommand.cMap[i];
-			if ( cVar.iVar == iPlayerVar )
-				if ( (cVar.iVarIndex == 0) || (cVar.iVarIndex == 1) ) // $player or $player1.
-					cCommand.iDirectedTo = cVar.iValue;
+			aSpans.push_back( good::pair<int, int>(aFrom[j], j) );
+			j = aFrom[j];
 		}
 	}
-	else
+
+	// Match found spans again to get their variables.
+	static CBotChat cChat;
+	int iFound;
+	TPlayerIndex iDirectedTo = -1;
+	for ( int i = aSpans.size() - 1; i >= 0; --i )
 	{
-		ChatMessage( "No match found." );
+		int iBegin = aSpans[i].first;
+		MatchWords( &aWords[iBegin], aSpans[i].second - iBegin, cChat, iFound );
+		if ( cChat.iDirectedTo == -1 )
+			cChat.iDirectedTo = iDirectedTo;
+		iDirectedTo = cChat.iDirectedTo;
+
+		CBotChat& cCommand = *aCommands.insert( aCommands.end(), CBotChat() );
+		cCommand.iBotChat = cChat.iBotChat;
+		cCommand.iDirectedTo = cChat.iDirectedTo;
+		for ( int j = 0; j < cChat.cMap.size(); ++j )
+			cCommand.cMap.push_back( cChat.cMap[j] );
 	}
-	return fBestImportance;
+	return aSpans.size();
 }
 
 
@@ -712,6 +1120,61 @@ const good::string& CChat::ChatToText( const CBotChat& cCommand )
 }
 
 
+//----------------------------------------------------------------------------------------------------------------
+void CChat::GenerateSentences( StringVector& aSentences, good::vector<TBotChat>& aCommands )
+{
+	good::string_buffer sbSentence(256);
+	for ( int i = 0; i < m_aCompiledPhrases.size(); ++i )
+	{
+		const CPhrase& cPhrase = m_aMatchPhrases[ m_aCompiledPhrases[i].first ][ m_aCompiledPhrases[i].second ];
+		sbSentence.erase();
+		for ( int iWord = 0; iWord < cPhrase.aWords.size(); ++iWord )
+		{
+			const CPhraseWord& cWord = cPhrase.aWords[iWord];
+			if ( cWord.iVar == EChatVariableInvalid )
+				sbSentence.append( cWord.sWord );
+			else
+			{
+				const StringVector& aValues = m_aVariableValues[cWord.iVar];
+				for ( int iValue = 0; iValue < aValues.size(); ++iValue )
+					if ( aValues[iValue].size() > 0 )
+					{
+						sbSentence.append( aValues[iValue] );
+						break;
+					}
+			}
+			sbSentence.append(' ');
+		}
+		sbSentence[sbSentence.size() - 1] = cPhrase.chrPhraseEnd;
+		aSentences.push_back( sbSentence.duplicate() );
+		aCommands.push_back( m_aCompiledPhrases[i].first );
+	}
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+float CChat::Benchmark( int iRepeat, int& iSentences, int& iMatched )
+{
+	if ( !m_bCompiled )
+		Compile();
+
+	StringVector aSentences;
+	good::vector<TBotChat> aCommands;
+	GenerateSentences( aSentences, aCommands );
+
+	iSentences = aSentences.size();
+	iMatched = 0;
+
+	CBotChat cChat;
+	float fStart = Plat_FloatTime();
+	for ( int iRun = 0; iRun < iRepeat; ++iRun )
+		for ( int i = 0; i < aSentences.size(); ++i )
+			if ( ChatFromText(aSentences[i], cChat) >= CHAT_REQUEST_IMPORTANCE )
+				iMatched++;
+	return Plat_FloatTime() - fStart;
+}
+
+
 //----------------------------------------------------------------------------------------------------------------
 class CAnswers
 {
@@ -2,6 +2,10 @@
 #define __BOTRIX_CHAT_H__
 
 
+#include "good/hash_map.h"
+#include "good/memory_pool.h"
+#include "good/string_pool.h"
+
 #include "types.h"
 
 
@@ -21,6 +25,17 @@ enum TChatVariableValues
 typedef int TChatVariableValue;            ///< Number that represents chat variable value.
 
 
+/// Enum to represent invalid chat word.
+enum TChatWords
+{
+	EChatWordInvalid = -1,                 ///< Invalid chat word (word is not in any phrase, synonim or variable value).
+};
+typedef int TChatWord;                     ///< Number that represents chat word. All synonims of a word share same number.
+
+
+#define CHAT_REQUEST_IMPORTANCE    6.0f    ///< Minimum importance of matched chat to be considered a request.
+
+
 
 /// Obtained value for chat variable.
 /**
@@ -38,7 +53,8 @@ public:
 	TChatVariableValue iValue;
 };
 
-typedef good::vector< CChatVarValue > CChatVariablesMap; ///< Map from chat variables to their values.
+/// Map from chat variables to their values. Usually has few values, so buffer of 4 is taken from a pool.
+typedef good::vector< CChatVarValue, good::pool_allocator<CChatVarValue, 4> > CChatVariablesMap;
 
 
 
@@ -62,9 +78,13 @@ class CPhraseWord
 {
 public:
 	CPhraseWord( good::string sWord, bool bOptional = false, bool bNextOptional = false, bool bCommaBefore = false, bool bCommaAfter = false):
-		sWord(sWord), bOptional(bOptional), bNextOptional(bNextOptional), bCommaBefore(bCommaBefore), bCommaAfter(bCommaAfter) {}
+		sWord(sWord), iWord(EChatWordInvalid), iVar(EChatVariableInvalid), iVarIndex(0),
+		bOptional(bOptional), bNextOptional(bNextOptional), bCommaBefore(bCommaBefore), bCommaAfter(bCommaAfter) {}
 
 	good::string sWord;                    ///< Word itself.
+	TChatWord iWord;                       ///< Word number, set by CChat::Compile(). Invalid for variables.
+	TChatVariable iVar;                    ///< Variable if word starts with $, set by CChat::Compile().
+	int iVarIndex;                         ///< Variable index (i.e. 1 for $player1), set by CChat::Compile().
 	//bool bVerb:1;                          ///< True, if word is verb (important).
 	bool bOptional:1;                      ///< True, if word is optional in the phrase.
 	bool bNextOptional:1;                  ///< True, if next word belongs to same optional subphrase in the phrase.
@@ -78,9 +98,10 @@ public:
 class CPhrase
 {
 public:
-	CPhrase(): aWords(16), chrPhraseEnd('.') {}
+	CPhrase(): aWords(16), iTotalRequired(0), chrPhraseEnd('.') {}
 
 	good::vector<CPhraseWord> aWords;      ///< Array of words.
+	int iTotalRequired;                    ///< Amount of not optional words, set by CChat::Compile().
 	char chrPhraseEnd;                     ///< One of '.', '?' or '!'.
 };
 
@@ -104,18 +125,51 @@ public: // Methods.
 	/// Add phrase with command meaning.
 	static bool AddChat( const good::string& sKey, const good::string& sValue );
 
-	/// Get command from text, returning number from 0 to 10 which represents matching.
+	/// Compile matching phrases: get word numbers and build index from words/variables to phrases.
+	/** Called after all phrases are loaded. Adding a variable will force recompile on next ChatFromText(). */
+	static void Compile();
+
+	/// Get command from first sentence of text, returning number from 0 to 10 which represents matching.
+	/** Only phrases that have some of spoken words or variable values are scored, so text without any of them
+	 *  matches nothing (phrase without matched words can't get more than 1 point anyway). */
 	static float ChatFromText( const good::string& sText, CBotChat& cCommand );
 
+	/// Get all requests from text (i.e. "follow me and cover the door"). Returns amount of requests found.
+	/**
+	 * Text is split in spans of words, so that matched requests cover most of words with best importance (words
+	 * that don't belong to any request, like "and", are skipped). Span can't cross end of sentence and can't be longer
+	 * than two times the longest phrase (K words). Spans that start at same word are scored in one pass: span grows
+	 * one word at a time and only phrases that have the added word are updated, comparing it with their words. So
+	 * for n spoken words, C compiled phrases and P max phrase length there are at most n*K*C*P comparisons of
+	 * words, plus n*C*P to get variables of found requests (see GetMatchCost()).
+	 * Requests are added to aCommands (it is not cleared). Request without $player/$player1 is directed to
+	 * player of previous request in same text.
+	 */
+	static int ChatsFromText( const good::string& sText, good::vector<CBotChat>& aCommands );
+
+	/// Get amount of comparisons of spoken words with phrase words made by last ChatsFromText().
+	static int GetMatchCost() { return m_iMatchCost; }
+
+	/// Get max amount of comparisons of words that ChatsFromText() can make for text of iWords words.
+	static int GetMatchCostBound( int iWords )
+	{
+		return iWords * (2*m_iMaxPhraseSize + 1) * m_aCompiledPhrases.size() * m_iMaxPhraseSize;
+	}
+
 	/// Get text from chat.
 	static const good::string& ChatToText( const CBotChat& cCommand );
 
+	/// Match one generated sentence per matching phrase iRepeat times. Returns elapsed seconds.
+	static float Benchmark( int iRepeat, int& iSentences, int& iMatched );
+
+
 
 	/// Remove all chat variable values.
 	static void CleanVariableValues()
 	{
 		for ( int i=0; i < m_aVariableValues.size(); ++i )
 			m_aVariableValues[i].clear();
+		m_cValueWords.clear();
 	}
 
 	/// Get chat variable index from string.
@@ -156,6 +210,7 @@ public: // Methods.
 			iPlayerVar = m_aVariables.size();
 		m_aVariables.push_back(sVar);
 		m_aVariableValues.push_back( StringVector(iValuesSize) );
+		m_bCompiled = false; // Phrases with this variable need to be recompiled.
 		return m_aVariables.size() - 1;
 	}
 
@@ -164,13 +219,16 @@ public: // Methods.
 	{
 		StringVector& cValues = m_aVariableValues[iVar];
 		cValues.push_back( sValue );
+		AddWordValue( iVar, cValues.size() - 1 );
 		return cValues.size() - 1;
 	}
 
 	/// Set string for given variable and value indexes. Must be lower case to match.
 	static void SetVariableValue( TChatVariable iVar, TChatVariableValue iValue, const good::string& sValue )
 	{
+		RemoveWordValue( iVar, iValue );
 		m_aVariableValues[iVar][iValue] = sValue;
+		AddWordValue( iVar, iValue );
 	}
 
 
@@ -178,17 +236,90 @@ public: // Methods.
 	static const good::vector<TBotChat>& PossibleAnswers( TBotChat iTalk );
 
 protected:
+	typedef good::pair<TChatVariable, TChatVariableValue> CWordValue; // Variable value that is equal to some word.
+	typedef good::vector<CWordValue> CWordValues;                     // Variable values that are equal to some word.
+
+	// Spoken word: its number (EChatWordInvalid if not in phrases / synonims) and variable values equal to it.
+	typedef struct
+	{
+		TChatWord iWord;
+		const CWordValues* pValues;        // NULL if word is not a value of any variable.
+	} CSpokenWord;
+
+	// Matched words of a phrase in span of spoken words that grows one word at a time.
+	typedef struct
+	{
+		int iCompiled;                     // Index of compiled phrase.
+		int iStep;                         // Span end when phrase was updated last time.
+		int iFound, iRequired, iOrdered;   // Amount of matched words, of them not optional ones, and ones in order.
+	} CSpanPhrase;
+
 	static const good::string& GetSynonim( const good::string& sWord );
 
+	// Get number of a word, or EChatWordInvalid if word is unknown.
+	static TChatWord GetWord( const good::string& sWord )
+	{
+		int iName = m_cWordNames.find(sWord);
+		return ( iName == good::string_pool::invalid_id )  ?  EChatWordInvalid  :  m_aNameWords[iName];
+	}
+
+	// Get number of a word, adding it if it is unknown.
+	static TChatWord AddWord( const good::string& sWord );
+
+	// Index value of variable by it's text, so spoken word can be checked against all variables at once.
+	static void AddWordValue( TChatVariable iVar, TChatVariableValue iValue );
+
+	// Remove value of variable from word index.
+	static void RemoveWordValue( TChatVariable iVar, TChatVariableValue iValue );
+
+	// Get numbers of spoken words of all sentences of text. aSentenceStart will have index of first word of its sentence for each word.
+	static void GetSpokenWords( const good::string& sText, good::vector<CSpokenWord>& aWords, good::vector<int>& aSentenceStart );
+
+	// Get how good phrase matches iSize spoken words (from 0 to 10). Fills cMatchMap with matched variables and
+	// iFound with amount of matched words.
+	static float MatchPhrase( const CPhrase& cPhrase, const CSpokenWord* aWords, int iSize, CChatVariablesMap& cMatchMap, int& iFound );
+
+	// Get importance of phrase (from 0 to 10) for iSize spoken words, iFound of them matched: iRequired not optional
+	// ones, and iOrdered in order of phrase.
+	static float PhraseImportance( const CPhrase& cPhrase, int iSize, int iFound, int iRequired, int iOrdered );
+
+	// Mark all phrases as not checked.
+	static void NewPhraseStamp();
+
+	// Match spoken word at position iPos of span to phrase of cSpan. aPositions has spoken word for each phrase word.
+	static void AddSpanWord( CSpanPhrase& cSpan, int* aPositions, const CSpokenWord& cWord, int iPos );
+
+	// Get best phrase for iSize spoken words. Returns importance, setting command and variables of cCommand and
+	// amount of matched words in iFound.
+	static float MatchWords( const CSpokenWord* aWords, int iSize, CBotChat& cCommand, int& iFound );
+
+	// Get $player/$player1 from chat variables, this is where chat is directed to.
+	static void SetDirectedTo( CBotChat& cCommand );
+
+	// Generate sentence for each matching phrase, replacing variables by their first value.
+	static void GenerateSentences( StringVector& aSentences, good::vector<TBotChat>& aCommands );
+
 
 	static good::vector<CPhrase> m_aMatchPhrases[EBotChatTotal]; // Phrases for commands used for matching.
 	static good::vector<CPhrase> m_aPhrases[EBotChatTotal];      // Phrases for commands used for generation of commands.
-	
-	static good::vector<StringVector> m_aSynonims;               // Available synonims.
 
 	static StringVector m_aVariables;                            // Available variable names ($player, $door, $button, etc).
 	static good::vector<StringVector> m_aVariableValues;         // Available variable values (1, 2, opened, closed, weapon_...).
 
+	static good::string_pool m_cWordNames;                       // Pool of words and their synonims.
+	static good::vector<TChatWord> m_aNameWords;                 // Word number for each id in m_cWordNames.
+	static StringVector m_aWords;                                // Word for each word number (first synonim).
+	static good::vector< good::vector<int> > m_aWordPhrases;     // Compiled phrases that contain each word.
+	static good::hash_map<good::string, CWordValues> m_cValueWords; // Variable values by their text. Not added to words, as values (player names) come and go.
+	static good::vector< good::vector<int> > m_aVariablePhrases; // Compiled phrases that contain each variable.
+	static good::vector< good::pair<TBotChat, int> > m_aCompiledPhrases; // Command and phrase index of each compiled phrase.
+	static good::vector<int> m_aPhraseStamps;                    // To not check same phrase twice in ChatFromText().
+	static good::vector<int> m_aPhraseSlots;                     // Index in span phrases of ChatsFromText(), valid if phrase is stamped.
+	static int m_iPhraseStamp;                                   // Current stamp for ChatFromText().
+	static int m_iMatchCost;                                     // Comparisons of spoken and phrase words made by last ChatsFromText().
+	static int m_iMaxPhraseSize;                                 // Max amount of words in a phrase.
+	static bool m_bCompiled;                                     // False if Compile() must be called before matching.
+
 };
 
 
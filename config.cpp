@@ -215,7 +215,7 @@ TModId CConfiguration::Load( const good::string& sFileName, const good::string&
 		good::ini_file::iterator it = m_iniFile.find( sbBuffer );
 		if ( it != m_iniFile.end() )
 		{
-			CItems::SetEntityClassesSizeForType( iType, it->size() ); // Reserve needed space, as we will use pointers to that space.
+			CItems::ReserveEntityClassesForType( iType, it->size() ); // Reserve needed space, as we will use pointers to that space.
 
 			// Iterate throught key values.
 			for ( good::ini_section::const_iterator itemIt = it->begin(); itemIt != it->end(); ++itemIt )
@@ -286,6 +286,15 @@ TModId CConfiguration::Load( const good::string& sFileName, const good::string&
 	it = m_iniFile.find( sbBuffer );
 	if ( it != m_iniFile.end() )
 	{
+		// Weapons point to their weapon and ammo classes, so reserve space for them. Each ammo takes 2 words at least.
+		int iWords = 0;
+		for ( good::ini_section::const_iterator itemIt = it->begin(); itemIt != it->end(); ++itemIt )
+			for ( int i = 0; i < itemIt->value.size(); ++i )
+				if ( itemIt->value[i] == ' ' )
+					iWords++;
+		CItems::ReserveEntityClassesForType( EEntityTypeWeapon, it->size() );
+		CItems::ReserveEntityClassesForType( EEntityTypeAmmo, iWords / 2 );
+
 		// Iterate throught key values.
 		for ( good::ini_section::const_iterator itemIt = it->begin(); itemIt != it->end(); ++itemIt )
 		{
@@ -593,6 +602,7 @@ TModId CConfiguration::Load( const good::string& sFileName, const good::string&
 		for ( good::ini_section::const_iterator wordIt = it->begin(); wordIt != it->end(); ++wordIt )
 			CChat::AddChat( wordIt->key, wordIt->value );
 	}
+	CChat::Compile();
 
 	return iModId;
 }
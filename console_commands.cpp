@@ -1,6 +1,8 @@
 #include "bot.h"
+#include "chat.h"
 #include "clients.h"
 #include "console_commands.h"
+#include "profiler.h"
 #include "waypoint.h"
 
 #include "good/string_buffer.h"
@@ -185,21 +187,25 @@ int CConsoleCommandContainer::AutoComplete( const char* partial, int partialLeng
 	return result;
 }
 
+void CConsoleCommandContainer::Add( CConsoleCommand* newCommand )
+{
+	m_commands.push_back(newCommand);
+	const good::string& sCommand = newCommand->GetCommand();
+	m_cCommandNames.insert( good::pair<good::string, CConsoleCommand*>(good::string(sCommand.c_str(), false, false, sCommand.size()), newCommand), false );
+}
+
 TCommandResult CConsoleCommandContainer::Execute( CClient* pClient, int argc, const char** argv )
 {
 	if (argc > 0)
 	{
-		for ( int i = 0; i < m_commands.size(); i ++ )
+		good::hash_map<good::string, CConsoleCommand*>::const_iterator it = m_cCommandNames.find(argv[0]);
+		if ( it != m_cCommandNames.end() )
 		{
-			CConsoleCommand *pCommand = m_commands[i].get();
-
-			if ( pCommand->IsCommand(argv[0]) )
-			{			
-				if ( pCommand->HasAccess( pClient ) )
-					return pCommand->Execute( pClient, argc-1, &argv[1] );
-				else
-					return ECommandRequireAccess;
-			}
+			CConsoleCommand *pCommand = it->second;
+			if ( pCommand->HasAccess( pClient ) )
+				return pCommand->Execute( pClient, argc-1, &argv[1] );
+			else
+				return ECommandRequireAccess;
 		}
 	}
 
@@ -414,7 +420,7 @@ TCommandResult CWaypointMoveCommand::Execute( CClient* pClient, int argc, const
 		return ECommandError;
 	}
 
-	CWaypoints::Get(id).vOrigin = vOrigin;
+	CWaypoints::Move(id, vOrigin);
 	CUtil::Message(pClient->GetEdict(), "Set new position for waypoint %d (%d, %d, %d).", id, (int)vOrigin.x, (int)vOrigin.y, (int)vOrigin.z);
 
 	return ECommandPerformed;
@@ -447,6 +453,49 @@ TCommandResult CWaypointAutoCreateCommand::Execute( CClient* pClient, int argc,
 }
 
 
+TCommandResult CWaypointBenchmarkCommand::Execute( CClient* pClient, int argc, const char** argv )
+{
+	edict_t* pEdict = pClient ? pClient->GetEdict() : NULL;
+
+	int iSearches = 1000;
+	if ( argc >= 1 )
+		sscanf(argv[0], "%d", &iSearches);
+	if ( (argc > 1) || (iSearches <= 0) )
+	{
+		CUtil::Message(pEdict, "Error, invalid argument (must be positive number).");
+		return ECommandError;
+	}
+	if ( CWaypoints::Size() < 2 )
+	{
+		CUtil::Message(pEdict, "Error, need at least 2 waypoints.");
+		return ECommandError;
+	}
+
+	const CWaypoints::WaypointNavGraph& cNavGraph = CWaypoints::GetNavGraph();
+	int iNodes, iFound;
+	float fTime = CWaypointNavigator::Benchmark(iSearches, iNodes, iFound);
+	CUtil::Message( pEdict, "%d waypoints, %d paths. %d searches (%d found) in %.3f seconds, %.3f microseconds per search, %.1f nodes per search.",
+	                cNavGraph.size(), cNavGraph.arcs_size(), iSearches, iFound, fTime, fTime * 1000000.0f / iSearches, (float)iNodes / iSearches );
+
+	// Walk over all paths: through arrays of each waypoint node, and through frozen arcs.
+	int iTimes = MAX2( 1, 10000000 / MAX2(1, cNavGraph.arcs_size()) );
+	float fGraphTime, fNavGraphTime;
+	CWaypoints::BenchmarkArcs(iTimes, fGraphTime, fNavGraphTime);
+	float fArcs = (float)iTimes * MAX2(1, cNavGraph.arcs_size());
+	CUtil::Message( pEdict, "Paths walk: %.3f nanoseconds per path in graph nodes, %.3f in frozen arcs.",
+	                fGraphTime * 1000000000.0f / fArcs, fNavGraphTime * 1000000000.0f / fArcs );
+
+	// Waypoints with more than DEFAULT_GRAPH_INLINE_ARCS paths need allocated memory for them.
+	int iAllocated = 0;
+	for ( TWaypointId id = 0; id < CWaypoints::Size(); ++id )
+		if ( !CWaypoints::GetNode(id).neighbours.is_inline() )
+			++iAllocated;
+	CUtil::Message( pEdict, "%d waypoints of %d have paths allocated in memory (more than %d paths), others keep paths inside node.",
+	                iAllocated, CWaypoints::Size(), DEFAULT_GRAPH_INLINE_ARCS );
+	return ECommandPerformed;
+}
+
+
 TCommandResult CWaypointClearCommand::Execute( CClient* pClient, int argc, const char** argv )
 {
 	if ( pClient == NULL )
@@ -516,7 +565,7 @@ TCommandResult CWaypointAddTypeCommand::Execute( CClient* pClient, int argc, con
 			return ECommandError;
 		}
 
-		FLAG_SET(iFlags, w.iFlags);
+		CWaypoints::SetFlags(pClient->iCurrentWaypoint, w.iFlags | iFlags);
 		CUtil::Message(pClient->GetEdict(), "Types %s (%d) added to waypoint %d.", CTypeToString::WaypointFlagsToString(iFlags).c_str(), iFlags, pClient->iCurrentWaypoint);
 		return ECommandPerformed;
 	}
@@ -535,8 +584,7 @@ TCommandResult CWaypointRemoveTypeCommand::Execute( CClient* pClient, int argc,
 
 	if ( CWaypoints::IsValid(id) )
 	{
-		CWaypoint& w = CWaypoints::Get(id);
-		w.iFlags = FWaypointNone;
+		CWaypoints::SetFlags(id, FWaypointNone);
 		CUtil::Message(pClient->GetEdict(), "Waypoint %d has no type now.", id);
 		return ECommandPerformed;
 	}
@@ -936,24 +984,12 @@ TCommandResult CWaypointAreaRemoveCommand::Execute( CClient* pClient, int argc,
 	}
 	sbBuffer.erase( sbBuffer.size()-1, 1 ); // Erase last space.
 
-	StringVector& cAreas = CWaypoints::GetAreas();
-	for ( TAreaId iArea = 1; iArea < cAreas.size(); ++iArea ) // Do not take default area in account.
+	TAreaId iArea = CWaypoints::GetAreaId(sbBuffer);
+	if ( (iArea != EAreaIdInvalid) && (iArea > 0) ) // Do not take default area in account.
 	{
-		if ( sbBuffer == cAreas[iArea] )
-		{
-			for ( TWaypointId iWaypoint = 0; iWaypoint < CWaypoints::Size(); ++iWaypoint )
-			{
-				CWaypoint& cWaypoint = CWaypoints::Get(iWaypoint);
-				if ( cWaypoint.iAreaId > iArea )
-					--cWaypoint.iAreaId;
-				else if ( cWaypoint.iAreaId == iArea )
-					cWaypoint.iAreaId = 0; // Set to default.
-			}
-
-			cAreas.erase(iArea);
-			CUtil::Message( pClient->GetEdict(), "Deleted area '%s'.", sbBuffer.c_str() );
-			return ECommandPerformed;
-		}
+		CWaypoints::RemoveArea(iArea);
+		CUtil::Message( pClient->GetEdict(), "Deleted area '%s'.", sbBuffer.c_str() );
+		return ECommandPerformed;
 	}
 
 	CUtil::Message(pClient->GetEdict(), "Error, no area with such name.");
@@ -980,7 +1016,7 @@ TCommandResult CWaypointAreaRenameCommand::Execute( CClient* pClient, int argc,
 	}
 	sbBuffer.erase( sbBuffer.size()-1, 1 ); // Erase last space.
 
-	StringVector& cAreas = CWaypoints::GetAreas();
+	const StringVector& cAreas = CWaypoints::GetAreas();
 	for ( int i=1; i < cAreas.size(); ++i ) // Do not take default area in account.
 	{
 		if ( sbBuffer.starts_with(cAreas[i]) )
@@ -990,7 +1026,7 @@ TCommandResult CWaypointAreaRenameCommand::Execute( CClient* pClient, int argc,
 			if ( sbBuffer.size() > 0 )
 			{
 				CUtil::Message( pClient->GetEdict(), "Renamed '%s' to '%s'.", cAreas[i].c_str(), sbBuffer.c_str() );
-				cAreas[i] = sbBuffer.duplicate();
+				CWaypoints::RenameArea( i, sbBuffer.duplicate() );
 				return ECommandPerformed;
 			}
 			else
@@ -1049,7 +1085,7 @@ TCommandResult CWaypointAreaSetCommand::Execute( CClient* pClient, int argc, con
 	if ( iAreaId == EAreaIdInvalid ) // If not, add it.
 		iAreaId = CWaypoints::AddAreaName(sbBuffer.duplicate());
 
-	CWaypoints::Get(iWaypoint).iAreaId = iAreaId;
+	CWaypoints::SetArea(iWaypoint, iAreaId);
 
 	return ECommandPerformed;
 }
@@ -1332,6 +1368,7 @@ TCommandResult CPathAddTypeCommand::Execute( CClient* pClient, int argc, const c
 	if ( pPath )
 	{
 		FLAG_SET(iFlags, pPath->iFlags);
+		CWaypoints::PathChanged();
 		CUtil::Message(pClient->GetEdict(), "Added path types %s (path from %d to %d).", CTypeToString::PathFlagsToString(iFlags).c_str(), iPathFrom, iPathTo);
 		return ECommandPerformed;
 	}
@@ -1374,6 +1411,7 @@ TCommandResult CPathRemoveTypeCommand::Execute( CClient* pClient, int argc, cons
 	if ( pPath )
 	{
 		pPath->iFlags = FPathNone;
+		CWaypoints::PathChanged();
 		CUtil::Message(pClient->GetEdict(), "Removed all types for path from %d to %d.", iPathFrom, pClient->iDestinationWaypoint);
 		return ECommandPerformed;
 	}
@@ -1424,6 +1462,7 @@ TCommandResult CPathArgumentCommand::Execute( CClient* pClient, int argc, const
 		}
 
 		pPath->iArgument = iFirst | (iSecond << 8);
+		CWaypoints::PathChanged();
 		CUtil::Message( pClient->GetEdict(), "Set path (from %d to %d) action time %d, action duration %d. Time in deciseconds.", 
 		                pClient->iCurrentWaypoint, pClient->iDestinationWaypoint, GET_1ST_BYTE(pPath->iArgument), GET_2ND_BYTE(pPath->iArgument) );
 		return ECommandPerformed;
@@ -1852,6 +1891,33 @@ TCommandResult CItemDrawTypeCommand::Execute( CClient* pClient, int argc, const
 	return ECommandPerformed;
 }
 
+TCommandResult CItemBenchmarkCommand::Execute( CClient* pClient, int argc, const char** argv )
+{
+	edict_t* pEdict = pClient ? pClient->GetEdict() : NULL;
+
+	int iCycles = 100000, iLive = 1000;
+	if ( argc >= 1 )
+		sscanf(argv[0], "%d", &iCycles);
+	if ( argc >= 2 )
+		sscanf(argv[1], "%d", &iLive);
+	if ( (argc > 2) || (iCycles <= 0) || (iLive <= 0) || (iLive > MAX_EDICTS) )
+	{
+		CUtil::Message(pEdict, "Error, invalid arguments (must be positive numbers, entities up to %d).", MAX_EDICTS);
+		return ECommandError;
+	}
+
+	float fTime = CItems::BenchmarkChurn(iCycles, iLive);
+	if ( fTime < 0.0f )
+	{
+		CUtil::Message(pEdict, "Error, can't run benchmark while map is running.");
+		return ECommandError;
+	}
+	CUtil::Message( pEdict, "%d allocate / free cycles with %d entities in %.3f seconds, %.3f microseconds per cycle.",
+	                iCycles, iLive, fTime, fTime * 1000000.0f / iCycles );
+	return ECommandPerformed;
+}
+
+
 //----------------------------------------------------------------------------------------------------------------
 // Config commands.
 //----------------------------------------------------------------------------------------------------------------
@@ -1866,6 +1932,26 @@ TCommandResult CConfigEventsCommand::Execute( CClient* pClient, int argc, const
 		return ECommandPerformed;
 	}
 
+	if ( (argc <= 2) && (strcmp(argv[0], "benchmark") == 0) )
+	{
+		int iRepeat = 100000;
+		if ( argc == 2 )
+			sscanf(argv[1], "%d", &iRepeat);
+		if ( iRepeat <= 0 )
+		{
+			CUtil::Message(pClient->GetEdict(), "Error, invalid argument (must be positive number).");
+			return ECommandError;
+		}
+
+		// Use events of this client: handlers do nothing for human players, so only dispatch is measured.
+		int iUserId = CBotrixPlugin::pEngineServer->GetPlayerUserId( pClient->GetEdict() );
+		float fTime = CMod::BenchmarkEvents(iUserId, iRepeat);
+		int iTotal = 2 * iRepeat;
+		CUtil::Message( pClient->GetEdict(), "Dispatched %d events (half unknown) in %.3f seconds, %.0f events per second.",
+		                iTotal, fTime, fTime > 0.0f ? iTotal / fTime : 0.0f );
+		return ECommandPerformed;
+	}
+
 	int iValue = -1;
 	if ( argc == 1 )
 		iValue = CTypeToString::BoolFromString(argv[0]);
@@ -1882,6 +1968,56 @@ TCommandResult CConfigEventsCommand::Execute( CClient* pClient, int argc, const
 	return ECommandPerformed;
 }
 
+TCommandResult CConfigChatBenchmarkCommand::Execute( CClient* pClient, int argc, const char** argv )
+{
+	edict_t* pEdict = pClient ? pClient->GetEdict() : NULL;
+
+	int iRepeat = 100;
+	if ( argc == 1 )
+		sscanf(argv[0], "%d", &iRepeat);
+	if ( (argc > 1) || (iRepeat <= 0) )
+	{
+		CUtil::Message(pEdict, "Error, invalid argument (must be positive number).");
+		return ECommandError;
+	}
+
+	int iSentences, iMatched;
+	float fTime = CChat::Benchmark(iRepeat, iSentences, iMatched);
+	int iTotal = iSentences * iRepeat;
+	CUtil::Message( pEdict, "Matched %d sentences (%d as requests) in %.3f seconds, %.2f microseconds per sentence.",
+	                iTotal, iMatched, fTime, iTotal ? fTime * 1000000.0f / iTotal : 0.0f );
+	return ECommandPerformed;
+}
+
+TCommandResult CConfigChatParseCommand::Execute( CClient* pClient, int argc, const char** argv )
+{
+	edict_t* pEdict = pClient ? pClient->GetEdict() : NULL;
+	if ( argc == 0 )
+	{
+		CUtil::Message(pEdict, "Error, missing text to parse.");
+		return ECommandError;
+	}
+
+	good::string_buffer sbText(256);
+	for ( int i = 0; i < argc; ++i )
+	{
+		if ( i > 0 )
+			sbText.append(' ');
+		sbText.append(argv[i]);
+	}
+
+	good::vector<CBotChat> aRequests;
+	int iCount = CChat::ChatsFromText(sbText, aRequests);
+	CUtil::Message(pEdict, "Requests found: %d.", iCount);
+	for ( int i = 0; i < aRequests.size(); ++i )
+	{
+		CPlayer* pTo = (aRequests[i].iDirectedTo == -1) ? NULL : CPlayers::Get(aRequests[i].iDirectedTo);
+		CUtil::Message( pEdict, "  %s, directed to: %s.", CTypeToString::BotCommandToString(aRequests[i].iBotChat).c_str(),
+		                pTo ? pTo->GetName() : "all" );
+	}
+	return ECommandPerformed;
+}
+
 TCommandResult CConfigAdminsShowCommand::Execute( CClient* pClient, int argc, const char** argv )
 {
 	if ( pClient == NULL )
@@ -1903,6 +2039,201 @@ TCommandResult CConfigAdminsShowCommand::Execute( CClient* pClient, int argc, co
 }
 
 
+//----------------------------------------------------------------------------------------------------------------
+// Profile commands.
+//----------------------------------------------------------------------------------------------------------------
+TCommandResult CProfileEnableCommand::Execute( CClient* pClient, int argc, const char** argv )
+{
+	edict_t* pEdict = pClient ? pClient->GetEdict() : NULL;
+
+	if ( !CProfiler::IsCompiled() )
+	{
+		CUtil::Message(pEdict, "Error, profiler is not compiled in (plugin is built with BOTRIX_NO_PROFILE).");
+		return ECommandError;
+	}
+
+	if ( argc == 0 )
+	{
+		CUtil::Message(pEdict, "Profiler is %s.", CProfiler::bEnabled ? "on" : "off");
+		return ECommandPerformed;
+	}
+
+	int iValue = -1;
+	if ( argc == 1 )
+		iValue = CTypeToString::BoolFromString(argv[0]);
+
+	if ( iValue == -1 )
+	{
+		CUtil::Message(pEdict, "Error, invalid argument (must be 'on' or 'off').");
+		return ECommandError;
+	}
+
+	CProfiler::SetEnabled(iValue != 0);
+	CUtil::Message(pEdict, "Profiler is %s.", CProfiler::bEnabled ? "on" : "off");
+	return ECommandPerformed;
+}
+
+TCommandResult CProfileShowCommand::Execute( CClient* pClient, int argc, const char** argv )
+{
+	edict_t* pEdict = pClient ? pClient->GetEdict() : NULL;
+
+	if ( CProfiler::GetFramesCount() == 0 )
+	{
+		CUtil::Message(pEdict, "No frames collected (profiler is %s).", CProfiler::bEnabled ? "on" : "off");
+		return ECommandPerformed;
+	}
+
+	CUtil::Message( pEdict, "Last %d frames (%d collected), milliseconds:", CProfiler::GetFramesCount(),
+	                CProfiler::GetTotalFramesCount() );
+	for ( TProfileSection iSection = 0; iSection < EProfileSectionTotal; ++iSection )
+		CUtil::Message( pEdict, "  %-14s avg %8.3f, p50 %8.3f, p95 %8.3f, p99 %8.3f, max %8.3f.",
+		                CProfiler::GetSectionName(iSection), CProfiler::GetTimeAverage(iSection),
+		                CProfiler::GetTimePercentile(iSection, 50), CProfiler::GetTimePercentile(iSection, 95),
+		                CProfiler::GetTimePercentile(iSection, 99), CProfiler::GetTimePercentile(iSection, 100) );
+
+	CUtil::Message(pEdict, "Counters per frame:");
+	for ( TProfileCounter iCounter = 0; iCounter < EProfileCountTotal; ++iCounter )
+		CUtil::Message( pEdict, "  %-14s avg %8.1f, p50 %8.0f, p95 %8.0f, p99 %8.0f, max %8.0f.",
+		                CProfiler::GetCounterName(iCounter), CProfiler::GetCountAverage(iCounter),
+		                CProfiler::GetCountPercentile(iCounter, 50), CProfiler::GetCountPercentile(iCounter, 95),
+		                CProfiler::GetCountPercentile(iCounter, 99), CProfiler::GetCountPercentile(iCounter, 100) );
+	return ECommandPerformed;
+}
+
+TCommandResult CProfileBotsCommand::Execute( CClient* pClient, int argc, const char** argv )
+{
+	edict_t* pEdict = pClient ? pClient->GetEdict() : NULL;
+
+	int iCount = 5;
+	if ( argc == 1 )
+		sscanf(argv[0], "%d", &iCount);
+	if ( (argc > 1) || (iCount <= 0) )
+	{
+		CUtil::Message(pEdict, "Error, invalid argument (must be positive number).");
+		return ECommandError;
+	}
+
+	// Sort bots by think time.
+	int aBots[CProfiler::PROFILE_MAX_PLAYERS];
+	int iBots = 0;
+	for ( int i = 0; (i < CPlayers::Size()) && (i < CProfiler::PROFILE_MAX_PLAYERS); ++i )
+	{
+		CPlayer* pPlayer = CPlayers::Get(i);
+		if ( (pPlayer == NULL) || !pPlayer->IsBot() || (CProfiler::GetPlayer(i).iFrames == 0) )
+			continue;
+
+		int iPos = iBots++;
+		for ( ; (iPos > 0) && (CProfiler::GetPlayer(aBots[iPos-1]).fTime < CProfiler::GetPlayer(i).fTime); --iPos )
+			aBots[iPos] = aBots[iPos-1];
+		aBots[iPos] = i;
+	}
+
+	if ( iBots == 0 )
+	{
+		CUtil::Message(pEdict, "No bots accounted (profiler is %s).", CProfiler::bEnabled ? "on" : "off");
+		return ECommandPerformed;
+	}
+
+	double fTotal = CProfiler::GetTotalTime();
+	CUtil::Message( pEdict, "Bots by think time over %d frames (%.3f ms of frames):", CProfiler::GetTotalFramesCount(), fTotal );
+	for ( int i = 0; (i < iBots) && (i < iCount); ++i )
+	{
+		CBot* pBot = (CBot*)CPlayers::Get(aBots[i]);
+		const profile_player_t& cProfile = CProfiler::GetPlayer(aBots[i]);
+		float fTime = (float)(cProfile.fTime * 1000.0);
+		CUtil::Message( pEdict, "%c %s: %.3f ms (%.1f%% of frames), avg %.3f ms, max %.3f ms, %.1f traces per frame, "
+		                "%d nav searches, %d stuck moves, %d outlier frames.", cProfile.iOutlierFrames ? '!' : ' ',
+		                pBot->GetName(), fTime, (fTotal > 0.0) ? fTime * 100.0 / fTotal : 0.0, fTime / cProfile.iFrames,
+		                cProfile.fMaxTime, (float)cProfile.aCounts[EProfileCountTraces] / cProfile.iFrames,
+		                cProfile.aCounts[EProfileCountNavSearches], cProfile.aCounts[EProfileCountStuckMoves],
+		                cProfile.iOutlierFrames );
+		CUtil::Message( pEdict, "    task %s, waypoint %d, destination %d.", pBot->GetTaskName().c_str(),
+		                pBot->iCurrentWaypoint, pBot->GetDestinationWaypoint() );
+	}
+	return ECommandPerformed;
+}
+
+TCommandResult CProfileOutlierCommand::Execute( CClient* pClient, int argc, const char** argv )
+{
+	edict_t* pEdict = pClient ? pClient->GetEdict() : NULL;
+
+	if ( argc > 0 )
+	{
+		float fPercent = -1.0f, fMinFrame = CProfiler::fOutlierMinFrame;
+		if ( argc <= 2 )
+			sscanf(argv[0], "%f", &fPercent);
+		if ( argc == 2 )
+		{
+			fMinFrame = -1.0f;
+			sscanf(argv[1], "%f", &fMinFrame);
+		}
+		if ( (fPercent < 0.0f) || (fPercent > 100.0f) || (fMinFrame < 0.0f) )
+		{
+			CUtil::Message(pEdict, "Error, invalid arguments (must be percent from 0 to 100 and optional milliseconds).");
+			return ECommandError;
+		}
+		CProfiler::fOutlierShare = fPercent / 100.0f;
+		CProfiler::fOutlierMinFrame = fMinFrame;
+	}
+
+	if ( CProfiler::fOutlierShare > 0.0f )
+		CUtil::Message( pEdict, "Flag bots taking more than %.0f%% of frames longer than %.3f ms.",
+		                CProfiler::fOutlierShare * 100.0f, CProfiler::fOutlierMinFrame );
+	else
+		CUtil::Message(pEdict, "Flagging of bots is off.");
+	return ECommandPerformed;
+}
+
+TCommandResult CProfileCaptureCommand::Execute( CClient* pClient, int argc, const char** argv )
+{
+	edict_t* pEdict = pClient ? pClient->GetEdict() : NULL;
+
+	if ( !CProfiler::IsCompiled() )
+	{
+		CUtil::Message(pEdict, "Error, profiler is not compiled in (plugin is built with BOTRIX_NO_PROFILE).");
+		return ECommandError;
+	}
+
+	if ( (argc == 1) && (strcmp(argv[0], "stop") == 0) )
+	{
+		if ( !CProfiler::IsCapturing() )
+		{
+			CUtil::Message(pEdict, "Error, capture is not running.");
+			return ECommandError;
+		}
+		return CProfiler::StopCapture() ? ECommandPerformed : ECommandError;
+	}
+
+	int iFrames = 0;
+	if ( (argc >= 1) && (argc <= 2) )
+		sscanf(argv[0], "%d", &iFrames);
+	if ( (iFrames <= 0) || (iFrames > CProfiler::PROFILE_CAPTURE_FRAMES) )
+	{
+		CUtil::Message(pEdict, "Error, invalid arguments (must be amount of frames up to %d and optional file name).",
+		               CProfiler::PROFILE_CAPTURE_FRAMES);
+		return ECommandError;
+	}
+
+	const good::string& sFile = CUtil::BuildFileName( "captures", (argc == 2) ? good::string(argv[1]) :
+	                                                  CBotrixPlugin::instance->sMapName, "json" );
+	if ( !CProfiler::StartCapture(iFrames, sFile) )
+	{
+		CUtil::Message(pEdict, "Error, capture is already running.");
+		return ECommandError;
+	}
+
+	CUtil::Message(pEdict, "Capturing %d frames to %s.", iFrames, sFile.c_str());
+	return ECommandPerformed;
+}
+
+TCommandResult CProfileResetCommand::Execute( CClient* pClient, int argc, const char** argv )
+{
+	CProfiler::Reset();
+	CUtil::Message(pClient ? pClient->GetEdict() : NULL, "Profiler frames cleared.");
+	return ECommandPerformed;
+}
+
+
 //----------------------------------------------------------------------------------------------------------------
 // Static "botrix" command (server side).
 //----------------------------------------------------------------------------------------------------------------
@@ -1960,6 +2291,7 @@ CMainCommand::CMainCommand()
 	Add(new CItemCommand);
 	Add(new CBotChatCommand);
 	Add(new CConfigCommand);
+	Add(new CProfileCommand);
 
 #ifdef SOURCE_ENGINE_2006
 	CBotrixPlugin::pCvar->RegisterConCommandBase( &botrix );
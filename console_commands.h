@@ -5,6 +5,8 @@
 #include "public/tier1/convar.h"
 #include "public/edict.h"
 
+#include "good/hash_map.h"
+
 #include "types.h"
 
 #include "clients.h"
@@ -22,8 +24,13 @@ public:
 	CConsoleCommand( char *szCommand, TCommandAccessFlags iCommandAccessFlags = FCommandAccessNone ):
 		m_sCommand(szCommand), m_iAccessLevel(iCommandAccessFlags) {}
 
+	/// Destructor. Containers own commands through base class pointers.
+	virtual ~CConsoleCommand() {}
+
 	bool IsCommand( const char* szCommand ) { return m_sCommand == szCommand; }
 
+	const good::string& GetCommand() const { return m_sCommand; }
+
 	bool HasAccess( CClient* pClient )
 	{
 		TCommandAccessFlags access = pClient ? pClient->iCommandAccessFlags : FCommandAccessAll;
@@ -55,13 +62,14 @@ class CConsoleCommandContainer: public CConsoleCommand
 public:
 	TCommandResult Execute( CClient* pClient, int argc, const char** argv );
 
-	void Add( CConsoleCommand* newCommand ) { m_commands.push_back(newCommand); }
+	void Add( CConsoleCommand* newCommand );
 
 	virtual int AutoComplete( const char* partial, int partialLength, char commands[ COMMAND_COMPLETION_MAXITEMS ][ COMMAND_COMPLETION_ITEM_LENGTH ], int strIndex, int charIndex );
 	virtual void PrintCommand( edict_t* pPrintTo, int indent = 0);
 
 protected:
 	good::vector< good::auto_ptr<CConsoleCommand> > m_commands;
+	good::hash_map<good::string, CConsoleCommand*> m_cCommandNames; // Map from command name to command, keys point to command names.
 };
 
 
@@ -141,6 +149,20 @@ public:
 	TCommandResult Execute( CClient* pClient, int argc, const char** argv );
 };
 
+class CWaypointBenchmarkCommand: public CConsoleCommand
+{
+public:
+	CWaypointBenchmarkCommand()
+	{
+		m_sCommand = "benchmark";
+		m_sHelp = "measure speed of path search between random waypoints";
+		m_sDescription = "Optional parameter: searches count (default is 1000). Also measures walks over all waypoint paths.";
+		m_iAccessLevel = FCommandAccessWaypoint;
+	}
+
+	TCommandResult Execute( CClient* pClient, int argc, const char** argv );
+};
+
 class CWaypointInfoCommand: public CConsoleCommand
 {
 public:
@@ -592,6 +614,126 @@ public:
 	}
 };
 
+class CItemCheckFieldsCommand: public CConsoleCommand
+{
+public:
+	CItemCheckFieldsCommand()
+	{
+		m_sCommand = "checkfields";
+		m_sHelp = "check that entity fields read by offset are the same as given by GetKeyValue()";
+		m_iAccessLevel = FCommandAccessConfig;
+	}
+
+	TCommandResult Execute( CClient* pClient, int argc, const char** argv )
+	{
+		int iChecked;
+		int iErrors = CItems::CheckFieldOffsets(iChecked);
+		CUtil::Message( pClient ? pClient->GetEdict() : NULL, "Checked %d entities, %d mismatches.", iChecked, iErrors );
+		return ECommandPerformed;
+	}
+};
+
+class CItemBenchmarkCommand: public CConsoleCommand
+{
+public:
+	CItemBenchmarkCommand()
+	{
+		m_sCommand = "benchmark";
+		m_sHelp = "measure speed of entities allocation / deallocation";
+		m_sDescription = "Optional parameters: allocate / free cycles (default is 100000) and entities alive at a time (default is 1000).";
+		m_iAccessLevel = FCommandAccessConfig;
+	}
+
+	TCommandResult Execute( CClient* pClient, int argc, const char** argv );
+};
+
+
+//****************************************************************************************************************
+// Profile commands.
+//****************************************************************************************************************
+class CProfileEnableCommand: public CConsoleCommand
+{
+public:
+	CProfileEnableCommand()
+	{
+		m_sCommand = "enable";
+		m_sHelp = "collect server frame times and counters ('off' - disable, 'on' - enable)";
+		m_sDescription = "Enabling clears collected frames. Without parameters displays if profiler is enabled.";
+		m_iAccessLevel = FCommandAccessConfig;
+	}
+
+	TCommandResult Execute( CClient* pClient, int argc, const char** argv );
+};
+
+class CProfileShowCommand: public CConsoleCommand
+{
+public:
+	CProfileShowCommand()
+	{
+		m_sCommand = "show";
+		m_sHelp = "display percentiles of frame times and counters over last frames";
+		m_sDescription = "Times are in milliseconds and include nested sections (traces are also part of navigation and players).";
+		m_iAccessLevel = FCommandAccessConfig;
+	}
+
+	TCommandResult Execute( CClient* pClient, int argc, const char** argv );
+};
+
+class CProfileBotsCommand: public CConsoleCommand
+{
+public:
+	CProfileBotsCommand()
+	{
+		m_sCommand = "bots";
+		m_sHelp = "display bots that take most time to think";
+		m_sDescription = "Optional parameter: amount of bots to display (default is 5). Bots that were flagged as outliers are marked with '!'.";
+		m_iAccessLevel = FCommandAccessConfig;
+	}
+
+	TCommandResult Execute( CClient* pClient, int argc, const char** argv );
+};
+
+class CProfileOutlierCommand: public CConsoleCommand
+{
+public:
+	CProfileOutlierCommand()
+	{
+		m_sCommand = "outlier";
+		m_sHelp = "flag bots that take more than given percent of frame";
+		m_sDescription = "Parameters: percent of frame (0 disables flagging, default is 25) and optional min frame time in milliseconds (default is 1), shorter frames are not checked.";
+		m_iAccessLevel = FCommandAccessConfig;
+	}
+
+	TCommandResult Execute( CClient* pClient, int argc, const char** argv );
+};
+
+class CProfileCaptureCommand: public CConsoleCommand
+{
+public:
+	CProfileCaptureCommand()
+	{
+		m_sCommand = "capture";
+		m_sHelp = "save timeline of next frames as Chrome trace (chrome://tracing)";
+		m_sDescription = "Parameters: amount of frames (up to 4096) and optional file name (default is map name), file is saved in botrix/captures folder. Parameter 'stop' saves capture before all frames are recorded.";
+		m_iAccessLevel = FCommandAccessConfig;
+	}
+
+	TCommandResult Execute( CClient* pClient, int argc, const char** argv );
+};
+
+class CProfileResetCommand: public CConsoleCommand
+{
+public:
+	CProfileResetCommand()
+	{
+		m_sCommand = "reset";
+		m_sHelp = "clear collected frames";
+		m_iAccessLevel = FCommandAccessConfig;
+	}
+
+	TCommandResult Execute( CClient* pClient, int argc, const char** argv );
+};
+
 
 //****************************************************************************************************************
 // Config commands.
@@ -634,12 +776,55 @@ public:
 	{
 		m_sCommand = "event";
 		m_sHelp = "display events on console ('off' - disable, 'on' - enable)";
+		m_sDescription = "Parameter 'benchmark' measures event dispatch speed, optionally followed by times to dispatch (default is 100000).";
+		m_iAccessLevel = FCommandAccessConfig;
+	}
+
+	TCommandResult Execute( CClient* pClient, int argc, const char** argv );
+};
+
+class CConfigChatBenchmarkCommand: public CConsoleCommand
+{
+public:
+	CConfigChatBenchmarkCommand()
+	{
+		m_sCommand = "benchmark";
+		m_sHelp = "measure chat matching speed";
+		m_sDescription = "Optional parameter: times to match every chat phrase (default is 100).";
+		m_iAccessLevel = FCommandAccessConfig;
+	}
+
+	TCommandResult Execute( CClient* pClient, int argc, const char** argv );
+};
+
+class CConfigChatParseCommand: public CConsoleCommand
+{
+public:
+	CConfigChatParseCommand()
+	{
+		m_sCommand = "parse";
+		m_sHelp = "display requests found in given text";
+		m_sDescription = "Parameters: text to parse.";
 		m_iAccessLevel = FCommandAccessConfig;
 	}
 
 	TCommandResult Execute( CClient* pClient, int argc, const char** argv );
 };
 
+//****************************************************************************************************************
+// Chat: test chat matching.
+//****************************************************************************************************************
+class CConfigChatCommand: public CConsoleCommandContainer
+{
+public:
+	CConfigChatCommand()
+	{
+		m_sCommand = "chat";
+		Add(new CConfigChatBenchmarkCommand());
+		Add(new CConfigChatParseCommand());
+	}
+};
+
 //****************************************************************************************************************
 // Admins: show admins and set admin flags.
 //****************************************************************************************************************
@@ -685,6 +870,7 @@ public:
 		Add(new CWaypointAreaCommand());
 		Add(new CWaypointArgumentCommand());
 		Add(new CWaypointAutoCreateCommand());
+		Add(new CWaypointBenchmarkCommand());
 		Add(new CWaypointClearCommand());
 		Add(new CWaypointCreateCommand());
 		Add(new CWaypointDestinationCommand()); // Todo: change waypoint by look.
@@ -734,6 +920,8 @@ public:
 		Add(new CItemDrawCommand());
 		Add(new CItemDrawTypeCommand());
 		Add(new CItemReloadCommand());
+		Add(new CItemBenchmarkCommand());
+		Add(new CItemCheckFieldsCommand());
 	}
 };
 
@@ -767,11 +955,31 @@ public:
 	{
 		m_sCommand = "config";
 		Add(new CConfigAdminsCommand());
+		Add(new CConfigChatCommand());
 		Add(new CConfigEventsCommand);
 	}
 };
 
 
+//****************************************************************************************************************
+// Container of all commands starting with "profile".
+//****************************************************************************************************************
+class CProfileCommand: public CConsoleCommandContainer
+{
+public:
+	CProfileCommand()
+	{
+		m_sCommand = "profile";
+		Add(new CProfileBotsCommand());
+		Add(new CProfileCaptureCommand());
+		Add(new CProfileEnableCommand());
+		Add(new CProfileOutlierCommand());
+		Add(new CProfileResetCommand());
+		Add(new CProfileShowCommand());
+	}
+};
+
+
 //****************************************************************************************************************
 // Container of all commands starting with "botrix".
 //****************************************************************************************************************
@@ -4,105 +4,147 @@
 #include "server_plugin.h"
 #include "source_engine.h"
 
+#include "tier1/KeyValues.h"
+#include "vstdlib/IKeyValuesSystem.h"
+
 // memdbgon must be the last include file in a .cpp file!!!
 #include "tier0/memdbgon.h"
 
 
 //----------------------------------------------------------------------------------------------------------------
-// Class for events of type KeyValues.
+StringVector CEvent::m_aFieldNames;
+good::vector<int> CEvent::m_aFieldSymbols;
+
+// Fields used by events, resolved once at load time.
+static const TEventField iFieldUserId = CEvent::AddField("userid");
+static const TEventField iFieldAttacker = CEvent::AddField("attacker");
+static const TEventField iFieldHealth = CEvent::AddField("health");
+static const TEventField iFieldText = CEvent::AddField("text");
+static const TEventField iFieldTeamOnly = CEvent::AddField("teamonly");
+
+
 //----------------------------------------------------------------------------------------------------------------
-class CGameEventInterface1 : public IEventInterface
+TEventField CEvent::AddField( const char* szKey )
 {
-public:
-	CGameEventInterface1( KeyValues *pEvent ) { m_pEvent = pEvent; }
+	good::string sKey(szKey);
+	for ( int i = 0; i < m_aFieldNames.size(); ++i )
+		if ( m_aFieldNames[i] == sKey )
+			return i;
+
+	m_aFieldNames.push_back(sKey);
+	m_aFieldSymbols.push_back(-1);
+	return m_aFieldNames.size() - 1;
+}
 
-	const char *GetName()
-	{
-		return m_pEvent->GetName();
-	}
 
-	bool GetBool( const char *keyName, bool defaultValue = false )
-	{
-		return ( m_pEvent->GetInt(keyName, defaultValue) != 0 );
-	}
+//----------------------------------------------------------------------------------------------------------------
+int CEvent::GetFieldSymbol( TEventField iField )
+{
+	// KeyValues system is not available at static initialization time, so resolve symbol on first use.
+	int& iSymbol = m_aFieldSymbols[iField];
+	if ( iSymbol == -1 )
+		iSymbol = KeyValuesSystem()->GetSymbolForString( m_aFieldNames[iField].c_str() );
+	return iSymbol;
+}
 
-	int GetInt( const char *keyName, int defaultValue = 0 )
-	{
-		return m_pEvent->GetInt(keyName, defaultValue);
-	}
 
-	float GetFloat( const char *keyName, float defaultValue = 0 )
-	{
-		return m_pEvent->GetFloat(keyName, defaultValue);
-	}
+//----------------------------------------------------------------------------------------------------------------
+// Class for events of type KeyValues.
+//----------------------------------------------------------------------------------------------------------------
+const char *CGameEventInterface1::GetName()
+{
+	return m_pEvent->GetName();
+}
 
-	const char *GetString( const char *keyName, const char *defaultValue = NULL )
-	{
-		return m_pEvent->GetString(keyName, defaultValue);
-	}
+bool CGameEventInterface1::GetBool( const char *szKey, bool bDefaultValue )
+{
+	return ( m_pEvent->GetInt(szKey, bDefaultValue) != 0 );
+}
 
-protected:
-	KeyValues *m_pEvent;
+int CGameEventInterface1::GetInt( const char *szKey, int iDefaultValue )
+{
+	return m_pEvent->GetInt(szKey, iDefaultValue);
+}
 
-};
+float CGameEventInterface1::GetFloat( const char *szKey, float fDefaultValue )
+{
+	return m_pEvent->GetFloat(szKey, fDefaultValue);
+}
 
+const char *CGameEventInterface1::GetString( const char *szKey, const char *szDefaultValue )
+{
+	return m_pEvent->GetString(szKey, szDefaultValue);
+}
 
-//----------------------------------------------------------------------------------------------------------------
-// Class for events of type IGameEvent.
-//----------------------------------------------------------------------------------------------------------------
-class CGameEventInterface2 : public IEventInterface
+bool CGameEventInterface1::GetBool( TEventField iField, bool bDefaultValue )
 {
-public:
-	CGameEventInterface2( IGameEvent *pEvent ) { m_pEvent = pEvent; }
+	KeyValues* pKey = m_pEvent->FindKey( CEvent::GetFieldSymbol(iField) );
+	return pKey ? ( pKey->GetInt(NULL, bDefaultValue) != 0 ) : bDefaultValue;
+}
 
-	const char *GetName() { return m_pEvent->GetName(); }
+int CGameEventInterface1::GetInt( TEventField iField, int iDefaultValue )
+{
+	KeyValues* pKey = m_pEvent->FindKey( CEvent::GetFieldSymbol(iField) );
+	return pKey ? pKey->GetInt(NULL, iDefaultValue) : iDefaultValue;
+}
 
-	bool GetBool( const char *keyName, bool defaultValue = false )
-	{
-		return m_pEvent->GetBool(keyName, defaultValue);
-	}
+const char *CGameEventInterface1::GetString( TEventField iField, const char *szDefaultValue )
+{
+	KeyValues* pKey = m_pEvent->FindKey( CEvent::GetFieldSymbol(iField) );
+	return pKey ? pKey->GetString(NULL, szDefaultValue) : szDefaultValue;
+}
 
-	int GetInt( const char *keyName, int defaultValue = 0 )
-	{
-		return m_pEvent->GetInt(keyName, defaultValue);
-	}
 
-	float GetFloat( const char *keyName, float defaultValue = 0 )
-	{
-		return m_pEvent->GetFloat(keyName, defaultValue);
-	}
+//----------------------------------------------------------------------------------------------------------------
+// Class for events of type IGameEvent. This interface has no symbol lookup, so fields are searched by name.
+//----------------------------------------------------------------------------------------------------------------
+const char *CGameEventInterface2::GetName()
+{
+	return m_pEvent->GetName();
+}
 
-	const char *GetString( const char *keyName, const char *defaultValue = 0 )
-	{
-		return m_pEvent->GetString(keyName, defaultValue);
-	}
+bool CGameEventInterface2::GetBool( const char *szKey, bool bDefaultValue )
+{
+	return m_pEvent->GetBool(szKey, bDefaultValue);
+}
 
-protected:
-	IGameEvent *m_pEvent;
-};
+int CGameEventInterface2::GetInt( const char *szKey, int iDefaultValue )
+{
+	return m_pEvent->GetInt(szKey, iDefaultValue);
+}
 
+float CGameEventInterface2::GetFloat( const char *szKey, float fDefaultValue )
+{
+	return m_pEvent->GetFloat(szKey, fDefaultValue);
+}
 
-//----------------------------------------------------------------------------------------------------------------
-IEventInterface* CEvent::GetEventInterface( void* pEvent, TEventType iType )
+const char *CGameEventInterface2::GetString( const char *szKey, const char *szDefaultValue )
 {
-	IEventInterface *result = NULL;
+	return m_pEvent->GetString(szKey, szDefaultValue);
+}
 
-	if (iType == EEventTypeKeyValues)
-		result = new CGameEventInterface1( (KeyValues*)pEvent );
-	else if (iType == EEventTypeIGameEvent)
-		result = new CGameEventInterface2( (IGameEvent*)pEvent );
+bool CGameEventInterface2::GetBool( TEventField iField, bool bDefaultValue )
+{
+	return m_pEvent->GetBool( CEvent::GetFieldName(iField).c_str(), bDefaultValue );
+}
 
-	return result;
+int CGameEventInterface2::GetInt( TEventField iField, int iDefaultValue )
+{
+	return m_pEvent->GetInt( CEvent::GetFieldName(iField).c_str(), iDefaultValue );
+}
+
+const char *CGameEventInterface2::GetString( TEventField iField, const char *szDefaultValue )
+{
+	return m_pEvent->GetString( CEvent::GetFieldName(iField).c_str(), szDefaultValue );
 }
 
 
 //----------------------------------------------------------------------------------------------------------------
 void CPlayerActivateEvent::Execute( IEventInterface* pEvent )
 {
-	edict_t* pActivator = CUtil::GetEntityByUserId( pEvent->GetInt("userid") );
-
-	int iIdx = CPlayers::Get(pActivator);
-	DebugAssert( iIdx >= 0 );
+	int iIdx = CPlayers::GetIndexByUserId( pEvent->GetInt(iFieldUserId) );
+	if ( iIdx == EPlayerIndexInvalid )
+		return; // Player connected before plugin was loaded.
 
 	CPlayer* pPlayer = CPlayers::Get(iIdx);
 	if (pPlayer)
@@ -113,10 +155,9 @@ void CPlayerActivateEvent::Execute( IEventInterface* pEvent )
 //----------------------------------------------------------------------------------------------------------------
 void CPlayerTeamEvent::Execute( IEventInterface* pEvent )
 {
-	edict_t* pActivator = CUtil::GetEntityByUserId( pEvent->GetInt("userid") );
-
-	int iIdx = CPlayers::Get(pActivator);
-	DebugAssert( iIdx >= 0 );
+	int iIdx = CPlayers::GetIndexByUserId( pEvent->GetInt(iFieldUserId) );
+	if ( iIdx == EPlayerIndexInvalid )
+		return; // Player connected before plugin was loaded.
 
 	CPlayer* pPlayer = CPlayers::Get(iIdx);
 	if (pPlayer)
@@ -127,10 +168,9 @@ void CPlayerTeamEvent::Execute( IEventInterface* pEvent )
 //----------------------------------------------------------------------------------------------------------------
 void CPlayerSpawnEvent::Execute( IEventInterface* pEvent )
 {
-	edict_t* pActivator = CUtil::GetEntityByUserId( pEvent->GetInt("userid") );
-
-	int iIdx = CPlayers::Get(pActivator);
-	DebugAssert( iIdx >= 0 );
+	int iIdx = CPlayers::GetIndexByUserId( pEvent->GetInt(iFieldUserId) );
+	if ( iIdx == EPlayerIndexInvalid )
+		return; // Player connected before plugin was loaded.
 
 	CPlayer* pPlayer = CPlayers::Get(iIdx);
 	if (pPlayer)
@@ -141,49 +181,47 @@ void CPlayerSpawnEvent::Execute( IEventInterface* pEvent )
 //----------------------------------------------------------------------------------------------------------------
 void CPlayerChatEvent::Execute( IEventInterface* pEvent )
 {
-	edict_t* pActivator = CUtil::GetEntityByUserId( pEvent->GetInt("userid") );
-	const char* szText = pEvent->GetString("text");
-	bool bTeamOnly = pEvent->GetBool("teamonly");
+	int iIdx = CPlayers::GetIndexByUserId( pEvent->GetInt(iFieldUserId) );
+	if ( (iIdx == EPlayerIndexInvalid) || (CPlayers::Get(iIdx) == NULL) )
+		return;
+
+	const char* szText = pEvent->GetString(iFieldText);
+	bool bTeamOnly = pEvent->GetBool(iFieldTeamOnly);
 	
-	CPlayers::DeliverChat(pActivator, bTeamOnly, szText);
+	CPlayers::DeliverChat(iIdx, bTeamOnly, szText);
 }
 
 	
 //----------------------------------------------------------------------------------------------------------------
 void CPlayerHurtEvent::Execute( IEventInterface* pEvent )
 {
-	edict_t* pActivator = CUtil::GetEntityByUserId( pEvent->GetInt("userid") );
-	int iActivator = CPlayers::Get(pActivator);
-	DebugAssert( iActivator >= 0 );
+	int iActivator = CPlayers::GetIndexByUserId( pEvent->GetInt(iFieldUserId) );
+	if ( iActivator == EPlayerIndexInvalid )
+		return;
 
-	edict_t* pAttacker = CUtil::GetEntityByUserId( pEvent->GetInt("attacker") );
-	int iAttacker = CPlayers::Get(pAttacker);
+	int iAttacker = CPlayers::GetIndexByUserId( pEvent->GetInt(iFieldAttacker) ); // Invalid for world.
 
 	CPlayer *pPlayer = CPlayers::Get(iActivator);
 	CPlayer *pPlayerAttacker = iAttacker >= 0 ? CPlayers::Get(iAttacker) : NULL;
 	if ( pPlayer && pPlayer->IsBot() )
-		((CBot*)pPlayer)->HurtBy( iAttacker, pPlayerAttacker, pEvent->GetInt("health") );
+		((CBot*)pPlayer)->HurtBy( iAttacker, pPlayerAttacker, pEvent->GetInt(iFieldHealth) );
 }
 
 
 //----------------------------------------------------------------------------------------------------------------
 void CPlayerDeathEvent::Execute( IEventInterface* pEvent )
 {
-	edict_t* pActivator = CUtil::GetEntityByUserId( pEvent->GetInt("userid") );
-	edict_t* pAttacker = CUtil::GetEntityByUserId( pEvent->GetInt("attacker") );
-
-	int iActivator = CPlayers::Get(pActivator);
-	DebugAssert( iActivator >= 0 );
+	int iActivator = CPlayers::GetIndexByUserId( pEvent->GetInt(iFieldUserId) );
+	if ( iActivator == EPlayerIndexInvalid )
+		return;
 
 	CPlayer* pPlayerActivator = CPlayers::Get(iActivator);
 	if ( pPlayerActivator )
 		pPlayerActivator->Dead();
 
-	if ( pAttacker )
+	int iAttacker = CPlayers::GetIndexByUserId( pEvent->GetInt(iFieldAttacker) );
+	if ( iAttacker != EPlayerIndexInvalid ) // Invalid for world.
 	{
-		int iAttacker = CPlayers::Get(pAttacker);
-		DebugAssert( iAttacker >= 0 );
-
 		CPlayer* pPlayerAttacker = CPlayers::Get(iAttacker);
 		if ( pPlayerAttacker && pPlayerAttacker->IsBot() )
 			((CBot*)pPlayerAttacker)->KilledEnemy(iActivator, pPlayerActivator);
@@ -5,6 +5,13 @@
 #include "types.h"
 
 
+class KeyValues;
+class IGameEvent;
+
+
+typedef int TEventField;                   ///< Field (key) of event, resolved once by name. See CEvent::AddField().
+
+
 //****************************************************************************************************************
 /// Interface for getting event's values.
 //****************************************************************************************************************
@@ -15,6 +22,15 @@ public:
 	/// Get event name.
 	virtual const char *GetName() = 0;
 
+	/// Get event bool value for field iField. Return bDefaultValue if field not found.
+	virtual bool GetBool( TEventField iField, bool bDefaultValue = false ) = 0;
+
+	/// Get event int value for field iField. Return iDefaultValue if field not found.
+	virtual int GetInt( TEventField iField, int iDefaultValue = 0 ) = 0;
+
+	/// Get event string value for field iField. Return szDefaultValue if field not found.
+	virtual const char *GetString( TEventField iField, const char *szDefaultValue = NULL ) = 0;
+
 	/// Get event bool value for key szKey. Return bDefaultValue if szKey not found.
 	virtual bool GetBool( const char *szKey, bool bDefaultValue = false ) = 0;
 
@@ -46,12 +62,68 @@ public:
 	/// Execute this event.
 	virtual void Execute( IEventInterface* pEvent ) = 0;
 
-	/// Get event interface from event pEvent with type iType. You will need to delete it after use.
-	static IEventInterface* GetEventInterface( void* pEvent, TEventType iType );
+	/// Get field for key name. Getting value by field is faster than by key name, as key is resolved only once.
+	static TEventField AddField( const char* szKey );
+
+	/// Get key name of field.
+	static const good::string& GetFieldName( TEventField iField ) { return m_aFieldNames[iField]; }
+
+	/// Get KeyValues symbol of field.
+	static int GetFieldSymbol( TEventField iField );
 
 protected:
 	good::string m_sType;
 
+	static StringVector m_aFieldNames;      // Key names of fields.
+	static good::vector<int> m_aFieldSymbols; // KeyValues symbols of fields, -1 if not resolved yet.
+};
+
+
+//****************************************************************************************************************
+/// Event interface for events of type KeyValues. Meant to be created on stack for each event.
+//****************************************************************************************************************
+class CGameEventInterface1: public IEventInterface
+{
+public:
+	CGameEventInterface1( KeyValues *pEvent ): m_pEvent(pEvent) {}
+
+	const char *GetName();
+
+	bool GetBool( const char *szKey, bool bDefaultValue = false );
+	int GetInt( const char *szKey, int iDefaultValue = 0 );
+	float GetFloat( const char *szKey, float fDefaultValue = 0 );
+	const char *GetString( const char *szKey, const char *szDefaultValue = NULL );
+
+	bool GetBool( TEventField iField, bool bDefaultValue = false );
+	int GetInt( TEventField iField, int iDefaultValue = 0 );
+	const char *GetString( TEventField iField, const char *szDefaultValue = NULL );
+
+protected:
+	KeyValues *m_pEvent;
+};
+
+
+//****************************************************************************************************************
+/// Event interface for events of type IGameEvent. Meant to be created on stack for each event.
+//****************************************************************************************************************
+class CGameEventInterface2: public IEventInterface
+{
+public:
+	CGameEventInterface2( IGameEvent *pEvent ): m_pEvent(pEvent) {}
+
+	const char *GetName();
+
+	bool GetBool( const char *szKey, bool bDefaultValue = false );
+	int GetInt( const char *szKey, int iDefaultValue = 0 );
+	float GetFloat( const char *szKey, float fDefaultValue = 0 );
+	const char *GetString( const char *szKey, const char *szDefaultValue = NULL );
+
+	bool GetBool( TEventField iField, bool bDefaultValue = false );
+	int GetInt( TEventField iField, int iDefaultValue = 0 );
+	const char *GetString( TEventField iField, const char *szDefaultValue = NULL );
+
+protected:
+	IGameEvent *m_pEvent;
 };
 
 
@@ -0,0 +1,169 @@
+//----------------------------------------------------------------------------------------------------------------
+// Aho-Corasick automaton to search several patterns in a text at once.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#ifndef __GOOD_AHO_CORASICK_H__
+#define __GOOD_AHO_CORASICK_H__
+
+
+#include <limits.h>
+#include <string.h>
+
+#include "good/defines.h"
+#include "good/string.h"
+#include "good/vector.h"
+
+
+namespace good
+{
+
+	//************************************************************************************************************
+	/** Finds which of given patterns appear in a text, in time linear to text size.
+	 * Add all patterns, then call build() to get automaton whose transitions are precomputed for every character
+	 * (characters that don't appear in patterns share one column of transitions table). Search returns index of
+	 * first added pattern that is substring of text, so result is the same as checking patterns in order. */
+	//************************************************************************************************************
+	class aho_corasick
+	{
+	public:
+		/// Constructor.
+		aho_corasick(): m_iColumns(0), m_bBuilt(false) {}
+
+		/// Add pattern, return its index. Automaton must be built again after this.
+		int add( const good::string& sPattern )
+		{
+			m_aPatterns.push_back( sPattern.duplicate() );
+			m_bBuilt = false;
+			return m_aPatterns.size() - 1;
+		}
+
+		/// Remove all patterns.
+		void clear()
+		{
+			m_aPatterns.clear();
+			m_aNext.clear();
+			m_aOutput.clear();
+			m_iColumns = 0;
+			m_bBuilt = false;
+		}
+
+		/// Get amount of patterns.
+		int size() const { return m_aPatterns.size(); }
+
+		/// Return true if automaton is built after last add().
+		bool is_built() const { return m_bBuilt; }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Build automaton from added patterns.
+		//--------------------------------------------------------------------------------------------------------
+		void build()
+		{
+			// Give column to each character used in patterns, 0 is for all other characters.
+			memset( m_aColumn, 0, sizeof(m_aColumn) );
+			m_iColumns = 1;
+			for ( int p = 0; p < m_aPatterns.size(); ++p )
+				for ( int i = 0; i < m_aPatterns[p].size(); ++i )
+				{
+					unsigned char c = m_aPatterns[p][i];
+					if ( m_aColumn[c] == 0 )
+						m_aColumn[c] = m_iColumns++;
+				}
+
+			// Build trie, -1 means there is no edge yet.
+			m_aNext.clear();
+			m_aOutput.clear();
+			new_state();
+			for ( int p = 0; p < m_aPatterns.size(); ++p )
+			{
+				int iState = 0;
+				for ( int i = 0; i < m_aPatterns[p].size(); ++i )
+				{
+					int iColumn = m_aColumn[ (unsigned char)m_aPatterns[p][i] ];
+					if ( m_aNext[iState * m_iColumns + iColumn] == -1 )
+					{
+						int iNew = new_state();
+						m_aNext[iState * m_iColumns + iColumn] = iNew;
+					}
+					iState = m_aNext[iState * m_iColumns + iColumn];
+				}
+				if ( m_aOutput[iState] > p )
+					m_aOutput[iState] = p;
+			}
+
+			// Traverse trie in breadth, replacing missing edges by edges of failure state. Failure state is less
+			// deep, so it is completed before. Output of state includes outputs of its failure states.
+			good::vector<int> aFail( m_aOutput.size() );
+			aFail.resize( m_aOutput.size(), 0 );
+			good::vector<int> aQueue( m_aOutput.size() );
+			for ( int c = 0; c < m_iColumns; ++c )
+			{
+				int& iChild = m_aNext[c];
+				if ( iChild == -1 )
+					iChild = 0;
+				else
+					aQueue.push_back(iChild); // Failure of depth 1 states is root.
+			}
+
+			for ( int iHead = 0; iHead < aQueue.size(); ++iHead )
+			{
+				int iState = aQueue[iHead];
+				int iFail = aFail[iState];
+				if ( m_aOutput[iState] > m_aOutput[iFail] )
+					m_aOutput[iState] = m_aOutput[iFail];
+
+				for ( int c = 0; c < m_iColumns; ++c )
+				{
+					int& iChild = m_aNext[iState * m_iColumns + c];
+					if ( iChild == -1 )
+						iChild = m_aNext[iFail * m_iColumns + c];
+					else
+					{
+						aFail[iChild] = m_aNext[iFail * m_iColumns + c];
+						aQueue.push_back(iChild);
+					}
+				}
+			}
+			m_bBuilt = true;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get index of first added pattern that is found in szText, or -1 if none. Automaton must be built.
+		//--------------------------------------------------------------------------------------------------------
+		int find_first( const char* szText ) const
+		{
+			DebugAssert( m_bBuilt );
+			if ( m_aOutput.size() == 0 )
+				return -1;
+
+			int iBest = INT_MAX, iState = 0;
+			for ( const unsigned char* c = (const unsigned char*)szText; *c && (iBest > 0); ++c )
+			{
+				iState = m_aNext[iState * m_iColumns + m_aColumn[*c]];
+				if ( iBest > m_aOutput[iState] )
+					iBest = m_aOutput[iState];
+			}
+			return (iBest == INT_MAX) ? -1 : iBest;
+		}
+
+	protected:
+		// Add state without edges and output, return its index.
+		int new_state()
+		{
+			m_aNext.resize( m_aNext.size() + m_iColumns, -1 );
+			m_aOutput.push_back( INT_MAX );
+			return m_aOutput.size() - 1;
+		}
+
+		good::vector<good::string> m_aPatterns;  // Added patterns.
+		good::vector<int> m_aNext;               // Transitions table, state * m_iColumns + column -> next state.
+		good::vector<int> m_aOutput;             // Smallest index of pattern that ends at state, INT_MAX if none.
+		int m_aColumn[256];                      // Column of transitions table for each character.
+		int m_iColumns;                          // Columns in transitions table.
+		bool m_bBuilt;                           // True if automaton is built after last add().
+	};
+
+} // namespace good
+
+
+#endif // __GOOD_AHO_CORASICK_H__
@@ -0,0 +1,238 @@
+//----------------------------------------------------------------------------------------------------------------
+// Arena (bump allocator) for short living temporaries, and allocator that uses arena of current frame.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#ifndef __GOOD_ARENA_H__
+#define __GOOD_ARENA_H__
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "good/utility.h"
+
+
+#define DEFAULT_ARENA_CHUNK  (64*1024)         ///< Size of first chunk of memory of arena.
+
+
+namespace good
+{
+
+
+	//************************************************************************************************************
+	/// Arena of memory: allocation moves pointer inside a chunk of memory, all memory is released by reset().
+	/** When chunk is full, new one is allocated. At reset() several chunks are replaced by one with their total
+	 * size, so after warm up arena uses only one chunk and doesn't call heap functions. Deallocation returns
+	 * memory only if it is the last allocation. Not thread safe. */
+	//************************************************************************************************************
+	class arena
+	{
+	public:
+		//--------------------------------------------------------------------------------------------------------
+		/// Constructor with size of first chunk. Memory is allocated at first allocate().
+		//--------------------------------------------------------------------------------------------------------
+		arena( int iChunkSize = DEFAULT_ARENA_CHUNK ): m_iChunkSize(iChunkSize), m_pChunk(NULL), m_iUsed(0), m_iLast(0) {}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Destructor, frees all memory.
+		//--------------------------------------------------------------------------------------------------------
+		~arena() { free_chunks(); }
+
+		/// Get used bytes of current chunk.
+		int size() const { return m_iUsed; }
+
+		/// Get count of chunks (more than 1 until reset() if arena was not big enough).
+		int chunks() const
+		{
+			int iCount = 0;
+			for ( chunk_t* pChunk = m_pChunk; pChunk; pChunk = pChunk->pPrev )
+				iCount++;
+			return iCount;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Allocate iSize bytes, aligned to 8.
+		//--------------------------------------------------------------------------------------------------------
+		void* allocate( int iSize )
+		{
+			iSize = align_size(iSize);
+			if ( (m_pChunk == NULL) || (m_iUsed + iSize > m_pChunk->iSize) )
+				add_chunk(iSize);
+			m_iLast = m_iUsed;
+			m_iUsed += iSize;
+			return data(m_pChunk) + m_iLast;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Reallocate memory. Last allocation grows in place if there is space in chunk.
+		//--------------------------------------------------------------------------------------------------------
+		void* reallocate( void* pOld, int iNewSize, int iOldSize )
+		{
+			if ( pOld == NULL )
+				return allocate(iNewSize);
+			if ( is_last(pOld) && (m_iLast + align_size(iNewSize) <= m_pChunk->iSize) )
+			{
+				m_iUsed = m_iLast + align_size(iNewSize);
+				return pOld;
+			}
+			void* pNew = allocate(iNewSize);
+			memcpy( pNew, pOld, MIN2(iOldSize, iNewSize) );
+			return pNew;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Deallocate memory. Memory is reused only if it is the last allocation, otherwise at reset().
+		//--------------------------------------------------------------------------------------------------------
+		void deallocate( void* pPtr, int /*iSize*/ )
+		{
+			if ( is_last(pPtr) )
+				m_iUsed = m_iLast;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Release all allocations. If arena has several chunks, they are joined in one.
+		//--------------------------------------------------------------------------------------------------------
+		void reset()
+		{
+			if ( m_pChunk && m_pChunk->pPrev )
+			{
+				int iTotal = 0;
+				for ( chunk_t* pChunk = m_pChunk; pChunk; pChunk = pChunk->pPrev )
+					iTotal += pChunk->iSize;
+				free_chunks();
+				m_iChunkSize = iTotal;
+				add_chunk(0);
+			}
+			m_iUsed = m_iLast = 0;
+		}
+
+		/// Position in arena, to release allocations made after it.
+		typedef struct
+		{
+			void* pChunk;                  ///< Current chunk.
+			int iUsed;                     ///< Used bytes of current chunk.
+		} position_t;
+
+		/// Get current position in arena.
+		position_t get_position() const { position_t cPos = { m_pChunk, m_iUsed }; return cPos; }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Release allocations made after cPos. Nothing is done if new chunk was added after it: memory is
+		/// released at reset().
+		//--------------------------------------------------------------------------------------------------------
+		void set_position( const position_t& cPos )
+		{
+			if ( cPos.pChunk == m_pChunk )
+				m_iUsed = m_iLast = cPos.iUsed;
+		}
+
+	protected:
+		static int align_size( int iSize ) { return (iSize + 7) & ~7; }
+
+		typedef struct chunk_t
+		{
+			chunk_t* pPrev;                // Previous chunk.
+			int iSize;                     // Size of data.
+		} chunk_t;
+
+		static const int CHUNK_HEADER = 16; // Data starts after header, aligned to 16.
+
+		static char* data( chunk_t* pChunk ) { return (char*)pChunk + CHUNK_HEADER; }
+
+		// Return true if pPtr is last allocation.
+		bool is_last( void* pPtr ) const { return m_pChunk && (pPtr == data(m_pChunk) + m_iLast) && (m_iLast < m_iUsed); }
+
+		// Add chunk that has at least iSize bytes.
+		void add_chunk( int iSize )
+		{
+			atomic_increment( &allocations_count() );
+			int iChunkSize = MAX2( m_iChunkSize, iSize );
+			chunk_t* pChunk = (chunk_t*)malloc( CHUNK_HEADER + iChunkSize );
+			pChunk->pPrev = m_pChunk;
+			pChunk->iSize = iChunkSize;
+			m_pChunk = pChunk;
+			m_iUsed = m_iLast = 0;
+		}
+
+		// Free all chunks.
+		void free_chunks()
+		{
+			while ( m_pChunk )
+			{
+				chunk_t* pPrev = m_pChunk->pPrev;
+				free(m_pChunk);
+				m_pChunk = pPrev;
+			}
+			m_iUsed = m_iLast = 0;
+		}
+
+		int m_iChunkSize;                  // Size of next chunk.
+		chunk_t* m_pChunk;                 // Current chunk, has pointer to previous ones.
+		int m_iUsed;                       // Used bytes of current chunk.
+		int m_iLast;                       // Start of last allocation in current chunk.
+	};
+
+
+	//------------------------------------------------------------------------------------------------------------
+	/// Get arena for temporaries of current frame. Program must call frame_arena().reset() at end of each frame.
+	//------------------------------------------------------------------------------------------------------------
+	inline arena& frame_arena()
+	{
+		static arena cArena;
+		return cArena;
+	}
+
+
+	//************************************************************************************************************
+	/// Release allocations of arena made during lifetime of this object (if arena didn't add chunk).
+	//************************************************************************************************************
+	class arena_scope
+	{
+	public:
+		/// Constructor, remembers position of arena.
+		arena_scope( arena& cArena = frame_arena() ): m_cArena(cArena), m_cPosition( cArena.get_position() ) {}
+
+		/// Destructor, releases allocations.
+		~arena_scope() { m_cArena.set_position(m_cPosition); }
+
+	protected:
+		arena& m_cArena;
+		arena::position_t m_cPosition;
+	};
+
+
+	//************************************************************************************************************
+	/// Allocator that takes memory from frame_arena(). Containers using it must not live after end of frame.
+	/** Note that copy of good::vector steals buffer, so it must not be copied to container with other allocator. */
+	//************************************************************************************************************
+	template <typename T>
+	class frame_allocator: public allocator<T>
+	{
+	public:
+		typedef typename allocator<T>::pointer_t pointer_t;
+
+		template <class _Other>
+		struct rebind
+		{
+			typedef frame_allocator<_Other> other;
+		};
+
+		/// Allocate memory for iSize objects of type T.
+		pointer_t allocate( int iSize ) const { return (pointer_t)frame_arena().allocate( iSize * sizeof(T) ); }
+
+		/// Reallocate memory for iNewSize objects of type T.
+		pointer_t reallocate( pointer_t pOld, int iNewSize, int iOldSize ) const
+		{
+			return (pointer_t)frame_arena().reallocate( pOld, iNewSize * sizeof(T), iOldSize * sizeof(T) );
+		}
+
+		/// Deallocate memory of iSize objects of type T.
+		void deallocate( pointer_t pPtr, int iSize ) const { frame_arena().deallocate( pPtr, iSize * sizeof(T) ); }
+	};
+
+
+} // namespace good
+
+
+#endif // __GOOD_ARENA_H__
@@ -7,6 +7,7 @@
 #define __GOOD_ASTAR_H__
 
 
+#include "good/csr_graph.h"
 #include "good/graph.h"
 #include "good/priority_queue.h"
 
@@ -30,7 +31,7 @@ namespace good
 		typename EdgeLength,                                           ///< Edge length functor, Edge as argument.
 		typename CanUse,                                               ///< Functor to know if can use certain node in search. Vertex as argument.
 		template <typename, typename> class NodesContainer = vector,   ///< Container for arcs of a graph node.
-		template <typename, typename> class ArcsContainer = vector,    ///< Container for graph nodes.
+		template <typename, typename> class ArcsContainer = arcs_vector, ///< Container for graph nodes.
 		typename Alloc = allocator<Vertex>                             ///< Memory allocator.
 	>
 	class astar
@@ -51,6 +52,9 @@ namespace good
 
 		typedef vector<node_id, Alloc> path_t;                               ///< Type for path of nodes.
 
+		/// Type for frozen arcs of graph, search runs on them.
+		typedef csr_graph<Edge, EdgeLengthType, typename Alloc::template rebind<Edge>::other> csr_t;
+
 	protected:
 
 		//========================================================================================================
@@ -59,7 +63,7 @@ namespace good
 		struct astar_node_t
 		{
 			/// A* node constructor.
-			astar_node_t(): g_score(0), h_score(0), prev(NULL), visited(0) {}
+			astar_node_t(): g_score(0), h_score(0), prev(0), visited(0) {}
 
 			EdgeLengthType g_score;   ///< Distance from source to this node.
 			EdgeLengthType h_score;   ///< Heuristic estimation to target from this node.
@@ -79,17 +83,28 @@ namespace good
 		//--------------------------------------------------------------------------------------------------------
 		/// Constructor.
 		//--------------------------------------------------------------------------------------------------------
-		astar(): m_hFunc(), m_cArcLength(), m_pQueue(), m_path(), m_nTarget(NULL), m_bFound(false) {}
+		astar(): m_hFunc(), m_cArcLength(), m_pQueue(), m_path(), m_nTarget(0), m_iMaxNodes(0), m_iCurrLoop(0), m_bFound(false) {}
 
 
 		//--------------------------------------------------------------------------------------------------------
-		/// Set graph for searches.
+		/// Set graph for searches. Arcs of graph are copied to internal frozen graph.
 		//--------------------------------------------------------------------------------------------------------
 		void set_graph( graph_t const& rGraph )
 		{
+			m_cOwnArcs.build(rGraph, m_cArcLength);
+			set_graph(rGraph, m_cOwnArcs);
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Set graph for searches, with its arcs already frozen in rArcs (built from rGraph, not copied).
+		//--------------------------------------------------------------------------------------------------------
+		void set_graph( graph_t const& rGraph, csr_t const& rArcs )
+		{
+			DebugAssert( rArcs.size() == rGraph.size() );
 			m_cANodes.clear();
 			m_cANodes.resize( rGraph.size() );
 			m_pGraph = &rGraph;
+			m_pArcs = &rArcs;
 		}
 
 		//--------------------------------------------------------------------------------------------------------
@@ -132,33 +147,34 @@ namespace good
 				m_pQueue.pop();
 
 				node_id curr_id = current - m_cANodes.begin();
-				const_node_it curr_node = m_pGraph->begin() + curr_id;
 
 				node_id prev_id = current->prev;
 				current->visited = prev_id == graph_t::invalid_node_id ? 1 : m_cANodes[prev_id].visited+1;
 
 				if (curr_id == m_nTarget)
 				{
+					++m_iCurrLoop; // Count target node too.
 					m_bFound = true;
 					_get_path();
 					return true;
 				}
 
-				for (const_arc_it arcIt = curr_node->neighbours.begin(); arcIt != curr_node->neighbours.end(); ++arcIt)
+				int arcs_end = m_pArcs->arcs_end(curr_id);
+				for (int arc = m_pArcs->arcs_begin(curr_id); arc < arcs_end; ++arc)
 				{
-					node_id neighbour_id = arcIt->target;
-					const_node_it neighbour_node = m_pGraph->begin() + neighbour_id;
+					node_id neighbour_id = m_pArcs->target(arc);
 					anode_it neighbour = m_cANodes.begin() + neighbour_id;
 					if ( neighbour->visited )
 						continue;
 
-					EdgeLengthType g_score = current->g_score + m_cArcLength(arcIt->edge);
+					EdgeLengthType g_score = current->g_score + m_pArcs->length(arc);
 
 					if (neighbour->prev == graph_t::invalid_node_id)
 					{
 						// First time visiting neighbour.
 						neighbour->prev = curr_id;
 						neighbour->g_score = g_score;
+						const_node_it neighbour_node = m_pGraph->begin() + neighbour_id;
 						neighbour->h_score = m_hFunc(neighbour_node->vertex, neighbour_node->vertex);
 						m_pQueue.push(neighbour);
 					}
@@ -178,6 +194,12 @@ namespace good
 		}
 
 
+		//--------------------------------------------------------------------------------------------------------
+		/// Return amount of nodes expanded by last call to step().
+		//--------------------------------------------------------------------------------------------------------
+		int last_step_nodes() const { return m_iCurrLoop; }
+
+
 		//--------------------------------------------------------------------------------------------------------
 		/// Return true if there is a path from source to target.
 		//--------------------------------------------------------------------------------------------------------
@@ -254,6 +276,8 @@ namespace good
 
 		anode_container_t m_cANodes;           // Container of nodes.
 		const graph_t* m_pGraph;               // Search graph.
+		const csr_t* m_pArcs;                  // Frozen arcs of search graph.
+		csr_t m_cOwnArcs;                      // Frozen arcs, when they are not given in set_graph().
 		
 		queue_t m_pQueue;                      // Priority queue for A* search algorithn.
 		path_t m_path;                         // Founded path.
@@ -0,0 +1,62 @@
+//----------------------------------------------------------------------------------------------------------------
+// Atomic operations on long integers (32-bit on Windows, 64-bit on 64-bit Linux).
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#ifndef __GOOD_ATOMIC_H__
+#define __GOOD_ATOMIC_H__
+
+
+#ifdef _WIN32
+#	include <intrin.h>
+#	pragma intrinsic(_InterlockedIncrement, _InterlockedExchangeAdd, _InterlockedCompareExchange, _ReadWriteBarrier)
+#endif
+
+
+namespace good
+{
+
+	/// Integer that can be modified atomically by several threads. It is long as Interlocked functions need it.
+	typedef volatile long atomic_t;
+
+
+#ifdef _WIN32
+
+	/// Atomically increment value, return incremented value.
+	inline long atomic_increment( atomic_t* pValue ) { return _InterlockedIncrement(pValue); }
+
+	/// Atomically add iAdd to value, return previous value.
+	inline long atomic_add( atomic_t* pValue, long iAdd ) { return _InterlockedExchangeAdd(pValue, iAdd); }
+
+	/// Atomically set value to iNew if it is equal to iComparand. Return previous value.
+	inline long atomic_compare_exchange( atomic_t* pValue, long iNew, long iComparand ) { return _InterlockedCompareExchange(pValue, iNew, iComparand); }
+
+	/// Read value, later reads/writes will not be moved before it.
+	inline long atomic_load( const atomic_t* pValue ) { long iResult = *pValue; _ReadWriteBarrier(); return iResult; }
+
+	/// Write value, previous reads/writes will not be moved after it.
+	inline void atomic_store( atomic_t* pValue, long iValue ) { _ReadWriteBarrier(); *pValue = iValue; }
+
+#else
+
+	/// Atomically increment value, return incremented value.
+	inline long atomic_increment( atomic_t* pValue ) { return __sync_add_and_fetch(pValue, 1); }
+
+	/// Atomically add iAdd to value, return previous value.
+	inline long atomic_add( atomic_t* pValue, long iAdd ) { return __sync_fetch_and_add(pValue, iAdd); }
+
+	/// Atomically set value to iNew if it is equal to iComparand. Return previous value.
+	inline long atomic_compare_exchange( atomic_t* pValue, long iNew, long iComparand ) { return __sync_val_compare_and_swap(pValue, iComparand, iNew); }
+
+	/// Read value, later reads/writes will not be moved before it.
+	inline long atomic_load( const atomic_t* pValue ) { long iResult = *pValue; __sync_synchronize(); return iResult; }
+
+	/// Write value, previous reads/writes will not be moved after it.
+	inline void atomic_store( atomic_t* pValue, long iValue ) { __sync_synchronize(); *pValue = iValue; }
+
+#endif // _WIN32
+
+} // namespace good
+
+
+#endif // __GOOD_ATOMIC_H__
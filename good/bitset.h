@@ -2,49 +2,171 @@
 #define __GOOD_BIT_SET_H__
 
 
+#include <string.h>
+
 #include "good/vector.h"
 #include "good/utility.h"
 
 
+// Use SSE2 for bulk operations when compiler targets it (always for x64).
+#if !defined(GOOD_BITSET_NO_SSE2) && ( defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) )
+#	define GOOD_BITSET_SSE2
+#	include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+
+
 namespace good
 {
 
-	
+
+	typedef unsigned long long bitset_word_t;     ///< Storage unit of bitset.
+
+
+	//------------------------------------------------------------------------------------------------------------
+	/// Get count of set bits in a word.
+	//------------------------------------------------------------------------------------------------------------
+	inline int bit_count( bitset_word_t iWord )
+	{
+#if defined(__GNUC__)
+		return __builtin_popcountll(iWord);
+#else
+		// __popcnt64() needs POPCNT instruction, not available on all CPUs. Count bits in parallel instead.
+		iWord = iWord - ( (iWord >> 1) & 0x5555555555555555ULL );
+		iWord = (iWord & 0x3333333333333333ULL) + ( (iWord >> 2) & 0x3333333333333333ULL );
+		iWord = (iWord + (iWord >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+		return (int)( (iWord * 0x0101010101010101ULL) >> 56 );
+#endif
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+	/// Get position of lowest set bit of a word. Word must not be 0.
+	//------------------------------------------------------------------------------------------------------------
+	inline int bit_first( bitset_word_t iWord )
+	{
+		DebugAssert( iWord != 0 );
+#if defined(__GNUC__)
+		return __builtin_ctzll(iWord);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		unsigned long iIndex;
+		_BitScanForward64(&iIndex, iWord);
+		return iIndex;
+#elif defined(_MSC_VER)
+		unsigned long iIndex;
+		if ( _BitScanForward(&iIndex, (unsigned long)iWord) )
+			return iIndex;
+		_BitScanForward(&iIndex, (unsigned long)(iWord >> 32));
+		return iIndex + 32;
+#else
+		int iIndex = 0;
+		while ( (iWord & 1) == 0 )
+		{
+			iWord >>= 1;
+			iIndex++;
+		}
+		return iIndex;
+#endif
+	}
+
+
 	//************************************************************************************************************
 	/// Small class for handling set of bits.
+	/** Bits are stored in 64-bit words, so count(), any(), find_next() and bulk logical operations process 64 bits
+	 * at a time (128 bits with SSE2). Bits after size() in last word are always 0. Bit i is in byte i/8, same as in
+	 * array of bytes, on little-endian machines. */
 	//************************************************************************************************************
 	template < typename Alloc >
 	class base_bitset
 	{
 	public:
-		typedef good::vector< unsigned char, Alloc > container_t;
+		typedef typename Alloc::template rebind<bitset_word_t>::other alloc_t; ///< Allocator of words.
+		typedef good::vector< bitset_word_t, alloc_t > container_t;           ///< Container of words.
+
+		static const int npos = -1;            ///< Returned by find_first() / find_next() when there are no more bits.
 
-		/// Constructor with optional size of set.
-		base_bitset( int iSize = 0 ): m_iSize(iSize) { m_cContainer.resize(BIT_ARRAY_SIZE(iSize)); }
+		/// Constructor with optional size of set. All bits are cleared.
+		base_bitset( int iSize = 0 ): m_iSize(0) { resize(iSize); }
 
-		/// Constructor with data.
-		base_bitset( const char* data, int iSize ): m_iSize(iSize)
+		/// Constructor with data (bit i is in byte i/8).
+		base_bitset( const char* data, int iSize ): m_iSize(0)
 		{
-			int iCharSize = BIT_ARRAY_SIZE(iSize);
-			m_cContainer.resize(iCharSize);
-			memcpy(m_cContainer.data(), data, iCharSize);
+			resize(iSize);
+			memcpy( m_cContainer.data(), data, BIT_ARRAY_SIZE(iSize) );
+			clear_unused();
 		}
 
 		/// Or operator.
-		base_bitset& operator|= (const base_bitset& other)
+		base_bitset& operator|= ( const base_bitset& other )
 		{
 			DebugAssert( size() == other.size() );
-			for ( int i=0; i < m_cContainer.size(); ++i )
-				m_cContainer[i] |= other.m_cContainer[i];
+			bitset_word_t* pTo = m_cContainer.data();
+			const bitset_word_t* pFrom = other.m_cContainer.data();
+			int i = 0;
+#ifdef GOOD_BITSET_SSE2
+			for ( ; i + 2 <= m_cContainer.size(); i += 2 )
+				_mm_storeu_si128( (__m128i*)&pTo[i], _mm_or_si128( _mm_loadu_si128((const __m128i*)&pTo[i]), _mm_loadu_si128((const __m128i*)&pFrom[i]) ) );
+#endif
+			for ( ; i < m_cContainer.size(); ++i )
+				pTo[i] |= pFrom[i];
 			return *this;
 		}
 
-		/// = operator.
-		base_bitset& operator= (const base_bitset& other)
+		/// And operator.
+		base_bitset& operator&= ( const base_bitset& other )
 		{
 			DebugAssert( size() == other.size() );
-			for ( int i=0; i < m_cContainer.size(); ++i )
-				m_cContainer[i] = other.m_cContainer[i];
+			bitset_word_t* pTo = m_cContainer.data();
+			const bitset_word_t* pFrom = other.m_cContainer.data();
+			int i = 0;
+#ifdef GOOD_BITSET_SSE2
+			for ( ; i + 2 <= m_cContainer.size(); i += 2 )
+				_mm_storeu_si128( (__m128i*)&pTo[i], _mm_and_si128( _mm_loadu_si128((const __m128i*)&pTo[i]), _mm_loadu_si128((const __m128i*)&pFrom[i]) ) );
+#endif
+			for ( ; i < m_cContainer.size(); ++i )
+				pTo[i] &= pFrom[i];
+			return *this;
+		}
+
+		/// Xor operator.
+		base_bitset& operator^= ( const base_bitset& other )
+		{
+			DebugAssert( size() == other.size() );
+			bitset_word_t* pTo = m_cContainer.data();
+			const bitset_word_t* pFrom = other.m_cContainer.data();
+			int i = 0;
+#ifdef GOOD_BITSET_SSE2
+			for ( ; i + 2 <= m_cContainer.size(); i += 2 )
+				_mm_storeu_si128( (__m128i*)&pTo[i], _mm_xor_si128( _mm_loadu_si128((const __m128i*)&pTo[i]), _mm_loadu_si128((const __m128i*)&pFrom[i]) ) );
+#endif
+			for ( ; i < m_cContainer.size(); ++i )
+				pTo[i] ^= pFrom[i];
+			return *this;
+		}
+
+		/// Clear bits that are set in other (this = this & ~other).
+		base_bitset& and_not( const base_bitset& other )
+		{
+			DebugAssert( size() == other.size() );
+			bitset_word_t* pTo = m_cContainer.data();
+			const bitset_word_t* pFrom = other.m_cContainer.data();
+			int i = 0;
+#ifdef GOOD_BITSET_SSE2
+			for ( ; i + 2 <= m_cContainer.size(); i += 2 ) // _mm_andnot_si128(a, b) is ~a & b.
+				_mm_storeu_si128( (__m128i*)&pTo[i], _mm_andnot_si128( _mm_loadu_si128((const __m128i*)&pFrom[i]), _mm_loadu_si128((const __m128i*)&pTo[i]) ) );
+#endif
+			for ( ; i < m_cContainer.size(); ++i )
+				pTo[i] &= ~pFrom[i];
+			return *this;
+		}
+
+		/// = operator. Copies bits, sizes must be equal.
+		base_bitset& operator= ( const base_bitset& other )
+		{
+			DebugAssert( size() == other.size() );
+			memcpy( m_cContainer.data(), other.m_cContainer.data(), m_cContainer.size() * sizeof(bitset_word_t) );
 			return *this;
 		}
 
@@ -54,9 +176,17 @@ namespace good
 		/// Returns true if any bits are set.
 		bool any() const
 		{
-			// TODO: iterate on long.
-			for ( int i=0; i < m_cContainer.size(); ++i )
-				if ( m_cContainer[i] )
+			const bitset_word_t* pWords = m_cContainer.data();
+			int i = 0;
+#ifdef GOOD_BITSET_SSE2
+			__m128i iOr = _mm_setzero_si128();
+			for ( ; i + 2 <= m_cContainer.size(); i += 2 )
+				iOr = _mm_or_si128( iOr, _mm_loadu_si128((const __m128i*)&pWords[i]) );
+			if ( _mm_movemask_epi8( _mm_cmpeq_epi8(iOr, _mm_setzero_si128()) ) != 0xFFFF )
+				return true;
+#endif
+			for ( ; i < m_cContainer.size(); ++i )
+				if ( pWords[i] )
 					return true;
 			return false;
 		}
@@ -64,57 +194,98 @@ namespace good
 		/// Returns true if no bits are set.
 		bool none() const { return !any(); }
 
-		/// Resize set to given size. Note that new bits will be undefined.
-		void resize( int iNewSize ) { m_cContainer.resize( BIT_ARRAY_SIZE(iNewSize) ); m_iSize = iNewSize; }
+		/// Resize set to given size. New bits are cleared.
+		void resize( int iNewSize )
+		{
+			m_cContainer.resize( word_count(iNewSize), 0 );
+			m_iSize = iNewSize;
+			clear_unused();
+		}
 
 		/// Clear all bits.
-		void reset() { memset( m_cContainer.data(), 0, m_cContainer.size() ); }
+		void reset() { memset( m_cContainer.data(), 0, m_cContainer.size() * sizeof(bitset_word_t) ); }
 
 		/// Set all bits.
-		void set() { memset( m_cContainer.data(), 0xFF, m_cContainer.size() ); }
+		void set()
+		{
+			memset( m_cContainer.data(), 0xFF, m_cContainer.size() * sizeof(bitset_word_t) );
+			clear_unused();
+		}
 
 		/// Returns true if bit n is set.
 		bool operator[]( int iIndex ) const { return test(iIndex); }
-	
+
 		/// Returns true if bit n is set.
-		bool test( int iIndex ) const { DebugAssert( iIndex < m_iSize ); return BIT_ARRAY_IS_SET(iIndex, m_cContainer) != 0; }
+		bool test( int iIndex ) const
+		{
+			DebugAssert( (0 <= iIndex) && (iIndex < m_iSize) );
+			return ( m_cContainer[iIndex >> 6] & bit_mask(iIndex) ) != 0;
+		}
 
 		/// Set bit at given position.
 		void set( int iIndex )
 		{
-			DebugAssert( iIndex < m_iSize );
-			BIT_ARRAY_SET(iIndex, m_cContainer);
+			DebugAssert( (0 <= iIndex) && (iIndex < m_iSize) );
+			m_cContainer[iIndex >> 6] |= bit_mask(iIndex);
 		}
 
 		/// Set bit at given position.
 		void set( int iIndex, bool bValue )
 		{
-			DebugAssert( iIndex < m_iSize );
 			if ( bValue )
-				BIT_ARRAY_SET(iIndex, m_cContainer);
+				set(iIndex);
 			else
-				BIT_ARRAY_CLEAR(iIndex, m_cContainer);
+				reset(iIndex);
 		}
 
 		/// Clear bit at given position.
-		void reset( int iIndex ) { set(iIndex, false); }
+		void reset( int iIndex )
+		{
+			DebugAssert( (0 <= iIndex) && (iIndex < m_iSize) );
+			m_cContainer[iIndex >> 6] &= ~bit_mask(iIndex);
+		}
 
 		/// Get count of set bits.
 		int count() const
 		{
-			// Bits expanded:                    0000 0001 0010 0011 0100 0101 0110 0111 1000 1001 1010 1011 1100 1101 1110 1111
-			static const int char_counts[16] = { 0,   1,   1,   2,   1,   2,   2,   3,   1,   2,   2,   3,   2,   3,   3,   4 };
-			int count = 0;
+			int iCount = 0;
 			for ( int i=0; i < m_cContainer.size(); ++i )
+				iCount += bit_count( m_cContainer[i] );
+			return iCount;
+		}
+
+		/// Get position of first set bit, npos if there are none.
+		int find_first() const { return find_next(-1); }
+
+		/// Get position of first set bit after iIndex, npos if there are none. Iterate: i = find_next(i).
+		int find_next( int iIndex ) const
+		{
+			iIndex++;
+			if ( iIndex >= m_iSize )
+				return npos;
+
+			int iWord = iIndex >> 6;
+			bitset_word_t iBits = m_cContainer[iWord] & ( ~(bitset_word_t)0 << (iIndex & 63) ); // Skip lower bits.
+			while ( iBits == 0 )
 			{
-				unsigned char c = m_cContainer[i];
-				count += char_counts[c & 0x0F];
-				count += char_counts[(c >> 4 ) & 0x0F];
+				if ( ++iWord == m_cContainer.size() )
+					return npos;
+				iBits = m_cContainer[iWord];
 			}
-			return count;
+			return (iWord << 6) + bit_first(iBits);
 		}
 
 	protected:
+		static int word_count( int iSize ) { return (iSize + 63) >> 6; }
+		static bitset_word_t bit_mask( int iIndex ) { return (bitset_word_t)1 << (iIndex & 63); }
+
+		// Clear bits after size in last word.
+		void clear_unused()
+		{
+			if ( m_iSize & 63 )
+				m_cContainer.back() &= ( (bitset_word_t)1 << (m_iSize & 63) ) - 1;
+		}
+
 		container_t m_cContainer;
 		int m_iSize;
 	};
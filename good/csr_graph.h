@@ -0,0 +1,135 @@
+//----------------------------------------------------------------------------------------------------------------
+// Immutable directed graph in compressed sparse row form, built from good::graph.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#ifndef __GOOD_CSR_GRAPH_H__
+#define __GOOD_CSR_GRAPH_H__
+
+
+#include "good/vector.h"
+
+
+namespace good
+{
+
+
+	//************************************************************************************************************
+	/// Frozen copy of arcs of a graph, stored as structure of arrays.
+	/** Arcs of node n are indexes from arcs_begin(n) to arcs_end(n) (not inclusive). Their targets, lengths and
+	 * edges are in separate contiguous arrays, in the same order as in neighbours of graph node, so search that
+	 * only needs target and length of arcs touches 8 bytes per arc, without following pointer to each node arcs.
+	 * Graph must be built again after any change of source graph. */
+	//************************************************************************************************************
+	template <
+		typename Edge,                                               ///< Edge can be any type.
+		typename EdgeLengthType = float,                             ///< Type of length of Edge.
+		typename Alloc = allocator<Edge>                             ///< Memory allocator.
+	>
+	class csr_graph
+	{
+	public:
+		typedef int node_id;                       ///< Type for node id (same as node id of source graph).
+		typedef int arc_id;                        ///< Type for arc index in arcs arrays.
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Build from graph. EdgeLength is functor that returns length of Edge.
+		//--------------------------------------------------------------------------------------------------------
+		template <typename Graph, typename EdgeLength>
+		void build( Graph const& cGraph, EdgeLength const& cLength )
+		{
+			clear();
+
+			int iArcs = 0;
+			for ( typename Graph::const_node_it it = cGraph.begin(); it != cGraph.end(); ++it )
+				iArcs += it->neighbours.size();
+
+			m_aOffsets.reserve( cGraph.size() + 1 );
+			m_aTargets.reserve( iArcs );
+			m_aLengths.reserve( iArcs );
+			m_aEdges.reserve( iArcs );
+
+			for ( typename Graph::const_node_it it = cGraph.begin(); it != cGraph.end(); ++it )
+			{
+				m_aOffsets.push_back( m_aTargets.size() );
+				for ( typename Graph::const_arc_it arcIt = it->neighbours.begin(); arcIt != it->neighbours.end(); ++arcIt )
+				{
+					m_aTargets.push_back( arcIt->target );
+					m_aLengths.push_back( cLength(arcIt->edge) );
+					m_aEdges.push_back( arcIt->edge );
+				}
+			}
+			m_aOffsets.push_back( m_aTargets.size() );
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Remove all nodes and arcs.
+		//--------------------------------------------------------------------------------------------------------
+		void clear()
+		{
+			m_aOffsets.clear();
+			m_aTargets.clear();
+			m_aLengths.clear();
+			m_aEdges.clear();
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get nodes count.
+		//--------------------------------------------------------------------------------------------------------
+		int size() const { return m_aOffsets.size() ? m_aOffsets.size() - 1 : 0; }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get arcs count.
+		//--------------------------------------------------------------------------------------------------------
+		int arcs_size() const { return m_aTargets.size(); }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get index of first arc of node.
+		//--------------------------------------------------------------------------------------------------------
+		arc_id arcs_begin( node_id iNode ) const { return m_aOffsets[iNode]; }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get index after last arc of node.
+		//--------------------------------------------------------------------------------------------------------
+		arc_id arcs_end( node_id iNode ) const { return m_aOffsets[iNode + 1]; }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get target node of arc.
+		//--------------------------------------------------------------------------------------------------------
+		node_id target( arc_id iArc ) const { return m_aTargets[iArc]; }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get length of arc.
+		//--------------------------------------------------------------------------------------------------------
+		EdgeLengthType length( arc_id iArc ) const { return m_aLengths[iArc]; }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get edge of arc.
+		//--------------------------------------------------------------------------------------------------------
+		Edge const& edge( arc_id iArc ) const { return m_aEdges[iArc]; }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get arc from node iFrom to node iTo, -1 if there is none.
+		//--------------------------------------------------------------------------------------------------------
+		arc_id find_arc( node_id iFrom, node_id iTo ) const
+		{
+			for ( arc_id iArc = m_aOffsets[iFrom]; iArc < m_aOffsets[iFrom + 1]; ++iArc )
+				if ( m_aTargets[iArc] == iTo )
+					return iArc;
+			return -1;
+		}
+
+	protected:
+		typedef typename Alloc::template rebind<EdgeLengthType>::other alloc_length_t; // Allocator for lengths.
+		typedef typename Alloc::template rebind<int>::other alloc_int_t;               // Allocator for offsets and targets.
+
+		vector<int, alloc_int_t> m_aOffsets;                 // Index of first arc of each node, plus arcs count at end.
+		vector<node_id, alloc_int_t> m_aTargets;             // Target node of each arc.
+		vector<EdgeLengthType, alloc_length_t> m_aLengths;   // Length of each arc.
+		vector<Edge, Alloc> m_aEdges;                        // Edge of each arc.
+	};
+
+
+} // namespace good
+
+#endif // __GOOD_CSR_GRAPH_H__
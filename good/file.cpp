@@ -5,6 +5,7 @@
 #	include <direct.h> // For mkdir() function.
 #else
 #	include <fcntl.h>
+#	include <sys/stat.h> // For mkdir() function.
 #endif
 
 #include "good/file.h"
@@ -73,7 +74,11 @@ namespace good
 			szFolderName[folderNameSize++] = PATH_SEPARATOR;//next
 			szFolderName[folderNameSize] = 0;
 			
+#ifdef _WIN32
 			mkdir(szFolderName);
+#else
+			mkdir(szFolderName, 0755);
+#endif
 		}
 
 		return true;
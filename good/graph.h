@@ -10,12 +10,35 @@
 #include "good/utility.h"
 #include "good/list.h"
 #include "good/vector.h"
+#include "good/small_vector.h"
+
+
+/// Count of arcs that are stored inside graph node, without allocating memory.
+#define DEFAULT_GRAPH_INLINE_ARCS 8
 
 
 namespace good
 {
 
 
+	//************************************************************************************************************
+	/// Container of node arcs: small_vector with DEFAULT_GRAPH_INLINE_ARCS inline arcs.
+	/** Graph takes arcs container as template with two parameters (type and allocator), so this class just fixes
+	 * inline capacity of small_vector. */
+	//************************************************************************************************************
+	template <typename T, typename Alloc = allocator<T> >
+	class arcs_vector: public small_vector<T, DEFAULT_GRAPH_INLINE_ARCS, Alloc>
+	{
+	public:
+		typedef small_vector<T, DEFAULT_GRAPH_INLINE_ARCS, Alloc> base_class; ///< Base class.
+
+		/// Default constructor.
+		arcs_vector() {}
+		/// Constructor with capacity parameter.
+		arcs_vector( int iCapacity ): base_class(iCapacity) {}
+	};
+
+
 	//************************************************************************************************************
 	/// Class that represents directional graph.
 	//************************************************************************************************************
@@ -23,7 +46,7 @@ namespace good
 		typename Vertex,                                             ///< Vertex can be any type.
 		typename Edge,                                               ///< Edge can be any type.
 		template <typename, typename> class NodesContainer = vector, ///< Random access for fast operations.
-		template <typename, typename> class ArcsContainer = vector,  ///< Any container class.
+		template <typename, typename> class ArcsContainer = arcs_vector, ///< Any container class.
 		typename Alloc = allocator<Vertex>                           ///< Memory allocator.
 	>
 	class graph
@@ -273,4 +296,4 @@ namespace good
 } // namespace good
 
 
-#endif // __GOOD_GRAPH_H__
\ No newline at end of file
+#endif // __GOOD_GRAPH_H__
\ No newline at end of file
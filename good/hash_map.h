@@ -0,0 +1,77 @@
+//----------------------------------------------------------------------------------------------------------------
+// Hash map implementation, based on open addressing with linear probing.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#ifndef __GOOD_HASH_MAP_H__
+#define __GOOD_HASH_MAP_H__
+
+
+#include "good/hash_table.h"
+
+
+namespace good
+{
+
+
+	//************************************************************************************************************
+	/** Map from Key to Value, using open addressing with linear probing (see hash_table).
+	 * Note that as in vector, assignment/copy constructor will "steal" internal buffers, and elements are moved
+	 * using their copy constructors (so good::string keys are moved, not duplicated).
+	 * Pointers/iterators to elements are invalidated by insertion and erasing. */
+	//************************************************************************************************************
+	template <
+		typename Key,
+		typename Value,
+		typename Hash = hash<Key>,
+		typename Equal = equal<Key>,
+		typename Alloc = allocator< pair<Key, Value> >
+	>
+	class hash_map: public hash_table< pair<Key, Value>, Key, pair_first_key< pair<Key, Value> >, Hash, Equal, Alloc >
+	{
+	public:
+		typedef pair<Key, Value> key_value_t;  ///< Type of element of this map.
+		typedef hash_table< key_value_t, Key, pair_first_key<key_value_t>, Hash, Equal, Alloc > base_class; ///< Base class.
+		typedef typename base_class::const_iterator const_iterator; ///< Const iterator of hash map.
+		typedef typename base_class::iterator iterator;             ///< Iterator of hash map.
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Constructor with optional count of elements to reserve space for.
+		//--------------------------------------------------------------------------------------------------------
+		hash_map( int iCapacity = 0 ): base_class(iCapacity) {}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Copy constructor. Note that it moves content, not copies it.
+		//--------------------------------------------------------------------------------------------------------
+		hash_map( const hash_map& cOther ): base_class(cOther) {}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Operator =. Note that this operator moves content, not copies it.
+		//--------------------------------------------------------------------------------------------------------
+		hash_map& operator= ( const hash_map& cOther )
+		{
+			this->assign(cOther);
+			return *this;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get mutable value for a key.
+		/**
+		 * If key not found, insert (key, empty value) into map, returning reference to that value.
+		 * Use find() function if you need to know if key has some value.
+		 */
+		//--------------------------------------------------------------------------------------------------------
+		Value& operator[]( const Key& key )
+		{
+			int iBucket = this->find_bucket( key, this->get_hash(key) );
+			if ( iBucket >= 0 )
+				return this->m_pBuckets[iBucket].second;
+			return this->insert( key_value_t(key, Value()), false )->second;
+		}
+	};
+
+
+} // namespace good
+
+
+#endif // __GOOD_HASH_MAP_H__
@@ -0,0 +1,59 @@
+//----------------------------------------------------------------------------------------------------------------
+// Hash set implementation, based on open addressing with linear probing.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#ifndef __GOOD_HASH_SET_H__
+#define __GOOD_HASH_SET_H__
+
+
+#include "good/hash_table.h"
+
+
+namespace good
+{
+
+
+	//************************************************************************************************************
+	/** Set of unique elements of type T, using open addressing with linear probing (see hash_table).
+	 * Note that as in vector, assignment/copy constructor will "steal" internal buffers, and elements are moved
+	 * using their copy constructors (so good::string elements are moved, not duplicated). */
+	//************************************************************************************************************
+	template <
+		typename T,
+		typename Hash = hash<T>,
+		typename Equal = equal<T>,
+		typename Alloc = allocator<T>
+	>
+	class hash_set: public hash_table< T, T, identity_key<T>, Hash, Equal, Alloc >
+	{
+	public:
+		typedef hash_table< T, T, identity_key<T>, Hash, Equal, Alloc > base_class; ///< Base class.
+		typedef typename base_class::const_iterator const_iterator; ///< Const iterator of hash set.
+		typedef typename base_class::iterator iterator;             ///< Iterator of hash set.
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Constructor with optional count of elements to reserve space for.
+		//--------------------------------------------------------------------------------------------------------
+		hash_set( int iCapacity = 0 ): base_class(iCapacity) {}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Copy constructor. Note that it moves content, not copies it.
+		//--------------------------------------------------------------------------------------------------------
+		hash_set( const hash_set& cOther ): base_class(cOther) {}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Operator =. Note that this operator moves content, not copies it.
+		//--------------------------------------------------------------------------------------------------------
+		hash_set& operator= ( const hash_set& cOther )
+		{
+			this->assign(cOther);
+			return *this;
+		}
+	};
+
+
+} // namespace good
+
+
+#endif // __GOOD_HASH_SET_H__
@@ -0,0 +1,590 @@
+//----------------------------------------------------------------------------------------------------------------
+// Hash table implementation, based on open addressing with linear probing. Base for hash_map and hash_set.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#ifndef __GOOD_HASH_TABLE_H__
+#define __GOOD_HASH_TABLE_H__
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "good/string.h"
+#include "good/utility.h"
+
+
+#define DEFAULT_HASH_MAP_BUCKETS  16         ///< Buckets count allocated by default on first insertion.
+
+
+namespace good
+{
+
+
+	//------------------------------------------------------------------------------------------------------------
+	/// Mix bits of a number, so that every bit of result depends on all bits of iKey (finalizer of MurmurHash3).
+	/** Hash table takes low bits of hash as bucket index, so keys that differ only in high bits need this. */
+	//------------------------------------------------------------------------------------------------------------
+	inline unsigned int hash_mix( unsigned int iKey )
+	{
+		iKey ^= iKey >> 16;
+		iKey *= 0x85EBCA6BU;
+		iKey ^= iKey >> 13;
+		iKey *= 0xC2B2AE35U;
+		iKey ^= iKey >> 16;
+		return iKey;
+	}
+
+
+	//************************************************************************************************************
+	/// Util class to get hash of an element. Default one is for integral types.
+	//************************************************************************************************************
+	template <typename T>
+	class hash
+	{
+	public:
+		/// Get hash of integral number. Multiplicative hash would leave low bits of key in low bits of hash (keys
+		/// that are multiples of buckets count would go to one bucket), so bits are mixed.
+		unsigned int operator() ( const T& tKey ) const
+		{
+			return hash_mix( (unsigned int)tKey );
+		}
+	};
+
+
+	//************************************************************************************************************
+	/// Hash of a pointer (compares addresses, not content). Bits are mixed, as low bits are 0 due to alignment.
+	//************************************************************************************************************
+	template <typename T>
+	class hash<T*>
+	{
+	public:
+		unsigned int operator() ( T* pKey ) const
+		{
+			size_t iKey = (size_t)pKey;
+			unsigned int iHash = (unsigned int)iKey;
+			if ( sizeof(size_t) > sizeof(unsigned int) )
+				iHash ^= (unsigned int)( (iKey >> 16) >> 16 );
+			return hash_mix(iHash);
+		}
+	};
+
+
+	//************************************************************************************************************
+	/// Get hash of iSize characters of a string (MurmurHash3, x86 32 bits, seed 0).
+	/** Reads 4 characters at a time, so it is about twice faster than byte per byte FNV-1a for words of 10 or more
+	 * characters. Note that result depends on endianness, so it must not be saved to disk. */
+	//************************************************************************************************************
+	inline unsigned int hash_string( const char* szStr, int iSize )
+	{
+		#define GOOD_ROTL32(x, r) ( ((x) << (r)) | ((x) >> (32 - (r))) )
+		unsigned int iHash = 0;
+		const char* szEnd = szStr + (iSize & ~3);
+		for ( ; szStr < szEnd; szStr += 4 )
+		{
+			unsigned int iBlock;
+			memcpy( &iBlock, szStr, 4 ); // Unaligned read, compiled to a single mov.
+			iBlock *= 0xCC9E2D51U;
+			iBlock = GOOD_ROTL32(iBlock, 15);
+			iBlock *= 0x1B873593U;
+			iHash ^= iBlock;
+			iHash = GOOD_ROTL32(iHash, 13);
+			iHash = iHash * 5 + 0xE6546B64U;
+		}
+
+		unsigned int iTail = 0;
+		switch ( iSize & 3 )
+		{
+		case 3:
+			iTail ^= (unsigned char)szStr[2] << 16;
+		case 2:
+			iTail ^= (unsigned char)szStr[1] << 8;
+		case 1:
+			iTail ^= (unsigned char)szStr[0];
+			iTail *= 0xCC9E2D51U;
+			iTail = GOOD_ROTL32(iTail, 15);
+			iTail *= 0x1B873593U;
+			iHash ^= iTail;
+		}
+		#undef GOOD_ROTL32
+
+		iHash ^= (unsigned int)iSize;
+		return hash_mix(iHash);
+	}
+
+
+	//************************************************************************************************************
+	/// Hash of a string. Also hashes C strings, so maps with good::string keys can be searched by const char*.
+	//************************************************************************************************************
+	template <>
+	class hash<good::string>
+	{
+	public:
+		unsigned int operator() ( const good::string& sKey ) const
+		{
+			return hash_string( sKey.c_str(), sKey.size() );
+		}
+
+		unsigned int operator() ( const char* szKey ) const
+		{
+			return hash_string( szKey, strlen(szKey) );
+		}
+	};
+
+
+	//************************************************************************************************************
+	/// Util class to get key of element of hash table: element itself.
+	//************************************************************************************************************
+	template <typename T>
+	class identity_key
+	{
+	public:
+		const T& operator() ( const T& tElem ) const { return tElem; }
+	};
+
+
+	//************************************************************************************************************
+	/// Util class to get key of element of hash table: first element of a pair.
+	//************************************************************************************************************
+	template <typename Pair>
+	class pair_first_key
+	{
+	public:
+		const typename Pair::first_type& operator() ( const Pair& tElem ) const { return tElem.first; }
+	};
+
+
+	//************************************************************************************************************
+	/** Table of elements T with unique keys, using open addressing with linear probing.
+	 * Buckets and their hashes are stored in two contiguous arrays, so lookup touches few cache lines. Deletion
+	 * shifts following elements back, so there are no tombstones and lookup cost doesn't grow with erases.
+	 * Lookup functions also accept other key types, for which Hash and Equal are defined (for example
+	 * const char* for good::string keys), so no temporary Key is constructed.
+	 * Note that as in vector, assignment/copy constructor will "steal" internal buffers, and elements are moved
+	 * using their copy constructors (so good::string keys are moved, not duplicated).
+	 * Pointers/iterators to elements are invalidated by insertion and erasing. */
+	//************************************************************************************************************
+	template <
+		typename T,
+		typename Key,
+		typename KeyOf,
+		typename Hash = hash<Key>,
+		typename Equal = equal<Key>,
+		typename Alloc = allocator<T>
+	>
+	class hash_table
+	{
+	public:
+		//========================================================================================================
+		/// Const iterator of hash table.
+		//========================================================================================================
+		class const_iterator
+		{
+		public:
+			friend class hash_table<T, Key, KeyOf, Hash, Equal, Alloc>;
+
+			// Constructor by value.
+			const_iterator( T* pCurrent = NULL, const unsigned int* pHash = NULL, const unsigned int* pHashEnd = NULL ):
+				m_pCurrent(pCurrent), m_pHash(pHash), m_pHashEnd(pHashEnd) { skip_empty(); }
+			// Copy constructor.
+			const_iterator( const_iterator const& itOther ):
+				m_pCurrent(itOther.m_pCurrent), m_pHash(itOther.m_pHash), m_pHashEnd(itOther.m_pHashEnd) {}
+
+			/// Operator ==.
+			bool operator== ( const const_iterator& itOther ) const { return m_pCurrent == itOther.m_pCurrent; }
+			/// Operator !=.
+			bool operator!= ( const const_iterator& itOther ) const { return m_pCurrent != itOther.m_pCurrent; }
+
+			/// Pre-increment.
+			const_iterator& operator++() { DebugAssert(m_pHash < m_pHashEnd); ++m_pCurrent; ++m_pHash; skip_empty(); return *this; }
+			/// Post-increment.
+			const_iterator operator++ (int) { const_iterator tmp(*this); ++(*this); return tmp; }
+
+			/// Dereference.
+			const T& operator*() const { DebugAssert(m_pHash < m_pHashEnd); return *m_pCurrent; }
+			/// Element selection through pointer.
+			const T* operator->() const { DebugAssert(m_pHash < m_pHashEnd); return m_pCurrent; }
+
+		protected:
+			void skip_empty()
+			{
+				while ( (m_pHash < m_pHashEnd) && (*m_pHash == 0) )
+				{
+					++m_pCurrent;
+					++m_pHash;
+				}
+			}
+
+			T* m_pCurrent;
+			const unsigned int* m_pHash;
+			const unsigned int* m_pHashEnd;
+		};
+
+
+		//========================================================================================================
+		/// Iterator of hash table. Note that key should not be modified.
+		//========================================================================================================
+		class iterator: public const_iterator
+		{
+		public:
+			typedef const_iterator base_class;
+
+			// Constructor by value.
+			iterator( T* pCurrent = NULL, const unsigned int* pHash = NULL, const unsigned int* pHashEnd = NULL ):
+				base_class(pCurrent, pHash, pHashEnd) {}
+			// Copy constructor.
+			iterator( iterator const& itOther ): base_class(itOther) {}
+
+			/// Pre-increment.
+			iterator& operator++() { base_class::operator++(); return *this; }
+			/// Post-increment.
+			iterator operator++ (int) { iterator tmp(*this); base_class::operator++(); return tmp; }
+
+			/// Dereference.
+			T& operator*() const { DebugAssert(this->m_pHash < this->m_pHashEnd); return *this->m_pCurrent; }
+			/// Element selection through pointer.
+			T* operator->() const { DebugAssert(this->m_pHash < this->m_pHashEnd); return this->m_pCurrent; }
+		};
+
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Constructor with optional count of elements to reserve space for.
+		//--------------------------------------------------------------------------------------------------------
+		hash_table( int iCapacity = 0 ): m_pBuckets(NULL), m_pHashes(NULL), m_iBuckets(0), m_iSize(0)
+		{
+			if ( iCapacity > 0 )
+				reserve(iCapacity);
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Copy constructor. Note that it moves content, not copies it.
+		//--------------------------------------------------------------------------------------------------------
+		hash_table( const hash_table& cOther ): m_pBuckets(NULL), m_pHashes(NULL), m_iBuckets(0), m_iSize(0)
+		{
+			assign(cOther);
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Destructor.
+		//--------------------------------------------------------------------------------------------------------
+		~hash_table()
+		{
+			clear();
+			deallocate();
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Operator =. Note that this operator moves content, not copies it.
+		//--------------------------------------------------------------------------------------------------------
+		hash_table& operator= ( const hash_table& cOther )
+		{
+			assign(cOther);
+			return *this;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Move content of other table to this one.
+		//--------------------------------------------------------------------------------------------------------
+		void assign( const hash_table& cOther )
+		{
+			if ( &cOther == this )
+				return;
+			clear();
+			hash_table& cSteal = (hash_table&)cOther;
+			good::swap(m_pBuckets, cSteal.m_pBuckets);
+			good::swap(m_pHashes, cSteal.m_pHashes);
+			good::swap(m_iBuckets, cSteal.m_iBuckets);
+			good::swap(m_iSize, cSteal.m_iSize);
+		}
+
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Return true if table has no elements.
+		//--------------------------------------------------------------------------------------------------------
+		bool empty() const { return m_iSize == 0; }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get count of elements in table.
+		//--------------------------------------------------------------------------------------------------------
+		int size() const { return m_iSize; }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get count of allocated buckets.
+		//--------------------------------------------------------------------------------------------------------
+		int buckets() const { return m_iBuckets; }
+
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get const iterator to first element. Note that elements are not ordered.
+		//--------------------------------------------------------------------------------------------------------
+		const_iterator begin() const { return const_iterator(m_pBuckets, m_pHashes, m_pHashes + m_iBuckets); }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get const iterator to element past last one.
+		//--------------------------------------------------------------------------------------------------------
+		const_iterator end() const { return const_iterator(m_pBuckets + m_iBuckets, m_pHashes + m_iBuckets, m_pHashes + m_iBuckets); }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get iterator to first element. Note that elements are not ordered.
+		//--------------------------------------------------------------------------------------------------------
+		iterator begin() { return iterator(m_pBuckets, m_pHashes, m_pHashes + m_iBuckets); }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get iterator to element past last one.
+		//--------------------------------------------------------------------------------------------------------
+		iterator end() { return iterator(m_pBuckets + m_iBuckets, m_pHashes + m_iBuckets, m_pHashes + m_iBuckets); }
+
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get const iterator to a key, or end() if there is no such key.
+		//--------------------------------------------------------------------------------------------------------
+		const_iterator find( const Key& key ) const
+		{
+			int iBucket = find_bucket( key, get_hash(key) );
+			return (iBucket < 0) ? end() : const_iterator(m_pBuckets + iBucket, m_pHashes + iBucket, m_pHashes + m_iBuckets);
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get iterator to a key, or end() if there is no such key.
+		//--------------------------------------------------------------------------------------------------------
+		iterator find( const Key& key )
+		{
+			int iBucket = find_bucket( key, get_hash(key) );
+			return (iBucket < 0) ? end() : iterator(m_pBuckets + iBucket, m_pHashes + iBucket, m_pHashes + m_iBuckets);
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get const iterator to a key of other type (for example const char* for good::string key).
+		//--------------------------------------------------------------------------------------------------------
+		template <typename K>
+		const_iterator find( const K& key ) const
+		{
+			int iBucket = find_bucket( key, get_hash(key) );
+			return (iBucket < 0) ? end() : const_iterator(m_pBuckets + iBucket, m_pHashes + iBucket, m_pHashes + m_iBuckets);
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get iterator to a key of other type (for example const char* for good::string key).
+		//--------------------------------------------------------------------------------------------------------
+		template <typename K>
+		iterator find( const K& key )
+		{
+			int iBucket = find_bucket( key, get_hash(key) );
+			return (iBucket < 0) ? end() : iterator(m_pBuckets + iBucket, m_pHashes + iBucket, m_pHashes + m_iBuckets);
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Return true if table has given key.
+		//--------------------------------------------------------------------------------------------------------
+		bool contains( const Key& key ) const { return find_bucket( key, get_hash(key) ) >= 0; }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Return true if table has given key of other type (for example const char* for good::string key).
+		//--------------------------------------------------------------------------------------------------------
+		template <typename K>
+		bool contains( const K& key ) const { return find_bucket( key, get_hash(key) ) >= 0; }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Insert element. If element with same key exists, it will be replaced only if bReplace is true.
+		/** Note that tElem is copied (so good::string key will be moved into this table). */
+		//--------------------------------------------------------------------------------------------------------
+		iterator insert( const T& tElem, bool bReplace = true )
+		{
+			unsigned int iHash = get_hash( m_cKeyOf(tElem) );
+			int iBucket = find_bucket( m_cKeyOf(tElem), iHash );
+			if ( iBucket >= 0 )
+			{
+				if ( bReplace )
+				{
+					m_cAlloc.destroy( &m_pBuckets[iBucket] );
+					m_cAlloc.construct( &m_pBuckets[iBucket], tElem );
+				}
+			}
+			else
+			{
+				if ( (m_iSize + 1) * 4 > m_iBuckets * 3 ) // Keep load factor below 3/4.
+					rehash( m_iBuckets ? m_iBuckets << 1 : DEFAULT_HASH_MAP_BUCKETS );
+				iBucket = insert_new( tElem, iHash );
+			}
+			return iterator(m_pBuckets + iBucket, m_pHashes + iBucket, m_pHashes + m_iBuckets);
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Remove element with given key. Return true if key was found.
+		//--------------------------------------------------------------------------------------------------------
+		bool erase( const Key& key )
+		{
+			int iBucket = find_bucket( key, get_hash(key) );
+			if ( iBucket < 0 )
+				return false;
+			erase_bucket(iBucket);
+			return true;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Remove element at iterator. Note that other iterators are invalidated.
+		//--------------------------------------------------------------------------------------------------------
+		void erase( iterator it )
+		{
+			DebugAssert( it != end() );
+			erase_bucket( it.m_pCurrent - m_pBuckets );
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Remove all elements. Buckets are not deallocated.
+		//--------------------------------------------------------------------------------------------------------
+		void clear()
+		{
+			for ( int i = 0; i < m_iBuckets; ++i )
+				if ( m_pHashes[i] )
+				{
+					m_cAlloc.destroy( &m_pBuckets[i] );
+					m_pHashes[i] = 0;
+				}
+			m_iSize = 0;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Reserve space for given count of elements, so they can be inserted without rehashing.
+		//--------------------------------------------------------------------------------------------------------
+		void reserve( int iCapacity )
+		{
+			int iBuckets = DEFAULT_HASH_MAP_BUCKETS;
+			while ( iBuckets * 3 < iCapacity * 4 )
+				iBuckets <<= 1;
+			if ( iBuckets > m_iBuckets )
+				rehash(iBuckets);
+		}
+
+
+	protected: // Methods.
+		//--------------------------------------------------------------------------------------------------------
+		// Get hash of key. 0 is reserved to mark empty buckets.
+		//--------------------------------------------------------------------------------------------------------
+		template <typename K>
+		unsigned int get_hash( const K& key ) const
+		{
+			unsigned int iHash = m_cHash(key);
+			return iHash ? iHash : 1;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		// Get bucket of key or -1 if not found.
+		//--------------------------------------------------------------------------------------------------------
+		template <typename K>
+		int find_bucket( const K& key, unsigned int iHash ) const
+		{
+			if ( m_iSize == 0 )
+				return -1;
+			int iMask = m_iBuckets - 1;
+			for ( int i = iHash & iMask; m_pHashes[i]; i = (i + 1) & iMask )
+				if ( (m_pHashes[i] == iHash) && m_cEqual(m_cKeyOf(m_pBuckets[i]), key) )
+					return i;
+			return -1;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		// Insert element that is not in the table. There must be free bucket.
+		//--------------------------------------------------------------------------------------------------------
+		int insert_new( const T& tElem, unsigned int iHash )
+		{
+			int iMask = m_iBuckets - 1;
+			int i = iHash & iMask;
+			while ( m_pHashes[i] )
+				i = (i + 1) & iMask;
+			m_cAlloc.construct( &m_pBuckets[i], tElem );
+			m_pHashes[i] = iHash;
+			m_iSize++;
+			return i;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		// Erase element at bucket, shifting back next elements of the cluster.
+		//--------------------------------------------------------------------------------------------------------
+		void erase_bucket( int iHole )
+		{
+			m_cAlloc.destroy( &m_pBuckets[iHole] );
+			m_pHashes[iHole] = 0;
+			m_iSize--;
+
+			int iMask = m_iBuckets - 1;
+			for ( int i = (iHole + 1) & iMask; m_pHashes[i]; i = (i + 1) & iMask )
+			{
+				int iIdeal = m_pHashes[i] & iMask;
+				// Element at i may move to the hole if its ideal bucket is not in (iHole, i] cyclically.
+				bool bMove = (iHole <= i) ? ( (iIdeal <= iHole) || (iIdeal > i) ) : ( (iIdeal <= iHole) && (iIdeal > i) );
+				if ( bMove )
+				{
+					m_cAlloc.construct( &m_pBuckets[iHole], m_pBuckets[i] );
+					m_pHashes[iHole] = m_pHashes[i];
+					m_cAlloc.destroy( &m_pBuckets[i] );
+					m_pHashes[i] = 0;
+					iHole = i;
+				}
+			}
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		// Reallocate buckets, iBuckets must be power of 2.
+		//--------------------------------------------------------------------------------------------------------
+		void rehash( int iBuckets )
+		{
+			DebugAssert( (iBuckets & (iBuckets-1)) == 0 );
+			T* pOldBuckets = m_pBuckets;
+			unsigned int* pOldHashes = m_pHashes;
+			int iOldBuckets = m_iBuckets;
+
+			m_pBuckets = m_cAlloc.allocate(iBuckets);
+			m_pHashes = (unsigned int*)malloc( iBuckets * sizeof(unsigned int) );
+			memset( m_pHashes, 0, iBuckets * sizeof(unsigned int) );
+			m_iBuckets = iBuckets;
+			m_iSize = 0;
+
+			for ( int i = 0; i < iOldBuckets; ++i )
+				if ( pOldHashes[i] )
+				{
+					insert_new( pOldBuckets[i], pOldHashes[i] );
+					m_cAlloc.destroy( &pOldBuckets[i] );
+				}
+
+			if ( pOldBuckets )
+			{
+				m_cAlloc.deallocate( pOldBuckets, iOldBuckets );
+				free( pOldHashes );
+			}
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		// Free buckets memory.
+		//--------------------------------------------------------------------------------------------------------
+		void deallocate()
+		{
+			if ( m_pBuckets )
+			{
+				m_cAlloc.deallocate( m_pBuckets, m_iBuckets );
+				free( m_pHashes );
+				m_pBuckets = NULL;
+				m_pHashes = NULL;
+				m_iBuckets = 0;
+			}
+		}
+
+	protected: // Members.
+		typedef typename Alloc::template rebind<T>::other alloc_t; // Allocator for elements.
+
+		alloc_t m_cAlloc;           // Allocator for elements.
+		Hash m_cHash;               // Hash functor.
+		Equal m_cEqual;             // Keys comparison functor.
+		KeyOf m_cKeyOf;             // Functor to get key of element.
+
+		T* m_pBuckets;              // Array of buckets.
+		unsigned int* m_pHashes;    // Hash of element in each bucket, 0 for empty bucket.
+		int m_iBuckets;             // Count of buckets, always power of 2.
+		int m_iSize;                // Count of elements.
+	};
+
+
+} // namespace good
+
+
+#endif // __GOOD_HASH_TABLE_H__
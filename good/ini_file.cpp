@@ -322,7 +322,7 @@ namespace good
 							{
 								*(line-1) = 0;
 								if (line == junk)
-									junk = "";
+									junk = line-1; // Empty string.
 							}
 							
 							ini_string Key(key), Value(value);
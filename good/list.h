@@ -87,6 +87,8 @@ namespace good
 		class iterator: public const_iterator
 		{
 		public:
+			friend class list<T, Alloc>;
+
 			typedef const_iterator base_class;
 
 			// Constructor by value.
@@ -108,6 +110,9 @@ namespace good
 			T& operator*() const { DebugAssert(m_pCurrent); return m_pCurrent->elem; }
 			/// Element selection through pointer.
 			T* operator->() const { DebugAssert(m_pCurrent); return &m_pCurrent->elem; }
+
+		protected:
+			using base_class::m_pCurrent;
 		};
 
 		//--------------------------------------------------------------------------------------------------------
@@ -0,0 +1,136 @@
+//----------------------------------------------------------------------------------------------------------------
+// Lock-free ring of text records, many threads can write and one thread reads.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#ifndef __GOOD_LOG_RING_H__
+#define __GOOD_LOG_RING_H__
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "good/atomic.h"
+#include "good/defines.h"
+
+
+#define LOG_RING_RECORD_SIZE  256            ///< Max size of text in one record, including trailing 0.
+
+
+namespace good
+{
+
+	//************************************************************************************************************
+	/** Bounded queue of fixed-size text records for multiple producers and a single consumer.
+	 * Each record has a sequence number, so writers reserve a record with one compare-exchange and never wait for
+	 * each other or for the reader. When ring is full, record is dropped and counted; text longer than a record
+	 * is truncated and counted. Only one thread may call pop(). */
+	//************************************************************************************************************
+	class log_ring
+	{
+	public:
+		//--------------------------------------------------------------------------------------------------------
+		/// Constructor. iCapacity is amount of records and must be power of 2.
+		//--------------------------------------------------------------------------------------------------------
+		log_ring( int iCapacity ): m_iMask(iCapacity - 1), m_iEnqueuePos(0), m_iDequeuePos(0), m_iDropped(0), m_iTruncated(0)
+		{
+			DebugAssert( (iCapacity > 0) && ((iCapacity & (iCapacity-1)) == 0) );
+			m_pRecords = (record_t*)malloc( iCapacity * sizeof(record_t) );
+			for ( int i = 0; i < iCapacity; ++i )
+				m_pRecords[i].iSequence = i;
+		}
+
+		/// Destructor.
+		~log_ring() { free(m_pRecords); }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Add text of iSize characters. Can be called from any thread. Returns false if ring is full.
+		//--------------------------------------------------------------------------------------------------------
+		bool push( const char* szText, int iSize )
+		{
+			record_t* pRecord;
+			long iPos = atomic_load(&m_iEnqueuePos);
+			for (;;)
+			{
+				pRecord = &m_pRecords[iPos & m_iMask];
+				long iDiff = atomic_load(&pRecord->iSequence) - iPos;
+				if ( iDiff == 0 ) // Record is free, try to reserve it.
+				{
+					long iPrev = atomic_compare_exchange(&m_iEnqueuePos, iPos + 1, iPos);
+					if ( iPrev == iPos )
+						break;
+					iPos = iPrev;
+				}
+				else if ( iDiff < 0 ) // Reader didn't free this record yet.
+				{
+					atomic_increment(&m_iDropped);
+					return false;
+				}
+				else // Other writer took this record.
+					iPos = atomic_load(&m_iEnqueuePos);
+			}
+
+			if ( iSize >= LOG_RING_RECORD_SIZE )
+			{
+				iSize = LOG_RING_RECORD_SIZE - 1;
+				atomic_increment(&m_iTruncated);
+			}
+			memcpy(pRecord->szText, szText, iSize);
+			pRecord->szText[iSize] = 0;
+			pRecord->iSize = iSize;
+			atomic_store(&pRecord->iSequence, iPos + 1); // Publish record to reader.
+			return true;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get next record into szBuffer (must have LOG_RING_RECORD_SIZE characters). Returns text size or -1 if empty.
+		//--------------------------------------------------------------------------------------------------------
+		int pop( char* szBuffer )
+		{
+			record_t* pRecord = &m_pRecords[m_iDequeuePos & m_iMask];
+			if ( atomic_load(&pRecord->iSequence) != m_iDequeuePos + 1 )
+				return -1; // Empty or writer didn't finish yet.
+
+			int iSize = pRecord->iSize;
+			memcpy(szBuffer, pRecord->szText, iSize + 1);
+			atomic_store(&pRecord->iSequence, m_iDequeuePos + m_iMask + 1); // Free record for next round.
+			m_iDequeuePos++;
+			return iSize;
+		}
+
+		/// Get amount of records that can be stored.
+		int capacity() const { return m_iMask + 1; }
+
+		/// Get amount of dropped records since last reset_counters().
+		int dropped() const { return atomic_load(&m_iDropped); }
+
+		/// Get amount of truncated records since last reset_counters().
+		int truncated() const { return atomic_load(&m_iTruncated); }
+
+		/// Subtract given amounts from counters (the ones already reported), so no increment is lost.
+		void reset_counters( int iDropped, int iTruncated )
+		{
+			atomic_add(&m_iDropped, -iDropped);
+			atomic_add(&m_iTruncated, -iTruncated);
+		}
+
+	protected:
+		typedef struct
+		{
+			atomic_t iSequence;                  // Equals position+1 when ready to read, position when ready to write.
+			int iSize;                           // Size of text.
+			char szText[LOG_RING_RECORD_SIZE];   // Text.
+		} record_t;
+
+		record_t* m_pRecords;                    // Array of records.
+		long m_iMask;                            // Capacity - 1.
+		atomic_t m_iEnqueuePos;                  // Next position to write.
+		long m_iDequeuePos;                      // Next position to read, only used by reader.
+		atomic_t m_iDropped;                     // Records dropped because ring was full.
+		atomic_t m_iTruncated;                   // Records truncated because text was too long.
+	};
+
+} // namespace good
+
+
+#endif // __GOOD_LOG_RING_H__
@@ -8,19 +8,28 @@
 
 #include <windows.h>
 
+#include "good/aho_corasick.h"
+#include "good/arena.h"
 #include "good/bitset.h"
 #include "good/list.h"
+#include "good/memory_pool.h"
+#include "good/log_ring.h"
 #include "good/file.h"
 #include "good/ini_file.h"
 #include "good/string.h"
 #include "good/string_buffer.h"
+#include "good/string_pool.h"
 #include "good/vector.h"
 #include "good/map.h"
+#include "good/hash_map.h"
+#include "good/hash_set.h"
 #include "good/set.h"
 #include "good/heap.h"
 #include "good/priority_queue.h"
 #include "good/graph.h"
+#include "good/small_vector.h"
 #include "good/astar.h"
+#include "good/csr_graph.h"
 #include "good/thread.h"
 #include "good/process.h"
 
@@ -190,6 +199,95 @@ void test_bitset()
 		else
 			printf("%d", b.test(i));
 	printf("\n");
+
+	// Count, iteration and bulk operations, compared with bit by bit results.
+	int errors = 0;
+	if ( b.count() != 34 )
+		errors++;
+	int found = 0;
+	for ( int i = b.find_first(); i != good::bitset::npos; i = b.find_next(i), ++found )
+		if ( i % 3 != 0 )
+			errors++;
+	if ( found != 34 )
+		errors++;
+
+	good::bitset other(100);
+	for ( int i=0; i<100; ++i )
+		if (i % 5 == 0)
+			other.set(i);
+	good::bitset result(100);
+	result = b; result |= other;
+	for ( int i=0; i<100; ++i )
+		if ( result.test(i) != ((i % 3 == 0) || (i % 5 == 0)) )
+			errors++;
+	result = b; result &= other;
+	for ( int i=0; i<100; ++i )
+		if ( result.test(i) != ((i % 3 == 0) && (i % 5 == 0)) )
+			errors++;
+	result = b; result ^= other;
+	for ( int i=0; i<100; ++i )
+		if ( result.test(i) != ((i % 3 == 0) != (i % 5 == 0)) )
+			errors++;
+	result = b; result.and_not(other);
+	for ( int i=0; i<100; ++i )
+		if ( result.test(i) != ((i % 3 == 0) && (i % 5 != 0)) )
+			errors++;
+
+	// Bits after size are not counted.
+	result.set();
+	result.resize(70);
+	if ( (result.count() != 70) || (result.find_next(69) != good::bitset::npos) )
+		errors++;
+	result.resize(100);
+	if ( (result.count() != 70) || result.test(70) )
+		errors++;
+	printf("Errors: %d (must be 0)\n\n", errors);
+
+	// Benchmark: belief update of Borzh bot (toggle doors of pushed button, skip checked ones, count and
+	// iterate remaining), bit by bit and by words. Sizes are doors, areas and waypoints of a big map.
+	const int sizes[] = { 64, 256, 4096 };
+	for ( int s = 0; s < sizeof(sizes)/sizeof(sizes[0]); ++s )
+	{
+		int size = sizes[s];
+		int updates = 20000000 / size;
+		good::bitset opened(size), toggles(size), checked(size);
+		for ( int i = 0; i < size; ++i )
+		{
+			toggles.set(i, rand() % 4 == 0);
+			checked.set(i, rand() % 2 == 0);
+		}
+
+		unsigned int sum = 0;
+		DWORD start = GetTickCount();
+		for ( int u = 0; u < updates; ++u )
+		{
+			for ( int i = 0; i < size; ++i )
+				if ( toggles.test(i) )
+					opened.set( i, !opened.test(i) );
+			for ( int i = 0; i < size; ++i )
+				if ( opened.test(i) && !checked.test(i) )
+					sum += i;
+		}
+		DWORD bits_time = GetTickCount() - start;
+
+		unsigned int sum2 = 0;
+		good::bitset unchecked(size);
+		opened.reset();
+		start = GetTickCount();
+		for ( int u = 0; u < updates; ++u )
+		{
+			opened ^= toggles;
+			unchecked = opened;
+			unchecked.and_not(checked);
+			for ( int i = unchecked.find_first(); i != good::bitset::npos; i = unchecked.find_next(i) )
+				sum2 += i;
+		}
+		DWORD words_time = GetTickCount() - start;
+
+		printf("%d bits, %d updates: bit by bit %d ms, words %d ms (sums %u %u must be equal)\n",
+		       size, updates, bits_time, words_time, sum, sum2);
+	}
+	printf("\n");
 }
 
 //--------------------------------------------------------------------------------------
@@ -676,6 +774,594 @@ void test_graph()
 }
 
 
+//--------------------------------------------------------------------------------------
+void test_hash_map()
+{
+	printf("%s()\n\n", __FUNCTION__);
+
+	typedef good::hash_map<good::string, int> hash_map_t;
+	hash_map_t map;
+
+	const int count = 1000;
+	char buf[16];
+	for (int i=0; i<count; ++i)
+	{
+		sprintf(buf, "word%d", i);
+		map.insert( good::pair<good::string, int>(good::string(buf).duplicate(), i) );
+	}
+	printf("Size: %d (must be %d), buckets: %d\n", map.size(), count, map.buckets());
+
+	int errors = 0;
+	for (int i=0; i<count; ++i)
+	{
+		sprintf(buf, "word%d", i);
+		hash_map_t::const_iterator it = map.find(buf);
+		if ( (it == map.end()) || (it->second != i) )
+			errors++;
+	}
+	printf("Find errors: %d (must be 0)\n", errors);
+
+	// Erase even words, odd ones must remain.
+	for (int i=0; i<count; i+=2)
+	{
+		sprintf(buf, "word%d", i);
+		map.erase(buf);
+	}
+	errors = 0;
+	for (int i=0; i<count; ++i)
+	{
+		sprintf(buf, "word%d", i);
+		if ( map.contains(buf) != (i % 2 == 1) )
+			errors++;
+	}
+	printf("Size: %d (must be %d), erase errors: %d (must be 0)\n", map.size(), count/2, errors);
+
+	map["hello"] = 7;
+	printf("hello: %d (must be 7), missing: %d (must be 0)\n", map["hello"], map["missing"]);
+
+	int sum = 0;
+	for (hash_map_t::const_iterator it = map.begin(); it != map.end(); ++it)
+		sum += it->second;
+	printf("Sum: %d (must be %d)\n", sum, count*count/4 + 7);
+
+	hash_map_t other = map; // Steals content.
+	printf("Sizes after copy: %d %d (must be %d 0)\n", other.size(), map.size(), count/2 + 2);
+}
+
+
+//--------------------------------------------------------------------------------------
+good::log_ring log_ring(256);
+const int log_ring_messages = 100000;
+
+void log_ring_producer( void* param )
+{
+	int thread = (int)(long)param;
+	char buf[32];
+	for ( int i = 0; i < log_ring_messages; ++i )
+	{
+		int size = sprintf(buf, "%d %d", thread, i);
+		log_ring.push(buf, size);
+		if ( i % 100 == 0 )
+			good::thread::sleep(1); // Give time to reader, some messages will be dropped anyway.
+	}
+}
+
+void test_log_ring()
+{
+	printf("%s()\n\n", __FUNCTION__);
+
+	const int producers = 4;
+	good::thread threads[producers];
+	for ( int i = 0; i < producers; ++i )
+	{
+		threads[i].set_func(&log_ring_producer);
+		threads[i].launch((void*)(long)i, false);
+	}
+
+	// Read while producers write, checking that messages of each producer come in order.
+	char buf[LOG_RING_RECORD_SIZE];
+	int last[producers], received = 0, errors = 0;
+	for ( int i = 0; i < producers; ++i )
+		last[i] = -1;
+
+	bool finished = false;
+	while ( !finished )
+	{
+		finished = true;
+		for ( int i = 0; i < producers; ++i )
+			finished &= threads[i].is_finished();
+
+		while ( log_ring.pop(buf) >= 0 )
+		{
+			int thread, counter;
+			if ( (sscanf(buf, "%d %d", &thread, &counter) != 2) || (thread < 0) || (thread >= producers) || (counter <= last[thread]) )
+				errors++;
+			else
+				last[thread] = counter;
+			received++;
+		}
+	}
+
+	printf("Received %d, dropped %d, sum %d (must be %d)\n", received, log_ring.dropped(), received + log_ring.dropped(), producers * log_ring_messages);
+	printf("Errors: %d (must be 0)\n", errors);
+}
+
+
+//--------------------------------------------------------------------------------------
+void test_aho_corasick()
+{
+	printf("%s()\n\n", __FUNCTION__);
+
+	good::aho_corasick ac;
+	ac.add("barrel");
+	ac.add("props_c17/oildrum");
+	ac.add("explosive");
+	ac.add("rel");
+	ac.build();
+
+	const char* texts[] = { "models/props_c17/oildrum001_explosive.mdl", "models/props_junk/wood_crate001a.mdl",
+	                        "models/props_c17/barrel001.mdl", "models/props_c17/explosive_rel.mdl", "" };
+	int expected[] = { 1, -1, 0, 2, -1 };
+
+	int errors = 0;
+	for ( int i = 0; i < sizeof(expected)/sizeof(expected[0]); ++i )
+	{
+		int found = ac.find_first(texts[i]);
+		printf("'%s': %d (must be %d)\n", texts[i], found, expected[i]);
+		if ( found != expected[i] )
+			errors++;
+	}
+
+	// Compare with naive search on generated texts.
+	char text[64];
+	for ( int i = 0; i < 10000; ++i )
+	{
+		int size = rand() % 60;
+		for ( int j = 0; j < size; ++j )
+			text[j] = "abelrsopxiv"[rand() % 11];
+		text[size] = 0;
+
+		int naive = -1;
+		const char* patterns[] = { "barrel", "props_c17/oildrum", "explosive", "rel" };
+		for ( int p = 0; p < 4; ++p )
+			if ( strstr(text, patterns[p]) )
+			{
+				naive = p;
+				break;
+			}
+		if ( ac.find_first(text) != naive )
+			errors++;
+	}
+	printf("Errors: %d (must be 0)\n", errors);
+}
+
+
+//--------------------------------------------------------------------------------------
+void test_csr_graph()
+{
+	printf("%s()\n\n", __FUNCTION__);
+	typedef good::graph< int, float > graph_t;
+	typedef good::csr_graph< float > csr_t;
+
+	class edge_length
+	{
+	public:
+		float operator()(float f) const { return f * 10; }
+	};
+
+	// Random graph, some nodes without arcs.
+	graph_t g;
+	for ( int i = 0; i < 100; ++i )
+		g.add_node(i);
+	for ( int i = 0; i < 500; ++i )
+	{
+		int from = rand() % 100, to = rand() % 100;
+		if ( (from % 7 != 0) && (g[from].find_arc_to(to) == g[from].neighbours.end()) )
+			g.add_arc(g.begin() + from, g.begin() + to, (float)i);
+	}
+
+	csr_t c;
+	c.build(g, edge_length());
+
+	int errors = 0, arcs = 0;
+	if ( c.size() != g.size() )
+		errors++;
+	for ( int n = 0; n < g.size(); ++n )
+	{
+		const graph_t::node_t::arcs_t& neighbours = g[n].neighbours;
+		if ( c.arcs_end(n) - c.arcs_begin(n) != neighbours.size() )
+		{
+			errors++;
+			continue;
+		}
+		for ( int i = 0; i < neighbours.size(); ++i )
+		{
+			int arc = c.arcs_begin(n) + i;
+			if ( (c.target(arc) != neighbours[i].target) || (c.edge(arc) != neighbours[i].edge) ||
+			     (c.length(arc) != neighbours[i].edge * 10) || (c.find_arc(n, neighbours[i].target) != arc) )
+				errors++;
+			arcs++;
+		}
+	}
+	if ( (c.arcs_size() != arcs) || (c.find_arc(0, 1) != -1) )
+		errors++;
+	printf("Nodes %d, arcs %d. Errors: %d (must be 0)\n", c.size(), c.arcs_size(), errors);
+}
+
+
+//--------------------------------------------------------------------------------------
+int iAllocations = 0; // Count of allocations made by counting_allocator.
+
+// Allocator that counts allocations and reallocations.
+template <typename T>
+class counting_allocator: public good::allocator<T>
+{
+public:
+	template <class _Other>
+	struct rebind
+	{
+		typedef counting_allocator<_Other> other;
+	};
+
+	T* allocate( int iSize ) const { iAllocations++; return good::allocator<T>::allocate(iSize); }
+	T* reallocate( T* pOld, int iNewSize, int iOldSize ) const { iAllocations++; return good::allocator<T>::reallocate(pOld, iNewSize, iOldSize); }
+};
+
+void test_small_vector()
+{
+	printf("%s()\n\n", __FUNCTION__);
+	typedef good::small_vector< int, 8, counting_allocator<int> > small_t;
+	typedef good::vector< int, counting_allocator<int> > vector_t;
+
+	// Same operations as for vector.
+	int errors = 0;
+	small_t s;
+	for ( int i = 0; i < 6; ++i )
+		s.push_back(i);
+	s.push_front(-1);
+	s.erase(3);
+	s.insert(s.begin() + 3, 2);
+	if ( !s.is_inline() || (s.size() != 7) || (s[0] != -1) || (s[3] != 2) || (s.back() != 5) )
+		errors++;
+	for ( int i = 6; i < 20; ++i )
+		s.push_back(i);
+	if ( s.is_inline() || (s.size() != 21) || (s[20] != 19) || (s[7] != 6) )
+		errors++;
+
+	small_t m(s); // Steals allocated buffer.
+	if ( (m.size() != 21) || (s.size() != 0) || !s.is_inline() || m.is_inline() )
+		errors++;
+	m.resize(3);
+	s.assign(m, true);
+	small_t t(s); // Moves inline elements.
+	if ( (t.size() != 3) || (s.size() != 0) || (t[1] != 0) || (m.size() != 3) )
+		errors++;
+	int iSum = 0;
+	for ( small_t::reverse_iterator it = t.rbegin(); it != t.rend(); ++it )
+		iSum += *it;
+	if ( iSum != 0 )
+		errors++;
+	printf("Errors: %d (must be 0)\n", errors);
+
+	// Allocations of lists of 5 elements.
+	const int iLists = 10000;
+	iAllocations = 0;
+	DWORD iStart = GetTickCount();
+	for ( int i = 0; i < iLists; ++i )
+	{
+		vector_t v;
+		for ( int j = 0; j < 5; ++j )
+			v.push_back(j);
+	}
+	printf("vector: %d lists, %d allocations, %d ms\n", iLists, iAllocations, GetTickCount() - iStart);
+
+	iAllocations = 0;
+	iStart = GetTickCount();
+	for ( int i = 0; i < iLists; ++i )
+	{
+		small_t v;
+		for ( int j = 0; j < 5; ++j )
+			v.push_back(j);
+	}
+	printf("small_vector: %d lists, %d allocations (must be 0), %d ms\n", iLists, iAllocations, GetTickCount() - iStart);
+
+	// Graph with 4 arcs per node.
+	typedef good::graph< int, float, good::vector, good::vector, counting_allocator<int> > graph_t;
+	typedef good::graph< int, float, good::vector, good::arcs_vector, counting_allocator<int> > small_graph_t;
+	graph_t g;
+	iAllocations = 0;
+	for ( int i = 0; i < 1000; ++i )
+		g.add_node(i);
+	for ( int i = 0; i < 1000; ++i )
+		for ( int j = 1; j <= 4; ++j )
+			g.add_arc(g.begin() + i, g.begin() + (i + j) % 1000, (float)j);
+	printf("graph with vector arcs: %d allocations\n", iAllocations);
+
+	small_graph_t sg;
+	iAllocations = 0;
+	for ( int i = 0; i < 1000; ++i )
+		sg.add_node(i);
+	for ( int i = 0; i < 1000; ++i )
+		for ( int j = 1; j <= 4; ++j )
+			sg.add_arc(sg.begin() + i, sg.begin() + (i + j) % 1000, (float)j);
+	printf("graph with inline arcs: %d allocations (only nodes array)\n", iAllocations);
+}
+
+
+//--------------------------------------------------------------------------------------
+// Byte per byte FNV-1a, to compare with good::hash_string().
+unsigned int hash_fnv( const char* szStr, int iSize )
+{
+	unsigned int iHash = 2166136261U;
+	for ( int i = 0; i < iSize; ++i )
+	{
+		iHash ^= (unsigned char)szStr[i];
+		iHash *= 16777619U;
+	}
+	return iHash;
+}
+
+void test_hash_set()
+{
+	printf("%s()\n\n", __FUNCTION__);
+
+	typedef good::hash_set<good::string> hash_set_t;
+	hash_set_t set;
+
+	const int count = 1000;
+	char buf[32];
+	for (int i=0; i<count; ++i)
+	{
+		sprintf(buf, "item_%d", i);
+		set.insert( good::string(buf).duplicate() );
+	}
+	set.insert( good::string("item_0") ); // Already in set.
+
+	int errors = 0;
+	for (int i=0; i<count*2; ++i)
+	{
+		sprintf(buf, "item_%d", i);
+		const char* szKey = buf;
+		if ( set.contains(szKey) != (i < count) ) // Lookup by const char*.
+			errors++;
+	}
+	set.erase( good::string("item_1") );
+	if ( set.contains("item_1") || !set.contains("item_2") || (set.find("item_3") == set.end()) )
+		errors++;
+	printf("Size: %d (must be %d), errors: %d (must be 0)\n\n", set.size(), count-1, errors);
+
+	// Integer keys that are multiples of buckets count must not go to the same bucket.
+	const int buckets = 512, stride = 1024;
+	good::hash<int> int_hash;
+	good::bitset used(buckets);
+	int used_count = 0;
+	for (int i=0; i<buckets/2; ++i)
+	{
+		int bucket = int_hash(i*stride) & (buckets-1);
+		if ( !used.test(bucket) )
+			used_count++;
+		used.set(bucket);
+	}
+	printf("Buckets used by %d keys with stride %d: %d (must be more than %d)\n\n", buckets/2, stride, used_count, buckets/4);
+
+	// Benchmark: lookups of existing names in hash map, map (tree) and vector (linear search).
+	typedef good::hash_map<good::string, int> hash_map_t;
+	typedef good::map<good::string, int> map_t;
+	typedef good::vector<good::string> vector_t;
+
+	const int sizes[] = { 8, 32, 128, 512 };
+	const int lookups = 1000000;
+	for ( int s = 0; s < sizeof(sizes)/sizeof(sizes[0]); ++s )
+	{
+		int size = sizes[s];
+		hash_map_t hash_map;
+		map_t map;
+		vector_t vector;
+		good::vector<good::string> names;
+		for (int i = 0; i < size; ++i)
+		{
+			sprintf(buf, "weapon_name_%d", i);
+			names.push_back( good::string(buf).duplicate() );
+			good::string name( names[i].c_str() ); // Copy steals, so use views of names.
+			hash_map.insert( hash_map_t::key_value_t(name, i) );
+			map.insert( map_t::key_value_t(good::string(name.c_str()), i) );
+			vector.push_back( good::string(name.c_str()) );
+		}
+
+		int sum = 0;
+		DWORD start = GetTickCount();
+		for ( int i = 0; i < lookups; ++i )
+			sum += hash_map.find( names[i % size].c_str() )->second;
+		DWORD hash_time = GetTickCount() - start;
+
+		start = GetTickCount();
+		for ( int i = 0; i < lookups; ++i )
+			sum += map.find( names[i % size] )->second;
+		DWORD map_time = GetTickCount() - start;
+
+		start = GetTickCount();
+		for ( int i = 0; i < lookups; ++i )
+			sum += good::find( vector.begin(), vector.end(), names[i % size] ) - vector.begin();
+		DWORD vector_time = GetTickCount() - start;
+
+		printf("%d names, %d lookups: hash_map %d ms, map %d ms, vector %d ms (%d)\n",
+		       size, lookups, hash_time, map_time, vector_time, sum);
+	}
+
+	// String hash speed.
+	const char* words[] = { "ak47", "weapon_crowbar", "item_healthkit", "prop_physics_multiplayer" };
+	for ( int w = 0; w < sizeof(words)/sizeof(words[0]); ++w )
+	{
+		int size = strlen(words[w]);
+		unsigned int sum = 0;
+		DWORD start = GetTickCount();
+		for ( int i = 0; i < lookups*10; ++i )
+			sum += good::hash_string( words[w], size - (i & 1) );
+		DWORD hash_time = GetTickCount() - start;
+
+		start = GetTickCount();
+		for ( int i = 0; i < lookups*10; ++i )
+			sum += hash_fnv( words[w], size - (i & 1) );
+		DWORD fnv_time = GetTickCount() - start;
+
+		printf("hash of %s, %d times: hash_string %d ms, FNV-1a %d ms (%u)\n", words[w], lookups*10, hash_time, fnv_time, sum);
+	}
+}
+
+
+//--------------------------------------------------------------------------------------
+void test_string_pool()
+{
+	printf("%s()\n\n", __FUNCTION__);
+
+	int errors = 0;
+
+	// Short strings are stored inside string object.
+	good::string shortStr = good::string("weapon_ar2").duplicate();
+	good::string longStr = good::string("prop_physics_multiplayer").duplicate();
+	if ( !shortStr.is_short() || longStr.is_short() || (shortStr != "weapon_ar2") )
+		errors++;
+
+	// Copy moves content, source becomes empty.
+	good::string moved(shortStr);
+	if ( (moved != "weapon_ar2") || (shortStr.size() != 0) )
+		errors++;
+
+	good::string sub = longStr.substr(5, 7);
+	if ( !sub.is_short() || (sub != "physics") )
+		errors++;
+
+	good::string trimmed = good::string("  item_healthkit  ").duplicate();
+	trimmed.trim();
+	if ( trimmed != "item_healthkit" )
+		errors++;
+
+	// Short strings survive relocation of vector.
+	good::vector<good::string> strings;
+	char buf[32];
+	for (int i=0; i<100; ++i)
+	{
+		sprintf(buf, "item_%d", i);
+		strings.push_back( good::string(buf).duplicate() );
+	}
+	for (int i=0; i<100; ++i)
+	{
+		sprintf(buf, "item_%d", i);
+		if ( strings[i] != buf )
+			errors++;
+	}
+	printf("SSO errors: %d (must be 0)\n", errors);
+
+	// Pool: equal strings get equal ids.
+	errors = 0;
+	good::string_pool pool(64);
+	const int count = 1000;
+	for (int i=0; i<count; ++i)
+	{
+		sprintf(buf, "weapon_name_%d", i);
+		if ( pool.intern(buf) != i )
+			errors++;
+	}
+	if ( pool.intern( good::string("weapon_name_5") ) != 5 )
+		errors++;
+	for (int i=0; i<count*2; ++i)
+	{
+		sprintf(buf, "weapon_name_%d", i);
+		int id = pool.find(buf);
+		if ( (i < count) ? ((id != i) || (pool[id] != buf)) : (id != good::string_pool::invalid_id) )
+			errors++;
+	}
+	printf("Pool size: %d (must be %d), errors: %d (must be 0)\n\n", pool.size(), count, errors);
+}
+
+
+//--------------------------------------------------------------------------------------
+void test_allocators()
+{
+	printf("%s()\n\n", __FUNCTION__);
+
+	typedef good::list< int, good::pool_allocator<int> > pool_list;
+	typedef good::list<int> heap_list;
+
+	int errors = 0;
+	const int count = 1000, times = 2000;
+
+	// Nodes of list are taken from pool and returned to it.
+	{
+		pool_list l;
+		for (int i=0; i<count; ++i)
+			l.push_back(i);
+		int i = 0;
+		for ( pool_list::iterator it = l.begin(); it != l.end(); ++it, ++i )
+			if ( *it != i )
+				errors++;
+		if ( i != count )
+			errors++;
+	}
+
+	// Freed blocks are reused.
+	good::memory_pool pool(sizeof(int), 16);
+	void* blocks[40];
+	for (int i=0; i<40; ++i)
+		blocks[i] = pool.allocate();
+	for (int i=0; i<40; ++i)
+		pool.deallocate(blocks[i]);
+	if ( pool.allocate() != blocks[39] )
+		errors++;
+	printf("Pool used blocks: %d (must be 1), capacity: %d (must be 48), errors: %d (must be 0)\n", pool.size(), pool.capacity(), errors);
+
+	// After warm up pool doesn't use heap.
+	long allocations = good::atomic_load( &good::allocations_count() );
+	DWORD start = GetTickCount();
+	for (int t=0; t<times; ++t)
+	{
+		pool_list l;
+		for (int i=0; i<count; ++i)
+			l.push_back(i);
+	}
+	DWORD poolTime = GetTickCount() - start;
+	long poolAllocations = good::atomic_load( &good::allocations_count() ) - allocations;
+
+	allocations = good::atomic_load( &good::allocations_count() );
+	start = GetTickCount();
+	for (int t=0; t<times; ++t)
+	{
+		heap_list l;
+		for (int i=0; i<count; ++i)
+			l.push_back(i);
+	}
+	DWORD heapTime = GetTickCount() - start;
+	long heapAllocations = good::atomic_load( &good::allocations_count() ) - allocations;
+	printf("List with pool: %d allocations (must be 0), %d ms; with heap: %ld allocations, %d ms.\n",
+	       (int)poolAllocations, (int)poolTime, heapAllocations, (int)heapTime);
+
+	// Arena: temporaries of a frame.
+	errors = 0;
+	good::arena& arena = good::frame_arena();
+	for (int frame=0; frame<3; ++frame)
+	{
+		allocations = good::atomic_load( &good::allocations_count() );
+		{
+			good::vector< int, good::frame_allocator<int> > v;
+			for (int i=0; i<count*30; ++i) // Bigger than first chunk of arena.
+				v.push_back(i);
+			for (int i=0; i<v.size(); ++i)
+				if ( v[i] != i )
+					errors++;
+		}
+		{
+			good::arena_scope scope;
+			good::vector< int, good::frame_allocator<int> > v(count);
+			v.resize(count, frame);
+		}
+		printf("Frame %d: arena chunks %d, used %d, allocations %d.\n", frame, arena.chunks(), arena.size(),
+		       (int)(good::atomic_load( &good::allocations_count() ) - allocations));
+		arena.reset();
+	}
+	printf("Arena errors: %d (must be 0), last frame must have 1 chunk and 0 allocations.\n\n", errors);
+}
+
+
 //--------------------------------------------------------------------------------------
 int main(int argc, char** argv)
 {
@@ -735,5 +1421,37 @@ int main(int argc, char** argv)
 	//system("pause");
 	//system("cls");
 
+	//test_hash_map();
+	//system("pause");
+	//system("cls");
+
+	//test_log_ring();
+	//system("pause");
+	//system("cls");
+
+	//test_aho_corasick();
+	//system("pause");
+	//system("cls");
+
+	//test_csr_graph();
+	//system("pause");
+	//system("cls");
+
+	//test_small_vector();
+	//system("pause");
+	//system("cls");
+
+	//test_hash_set();
+	//system("pause");
+	//system("cls");
+
+	//test_string_pool();
+	//system("pause");
+	//system("cls");
+
+	//test_allocators();
+	//system("pause");
+	//system("cls");
+
 	return 0;
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+//----------------------------------------------------------------------------------------------------------------
+// Pool of memory blocks of fixed size, and allocator that takes small allocations (like nodes) from it.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#ifndef __GOOD_MEMORY_POOL_H__
+#define __GOOD_MEMORY_POOL_H__
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "good/utility.h"
+
+
+#define DEFAULT_MEMORY_POOL_BLOCKS  64         ///< Amount of blocks in one chunk of memory pool.
+
+
+namespace good
+{
+
+
+	//************************************************************************************************************
+	/// Pool of memory blocks of one size.
+	/** Blocks are taken from big chunks of memory. Freed blocks are kept in a list and given again by next
+	 * allocate(), so after warm up allocation and deallocation don't call heap functions. Chunks are freed only in
+	 * destructor. Not thread safe. */
+	//************************************************************************************************************
+	class memory_pool
+	{
+	public:
+		//--------------------------------------------------------------------------------------------------------
+		/// Constructor with size of block and amount of blocks in one chunk of memory.
+		//--------------------------------------------------------------------------------------------------------
+		memory_pool( int iBlockSize, int iBlocksPerChunk = DEFAULT_MEMORY_POOL_BLOCKS ):
+			m_iBlockSize( (MAX2(iBlockSize, (int)sizeof(void*)) + 7) & ~7 ), m_iBlocksPerChunk(iBlocksPerChunk),
+			m_pFree(NULL), m_pChunks(NULL), m_iUsed(0), m_iBlocks(0) {}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Destructor. Memory is freed only if all blocks were returned: static containers that are destroyed
+		/// at exit after pool could still return their blocks.
+		//--------------------------------------------------------------------------------------------------------
+		~memory_pool()
+		{
+			if ( m_iUsed == 0 )
+				free_chunks();
+		}
+
+		/// Get size of one block (aligned to 8 bytes).
+		int block_size() const { return m_iBlockSize; }
+
+		/// Get count of used blocks.
+		int size() const { return m_iUsed; }
+
+		/// Get count of allocated blocks (used and free).
+		int capacity() const { return m_iBlocks; }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get free block.
+		//--------------------------------------------------------------------------------------------------------
+		void* allocate()
+		{
+			if ( m_pFree == NULL )
+				add_chunk();
+			void* pBlock = m_pFree;
+			m_pFree = *(void**)pBlock;
+			m_iUsed++;
+			return pBlock;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Return block to pool.
+		//--------------------------------------------------------------------------------------------------------
+		void deallocate( void* pBlock )
+		{
+			DebugAssert( m_iUsed > 0 );
+			*(void**)pBlock = m_pFree;
+			m_pFree = pBlock;
+			m_iUsed--;
+		}
+
+	protected:
+		static const int CHUNK_HEADER = 16;  // Chunk starts with pointer to previous chunk, blocks are aligned to 16.
+
+		// Allocate new chunk and put its blocks to free list, first block at head.
+		void add_chunk()
+		{
+			atomic_increment( &allocations_count() );
+			char* pChunk = (char*)malloc( CHUNK_HEADER + m_iBlockSize * m_iBlocksPerChunk );
+			*(char**)pChunk = m_pChunks;
+			m_pChunks = pChunk;
+
+			char* pBlocks = pChunk + CHUNK_HEADER;
+			for ( int i = m_iBlocksPerChunk - 1; i >= 0; --i )
+			{
+				void* pBlock = pBlocks + i * m_iBlockSize;
+				*(void**)pBlock = m_pFree;
+				m_pFree = pBlock;
+			}
+			m_iBlocks += m_iBlocksPerChunk;
+		}
+
+		// Free all chunks.
+		void free_chunks()
+		{
+			while ( m_pChunks )
+			{
+				char* pPrev = *(char**)m_pChunks;
+				free(m_pChunks);
+				m_pChunks = pPrev;
+			}
+			m_pFree = NULL;
+			m_iBlocks = 0;
+		}
+
+		int m_iBlockSize;                  // Size of block.
+		int m_iBlocksPerChunk;             // Amount of blocks in one chunk.
+		void* m_pFree;                     // List of free blocks, each one starts with pointer to next.
+		char* m_pChunks;                   // List of chunks, each one starts with pointer to previous.
+		int m_iUsed;                       // Used blocks.
+		int m_iBlocks;                     // Allocated blocks.
+	};
+
+
+	//************************************************************************************************************
+	/// Allocator that takes allocations of up to N objects of type T from a pool, bigger ones from heap.
+	/** Use it for nodes of good::list / good::aatree (N = 1), or for vectors that usually have few elements
+	 * (N = reserved size). There is one pool for each T and N, shared by all containers, so it is not thread safe. */
+	//************************************************************************************************************
+	template <typename T, int N = 1>
+	class pool_allocator: public allocator<T>
+	{
+	public:
+		typedef typename allocator<T>::pointer_t pointer_t;
+
+		template <class _Other>
+		struct rebind
+		{
+			typedef pool_allocator<_Other, N> other;
+		};
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Allocate memory for iSize objects of type T.
+		//--------------------------------------------------------------------------------------------------------
+		pointer_t allocate( int iSize ) const
+		{
+			return ( iSize <= N ) ? (pointer_t)pool().allocate() : allocator<T>::allocate(iSize);
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Reallocate memory for iNewSize objects of type T. Memory moves between pool and heap if needed.
+		//--------------------------------------------------------------------------------------------------------
+		pointer_t reallocate( pointer_t pOld, int iNewSize, int iOldSize ) const
+		{
+			if ( pOld == NULL )
+				return allocate(iNewSize);
+			if ( (iOldSize > N) && (iNewSize > N) )
+				return allocator<T>::reallocate(pOld, iNewSize, iOldSize);
+			if ( (iOldSize <= N) && (iNewSize <= N) )
+				return pOld; // Same block.
+
+			pointer_t pNew = allocate(iNewSize);
+			memcpy( pNew, pOld, MIN2(iOldSize, iNewSize) * sizeof(T) );
+			deallocate(pOld, iOldSize);
+			return pNew;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Deallocate memory of iSize objects of type T.
+		//--------------------------------------------------------------------------------------------------------
+		void deallocate( pointer_t pPtr, int iSize ) const
+		{
+			if ( pPtr == NULL )
+				return;
+			if ( iSize <= N )
+				pool().deallocate(pPtr);
+			else
+				allocator<T>::deallocate(pPtr, iSize);
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get pool of this allocator.
+		//--------------------------------------------------------------------------------------------------------
+		static memory_pool& pool()
+		{
+			static memory_pool cPool( N * sizeof(T) );
+			return cPool;
+		}
+	};
+
+
+} // namespace good
+
+
+#endif // __GOOD_MEMORY_POOL_H__
@@ -3,6 +3,8 @@
 
 #ifdef _WIN32
 	#include "windows.h"
+#else
+	#include <pthread.h>
 #endif
 
 namespace good
@@ -37,7 +39,38 @@ namespace good
 	}
 
 #else
-#	error Mutex not implemented
+	mutex::mutex()
+	{
+		pthread_mutex_t* pMutex = new pthread_mutex_t;
+		pthread_mutexattr_t cAttr; // Recursive, as windows mutex.
+		pthread_mutexattr_init(&cAttr);
+		pthread_mutexattr_settype(&cAttr, PTHREAD_MUTEX_RECURSIVE);
+		pthread_mutex_init(pMutex, &cAttr);
+		pthread_mutexattr_destroy(&cAttr);
+		m_hMutex = pMutex;
+	}
+
+	mutex::~mutex()
+	{
+		pthread_mutex_destroy( (pthread_mutex_t*)m_hMutex );
+		delete (pthread_mutex_t*)m_hMutex;
+	}
+
+	void mutex::lock()
+	{
+		pthread_mutex_lock( (pthread_mutex_t*)m_hMutex );
+	}
+
+	bool mutex::try_lock()
+	{
+		return pthread_mutex_trylock( (pthread_mutex_t*)m_hMutex ) == 0;
+	}
+
+	void mutex::unlock()
+	{
+		pthread_mutex_unlock( (pthread_mutex_t*)m_hMutex );
+	}
+
 #endif // _WIN32
 
 } // namespace good
\ No newline at end of file
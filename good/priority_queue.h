@@ -97,7 +97,7 @@ namespace good
 		//--------------------------------------------------------------------------------------------------------
 		void modify( const T& elem )
 		{
-			container_t::iterator it = find(m_cContainer.begin(), m_cContainer.end(), elem);
+			typename container_t::iterator it = find(m_cContainer.begin(), m_cContainer.end(), elem);
 			DebugAssert(it != m_cContainer.end());
 
 			good::heap_modify(&*m_cContainer.begin(), &*it - &*m_cContainer.begin(), size(), m_cLess);
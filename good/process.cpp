@@ -452,4 +452,424 @@ namespace good
 } // namespace good
 
 
+#else // WIN32
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "good/file.h"
+#include "good/process.h"
+
+
+namespace good
+{
+
+	//----------------------------------------------------------------------------------------------------------------
+	// Process implementation with fork() / exec(). Command line is executed by shell.
+	//----------------------------------------------------------------------------------------------------------------
+	class process_impl
+	{
+	public:
+		inline process_impl(): m_iPid(0), m_bFinished(false), m_iWriteChildInput(-1), m_iReadChildOutput(-1),
+			m_iReadChildError(-1), m_bDaemon(true), m_bChangeWorkingDir(false), m_bRedirect(false) { m_szLastError[0] = 0; }
+
+		inline virtual ~process_impl()
+		{
+			dispose();
+		}
+
+		//------------------------------------------------------------------------------------------------------------
+		// Set process parameters.
+		//------------------------------------------------------------------------------------------------------------
+		inline void set_params( const good::string& sExe, const good::string& sCmd, bool bRedirect, bool bChangeWorkingDir )
+		{
+			DebugAssert( sExe.size() > 0 || sCmd.size() > 0 );
+			m_sExe.assign(sExe, true);
+			m_sCmd.assign(sCmd, true);
+
+			m_bChangeWorkingDir = bChangeWorkingDir;
+			m_bRedirect = bRedirect;
+			if ( bChangeWorkingDir )
+				m_sCurrentDir = file::file_dir(sExe);
+		}
+
+		//------------------------------------------------------------------------------------------------------------
+		// Execute process.
+		//------------------------------------------------------------------------------------------------------------
+		inline bool launch( bool /*bShowProcessWindow*/, bool bDaemon )
+		{
+			DebugAssert( m_sExe.size() > 0 );
+
+			m_szLastError[0] = 0; // No error.
+			m_bDaemon = bDaemon;
+			m_bFinished = false;
+
+			int aInput[2] = { -1, -1 }, aOutput[2] = { -1, -1 }, aError[2] = { -1, -1 };
+			if ( m_bRedirect && ( (pipe(aInput) != 0) || (pipe(aOutput) != 0) || (pipe(aError) != 0) ) )
+			{
+				SetError("pipe", __LINE__ - 2);
+				close_pipes(aInput, aOutput, aError);
+				return false;
+			}
+
+			m_iPid = fork();
+			if ( m_iPid < 0 )
+			{
+				SetError("fork", __LINE__ - 2);
+				m_iPid = 0;
+				close_pipes(aInput, aOutput, aError);
+				return false;
+			}
+
+			if ( m_iPid == 0 )
+			{
+				// Child.
+				if ( m_bRedirect )
+				{
+					dup2(aInput[0], STDIN_FILENO);
+					dup2(aOutput[1], STDOUT_FILENO);
+					dup2(aError[1], STDERR_FILENO);
+					close_pipes(aInput, aOutput, aError);
+				}
+				if ( (m_sCurrentDir.size() > 0) && (chdir(m_sCurrentDir.c_str()) != 0) )
+					_exit(127);
+				if ( m_sCmd.size() > 0 )
+					execl("/bin/sh", "sh", "-c", m_sCmd.c_str(), (char*)NULL);
+				else
+					execl(m_sExe.c_str(), m_sExe.c_str(), (char*)NULL);
+				_exit(127);
+			}
+
+			// Parent: keep our ends of pipes only.
+			if ( m_bRedirect )
+			{
+				close(aInput[0]);
+				close(aOutput[1]);
+				close(aError[1]);
+				m_iWriteChildInput = aInput[1];
+				m_iReadChildOutput = aOutput[0];
+				m_iReadChildError = aError[0];
+			}
+			return true;
+		}
+
+		//------------------------------------------------------------------------------------------------------------
+		// Free all handles and memory. Terminate process if not daemon.
+		//------------------------------------------------------------------------------------------------------------
+		inline void dispose()
+		{
+			if ( m_iPid )
+			{
+				if ( !m_bDaemon && !is_finished() )
+				{
+					kill(m_iPid, SIGKILL);
+					waitpid(m_iPid, NULL, 0);
+				}
+				close_handle(m_iWriteChildInput);
+				close_handle(m_iReadChildOutput);
+				close_handle(m_iReadChildError);
+				m_iPid = 0;
+			}
+		}
+
+		//------------------------------------------------------------------------------------------------------------
+		// Join a process for a given time.
+		//------------------------------------------------------------------------------------------------------------
+		inline bool join( int iMSecs = TIME_INFINITE )
+		{
+			DebugAssert( m_iPid );
+			if ( iMSecs == TIME_INFINITE )
+			{
+				if ( !m_bFinished && (waitpid(m_iPid, NULL, 0) == m_iPid) )
+					m_bFinished = true;
+				return m_bFinished;
+			}
+			for ( ; (iMSecs > 0) && !is_finished(); iMSecs -= 1 )
+				usleep(1000);
+			return is_finished();
+		}
+
+		//------------------------------------------------------------------------------------------------------------
+		// Terminate process.
+		//------------------------------------------------------------------------------------------------------------
+		inline void terminate()
+		{
+			DebugAssert( m_iPid );
+			kill(m_iPid, SIGKILL);
+		}
+
+		//------------------------------------------------------------------------------------------------------------
+		// Check if process was launched previously.
+		//------------------------------------------------------------------------------------------------------------
+		inline bool is_launched() { return m_iPid != 0; }
+
+		//------------------------------------------------------------------------------------------------------------
+		// Check if process is finished.
+		//------------------------------------------------------------------------------------------------------------
+		inline bool is_finished()
+		{
+			DebugAssert( m_iPid );
+			if ( !m_bFinished && (waitpid(m_iPid, NULL, WNOHANG) == m_iPid) )
+				m_bFinished = true;
+			return m_bFinished;
+		}
+
+		//----------------------------------------------------------------------------------------------------------------
+		// Close process stdin, end of input.
+		//------------------------------------------------------------------------------------------------------------
+		void close_stdin()
+		{
+			DebugAssert( m_iWriteChildInput >= 0 );
+			close_handle(m_iWriteChildInput);
+		}
+
+		//----------------------------------------------------------------------------------------------------------------
+		// Write input for the process. Return false on error or when child exits.
+		//----------------------------------------------------------------------------------------------------------------
+		inline bool write_stdin( void* pBuffer, int iSize )
+		{
+			m_szLastError[0] = 0; // No error.
+
+			DebugAssert( m_iWriteChildInput >= 0 );
+			int iTotal = 0;
+			while ( iTotal < iSize )
+			{
+				ssize_t iWritten = write(m_iWriteChildInput, (char*)pBuffer + iTotal, iSize - iTotal);
+				if ( iWritten < 0 )
+				{
+					if ( errno == EINTR )
+						continue;
+					if ( errno != EPIPE ) // Pipe was closed (normal exit path).
+						SetError("write", __LINE__ - 7);
+					close_handle(m_iWriteChildInput);
+					return false;
+				}
+				iTotal += (int)iWritten;
+			}
+			return true;
+		}
+
+		// Return true if child has data on stdout.
+		inline bool has_data_stdout()
+		{
+			return has_data(m_iReadChildOutput);
+		}
+
+		// Read output of the process, returning true, if there is more output.
+		inline bool read_stdout( void* pBuffer, int iMaxSize, int& iReadSize )
+		{
+			return read( m_iReadChildOutput, pBuffer, iMaxSize, iReadSize );
+		}
+
+		// Return true if child has data on stderr.
+		inline bool has_data_stderr()
+		{
+			return has_data(m_iReadChildError);
+		}
+
+		// Read error of the process, returning true, if there is more output.
+		inline bool read_stderr( void* pBuffer, int iMaxSize, int& iReadSize )
+		{
+			return read( m_iReadChildError, pBuffer, iMaxSize, iReadSize );
+		}
+
+		// Get last error.
+		inline const char* get_last_error()
+		{
+			return (m_szLastError[0] == 0) ? NULL : m_szLastError;
+		}
+
+	protected:
+		// Close handle if it is opened.
+		static void close_handle( int& iHandle )
+		{
+			if ( iHandle >= 0 )
+			{
+				close(iHandle);
+				iHandle = -1;
+			}
+		}
+
+		// Close both ends of pipes, on launch error or in child after redirection.
+		static void close_pipes( int* aInput, int* aOutput, int* aError )
+		{
+			for ( int i = 0; i < 2; ++i )
+			{
+				close_handle(aInput[i]);
+				close_handle(aOutput[i]);
+				close_handle(aError[i]);
+			}
+		}
+
+		// Return true if there is data on handle. Closed pipe counts as data, so next read fails.
+		bool has_data( int iHandle )
+		{
+			DebugAssert( iHandle >= 0 );
+			pollfd cPoll = { iHandle, POLLIN, 0 };
+			return poll(&cPoll, 1, 0) != 0;
+		}
+
+		// Read handle.
+		bool read( int& iHandle, void* pBuffer, int iMaxSize, int& iReadSize )
+		{
+			DebugAssert( iHandle >= 0 );
+
+			m_szLastError[0] = 0; // No error.
+
+			ssize_t iRead;
+			do {
+				iRead = ::read(iHandle, pBuffer, iMaxSize);
+			} while ( (iRead < 0) && (errno == EINTR) );
+			iReadSize = (iRead < 0) ? 0 : (int)iRead;
+
+			if ( iRead <= 0 )
+			{
+				if ( iRead < 0 )
+					SetError("read", __LINE__ - 8); // Something bad happened.
+				close_handle(iHandle);
+				return false; // Error or pipe gone = child exited, no more data.
+			}
+			return true;
+		}
+
+		// Set error message from errno.
+		void SetError( const char* szFunction, int iLine )
+		{
+#if defined(DEBUG) || defined(_DEBUG)
+			snprintf(m_szLastError, sizeof(m_szLastError), "Error %d from %s(), line %d: %s", errno, szFunction, iLine, strerror(errno));
+#else
+			snprintf(m_szLastError, sizeof(m_szLastError), "Error %d from %s(): %s", errno, szFunction, strerror(errno));
+#endif
+		}
+
+		good::string m_sExe, m_sCmd, m_sCurrentDir;
+		pid_t m_iPid;
+		bool m_bFinished;
+		int m_iWriteChildInput, m_iReadChildOutput, m_iReadChildError;
+		char m_szLastError[512];
+		bool m_bDaemon;
+		bool m_bChangeWorkingDir;
+		bool m_bRedirect;
+	};
+
+
+	//----------------------------------------------------------------------------------------------------------------
+	void process::exit( int iExitCode )
+	{
+		::exit(iExitCode);
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	// process functions.
+	//----------------------------------------------------------------------------------------------------------------
+	process::process()
+	{
+		m_pImpl = new process_impl();
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	process::process( const good::string& sExe, const good::string& sCmd, bool bRedirect, bool bChangeWorkingDir )
+	{
+		m_pImpl = new process_impl();
+		set_params(sExe, sCmd, bRedirect, bChangeWorkingDir);
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	process::~process()
+	{
+		delete (process_impl*)m_pImpl;
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	void process::set_params( const good::string& sExe, const good::string& sCmd, bool bRedirect, bool bChangeWorkingDir)
+	{
+		((process_impl*)m_pImpl)->set_params(sExe, sCmd, bRedirect, bChangeWorkingDir);
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	bool process::launch( bool bShowProcessWindow, bool bDaemon )
+	{
+		return ((process_impl*)m_pImpl)->launch(bShowProcessWindow, bDaemon);
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	void process::terminate()
+	{
+		((process_impl*)m_pImpl)->terminate();
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	void process::dispose()
+	{
+		((process_impl*)m_pImpl)->dispose();
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	bool process::join( int iMSecs )
+	{
+		return ((process_impl*)m_pImpl)->join(iMSecs);
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	bool process::is_launched()
+	{
+		return ((process_impl*)m_pImpl)->is_launched();
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	bool process::is_finished()
+	{
+		return ((process_impl*)m_pImpl)->is_finished();
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	bool process::write_stdin( void* pBuffer, int iSize )
+	{
+		return ((process_impl*)m_pImpl)->write_stdin(pBuffer, iSize);
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	void process::close_stdin()
+	{
+		return ((process_impl*)m_pImpl)->close_stdin();
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	bool process::has_data_stdout()
+	{
+		return ((process_impl*)m_pImpl)->has_data_stdout();
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	bool process::read_stdout( void* pBuffer, int iMaxSize, int& iReadSize )
+	{
+		return ((process_impl*)m_pImpl)->read_stdout(pBuffer, iMaxSize, iReadSize);
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	bool process::has_data_stderr()
+	{
+		return ((process_impl*)m_pImpl)->has_data_stderr();
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	bool process::read_stderr( void* pBuffer, int iMaxSize, int& iReadSize )
+	{
+		return ((process_impl*)m_pImpl)->read_stderr(pBuffer, iMaxSize, iReadSize);
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	const char* process::get_last_error()
+	{
+		return ((process_impl*)m_pImpl)->get_last_error();
+	}
+} // namespace good
+
 #endif // WIN32
@@ -0,0 +1,294 @@
+//----------------------------------------------------------------------------------------------------------------
+// Vector with inline storage for few elements, allocates memory only when it grows beyond them.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#ifndef __GOOD_SMALL_VECTOR_H__
+#define __GOOD_SMALL_VECTOR_H__
+
+
+#include <string.h>
+
+#include "good/vector.h"
+
+
+namespace good
+{
+
+
+	//************************************************************************************************************
+	/** Class that holds an array of objects of type T, first N of them inside object itself.
+	 * Same interface and iterators as good::vector. Assignment/copy constructor "steal" allocated buffer, as in
+	 * vector; elements stored inline are moved with their copy constructors.
+	 * Object has no pointer to itself, so it can be moved with memcpy() like other objects inside good::vector
+	 * (for example vector of graph nodes with small_vector of arcs). */
+	//************************************************************************************************************
+	template <
+		typename T,
+		int N,
+		typename Alloc = good::allocator<T>
+	>
+	class small_vector
+	{
+	public:
+		typedef typename vector<T, Alloc>::const_iterator const_iterator;     ///< Const iterator of a small_vector.
+		typedef typename vector<T, Alloc>::iterator iterator;                 ///< Iterator of a small_vector.
+		typedef good::reverse_iterator<const_iterator> const_reverse_iterator; ///< Reverse const iterator.
+		typedef good::reverse_iterator<iterator> reverse_iterator;             ///< Reverse iterator.
+
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Default constructor.
+		//--------------------------------------------------------------------------------------------------------
+		small_vector(): m_pHeap(NULL), m_iCapacity(N), m_iSize(0) {}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Constructor with capacity parameter. Memory is allocated only if iCapacity is greater than N.
+		//--------------------------------------------------------------------------------------------------------
+		small_vector( int iCapacity ): m_pHeap(NULL), m_iCapacity(N), m_iSize(0)
+		{
+			reserve(iCapacity);
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Copy constructor. Moves content of aOther.
+		//--------------------------------------------------------------------------------------------------------
+		small_vector( const small_vector& aOther ): m_pHeap(NULL), m_iCapacity(N), m_iSize(0)
+		{
+			assign(aOther);
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Destructor.
+		//--------------------------------------------------------------------------------------------------------
+		~small_vector()
+		{
+			clear();
+			if ( m_pHeap )
+				m_cAlloc.deallocate( m_pHeap, m_iCapacity );
+		}
+
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Return underlaying const array.
+		//--------------------------------------------------------------------------------------------------------
+		const T* data() const { return m_pHeap ? m_pHeap : (const T*)m_cInline.aBuffer; }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Return underlaying array.
+		//--------------------------------------------------------------------------------------------------------
+		T* data() { return m_pHeap ? m_pHeap : (T*)m_cInline.aBuffer; }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Return true if elements are stored inside object, i.e. no memory is allocated.
+		//--------------------------------------------------------------------------------------------------------
+		bool is_inline() const { return m_pHeap == NULL; }
+
+		/// Return const iterator to the first element.
+		const_iterator begin() const { return const_iterator( (T*)data() ); }
+		/// Return const iterator to the element past last one.
+		const_iterator end() const { return const_iterator( (T*)data() + m_iSize ); }
+		/// Return reverse const iterator to the last element.
+		const_reverse_iterator rbegin() const { return const_reverse_iterator( end() ); }
+		/// Return reverse const iterator to the first element.
+		const_reverse_iterator rend() const { return const_reverse_iterator( begin() ); }
+
+		/// Return iterator to the first element.
+		iterator begin() { return iterator( data() ); }
+		/// Return iterator to the element past last one.
+		iterator end() { return iterator( data() + m_iSize ); }
+		/// Return reverse iterator to the last element.
+		reverse_iterator rbegin() { return reverse_iterator( end() ); }
+		/// Return reverse iterator to the first element.
+		reverse_iterator rend() { return reverse_iterator( begin() ); }
+
+		/// Return true if array has no elements.
+		bool empty() const { return m_iSize == 0; }
+		/// Get count of elements.
+		int size() const { return m_iSize; }
+		/// Get capacity (at least N).
+		int capacity() const { return m_iCapacity; }
+
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Assignment. If bCopy is false, content of aOther is moved.
+		//--------------------------------------------------------------------------------------------------------
+		void assign( const small_vector& aOther, bool bCopy = false )
+		{
+			if ( &aOther == this )
+				return;
+
+			clear();
+			small_vector& aFrom = (small_vector&)aOther;
+			if ( !bCopy && aFrom.m_pHeap )
+			{
+				// Steal allocated buffer.
+				if ( m_pHeap )
+					m_cAlloc.deallocate( m_pHeap, m_iCapacity );
+				m_pHeap = aFrom.m_pHeap;
+				m_iCapacity = aFrom.m_iCapacity;
+				m_iSize = aFrom.m_iSize;
+				aFrom.m_pHeap = NULL;
+				aFrom.m_iCapacity = N;
+				aFrom.m_iSize = 0;
+				return;
+			}
+
+			reserve(aFrom.m_iSize);
+			T* pTo = data();
+			T* pFrom = aFrom.data();
+			for ( int i = 0; i < aFrom.m_iSize; ++i )
+				m_cAlloc.construct( &pTo[i], pFrom[i] );
+			m_iSize = aFrom.m_iSize;
+			if ( !bCopy )
+				aFrom.clear();
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Operator =. Note that this operator moves content, not copies it.
+		//--------------------------------------------------------------------------------------------------------
+		small_vector& operator= ( const small_vector& aOther )
+		{
+			assign(aOther);
+			return *this;
+		}
+
+		/// Array subscript.
+		T& operator[] ( int iIndex ) { DebugAssert(iIndex < m_iSize); return data()[iIndex]; }
+		/// Array subscript const.
+		T const& operator[] ( int iIndex ) const { DebugAssert(iIndex < m_iSize); return data()[iIndex]; }
+		/// Element at index.
+		T& at( int iIndex ) { DebugAssert(iIndex < m_iSize); return data()[iIndex]; }
+		/// Element at index.
+		T const& at( int iIndex ) const { DebugAssert(iIndex < m_iSize); return data()[iIndex]; }
+		/// Get first array element.
+		T& front() { DebugAssert(m_iSize > 0); return data()[0]; }
+		/// Get last array element.
+		T& back() { DebugAssert(m_iSize > 0); return data()[m_iSize-1]; }
+
+		/// Add element to end of array.
+		void push_back( const T& tElem ) { insert(m_iSize, tElem); }
+		/// Add element to start of array.
+		void push_front( const T& tElem ) { insert(0, tElem); }
+		/// Remove element from end of array.
+		void pop_back() { erase(m_iSize-1); }
+		/// Remove element from start of array.
+		void pop_front() { erase(0); }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Insert element tElem at position iPos.
+		//--------------------------------------------------------------------------------------------------------
+		iterator insert( int iPos, const T& tElem )
+		{
+			DebugAssert( iPos <= m_iSize );
+			if ( m_iSize == m_iCapacity )
+				reserve( m_iCapacity << 1 ); // Double buffer size.
+			T* pBuffer = data();
+			if ( iPos < m_iSize )
+				memmove( &pBuffer[iPos + 1], &pBuffer[iPos], (m_iSize - iPos) * sizeof(T) );
+			m_cAlloc.construct( &pBuffer[iPos], tElem );
+			m_iSize++;
+			return iterator(pBuffer + iPos);
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Insert element tElem before iterator position. Return iterator pointing to inserted element.
+		//--------------------------------------------------------------------------------------------------------
+		iterator insert( iterator it, const T& tElem )
+		{
+			return insert( it - begin(), tElem );
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Delete element at position iPos. Return iterator pointing to next element.
+		//--------------------------------------------------------------------------------------------------------
+		iterator erase( int iPos )
+		{
+			DebugAssert( iPos < m_iSize );
+			T* pBuffer = data();
+			m_cAlloc.destroy(&pBuffer[iPos]);
+			m_iSize--;
+			if ( iPos < m_iSize )
+				memmove( &pBuffer[iPos], &pBuffer[iPos+1], (m_iSize - iPos) * sizeof(T) );
+			return iterator(pBuffer + iPos);
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Delete element at iterator. Return iterator pointing to next element.
+		//--------------------------------------------------------------------------------------------------------
+		iterator erase( iterator it )
+		{
+			return erase( it - begin() );
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Remove all elements. Allocated memory is kept.
+		//--------------------------------------------------------------------------------------------------------
+		void clear()
+		{
+			T* pBuffer = data();
+			for ( int i = 0; i < m_iSize; ++i )
+				m_cAlloc.destroy(&pBuffer[i]);
+			m_iSize = 0;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Reserve space for iCapacity elements. Memory is allocated only when iCapacity is greater than N.
+		//--------------------------------------------------------------------------------------------------------
+		void reserve( int iCapacity )
+		{
+			if ( m_iCapacity >= iCapacity )
+				return;
+			if ( m_pHeap )
+				m_pHeap = m_cAlloc.reallocate( m_pHeap, iCapacity, m_iCapacity );
+			else
+			{
+				// Move elements out of object.
+				m_pHeap = m_cAlloc.allocate(iCapacity);
+				memcpy( m_pHeap, m_cInline.aBuffer, m_iSize * sizeof(T) );
+			}
+			m_iCapacity = iCapacity;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Resize array.
+		//--------------------------------------------------------------------------------------------------------
+		void resize( int iSize, T const& elem = T() )
+		{
+			if ( iSize >= m_iSize )
+			{
+				reserve(iSize);
+				T* pBuffer = data();
+				for ( int i = m_iSize; i < iSize; ++i )
+					m_cAlloc.construct(&pBuffer[i], elem);
+			}
+			else
+			{
+				T* pBuffer = data();
+				for ( int i = iSize; i < m_iSize; ++i )
+					m_cAlloc.destroy(&pBuffer[i]);
+			}
+			m_iSize = iSize;
+		}
+
+	protected:
+		typedef typename Alloc::template rebind<T>::other alloc_t; // Allocator object for T.
+
+		alloc_t m_cAlloc;         // Allocator for T.
+
+		T* m_pHeap;               // Allocated array of T, NULL when elements are inline.
+		int m_iCapacity;          // Allocated size (N when elements are inline).
+		int m_iSize;              // Used size.
+
+		union                     // Inline elements, aligned as pointer or double.
+		{
+			char aBuffer[N * sizeof(T)];
+			void* pAlign;
+			double fAlign;
+		} m_cInline;
+	};
+
+
+} // namespace good
+
+#endif // __GOOD_SMALL_VECTOR_H__
@@ -18,6 +18,9 @@
 //#define DEBUG_STRING_PRINT
 
 
+#define STRING_SHORT_SIZE  16                  ///< Owned strings shorter than this are stored inside string object.
+
+
 // Disable obsolete warnings.
 #pragma warning(push)
 #pragma warning(disable: 4996)
@@ -39,10 +42,13 @@ namespace good
 	/// Class that holds a string of characters.
 	/** Note that in this version of string assignment or copy constructor "steal" internal buffer so use 
 	 *  carefully (i.e. it behaves like std::auto_ptr). Use duplicate() to obtain newly allocated string.
+	 *  Strings that own less than STRING_SHORT_SIZE characters (with trailing 0) keep them inside the object,
+	 *  without allocation; such strings are copied on move, so don't keep c_str() of a short owned string
+	 *  that is in an array that can grow.
 	 *  Note that c_str() will never return NULL. */
 	//************************************************************************************************************
 	template <
-		typename Char = Char,
+		typename Char = char,
 		typename Alloc = allocator<Char>
 	>
 	class base_string
@@ -54,7 +60,7 @@ namespace good
 		//--------------------------------------------------------------------------------------------------------
 		/// Default constructor.
 		//--------------------------------------------------------------------------------------------------------
-		base_string(): m_pBuffer(""), m_iSize(), m_iStatic(1)
+		base_string(): m_pBuffer((Char*)""), m_iSize(), m_iStatic(1), m_iShort(0)
 		{
 #ifdef DEBUG_STRING_PRINT
 			DebugPrint( "base_string default constructor\n" );
@@ -64,12 +70,18 @@ namespace good
 		//--------------------------------------------------------------------------------------------------------
 		/// Copy constructor. Move all parameters into constructed string.
 		//--------------------------------------------------------------------------------------------------------
-		base_string( const base_string& other, bool bCopy = false ): m_pBuffer(other.m_pBuffer), m_iSize(other.m_iSize), m_iStatic(other.m_iStatic)
+		base_string( const base_string& other, bool bCopy = false ): m_pBuffer(other.m_pBuffer), m_iSize(other.m_iSize), m_iStatic(other.m_iStatic), m_iShort(other.m_iShort)
 		{
 #ifdef DEBUG_STRING_PRINT
 			DebugPrint( "base_string copy constructor: %s, copy %d.\n", other.c_str() );
 #endif
-			if ( !m_iStatic )
+			if ( m_iShort )
+			{
+				memcpy( m_aShort, other.m_aShort, (m_iSize + 1) * sizeof(Char) );
+				if ( !bCopy )
+					((base_string&)other).set_empty();
+			}
+			else if ( !m_iStatic )
 			{
 				if ( bCopy )
 				{
@@ -77,11 +89,7 @@ namespace good
 					assign(other, true);
 				}
 				else
-				{
-					((base_string&)other).m_iSize = 0;
-					((base_string&)other).m_pBuffer = "";
-					((base_string&)other).m_iStatic = 1;
-				}
+					((base_string&)other).set_empty();
 			}
 		}
 
@@ -94,14 +102,12 @@ namespace good
 			DebugPrint( "base_string constructor: %s, copy %d, dealloc %d\n", szStr, bCopy, bDealloc );
 #endif
 			m_iSize = ( iSize == npos ) ? strlen(szStr) : iSize;
+			m_iShort = 0;
 
 			if ( m_iSize > 0 ) // szStr is not null nor empty.
 			{
 				if ( bCopy )
-				{
 					copy_contents(szStr);
-					m_iStatic = 0;
-				}
 				else
 				{
 					m_pBuffer = (Char*)szStr;
@@ -110,7 +116,7 @@ namespace good
 			}
 			else
 			{
-				m_pBuffer = "";
+				m_pBuffer = (Char*)"";
 				m_iStatic = 1;
 			}
 		}
@@ -133,7 +139,12 @@ namespace good
 		//--------------------------------------------------------------------------------------------------------
 		/// Get 0-terminating string.
 		//--------------------------------------------------------------------------------------------------------
-		const Char* c_str() const { return m_pBuffer; }
+		const Char* c_str() const { return m_iShort ? m_aShort : m_pBuffer; }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Return true if characters are stored inside this object (short owned string).
+		//--------------------------------------------------------------------------------------------------------
+		bool is_short() const { return m_iShort != 0; }
 		
 		//--------------------------------------------------------------------------------------------------------
 		/// Const array subscript.
@@ -141,7 +152,7 @@ namespace good
 		const Char& operator[] ( int iIndex ) const
 		{
 			DebugAssert( (0 <= iIndex) && (iIndex < m_iSize) );
-			return m_pBuffer[iIndex];
+			return c_str()[iIndex];
 		}
 		
 		//--------------------------------------------------------------------------------------------------------
@@ -150,7 +161,7 @@ namespace good
 		Char& operator[] ( int iIndex )
 		{
 			DebugAssert( (0 <= iIndex) && (iIndex < m_iSize) );
-			return m_pBuffer[iIndex];
+			return buffer()[iIndex];
 		}
 		
 		//--------------------------------------------------------------------------------------------------------
@@ -163,16 +174,31 @@ namespace good
 
 			if ( bCopy )
 			{
+				if ( iSize < STRING_SHORT_SIZE )
+				{
+					// s may point to this string, so free old buffer after copying.
+					Char* pOld = ( m_iStatic || m_iShort ) ? NULL : m_pBuffer;
+					memmove( m_aShort, s, iSize * sizeof(Char) );
+					m_aShort[iSize] = 0;
+					m_iShort = 1;
+					m_iStatic = 1;
+					m_iSize = iSize;
+					if ( pOld )
+						free(pOld);
+					return *this;
+				}
 				if ( m_iStatic )
 					m_pBuffer = m_cAlloc.allocate(iSize+1);
 				else if (m_iSize < iSize)
 					m_pBuffer = m_cAlloc.reallocate(m_pBuffer, (iSize+1)*sizeof(Char), (m_iSize+1)*sizeof(Char));
-				memcpy(m_pBuffer, s, (iSize + 1)*sizeof(Char) );
+				memcpy(m_pBuffer, s, iSize*sizeof(Char) );
+				m_pBuffer[iSize] = 0;
 			}
 			else
 				m_pBuffer = (Char*)s;
 
 			m_iStatic = !bCopy;
+			m_iShort = 0;
 			m_iSize = iSize;
 
 			return *this;
@@ -189,15 +215,22 @@ namespace good
 			if ( bCopy )
 				return assign( other.c_str(), other.size(), bCopy );
 
+			if ( &other == this )
+				return *this;
 			deallocate();
-			m_pBuffer = other.m_pBuffer;
 			m_iSize = other.m_iSize;
 			m_iStatic = other.m_iStatic;
-			if ( !m_iStatic )
+			m_iShort = other.m_iShort;
+			if ( m_iShort )
 			{
-				((base_string&)other).m_pBuffer = "";
-				((base_string&)other).m_iSize = 0;
-				((base_string&)other).m_iStatic = 1;
+				memcpy( m_aShort, other.m_aShort, (m_iSize + 1) * sizeof(Char) );
+				((base_string&)other).set_empty();
+			}
+			else
+			{
+				m_pBuffer = other.m_pBuffer;
+				if ( !m_iStatic )
+					((base_string&)other).set_empty();
 			}
 			return *this;
 		}
@@ -283,7 +316,7 @@ namespace good
 		bool starts_with( Char c ) const
 		{
 			DebugAssert( m_iSize > 0 );
-			return m_pBuffer[0] == c;
+			return c_str()[0] == c;
 		}
 		
 		//--------------------------------------------------------------------------------------------------------
@@ -292,7 +325,7 @@ namespace good
 		bool ends_with( const base_string& sStr ) const
 		{
 			if (sStr.m_iSize > m_iSize) return false;
-			return strncmp( &m_pBuffer[m_iSize - sStr.m_iSize], sStr.c_str(), sStr.m_iSize ) == 0;
+			return strncmp( &c_str()[m_iSize - sStr.m_iSize], sStr.c_str(), sStr.m_iSize ) == 0;
 		}
 		
 		//--------------------------------------------------------------------------------------------------------
@@ -301,7 +334,7 @@ namespace good
 		bool ends_with( Char c ) const
 		{
 			DebugAssert( m_iSize > 0 );
-			return m_pBuffer[m_iSize-1] == c;
+			return c_str()[m_iSize-1] == c;
 		}
 
 		//--------------------------------------------------------------------------------------------------------
@@ -309,9 +342,10 @@ namespace good
 		//--------------------------------------------------------------------------------------------------------
 		base_string& lower_case()
 		{
+			Char* pBuffer = buffer();
 			for ( int i = 0; i < m_iSize; ++i )
-				if ( ('A' <= m_pBuffer[i]) && (m_pBuffer[i] <= 'Z') )
-					m_pBuffer[i] = m_pBuffer[i] - 'A' + 'a';
+				if ( ('A' <= pBuffer[i]) && (pBuffer[i] <= 'Z') )
+					pBuffer[i] = pBuffer[i] - 'A' + 'a';
 			return *this;
 		}
 
@@ -320,10 +354,7 @@ namespace good
 		//--------------------------------------------------------------------------------------------------------
 		base_string duplicate() const
 		{
-			int len = m_iSize;
-			Char* buffer = m_cAlloc.allocate(len+1);
-			strncpy( buffer, m_pBuffer, (len + 1) * sizeof(Char) );
-			return base_string( buffer, false, true, len );
+			return base_string( c_str(), true, false, m_iSize );
 		}
 
 		//--------------------------------------------------------------------------------------------------------
@@ -333,26 +364,27 @@ namespace good
 		{
 			if (m_iSize == 0)
 				return *this;
+			Char* pBuffer = buffer();
 			int begin = 0, end = m_iSize - 1;
 
 			for (; begin <= end; ++begin)
 			{
-				Char c = m_pBuffer[begin];
+				Char c = pBuffer[begin];
 				if ( (c != ' ') && (c != '\t') && (c != '\n') && (c != '\r') )
 					break;
 			}
 
 			for (; begin <= end; --end)
 			{
-				Char c = m_pBuffer[end];
+				Char c = pBuffer[end];
 				if ( (c != ' ') && (c != '\t') && (c != '\n') && (c != '\r') )
 					break;
 			}
 
 			m_iSize = end - begin + 1;
 			if (begin > 0)
-				memmove(m_pBuffer, &m_pBuffer[begin], m_iSize);
-			m_pBuffer[m_iSize] = 0;
+				memmove(pBuffer, &pBuffer[begin], m_iSize);
+			pBuffer[m_iSize] = 0;
 			return *this;
 		}
 
@@ -361,7 +393,7 @@ namespace good
 		//--------------------------------------------------------------------------------------------------------
 		base_string& escape()
 		{
-			Char* buf = m_pBuffer;
+			Char* buf = buffer();
 
 			// Skip start sequence.
 			int start = find('\\'), end = start, count = 0;
@@ -399,9 +431,9 @@ namespace good
 			if ( m_iSize - iFrom < str.m_iSize )
 				return npos;
 
-			Char* result = strstr( &m_pBuffer[iFrom], str.c_str() );
+			const Char* result = strstr( &c_str()[iFrom], str.c_str() );
 			if (result)
-				return (int)( result - m_pBuffer );
+				return (int)( result - c_str() );
 			else
 				return npos;
 		}
@@ -412,9 +444,9 @@ namespace good
 		int find( Char c, int iFrom = 0 ) const
 		{
 			DebugAssert( iFrom <= m_iSize );
-			Char* result = strchr( &m_pBuffer[iFrom], (int)c );
+			const Char* result = strchr( &c_str()[iFrom], (int)c );
 			if (result)
-				return (int)( result - m_pBuffer );
+				return (int)( result - c_str() );
 			else
 				return npos;
 		}
@@ -424,9 +456,10 @@ namespace good
 		//--------------------------------------------------------------------------------------------------------
 		int rfind( Char c ) const
 		{
-			for ( Char* pCurr = m_pBuffer + m_iSize - 1; pCurr >= m_pBuffer; --pCurr )
+			const Char* pBuffer = c_str();
+			for ( const Char* pCurr = pBuffer + m_iSize - 1; pCurr >= pBuffer; --pCurr )
 				if ( *pCurr == c )
-					return pCurr - m_pBuffer;
+					return pCurr - pBuffer;
 			return npos;
 		}
 
@@ -443,16 +476,12 @@ namespace good
 			DebugAssert( iFrom + iSize <= m_iSize );
 
 			if (bAlloc)
-			{
-				Char* buffer = m_cAlloc.allocate(iSize+1);
-				strncpy( buffer, &m_pBuffer[iFrom], iSize );
-				buffer[iSize] = 0;
-				return base_string( buffer, false, true, iSize );
-			}
+				return base_string( &c_str()[iFrom], true, false, iSize );
 			else
 			{
-				m_pBuffer[iFrom + iSize] = 0;
-				return base_string( &m_pBuffer[iFrom], false, false, iSize );
+				Char* pBuffer = (Char*)c_str();
+				pBuffer[iFrom + iSize] = 0;
+				return base_string( &pBuffer[iFrom], false, false, iSize );
 			}
 		}
 
@@ -500,7 +529,7 @@ namespace good
 			{
 				bool bFound = false;
 				for ( int i=0; i<separators.size(); ++i )
-					if ( separators[i] == m_pBuffer[end] )
+					if ( separators[i] == c_str()[end] )
 					{
 						base_string s = substr(start, end - start);
 						if (bTrim)
@@ -522,15 +551,13 @@ namespace good
 		static base_string concatenate( const base_string& s1, const base_string& s2 )
 		{
 			int len3 = s1.m_iSize + s2.m_iSize;
-			Char* buffer = m_cAlloc.allocate(len3 + 1);
+			base_string result;
+			Char* buffer = result.allocate_contents(len3);
 			if (s1.size() > 0)
 				strncpy( buffer, s1.c_str(), s1.m_iSize * sizeof(Char) );
 			if (s2.size() > 0)
 				strncpy( &buffer[s1.m_iSize], s2.c_str(), s2.m_iSize * sizeof(Char) );
 			buffer[len3] = 0;
-			base_string result;
-			result.m_pBuffer = buffer;
-			result.m_iSize = len3;
 			return result;
 		}
 
@@ -549,12 +576,49 @@ namespace good
 		}
 
 		//--------------------------------------------------------------------------------------------------------
-		// Copy 0-termination base_string.
+		// Get mutable characters.
+		//--------------------------------------------------------------------------------------------------------
+		Char* buffer() { return m_iShort ? m_aShort : m_pBuffer; }
+
+		//--------------------------------------------------------------------------------------------------------
+		// Make this string empty, without deallocating (used when content is moved to other string).
+		//--------------------------------------------------------------------------------------------------------
+		void set_empty()
+		{
+			m_pBuffer = (Char*)"";
+			m_iSize = 0;
+			m_iStatic = 1;
+			m_iShort = 0;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		// Get space for own iSize characters (plus trailing 0) inside object or allocated. Old content is lost.
+		//--------------------------------------------------------------------------------------------------------
+		Char* allocate_contents( int iSize )
+		{
+			deallocate();
+			m_iSize = iSize;
+			if ( iSize < STRING_SHORT_SIZE )
+			{
+				m_iShort = 1;
+				m_iStatic = 1;
+				return m_aShort;
+			}
+			m_iShort = 0;
+			m_iStatic = 0;
+			m_pBuffer = m_cAlloc.allocate(iSize+1);
+			return m_pBuffer;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		// Copy m_iSize characters of szFrom to own buffer.
 		//--------------------------------------------------------------------------------------------------------
 		void copy_contents(const Char* szFrom)
 		{
-			m_pBuffer = m_cAlloc.allocate(m_iSize+1);
-			strncpy( m_pBuffer, szFrom, (m_iSize+1) * sizeof(Char) );
+			m_iStatic = 1; // Nothing to deallocate.
+			Char* pBuffer = allocate_contents(m_iSize);
+			memcpy( pBuffer, szFrom, m_iSize * sizeof(Char) );
+			pBuffer[m_iSize] = 0;
 		}
 
 		//--------------------------------------------------------------------------------------------------------
@@ -563,19 +627,25 @@ namespace good
 		base_string concat_with( const Char* szRight, int iRightSize ) const
 		{
 			int len = m_iSize;
-			Char* buffer = m_cAlloc.allocate(len + iRightSize + 1);
-			strncpy( buffer, m_pBuffer, len * sizeof(Char) );
+			base_string result;
+			Char* buffer = result.allocate_contents(len + iRightSize);
+			strncpy( buffer, c_str(), len * sizeof(Char) );
 			strncpy( &buffer[m_iSize], szRight, (iRightSize+1) * sizeof(Char) );
-			return base_string ( buffer, false, true );
+			return result;
 		}
 
 	protected:
 		typedef typename Alloc::template rebind<Char>::other alloc_t; // Allocator object for Char.
 
 		alloc_t m_cAlloc;         // Allocator for Char.
-		Char* m_pBuffer;          // Allocated space is m_iSize+1 bytes (for trailing 0).
-		int m_iSize:31;           // String size.
+		union
+		{
+			Char* m_pBuffer;                   // Allocated space is m_iSize+1 bytes (for trailing 0).
+			Char m_aShort[STRING_SHORT_SIZE];  // Characters of short string (if m_iShort is true).
+		};
+		int m_iSize:30;           // String size.
 		int m_iStatic:1;          // If true, then base_string must NOT be deallocated.
+		int m_iShort:1;           // If true, then characters are in m_aShort.
 	};
 
 	
@@ -588,4 +658,4 @@ namespace good
 #pragma warning(pop) // Restore warnings.
 
 
-#endif // __GOOD_STRING_H__
\ No newline at end of file
+#endif // __GOOD_STRING_H__
\ No newline at end of file
@@ -34,6 +34,13 @@ namespace good
 	{
 	public:
 		typedef string base_class;
+		typedef good::base_string<Char, Alloc> base_string;
+		using base_string::m_pBuffer;
+		using base_string::m_iSize;
+		using base_string::m_iStatic;
+		using base_string::m_cAlloc;
+		using base_string::npos;
+		using base_string::length;
 
 
 
@@ -201,8 +208,8 @@ namespace good
 			{
 				if ( diff > 0 )
 					increment( diff );
-				memmove( &m_pBuffer[pos+fromL], &m_pBuffer[pos+toL], (size - iPos - fromL) * sizeof(Char) );
-				strncpy( &m_pBuffer[pos], sTo.c_str() );
+				memmove( &m_pBuffer[pos+fromL], &m_pBuffer[pos+toL], (size - pos - fromL) * sizeof(Char) );
+				strcpy( &m_pBuffer[pos], sTo.c_str() );
 				m_iSize += diff;
 				pos += toL;
 			}
@@ -306,4 +313,4 @@ namespace good
 #pragma warning(pop) // Restore warnings.
 
 
-#endif // __GOOD_STRING_BUFFER_H__
\ No newline at end of file
+#endif // __GOOD_STRING_BUFFER_H__
\ No newline at end of file
@@ -0,0 +1,151 @@
+//----------------------------------------------------------------------------------------------------------------
+// Pool of unique strings (string interning).
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#ifndef __GOOD_STRING_POOL_H__
+#define __GOOD_STRING_POOL_H__
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "good/hash_map.h"
+#include "good/string.h"
+#include "good/vector.h"
+
+
+#define DEFAULT_STRING_POOL_CHUNK  4096        ///< Size of memory chunk for characters of strings in pool.
+
+
+namespace good
+{
+
+
+	//************************************************************************************************************
+	/// Pool of unique strings. Each different string gets an id: index in order of addition.
+	/** Two strings of the same pool are equal if their ids are equal, so strings can be compared as integers.
+	 * Characters are stored in big chunks that are never moved nor freed until clear(), so strings returned by
+	 * get() don't own memory and remain valid while pool is alive. */
+	//************************************************************************************************************
+	class string_pool
+	{
+	public:
+		static const int invalid_id = -1;         ///< Id of string that is not in pool.
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Constructor with optional size of chunks of memory for characters.
+		//--------------------------------------------------------------------------------------------------------
+		string_pool( int iChunkSize = DEFAULT_STRING_POOL_CHUNK ):
+			m_iChunkSize(iChunkSize), m_pChunkPos(NULL), m_iChunkFree(0) {}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Destructor.
+		//--------------------------------------------------------------------------------------------------------
+		~string_pool() { clear(); }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get count of strings in pool.
+		//--------------------------------------------------------------------------------------------------------
+		int size() const { return m_aStrings.size(); }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get string by id. It doesn't own characters, so it can be copied freely.
+		//--------------------------------------------------------------------------------------------------------
+		const string& get( int iId ) const { return m_aStrings[iId]; }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get string by id.
+		//--------------------------------------------------------------------------------------------------------
+		const string& operator[]( int iId ) const { return m_aStrings[iId]; }
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get id of string, or invalid_id if string is not in pool.
+		//--------------------------------------------------------------------------------------------------------
+		int find( const string& sStr ) const
+		{
+			hash_map<string, int>::const_iterator it = m_cIds.find(sStr);
+			return ( it == m_cIds.end() ) ? invalid_id : it->second;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get id of 0-terminated string, or invalid_id if string is not in pool.
+		//--------------------------------------------------------------------------------------------------------
+		int find( const char* szStr ) const
+		{
+			hash_map<string, int>::const_iterator it = m_cIds.find(szStr);
+			return ( it == m_cIds.end() ) ? invalid_id : it->second;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get id of string, adding it to pool if it is not there. New string gets id equal to previous size().
+		//--------------------------------------------------------------------------------------------------------
+		int intern( const string& sStr )
+		{
+			int iId = find(sStr);
+			return ( iId == invalid_id ) ? add( sStr.c_str(), sStr.size() ) : iId;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Get id of 0-terminated string, adding it to pool if it is not there.
+		//--------------------------------------------------------------------------------------------------------
+		int intern( const char* szStr )
+		{
+			int iId = find(szStr);
+			return ( iId == invalid_id ) ? add( szStr, strlen(szStr) ) : iId;
+		}
+
+		//--------------------------------------------------------------------------------------------------------
+		/// Remove all strings and free memory.
+		//--------------------------------------------------------------------------------------------------------
+		void clear()
+		{
+			m_cIds.clear();
+			m_aStrings.clear();
+			for ( int i = 0; i < m_aChunks.size(); ++i )
+				free( m_aChunks[i] );
+			m_aChunks.clear();
+			m_pChunkPos = NULL;
+			m_iChunkFree = 0;
+		}
+
+	protected:
+		//--------------------------------------------------------------------------------------------------------
+		// Copy characters to chunk and add new string.
+		//--------------------------------------------------------------------------------------------------------
+		int add( const char* szStr, int iSize )
+		{
+			if ( iSize + 1 > m_iChunkFree )
+			{
+				// Rest of current chunk is lost. Long strings get their own chunk.
+				int iAlloc = MAX2( m_iChunkSize, iSize + 1 );
+				m_pChunkPos = (char*)malloc(iAlloc);
+				m_iChunkFree = iAlloc;
+				m_aChunks.push_back(m_pChunkPos);
+			}
+			char* szCopy = m_pChunkPos;
+			memcpy( szCopy, szStr, iSize );
+			szCopy[iSize] = 0;
+			m_pChunkPos += iSize + 1;
+			m_iChunkFree -= iSize + 1;
+
+			int iId = m_aStrings.size();
+			string sView( szCopy, false, false, iSize );
+			m_aStrings.push_back( sView );
+			m_cIds.insert( pair<string, int>(sView, iId) );
+			return iId;
+		}
+
+		int m_iChunkSize;                    // Size of allocated chunks.
+		char* m_pChunkPos;                   // Free position in last chunk.
+		int m_iChunkFree;                    // Free characters in last chunk.
+		vector<char*> m_aChunks;             // Allocated chunks.
+		vector<string> m_aStrings;           // Strings by id, pointing to chunks.
+		hash_map<string, int> m_cIds;        // Map from string to id, keys point to chunks.
+	};
+
+
+} // namespace good
+
+
+#endif // __GOOD_STRING_POOL_H__
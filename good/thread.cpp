@@ -169,4 +169,186 @@ namespace good
 
 } // namespace good
 
+#else // WIN32
+
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "good/atomic.h"
+#include "good/thread.h"
+
+namespace good
+{
+
+	void* thread_impl_thread_proc( void* pThreadParameter ); // Forward declaration.
+
+	//----------------------------------------------------------------------------------------------------------------
+	// Thread implementation with POSIX threads.
+	//----------------------------------------------------------------------------------------------------------------
+	class thread_impl
+	{
+	public:
+		thread_impl(good::thread::thread_func_t thread_func): m_bLaunched(false), m_iFinished(0), m_pThreadFunc(thread_func) {}
+		~thread_impl()
+		{
+			dispose();
+		}
+
+		/// Set function.
+		inline void set_func( thread::thread_func_t thread_func ) { m_pThreadFunc = thread_func; }
+
+		// Execute thread. 
+		inline void launch( void* pThreadParameter, bool bDaemon = false )
+		{
+			DebugAssert( !m_bLaunched );
+			m_bDaemon = bDaemon;
+			m_pThreadParameter = pThreadParameter;
+			atomic_store(&m_iFinished, 0);
+			m_bLaunched = ( pthread_create(&m_hThread, NULL, thread_impl_thread_proc, this) == 0 );
+			DebugAssert(m_bLaunched);
+		}
+
+		/// Free all handles and memory.
+		inline void dispose()
+		{
+			if ( m_bLaunched )
+			{
+				pthread_detach(m_hThread);
+				m_bLaunched = false;
+			}
+		}
+
+		// Wait for this thread.  Return true if thread is terminated.
+		inline bool join( int iMSecs )
+		{
+			DebugAssert( m_bLaunched );
+			if ( iMSecs == TIME_INFINITE )
+			{
+				pthread_join(m_hThread, NULL);
+				m_bLaunched = false;
+				return true;
+			}
+			for ( ; (iMSecs > 0) && !is_finished(); iMSecs -= 1 )
+				usleep(1000);
+			return is_finished();
+		}
+
+		// Terminate thread.
+		inline void terminate()
+		{
+			DebugAssert( m_bLaunched );
+			pthread_cancel(m_hThread);
+		}
+
+		// Check if thread was launched previously.
+		inline bool is_launched() { return m_bLaunched; }
+
+		// Check if thread is finished.
+		inline bool is_finished()
+		{
+			DebugAssert( m_bLaunched );
+			return atomic_load(&m_iFinished) != 0;
+		}
+
+	protected:
+		friend void* thread_impl_thread_proc( void* pThreadParameter );
+
+		bool m_bDaemon;
+		bool m_bLaunched;
+		atomic_t m_iFinished;
+		pthread_t m_hThread;
+		good::thread::thread_func_t m_pThreadFunc;
+		void* m_pThreadParameter;
+	};
+
+
+	//----------------------------------------------------------------------------------------------------------------
+	// Thread functions.
+	//----------------------------------------------------------------------------------------------------------------
+	void thread::sleep( int iMSecs )
+	{
+		usleep(iMSecs * 1000);
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	void thread::exit( int iExitCode )
+	{
+		pthread_exit(NULL);
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	thread::thread()
+	{
+		m_pImpl = new thread_impl( NULL );
+	}
+
+	thread::thread( thread_func_t thread_func )
+	{
+		m_pImpl = new thread_impl( thread_func );
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	thread::~thread()
+	{
+		delete (thread_impl*)m_pImpl;
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	void thread::set_func( thread_func_t thread_func )
+	{
+		((thread_impl*)m_pImpl)->set_func(thread_func);
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	void thread::launch( void* pThreadParameter, bool bDaemon )
+	{
+		((thread_impl*)m_pImpl)->launch(pThreadParameter, bDaemon);
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	void thread::terminate()
+	{
+		((thread_impl*)m_pImpl)->terminate();
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	void thread::dispose()
+	{
+		((thread_impl*)m_pImpl)->dispose();
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	bool thread::join( int iMSecs )
+	{
+		return ((thread_impl*)m_pImpl)->join(iMSecs);
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	bool thread::is_launched()
+	{
+		return ((thread_impl*)m_pImpl)->is_launched();
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	bool thread::is_finished()
+	{
+		return ((thread_impl*)m_pImpl)->is_finished();
+	}
+
+
+	//----------------------------------------------------------------------------------------------------------------
+	// Thread function.
+	//----------------------------------------------------------------------------------------------------------------
+	void* thread_impl_thread_proc( void* pThreadParameter )
+	{
+		good::thread_impl* pImpl = (good::thread_impl*)pThreadParameter;
+		DebugAssert( pImpl->m_pThreadFunc );
+		pImpl->m_pThreadFunc(pImpl->m_pThreadParameter);
+		atomic_store(&pImpl->m_iFinished, 1);
+		return NULL;
+	}
+
+} // namespace good
+
 #endif // WIN32
@@ -8,6 +8,7 @@
 
 
 #include <new>
+#include "good/atomic.h"
 #include "good/defines.h"
 
 
@@ -32,6 +33,13 @@ namespace good
 		{
 			return (tLeft == tRight);
 		}
+
+		/// Compare element with value of other type (for example good::string with const char*).
+		template <typename K>
+		bool operator() ( const T& tLeft, const K& tRight ) const
+		{
+			return (tLeft == tRight);
+		}
 	};
 
 
@@ -105,7 +113,7 @@ namespace good
 	template <typename T, typename Container>
 	typename Container::const_iterator find( const Container& aContainer, const T& elem )
 	{
-		return good::find<T, Container::const_iterator>(aContainer.begin(), aContainer.end(), elem);
+		return good::find<T, typename Container::const_iterator>(aContainer.begin(), aContainer.end(), elem);
 	}
 
 
@@ -115,7 +123,19 @@ namespace good
 	template <typename T, typename Container>
 	typename Container::iterator find( Container& aContainer, const T& elem )
 	{
-		return good::find<T, Container::iterator>(aContainer.begin(), aContainer.end(), elem);
+		return good::find<T, typename Container::iterator>(aContainer.begin(), aContainer.end(), elem);
+	}
+
+
+	//************************************************************************************************************
+	/// Get count of heap allocations made by good allocators since start of program.
+	/** Counts calls to malloc() / realloc() of allocator, and new chunks of memory_pool and arena. Compare values
+	 * at start and end of a frame to know how many allocations were made during it. */
+	//************************************************************************************************************
+	inline atomic_t& allocations_count()
+	{
+		static atomic_t iCount = 0;
+		return iCount;
 	}
 
 
@@ -161,6 +181,7 @@ namespace good
 		//--------------------------------------------------------------------------------------------------------
 		pointer_t allocate( int iSize ) const
 		{
+			atomic_increment( &allocations_count() );
 			return (pointer_t) malloc( iSize * sizeof(T) );
 		}
 		
@@ -169,6 +190,7 @@ namespace good
 		//--------------------------------------------------------------------------------------------------------
 		pointer_t reallocate( pointer_t pOld, int iNewSize, int /*iOldSize*/ ) const
 		{
+			atomic_increment( &allocations_count() );
 			return (pointer_t) realloc( pOld, iNewSize * sizeof(T) );
 		}
 		
@@ -214,7 +236,7 @@ namespace good
 		/// Dereference.
 		reference operator[] (int iOffset) const { return m_cCurrent[iOffset-1]; }
 		/// Element selection through pointer.
-		pointer operator->() const { return (m_cCurrent-1)->(); }
+		pointer operator->() const { return &*(m_cCurrent-1); }
 		
 	protected:
 		Iterator m_cCurrent;
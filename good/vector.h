@@ -103,7 +103,11 @@ namespace good
 		class iterator: public const_iterator
 		{
 		public:
+			friend class good::vector<T, Alloc>;
+
 			typedef const_iterator base_class;
+			typedef typename base_class::pointer pointer;
+			typedef typename base_class::reference reference;
 
 			// Constructor by value.
 			iterator( pointer n = NULL ): base_class(n) {}
@@ -139,11 +143,14 @@ namespace good
 			reference operator[] (int iOffset) const { DebugAssert(m_pCurrent); return m_pCurrent[iOffset]; }
 			/// Element selection through pointer.
 			pointer operator->() const { DebugAssert(m_pCurrent); return m_pCurrent; }
+
+		protected:
+			using base_class::m_pCurrent;
 		};
 
 
-		typedef reverse_iterator<const_iterator> const_reverse_iterator; ///< Reverse const iterator of a vector.
-		typedef reverse_iterator<iterator> reverse_iterator;             ///< Reverse iterator of a vector.
+		typedef good::reverse_iterator<const_iterator> const_reverse_iterator; ///< Reverse const iterator of a vector.
+		typedef good::reverse_iterator<iterator> reverse_iterator;             ///< Reverse iterator of a vector.
 
 
 		//--------------------------------------------------------------------------------------------------------
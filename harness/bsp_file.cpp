@@ -0,0 +1,371 @@
+//----------------------------------------------------------------------------------------------------------------
+// Reader of Source engine .bsp files, see bsp_file.h. Traces follow engine's collision code (CM_RecursiveHullCheck
+// and CM_ClipBoxToBrush): hull is moved through nodes by its center, planes are pushed out by hull extents.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#include "good/file.h"
+
+#include "bsp_file.h"
+
+
+//----------------------------------------------------------------------------------------------------------------
+template <typename T>
+bool CBspFile::ReadLump( const char* pFile, int iFileSize, int iLump, good::vector<T>& aResult )
+{
+	const bsp_lump_t& cLump = ((const bsp_header_t*)pFile)->lumps[iLump];
+	if ( (cLump.fileofs < 0) || (cLump.filelen < 0) || (cLump.fileofs + cLump.filelen > iFileSize) ||
+	     (cLump.filelen % sizeof(T) != 0) )
+		return false;
+
+	aResult.clear();
+	aResult.resize( cLump.filelen / sizeof(T) );
+	if ( cLump.filelen > 0 )
+		memcpy( &aResult[0], pFile + cLump.fileofs, cLump.filelen );
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CBspFile::Load( const char* szFileName )
+{
+	size_t iSize = good::file::file_size(szFileName);
+	if ( (iSize == (size_t)-1) || (iSize < sizeof(bsp_header_t)) )
+	{
+		fprintf(stderr, "Can't read BSP file %s.\n", szFileName);
+		return false;
+	}
+
+	char* pFile = (char*)malloc(iSize);
+	good::file::file_to_memory(szFileName, pFile, iSize);
+	const bsp_header_t* pHeader = (const bsp_header_t*)pFile;
+
+	bool bResult = (pHeader->ident == BSP_IDENT);
+	if ( !bResult )
+		fprintf(stderr, "%s is not a BSP file.\n", szFileName);
+
+	good::vector<bsp_model_t> aModels;
+	if ( bResult )
+	{
+		bResult = ReadLump(pFile, iSize, EBspLumpPlanes, m_aPlanes) && ReadLump(pFile, iSize, EBspLumpNodes, m_aNodes) &&
+		          ReadLump(pFile, iSize, EBspLumpLeafBrushes, m_aLeafBrushes) && ReadLump(pFile, iSize, EBspLumpBrushes, m_aBrushes) &&
+		          ReadLump(pFile, iSize, EBspLumpBrushSides, m_aBrushSides) && ReadLump(pFile, iSize, EBspLumpModels, aModels) &&
+		          ReadLump(pFile, iSize, EBspLumpVisibility, m_aVisibility) && (aModels.size() > 0) && (m_aNodes.size() > 0);
+		if ( !bResult )
+			fprintf(stderr, "BSP file %s has invalid lumps.\n", szFileName);
+	}
+
+	if ( bResult )
+	{
+		// Leaf has ambient lighting in lump version 0, read only fields we need.
+		const bsp_lump_t& cLump = pHeader->lumps[EBspLumpLeafs];
+		int iLeafSize = (cLump.version == 0) ? BSP_LEAF_SIZE_V0 : BSP_LEAF_SIZE_V1;
+		bResult = (cLump.fileofs >= 0) && (cLump.filelen >= 0) && (cLump.fileofs + cLump.filelen <= (int)iSize) &&
+		          (cLump.filelen % iLeafSize == 0);
+		if ( !bResult )
+			fprintf(stderr, "BSP file %s has invalid leafs.\n", szFileName);
+
+		m_aLeafs.clear();
+		m_aLeafs.reserve( cLump.filelen / iLeafSize );
+		for ( const char* pLeaf = pFile + cLump.fileofs; bResult && (pLeaf < pFile + cLump.fileofs + cLump.filelen); pLeaf += iLeafSize )
+		{
+			// int contents; short cluster; short area/flags; short mins[3], maxs[3]; ushort firstleafface,
+			// numleaffaces, firstleafbrush, numleafbrushes.
+			bsp_leaf_t cLeaf;
+			cLeaf.contents = *(const int*)pLeaf;
+			cLeaf.cluster = *(const short*)(pLeaf + 4);
+			cLeaf.firstleafbrush = *(const unsigned short*)(pLeaf + 24);
+			cLeaf.numleafbrushes = *(const unsigned short*)(pLeaf + 26);
+			m_aLeafs.push_back(cLeaf);
+		}
+	}
+
+	free(pFile);
+	if ( !bResult )
+	{
+		m_aNodes.clear();
+		return false;
+	}
+
+	m_iHeadNode = aModels[0].headnode;
+	m_vMins = aModels[0].mins;
+	m_vMaxs = aModels[0].maxs;
+	m_iClusters = (m_aVisibility.size() >= sizeof(int)) ? *(const int*)&m_aVisibility[0] : 0;
+	if ( m_aVisibility.size() < (int)sizeof(int) * (1 + 2 * m_iClusters) )
+		m_iClusters = 0;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CBspFile::TraceRay( const Ray_t& ray, unsigned int fMask, float& fFraction, Vector& vNormal, int& iContents,
+                         bool& bStartSolid ) const
+{
+	trace_work_t cWork;
+	cWork.vStart = ray.m_Start;
+	cWork.vEnd = ray.m_Start + ray.m_Delta;
+	cWork.vExtents = ray.m_Extents;
+	cWork.bIsRay = ray.m_IsRay;
+	cWork.fMask = fMask;
+	cWork.fFraction = fFraction;
+	cWork.vNormal = vNormal;
+	cWork.iContents = 0;
+	cWork.bStartSolid = cWork.bAllSolid = cWork.bHit = false;
+
+	RecursiveHullCheck(cWork, m_iHeadNode, 0.0f, 1.0f, cWork.vStart, cWork.vEnd);
+
+	if ( cWork.bStartSolid )
+		bStartSolid = true;
+	if ( !cWork.bHit )
+		return false;
+
+	fFraction = cWork.fFraction;
+	vNormal = cWork.vNormal;
+	iContents = cWork.iContents;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CBspFile::RecursiveHullCheck( trace_work_t& cWork, int iNode, float p1f, float p2f, const Vector& p1, const Vector& p2 ) const
+{
+	if ( cWork.fFraction <= p1f )
+		return; // Already hit something nearer.
+
+	if ( iNode < 0 )
+	{
+		TraceToLeaf(cWork, -1 - iNode);
+		return;
+	}
+
+	const bsp_node_t& cNode = m_aNodes[iNode];
+	const bsp_plane_t& cPlane = m_aPlanes[cNode.planenum];
+	float t1 = cPlane.normal.Dot(p1) - cPlane.dist;
+	float t2 = cPlane.normal.Dot(p2) - cPlane.dist;
+	float fOffset = cWork.bIsRay ? 0.0f : fabsf(cWork.vExtents.x * cPlane.normal.x) +
+	                fabsf(cWork.vExtents.y * cPlane.normal.y) + fabsf(cWork.vExtents.z * cPlane.normal.z);
+
+	// See which sides we need to consider.
+	if ( (t1 >= fOffset) && (t2 >= fOffset) )
+	{
+		RecursiveHullCheck(cWork, cNode.children[0], p1f, p2f, p1, p2);
+		return;
+	}
+	if ( (t1 < -fOffset) && (t2 < -fOffset) )
+	{
+		RecursiveHullCheck(cWork, cNode.children[1], p1f, p2f, p1, p2);
+		return;
+	}
+
+	// Put the crosspoint DIST_EPSILON pixels on the near side.
+	int iSide;
+	float fFrac, fFrac2;
+	if ( t1 < t2 )
+	{
+		float fInvDist = 1.0f / (t1 - t2);
+		iSide = 1;
+		fFrac2 = (t1 + fOffset + BSP_DIST_EPSILON) * fInvDist;
+		fFrac = (t1 - fOffset + BSP_DIST_EPSILON) * fInvDist;
+	}
+	else if ( t1 > t2 )
+	{
+		float fInvDist = 1.0f / (t1 - t2);
+		iSide = 0;
+		fFrac2 = (t1 - fOffset - BSP_DIST_EPSILON) * fInvDist;
+		fFrac = (t1 + fOffset + BSP_DIST_EPSILON) * fInvDist;
+	}
+	else
+	{
+		iSide = 0;
+		fFrac = 1.0f;
+		fFrac2 = 0.0f;
+	}
+
+	// Move up to the node.
+	fFrac = MAX2( 0.0f, MIN2(1.0f, fFrac) );
+	float fMid = p1f + (p2f - p1f) * fFrac;
+	Vector vMid = p1 + (p2 - p1) * fFrac;
+	RecursiveHullCheck(cWork, cNode.children[iSide], p1f, fMid, p1, vMid);
+
+	// Go past the node.
+	fFrac2 = MAX2( 0.0f, MIN2(1.0f, fFrac2) );
+	fMid = p1f + (p2f - p1f) * fFrac2;
+	vMid = p1 + (p2 - p1) * fFrac2;
+	RecursiveHullCheck(cWork, cNode.children[iSide ^ 1], fMid, p2f, vMid, p2);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CBspFile::TraceToLeaf( trace_work_t& cWork, int iLeaf ) const
+{
+	const bsp_leaf_t& cLeaf = m_aLeafs[iLeaf];
+
+	// Brush can be in several leafs and is clipped again then. Result is the same, so there is no check counter
+	// as in engine, which would make trace not thread safe.
+	for ( int i = 0; i < cLeaf.numleafbrushes; ++i )
+	{
+		const bsp_brush_t& cBrush = m_aBrushes[ m_aLeafBrushes[cLeaf.firstleafbrush + i] ];
+		if ( cBrush.contents & cWork.fMask )
+		{
+			ClipBoxToBrush(cWork, cBrush);
+			if ( cWork.fFraction == 0.0f )
+				return;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CBspFile::ClipBoxToBrush( trace_work_t& cWork, const bsp_brush_t& cBrush ) const
+{
+	if ( cBrush.numsides == 0 )
+		return;
+
+	float fEnter = -1.0f, fLeave = 1.0f;
+	bool bGetOut = false, bStartOut = false;
+	const bsp_plane_t* pLeadPlane = NULL;
+
+	for ( int i = 0; i < cBrush.numsides; ++i )
+	{
+		const bsp_brushside_t& cSide = m_aBrushSides[cBrush.firstside + i];
+		const bsp_plane_t& cPlane = m_aPlanes[cSide.planenum];
+
+		// Push plane out by hull extents.
+		float fDist = cPlane.dist;
+		if ( !cWork.bIsRay )
+			fDist += fabsf(cWork.vExtents.x * cPlane.normal.x) + fabsf(cWork.vExtents.y * cPlane.normal.y) +
+			         fabsf(cWork.vExtents.z * cPlane.normal.z);
+
+		float d1 = cPlane.normal.Dot(cWork.vStart) - fDist;
+		float d2 = cPlane.normal.Dot(cWork.vEnd) - fDist;
+		if ( d2 > 0.0f )
+			bGetOut = true; // Endpoint is not in solid.
+		if ( d1 > 0.0f )
+			bStartOut = true;
+
+		// If completely in front of face, no intersection.
+		if ( (d1 > 0.0f) && (d2 >= d1) )
+			return;
+		if ( (d1 <= 0.0f) && (d2 <= 0.0f) )
+			continue;
+
+		// Crosses face.
+		if ( d1 > d2 ) // Enter.
+		{
+			float f = (d1 - BSP_DIST_EPSILON) / (d1 - d2);
+			if ( f > fEnter )
+			{
+				fEnter = f;
+				pLeadPlane = &cPlane;
+			}
+		}
+		else // Leave.
+		{
+			float f = (d1 + BSP_DIST_EPSILON) / (d1 - d2);
+			if ( f < fLeave )
+				fLeave = f;
+		}
+	}
+
+	if ( !bStartOut ) // Original point was inside brush.
+	{
+		cWork.bStartSolid = true;
+		if ( !bGetOut )
+		{
+			cWork.bAllSolid = cWork.bHit = true;
+			cWork.fFraction = 0.0f;
+			cWork.vNormal.Init();
+			cWork.iContents = cBrush.contents;
+		}
+		return;
+	}
+
+	if ( (fEnter < fLeave) && (fEnter > -1.0f) && (fEnter < cWork.fFraction) )
+	{
+		cWork.bHit = true;
+		cWork.fFraction = MAX2(0.0f, fEnter);
+		cWork.vNormal = pLeadPlane->normal;
+		cWork.iContents = cBrush.contents;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------
+int CBspFile::GetLeaf( const Vector& vPos ) const
+{
+	int iNode = m_iHeadNode;
+	while ( iNode >= 0 )
+	{
+		const bsp_node_t& cNode = m_aNodes[iNode];
+		const bsp_plane_t& cPlane = m_aPlanes[cNode.planenum];
+		iNode = cNode.children[ (cPlane.normal.Dot(vPos) - cPlane.dist < 0.0f) ? 1 : 0 ];
+	}
+	return -1 - iNode;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+int CBspFile::GetPointContents( const Vector& vPos ) const
+{
+	const bsp_leaf_t& cLeaf = m_aLeafs[ GetLeaf(vPos) ];
+	int iContents = cLeaf.contents;
+	for ( int i = 0; i < cLeaf.numleafbrushes; ++i )
+	{
+		const bsp_brush_t& cBrush = m_aBrushes[ m_aLeafBrushes[cLeaf.firstleafbrush + i] ];
+		int iSide = 0;
+		for ( ; iSide < cBrush.numsides; ++iSide )
+		{
+			const bsp_plane_t& cPlane = m_aPlanes[ m_aBrushSides[cBrush.firstside + iSide].planenum ];
+			if ( cPlane.normal.Dot(vPos) - cPlane.dist > 0.0f )
+				break;
+		}
+		if ( (cBrush.numsides > 0) && (iSide == cBrush.numsides) )
+			iContents |= cBrush.contents;
+	}
+	return iContents;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+int CBspFile::GetClusterForOrigin( const Vector& vPos ) const
+{
+	return m_aLeafs[ GetLeaf(vPos) ].cluster;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+int CBspFile::GetPVSForCluster( int iCluster, int iOutputPvsLength, unsigned char* pOutputPvs ) const
+{
+	int iRowSize = (m_iClusters + 7) >> 3;
+	int iSize = MIN2(iRowSize, iOutputPvsLength);
+	if ( (iCluster < 0) || (iCluster >= m_iClusters) )
+	{
+		// Outside of map, or no visibility: everything is visible, as in engine.
+		memset(pOutputPvs, 0xFF, iSize);
+		return iSize;
+	}
+
+	// Run length encoding of zeros: 0 byte is followed by amount of zero bytes.
+	const int* aOffsets = (const int*)&m_aVisibility[sizeof(int)];
+	const unsigned char* pIn = &m_aVisibility[0] + aOffsets[2 * iCluster]; // PVS, then PAS.
+	const unsigned char* pInEnd = &m_aVisibility[0] + m_aVisibility.size();
+	unsigned char* pOut = pOutputPvs;
+	unsigned char* pOutEnd = pOutputPvs + iSize;
+	while ( (pOut < pOutEnd) && (pIn < pInEnd) )
+	{
+		if ( *pIn )
+		{
+			*pOut++ = *pIn++;
+			continue;
+		}
+		if ( pIn + 1 >= pInEnd )
+			break;
+		int iZeros = pIn[1];
+		pIn += 2;
+		for ( ; (iZeros > 0) && (pOut < pOutEnd); --iZeros )
+			*pOut++ = 0;
+	}
+	if ( pOut < pOutEnd )
+		memset(pOut, 0, pOutEnd - pOut);
+	return iSize;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CBspFile::CheckOriginInPVS( const Vector& vPos, const unsigned char* pCheckPvs, int iCheckPvsSize ) const
+{
+	int iCluster = GetClusterForOrigin(vPos);
+	if ( (iCluster < 0) || ((iCluster >> 3) >= iCheckPvsSize) )
+		return true;
+	return (pCheckPvs[iCluster >> 3] & (1 << (iCluster & 7))) != 0;
+}
@@ -0,0 +1,184 @@
+//----------------------------------------------------------------------------------------------------------------
+// Reader of Source engine .bsp files: planes, nodes, leafs, brushes and PVS clusters, with line and hull traces
+// against brush BSP. Doesn't need the engine, so tables can be precomputed offline and on many threads.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#ifndef __BSP_FILE_H__
+#define __BSP_FILE_H__
+
+
+#include "good/vector.h"
+
+#include "sdk/harness_sdk.h"
+
+
+#define BSP_IDENT           (('P'<<24) + ('S'<<16) + ('B'<<8) + 'V') ///< "VBSP".
+#define BSP_HEADER_LUMPS    64
+
+/// Lumps used by reader (indices in header).
+enum TBspLump
+{
+	EBspLumpPlanes = 1,
+	EBspLumpVisibility = 4,
+	EBspLumpNodes = 5,
+	EBspLumpLeafs = 10,
+	EBspLumpModels = 14,
+	EBspLumpLeafBrushes = 17,
+	EBspLumpBrushes = 18,
+	EBspLumpBrushSides = 19,
+};
+
+#define BSP_DIST_EPSILON    0.03125f         ///< Traces stop this far from brush surfaces.
+#define BSP_LEAF_SIZE_V0    56               ///< Size of leaf in lump version 0 (has ambient lighting cube).
+#define BSP_LEAF_SIZE_V1    32               ///< Size of leaf in lump version 1.
+
+
+//****************************************************************************************************************
+// Structures of .bsp file (see public/bspfile.h of Source SDK).
+//****************************************************************************************************************
+typedef struct
+{
+	int fileofs, filelen;
+	int version;
+	char fourCC[4];
+} bsp_lump_t;
+
+typedef struct
+{
+	int ident;
+	int version;
+	bsp_lump_t lumps[BSP_HEADER_LUMPS];
+	int mapRevision;
+} bsp_header_t;
+
+typedef struct
+{
+	Vector normal;
+	float dist;
+	int type;                                // 0..2 for axial planes, 3..5 for non axial (major axis).
+} bsp_plane_t;
+
+typedef struct
+{
+	int planenum;
+	int children[2];                         // Negative numbers are -(leaf + 1), 0 is front of plane.
+	short mins[3], maxs[3];
+	unsigned short firstface, numfaces;
+	short area;
+	short padding;
+} bsp_node_t;
+
+typedef struct
+{
+	Vector mins, maxs;
+	Vector origin;
+	int headnode;
+	int firstface, numfaces;
+} bsp_model_t;
+
+typedef struct
+{
+	int firstside;
+	int numsides;
+	int contents;
+} bsp_brush_t;
+
+typedef struct
+{
+	unsigned short planenum;
+	short texinfo;
+	short dispinfo;
+	unsigned char bevel;
+	unsigned char thin;
+} bsp_brushside_t;
+
+/// Leaf, fields that reader uses (leafs have different size in different lump versions).
+typedef struct
+{
+	int contents;
+	int cluster;                             // -1 if leaf is outside of map or solid.
+	int firstleafbrush, numleafbrushes;
+} bsp_leaf_t;
+
+
+//****************************************************************************************************************
+/// Brush BSP of .bsp file. After Load() all methods are const and can be called from several threads.
+//****************************************************************************************************************
+class CBspFile
+{
+public:
+	/// Constructor.
+	CBspFile(): m_iClusters(0), m_iHeadNode(0), m_vMins(0, 0, 0), m_vMaxs(0, 0, 0) {}
+
+	/// Load planes, nodes, leafs, brushes and visibility of .bsp file. Return false on error (message to stderr).
+	bool Load( const char* szFileName );
+
+	/// Return true if file is loaded.
+	bool IsLoaded() const { return m_aNodes.size() > 0; }
+
+	/// Get bounding box of world model.
+	const Vector& GetMins() const { return m_vMins; }
+	const Vector& GetMaxs() const { return m_vMaxs; }
+
+	/// Get amount of brushes.
+	int GetBrushesCount() const { return m_aBrushes.size(); }
+
+	/// Clip ray (or hull) against brushes with contents in fMask. If hit is closer than fFraction, update fFraction,
+	/// vNormal and iContents and return true. Start in solid sets bStartSolid (and fFraction to 0 if trace never
+	/// gets out), as engine does.
+	bool TraceRay( const Ray_t& ray, unsigned int fMask, float& fFraction, Vector& vNormal, int& iContents,
+	               bool& bStartSolid ) const;
+
+	/// Get contents of point (contents of leaf and of brushes that contain point).
+	int GetPointContents( const Vector& vPos ) const;
+
+	/// Get leaf index of point.
+	int GetLeaf( const Vector& vPos ) const;
+
+	/// Get amount of clusters.
+	int GetClusterCount() const { return m_iClusters; }
+
+	/// Get cluster of point, -1 if point is outside of map.
+	int GetClusterForOrigin( const Vector& vPos ) const;
+
+	/// Decompress PVS of cluster to pOutputPvs. Return amount of bytes written.
+	int GetPVSForCluster( int iCluster, int iOutputPvsLength, unsigned char* pOutputPvs ) const;
+
+	/// Return true if cluster of point is set in PVS.
+	bool CheckOriginInPVS( const Vector& vPos, const unsigned char* pCheckPvs, int iCheckPvsSize ) const;
+
+protected:
+	// State of one trace.
+	typedef struct
+	{
+		Vector vStart, vEnd, vExtents;
+		bool bIsRay;
+		unsigned int fMask;
+		float fFraction;
+		Vector vNormal;
+		int iContents;
+		bool bStartSolid, bAllSolid, bHit;
+	} trace_work_t;
+
+	template <typename T>
+	bool ReadLump( const char* pFile, int iFileSize, int iLump, good::vector<T>& aResult );
+
+	void RecursiveHullCheck( trace_work_t& cWork, int iNode, float p1f, float p2f, const Vector& p1, const Vector& p2 ) const;
+	void TraceToLeaf( trace_work_t& cWork, int iLeaf ) const;
+	void ClipBoxToBrush( trace_work_t& cWork, const bsp_brush_t& cBrush ) const;
+
+	good::vector<bsp_plane_t> m_aPlanes;
+	good::vector<bsp_node_t> m_aNodes;
+	good::vector<bsp_leaf_t> m_aLeafs;
+	good::vector<unsigned short> m_aLeafBrushes;
+	good::vector<bsp_brush_t> m_aBrushes;
+	good::vector<bsp_brushside_t> m_aBrushSides;
+	good::vector<unsigned char> m_aVisibility; // Visibility lump: clusters count, offsets, compressed PVS rows.
+	int m_iClusters;
+	int m_iHeadNode;
+	Vector m_vMins, m_vMaxs;
+};
+
+
+#endif // __BSP_FILE_H__
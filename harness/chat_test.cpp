@@ -0,0 +1,124 @@
+//----------------------------------------------------------------------------------------------------------------
+// Test of chat: splitting of text with several requests, and amount of word comparisons made for it.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#include <stdio.h>
+
+#include "good/string_buffer.h"
+
+#include "chat.h"
+#include "type2string.h"
+
+#include "chat_test.h"
+
+
+//----------------------------------------------------------------------------------------------------------------
+// Phrases of test, in format of [Chat.sentences] section of config.ini.
+static const char* aChats[][2] =
+{
+	{ "greeting", "hello ($player)." },
+	{ "stop",     "($player) stop (now)." },
+	{ "come",     "($player) come here." },
+	{ "follow",   "($player) follow me." },
+	{ "attack",   "attack $player." },
+	{ "jump",     "($player) jump." },
+};
+
+static const char* aPlayers[] = { "walker", "runner" };
+
+// Text and requests that must be found in it, with index of player they are directed to.
+typedef struct
+{
+	const char* szText;
+	int iRequests;
+	TBotChat aRequests[3];
+	int aDirectedTo[3];
+} CChatTestCase;
+
+static const CChatTestCase aCases[] =
+{
+	{ "follow me and stop",                        2, { EBotChatFollow, EBotChatStop },                 { -1, -1 } },
+	{ "walker follow me and then come here",       2, { EBotChatFollow, EBotChatCome },                 { 0, 0 } },
+	{ "hi runner. attack walker, runner jump",     3, { EBotChatGreeting, EBotChatAttack, EBotChatJump }, { 1, 0, 1 } },
+	{ "stop now please come here",                 2, { EBotChatStop, EBotChatCome },                   { -1, -1 } },
+	{ "nothing to see here",                       0, {},                                               {} },
+};
+
+
+//----------------------------------------------------------------------------------------------------------------
+static const good::string& RequestsToString( const good::vector<CBotChat>& aRequests )
+{
+	static good::string_buffer sbResult(256);
+	sbResult.erase();
+	for ( int i = 0; i < aRequests.size(); ++i )
+	{
+		if ( i > 0 )
+			sbResult.append(", ");
+		sbResult.append( CTypeToString::BotCommandToString(aRequests[i].iBotChat) );
+		if ( aRequests[i].iDirectedTo != -1 )
+		{
+			sbResult.append(" -> ");
+			sbResult.append( aPlayers[ aRequests[i].iDirectedTo ] );
+		}
+	}
+	return sbResult;
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+int CHarnessChatTest::Run( bool bVerbose )
+{
+	CChat::AddSynonims( "hello", good::string("hi.hey", true) ); // Value is escaped in place.
+	for ( int i = 0; i < (int)(sizeof(aChats) / sizeof(aChats[0])); ++i )
+		CChat::AddChat( aChats[i][0], aChats[i][1] );
+	TChatVariable iVar = CChat::AddVariable("$player");
+	for ( int i = 0; i < (int)(sizeof(aPlayers) / sizeof(aPlayers[0])); ++i )
+		CChat::AddVariableValue( iVar, aPlayers[i] );
+	CChat::Compile();
+
+	int iErrors = 0;
+	good::vector<CBotChat> aRequests;
+
+	// Requests found in text.
+	for ( int iCase = 0; iCase < (int)(sizeof(aCases) / sizeof(aCases[0])); ++iCase )
+	{
+		const CChatTestCase& cCase = aCases[iCase];
+		aRequests.clear();
+		CChat::ChatsFromText( cCase.szText, aRequests );
+
+		bool bCorrect = ( aRequests.size() == cCase.iRequests );
+		for ( int i = 0; bCorrect && (i < aRequests.size()); ++i )
+			bCorrect = (aRequests[i].iBotChat == cCase.aRequests[i]) && (aRequests[i].iDirectedTo == cCase.aDirectedTo[i]);
+		if ( !bCorrect )
+		{
+			printf("Chat test: wrong requests for '%s': %s.\n", cCase.szText, RequestsToString(aRequests).c_str());
+			iErrors++;
+		}
+		else if ( bVerbose )
+			printf("Chat test: '%s': %s.\n", cCase.szText, RequestsToString(aRequests).c_str());
+	}
+
+	// Long text: all requests must be found, with word comparisons bounded by amount of words (not its square).
+	good::string_buffer sbText(4096);
+	for ( int iWords = 4; iWords <= 256; iWords *= 2 )
+	{
+		sbText.erase();
+		for ( int i = 0; i < iWords / 4; ++i )
+			sbText.append("follow me and stop ");
+		aRequests.clear();
+		CChat::ChatsFromText( sbText, aRequests );
+
+		int iCost = CChat::GetMatchCost(), iBound = CChat::GetMatchCostBound(iWords);
+		if ( (aRequests.size() != iWords / 2) || (iCost > iBound) )
+		{
+			printf("Chat test: %d words, %d requests found instead of %d, %d word comparisons (bound %d).\n",
+			       iWords, aRequests.size(), iWords / 2, iCost, iBound);
+			iErrors++;
+		}
+		else if ( bVerbose )
+			printf("Chat test: %d words, %d requests, %d word comparisons (bound %d).\n", iWords, aRequests.size(), iCost, iBound);
+	}
+
+	return iErrors;
+}
@@ -0,0 +1,21 @@
+//----------------------------------------------------------------------------------------------------------------
+// Test of chat: splitting of text with several requests, and amount of word comparisons made for it.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#ifndef __HARNESS_CHAT_TEST_H__
+#define __HARNESS_CHAT_TEST_H__
+
+
+//****************************************************************************************************************
+/// Chat test. Adds its own phrases and $player values, so plugin's chat can't be used after it.
+//****************************************************************************************************************
+class CHarnessChatTest
+{
+public:
+	/// Run test. Return amount of errors.
+	static int Run( bool bVerbose );
+};
+
+
+#endif // __HARNESS_CHAT_TEST_H__
@@ -0,0 +1,1317 @@
+//----------------------------------------------------------------------------------------------------------------
+// Headless engine stand-in, see harness_engine.h.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#include <ctype.h>
+
+#include "good/file.h"
+#include "good/string_buffer.h"
+
+#include "players.h"
+#include "source_engine.h"
+#include "waypoint.h"
+
+#include "harness_engine.h"
+#include "harness_world.h"
+
+
+extern void* HarnessGetPluginInterface();
+
+#define PLUGIN() ( (IServerPluginCallbacks*)HarnessGetPluginInterface() )
+
+
+//----------------------------------------------------------------------------------------------------------------
+// CHarness static members.
+//----------------------------------------------------------------------------------------------------------------
+bool CHarness::bQuiet = false;
+good::string CHarness::sGameDir;
+good::string CHarness::sMapName("harness");
+
+int CHarness::iMaxPlayers = 16;
+int CHarness::iFrame = 0;
+float CHarness::fInterval = 1.0f / 66.0f;
+float CHarness::fTime = 0.0f;
+bool CHarness::bMapLoaded = false;
+unsigned int CHarness::iRandomSeed = 1;
+
+CBspFile CHarness::cBsp;
+bool CHarness::bUseBsp = false;
+
+float CHarness::fGroundHeight = 0.0f;
+bool CHarness::bGround = false;
+float CHarness::fItemRespawnTime = 20.0f;
+float CHarness::fPlayerRespawnTime = 2.0f;
+
+edict_t CHarness::aEdicts[MAX_EDICTS];
+int CHarness::iEdictCount = 1;
+CHarnessPlayer CHarness::aPlayers[HARNESS_MAX_PLAYERS];
+good::vector<Vector> CHarness::aSpawnPoints;
+
+good::vector<CHarness::action_t> CHarness::m_aActions;
+float CHarness::m_aItemRespawns[MAX_EDICTS];
+int CHarness::m_iNextUserId = 2;
+
+static CBaseEntity cWorldEntity;
+static CGlobalVars cGlobalVars;
+
+
+//================================================================================================================
+// Engine server.
+//================================================================================================================
+class CHarnessEngineServer: public IVEngineServer
+{
+public:
+	void ServerCommand( const char* szCommand )
+	{
+		int iUserId;
+		if ( sscanf(szCommand, "kickid %d", &iUserId) == 1 )
+		{
+			char szUserId[16];
+			sprintf(szUserId, "%d", iUserId);
+			CHarnessPlayer* pPlayer = CHarness::FindPlayer(szUserId);
+			if ( pPlayer )
+				CHarness::DisconnectPlayer(pPlayer);
+		}
+		else
+			CHarness::ExecuteCommand(szCommand);
+	}
+
+	int PrecacheModel( const char* szModel, bool bPreload ) { return ++m_iModels; }
+
+	// Without .bsp file every point is visible from any other.
+	int GetClusterCount() { return CHarness::bUseBsp ? CHarness::cBsp.GetClusterCount() : 0; }
+	int GetClusterForOrigin( const Vector& vOrigin ) { return CHarness::bUseBsp ? CHarness::cBsp.GetClusterForOrigin(vOrigin) : 0; }
+	int GetPVSForCluster( int iCluster, int iOutputPvsLength, unsigned char* pOutputPvs )
+	{
+		if ( CHarness::bUseBsp )
+			return CHarness::cBsp.GetPVSForCluster(iCluster, iOutputPvsLength, pOutputPvs);
+		memset(pOutputPvs, 0xFF, iOutputPvsLength);
+		return iOutputPvsLength;
+	}
+	bool CheckOriginInPVS( const Vector& vOrigin, const unsigned char* pCheckPvs, int iCheckPvsSize )
+	{
+		return !CHarness::bUseBsp || CHarness::cBsp.CheckOriginInPVS(vOrigin, pCheckPvs, iCheckPvsSize);
+	}
+
+	int GetPlayerUserId( const edict_t* pEdict )
+	{
+		CHarnessPlayer* pPlayer = CHarness::GetPlayer(pEdict);
+		return pPlayer ? pPlayer->m_iUserId : -1;
+	}
+
+	bool IsDedicatedServer() { return true; }
+	int IndexOfEdict( const edict_t* pEdict ) { return pEdict ? (int)(pEdict - CHarness::aEdicts) : 0; }
+	edict_t* PEntityOfEntIndex( int iEntIndex ) { return ( (0 <= iEntIndex) && (iEntIndex < MAX_EDICTS) ) ? &CHarness::aEdicts[iEntIndex] : NULL; }
+	int GetEntityCount() { return CHarness::iEdictCount; }
+
+	void ClientPrintf( edict_t* pEdict, const char* szMessage )
+	{
+		if ( !CHarness::bQuiet )
+			fputs(szMessage, stdout);
+	}
+
+	float Time() { return CHarness::fTime; }
+
+	bf_write* UserMessageBegin( IRecipientFilter* pFilter, int iMsgType ) { return &m_cMessage; }
+	void MessageEnd() {}
+
+	void GetGameDir( char* szGetGameDir, int iMaxLength ) { Q_strncpy(szGetGameDir, CHarness::sGameDir.c_str(), iMaxLength); }
+	const char* GetClientConVarValue( int iClientIndex, const char* szName ) { return ""; }
+	void SetFakeClientConVarValue( edict_t* pEdict, const char* szCvar, const char* szValue ) {}
+
+	int Cmd_Argc() { return 0; }
+	const char* Cmd_Argv( int iArg ) { return ""; }
+
+protected:
+	int m_iModels;
+	bf_write m_cMessage;
+};
+
+static CHarnessEngineServer cEngineServer;
+
+
+//================================================================================================================
+// Engine trace: ground plane and world brushes (or .bsp file), and solid entities (doors, props) as axis aligned
+// boxes.
+//================================================================================================================
+inline bool IsSolidEntity( const CBaseEntity* pEntity )
+{
+	return (strncmp(pEntity->m_szClassName, "func_", 5) == 0) || (strncmp(pEntity->m_szClassName, "prop_", 5) == 0);
+}
+
+class CHarnessEngineTrace: public IEngineTrace
+{
+public:
+	int GetPointContents( const Vector& vPos, IHandleEntity** ppEntity )
+	{
+		if ( ppEntity )
+			*ppEntity = NULL;
+		if ( CHarness::bUseBsp )
+		{
+			int iContents = CHarness::cBsp.GetPointContents(vPos);
+			if ( iContents )
+				return iContents;
+		}
+		else if ( (CHarness::bGround && (vPos.z < CHarness::fGroundHeight)) || CHarnessWorld::IsSolid(vPos) )
+			return CONTENTS_SOLID;
+
+		for ( int i = CHarness::iMaxPlayers + 1; i < CHarness::iEdictCount; ++i )
+		{
+			CBaseEntity* pEntity = CHarness::aEdicts[i].m_pEntity;
+			if ( CHarness::aEdicts[i].IsFree() || !IsSolidEntity(pEntity) )
+				continue;
+
+			Vector vMins = pEntity->m_vOrigin + pEntity->m_vMins, vMaxs = pEntity->m_vOrigin + pEntity->m_vMaxs;
+			if ( (vMins.x <= vPos.x) && (vPos.x <= vMaxs.x) && (vMins.y <= vPos.y) && (vPos.y <= vMaxs.y) &&
+			     (vMins.z <= vPos.z) && (vPos.z <= vMaxs.z) )
+			{
+				if ( ppEntity )
+					*ppEntity = pEntity;
+				return CONTENTS_SOLID;
+			}
+		}
+		return CONTENTS_EMPTY;
+	}
+
+	void TraceRay( const Ray_t& ray, unsigned int fMask, ITraceFilter* pTraceFilter, trace_t* pTrace )
+	{
+		memset(pTrace, 0, sizeof(trace_t));
+		pTrace->fraction = 1.0f;
+		pTrace->startpos = ray.m_Start + ray.m_StartOffset;
+
+		TraceType_t iType = pTraceFilter ? pTraceFilter->GetTraceType() : TRACE_EVERYTHING;
+		Vector vNormal(0, 0, 0);
+		bool bStartSolid = false;
+
+		if ( (iType != TRACE_ENTITIES_ONLY) && CHarness::bUseBsp )
+		{
+			int iContents;
+			if ( CHarness::cBsp.TraceRay(ray, fMask, pTrace->fraction, vNormal, iContents, bStartSolid) )
+				pTrace->contents = iContents;
+		}
+		else if ( iType != TRACE_ENTITIES_ONLY )
+		{
+			if ( CHarness::bGround )
+			{
+				Vector vMins(-CUtil::iMaxMapSize, -CUtil::iMaxMapSize, -CUtil::iMaxMapSize);
+				Vector vMaxs(CUtil::iMaxMapSize, CUtil::iMaxMapSize, CHarness::fGroundHeight);
+				if ( CHarness::ClipRayToBox(ray, vMins, vMaxs, pTrace->fraction, vNormal, bStartSolid) )
+					pTrace->contents = CONTENTS_SOLID;
+			}
+			if ( CHarnessWorld::TraceRay(ray, pTrace->fraction, vNormal, bStartSolid) )
+				pTrace->contents = CONTENTS_SOLID;
+		}
+
+		if ( iType != TRACE_WORLD_ONLY )
+		{
+			for ( int i = CHarness::iMaxPlayers + 1; i < CHarness::iEdictCount; ++i )
+			{
+				CBaseEntity* pEntity = CHarness::aEdicts[i].m_pEntity;
+				if ( CHarness::aEdicts[i].IsFree() || !IsSolidEntity(pEntity) ||
+				     (pTraceFilter && !pTraceFilter->ShouldHitEntity(pEntity, fMask)) )
+					continue;
+
+				if ( CHarness::ClipRayToBox(ray, pEntity->m_vOrigin + pEntity->m_vMins, pEntity->m_vOrigin + pEntity->m_vMaxs,
+				                            pTrace->fraction, vNormal, bStartSolid) )
+				{
+					pTrace->contents = CONTENTS_SOLID;
+					pTrace->m_pEnt = pEntity;
+				}
+			}
+		}
+
+		pTrace->startsolid = pTrace->allsolid = bStartSolid;
+		pTrace->plane.normal = vNormal;
+		pTrace->endpos = pTrace->startpos + ray.m_Delta * pTrace->fraction;
+	}
+};
+
+static CHarnessEngineTrace cEngineTrace;
+
+
+//================================================================================================================
+// Game events.
+//================================================================================================================
+//****************************************************************************************************************
+/// IGameEvent over KeyValues.
+//****************************************************************************************************************
+class CHarnessGameEvent: public IGameEvent
+{
+public:
+	CHarnessGameEvent( KeyValues* pData, bool bOwner ): m_pData(pData), m_bOwner(bOwner) {}
+	~CHarnessGameEvent() { if ( m_bOwner && m_pData ) m_pData->deleteThis(); }
+
+	const char* GetName() const { return m_pData->GetName(); }
+
+	bool IsEmpty( const char* szKeyName ) { return m_pData->FindKey(szKeyName) == NULL; }
+	bool GetBool( const char* szKeyName, bool bDefaultValue ) { return m_pData->GetBool(szKeyName, bDefaultValue); }
+	int GetInt( const char* szKeyName, int iDefaultValue ) { return m_pData->GetInt(szKeyName, iDefaultValue); }
+	float GetFloat( const char* szKeyName, float fDefaultValue ) { return m_pData->GetFloat(szKeyName, fDefaultValue); }
+	const char* GetString( const char* szKeyName, const char* szDefaultValue ) { return m_pData->GetString(szKeyName, szDefaultValue); }
+
+	void SetBool( const char* szKeyName, bool bValue ) { m_pData->SetBool(szKeyName, bValue); }
+	void SetInt( const char* szKeyName, int iValue ) { m_pData->SetInt(szKeyName, iValue); }
+	void SetFloat( const char* szKeyName, float fValue ) { m_pData->SetFloat(szKeyName, fValue); }
+	void SetString( const char* szKeyName, const char* szValue ) { m_pData->SetString(szKeyName, szValue); }
+
+	/// Take data away from event.
+	KeyValues* Detach() { KeyValues* pData = m_pData; m_pData = NULL; return pData; }
+
+protected:
+	KeyValues* m_pData;
+	bool m_bOwner;
+};
+
+//----------------------------------------------------------------------------------------------------------------
+static good::vector<IGameEventListener*> aListeners;
+static good::vector<IGameEventListener2*> aListeners2;
+static good::vector<good::string> aListeners2Events;
+
+class CHarnessGameEventManager: public IGameEventManager
+{
+public:
+	bool AddListener( IGameEventListener* pListener, const char* szEvent, bool bIsServerSide ) { return AddListener(pListener, bIsServerSide); }
+	bool AddListener( IGameEventListener* pListener, bool bIsServerSide )
+	{
+		if ( good::find(aListeners, pListener) == aListeners.end() )
+			aListeners.push_back(pListener);
+		return true;
+	}
+
+	void RemoveListener( IGameEventListener* pListener )
+	{
+		good::vector<IGameEventListener*>::iterator it = good::find(aListeners, pListener);
+		if ( it != aListeners.end() )
+			aListeners.erase(it);
+	}
+
+	KeyValues* GetEvent( const char* szName ) { return new KeyValues(szName); }
+	bool FireEvent( KeyValues* pEvent ) { CHarness::FireEvent(pEvent); return true; }
+};
+
+class CHarnessGameEventManager2: public IGameEventManager2
+{
+public:
+	bool AddListener( IGameEventListener2* pListener, const char* szName, bool bServerSide )
+	{
+		aListeners2.push_back(pListener);
+		aListeners2Events.push_back( good::string(szName).duplicate() );
+		return true;
+	}
+
+	void RemoveListener( IGameEventListener2* pListener )
+	{
+		for ( int i = aListeners2.size() - 1; i >= 0; --i )
+			if ( aListeners2[i] == pListener )
+			{
+				aListeners2.erase( aListeners2.begin() + i );
+				aListeners2Events.erase( aListeners2Events.begin() + i );
+			}
+	}
+
+	IGameEvent* CreateEvent( const char* szName, bool bForce ) { return new CHarnessGameEvent(new KeyValues(szName), true); }
+
+	bool FireEvent( IGameEvent* pEvent, bool bDontBroadcast )
+	{
+		CHarness::FireEvent( ((CHarnessGameEvent*)pEvent)->Detach() );
+		delete pEvent;
+		return true;
+	}
+
+	void FreeEvent( IGameEvent* pEvent ) { delete pEvent; }
+};
+
+static CHarnessGameEventManager cGameEventManager;
+static CHarnessGameEventManager2 cGameEventManager2;
+
+
+//================================================================================================================
+// Console.
+//================================================================================================================
+static ConVar cTeamplay("mp_teamplay", "0");
+
+class CHarnessCvar: public ICvar
+{
+public:
+	CHarnessCvar() { m_aVars.push_back(&cTeamplay); }
+
+	void RegisterConCommand( ConCommandBase* pCommandBase ) { m_aCommands.push_back( (ConCommand*)pCommandBase ); }
+
+	void UnregisterConCommand( ConCommandBase* pCommandBase )
+	{
+		good::vector<ConCommand*>::iterator it = good::find(m_aCommands, (ConCommand*)pCommandBase);
+		if ( it != m_aCommands.end() )
+			m_aCommands.erase(it);
+	}
+
+	ConVar* FindVar( const char* szVarName )
+	{
+		for ( int i = 0; i < m_aVars.size(); ++i )
+			if ( Q_stricmp(m_aVars[i]->GetName(), szVarName) == 0 )
+				return m_aVars[i];
+		return NULL;
+	}
+
+	ConCommand* FindCommand( const char* szName )
+	{
+		for ( int i = 0; i < m_aCommands.size(); ++i )
+			if ( Q_stricmp(m_aCommands[i]->GetName(), szName) == 0 )
+				return m_aCommands[i];
+		return NULL;
+	}
+
+protected:
+	good::vector<ConCommand*> m_aCommands;
+	good::vector<ConVar*> m_aVars;
+};
+
+static CHarnessCvar cCvar;
+
+
+//================================================================================================================
+// Game server interfaces.
+//================================================================================================================
+class CHarnessPlayerInfoManager: public IPlayerInfoManager
+{
+public:
+	IPlayerInfo* GetPlayerInfo( edict_t* pEdict ) { return CHarness::GetPlayer(pEdict); }
+	CGlobalVars* GetGlobalVars() { return &cGlobalVars; }
+};
+
+class CHarnessBotManager: public IBotManager
+{
+public:
+	IBotController* GetBotController( edict_t* pEdict )
+	{
+		CHarnessPlayer* pPlayer = CHarness::GetPlayer(pEdict);
+		return ( pPlayer && pPlayer->m_bBot ) ? pPlayer : NULL;
+	}
+
+	edict_t* CreateBot( const char* szBotName )
+	{
+		CHarnessPlayer* pPlayer = CHarness::ConnectPlayer(szBotName, true);
+		return pPlayer ? pPlayer->m_pEdict : NULL;
+	}
+};
+
+class CHarnessGameClients: public IServerGameClients
+{
+public:
+	void ClientEarPosition( edict_t* pEdict, Vector* pEarOrigin )
+	{
+		CHarnessPlayer* pPlayer = CHarness::GetPlayer(pEdict);
+		if ( pPlayer )
+		{
+			*pEarOrigin = pPlayer->m_vOrigin;
+			pEarOrigin->z += pPlayer->m_bDucking ? CUtil::iPlayerEyeLevelCrouched : CUtil::iPlayerEyeLevel;
+		}
+		else
+			*pEarOrigin = pEdict->m_pEntity->m_vOrigin;
+	}
+};
+
+class CHarnessPluginHelpers: public IServerPluginHelpers
+{
+public:
+	void CreateMessage( edict_t* pEdict, DIALOG_TYPE iType, KeyValues* pData, IServerPluginCallbacks* pPlugin ) {}
+	void ClientCommand( edict_t* pEdict, const char* szCmd ) {}
+};
+
+class CHarnessFileSystem: public IFileSystem
+{
+public:
+	bool GetCurrentDirectory( char* szDirectory, int iMaxLength )
+	{
+		Q_strncpy(szDirectory, CHarness::sGameDir.c_str(), iMaxLength);
+		char* szLast = strrchr(szDirectory, PATH_SEPARATOR);
+		if ( szLast )
+			*szLast = 0; // Remove mod folder.
+		return true;
+	}
+};
+
+class CHarnessEffects: public IEffects
+{
+public:
+	void Beam( const Vector& Start, const Vector& End, int nModelIndex, int nHaloIndex, unsigned char frameStart,
+	           unsigned char frameRate, float flLife, unsigned char width, unsigned char endWidth,
+	           unsigned char fadeLength, unsigned char noise, unsigned char red, unsigned char green,
+	           unsigned char blue, unsigned char brightness, unsigned char speed ) {}
+};
+
+class CHarnessDebugOverlay: public IVDebugOverlay
+{
+public:
+	void AddBoxOverlay( const Vector& origin, const Vector& mins, const Vector& max, QAngle const& orientation,
+	                    int r, int g, int b, int a, float duration ) {}
+	void AddLineOverlay( const Vector& origin, const Vector& dest, int r, int g, int b, bool noDepthTest, float duration ) {}
+	void AddTextOverlay( const Vector& origin, int line_offset, float duration, const char* format, ... ) {}
+};
+
+static CHarnessPlayerInfoManager cPlayerInfoManager;
+static CHarnessBotManager cBotManager;
+static CHarnessGameClients cGameClients;
+static CHarnessPluginHelpers cPluginHelpers;
+static CHarnessFileSystem cFileSystem;
+static CHarnessEffects cEffects;
+static CHarnessDebugOverlay cDebugOverlay;
+
+
+//================================================================================================================
+// CHarnessPlayer.
+//================================================================================================================
+void CHarnessPlayer::Reset()
+{
+	m_sName = "";
+	m_szNetworkId[0] = 0;
+	m_iUserId = -1;
+	m_iTeam = 0;
+	m_bBot = m_bConnected = m_bDead = m_bDucking = m_bNeedSpawnEvent = false;
+	m_iHealth = m_iArmor = m_iFrags = m_iDeaths = 0;
+	m_vOrigin.Init();
+	m_vVelocity.Init();
+	m_angAngles.Init();
+	m_sWeapon = "";
+	m_cLastCmd.Reset();
+	m_fRespawnTime = 0.0f;
+	m_aPath.clear();
+	m_iPathPoint = 0;
+	m_fSpeed = CUtil::fMaxRunVelocity;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CHarnessPlayer::Spawn()
+{
+	if ( m_aPath.size() > 0 ) // Scripted human starts at first point of path.
+	{
+		m_vOrigin = m_aPath[0];
+		m_iPathPoint = 0;
+	}
+	else if ( CHarness::aSpawnPoints.size() > 0 )
+		m_vOrigin = CHarness::aSpawnPoints[ CHarness::Random(CHarness::aSpawnPoints.size()) ];
+	else if ( CWaypoints::Size() > 0 )
+	{
+		m_vOrigin = CWaypoints::Get( CHarness::Random(CWaypoints::Size()) ).vOrigin;
+		m_vOrigin.z -= CUtil::iPlayerEyeLevel;
+	}
+	else
+		m_vOrigin.Init(0, 0, CHarness::fGroundHeight);
+
+	m_angAngles.Init( 0, (float)CHarness::Random(360) - 180.0f, 0 );
+	m_cLastCmd.Reset();
+	m_cLastCmd.viewangles = m_angAngles;
+	m_vVelocity.Init();
+	m_iHealth = 100;
+	m_iArmor = 0;
+	m_bDead = m_bDucking = false;
+	SyncEntity();
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CHarnessPlayer::SetPath( const char* szPoints )
+{
+	m_aPath.clear();
+	Vector v;
+	int iRead;
+	while ( sscanf(szPoints, "%f %f %f%n", &v.x, &v.y, &v.z, &iRead) == 3 )
+	{
+		m_aPath.push_back(v);
+		szPoints += iRead;
+	}
+	while ( isspace(*szPoints) )
+		szPoints++;
+	return (m_aPath.size() > 0) && (*szPoints == 0);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CHarnessPlayer::SyncEntity()
+{
+	m_cEntity.m_vOrigin = m_vOrigin;
+	m_cEntity.m_angAngles = m_angAngles;
+	m_cEntity.m_vMins = GetPlayerMins();
+	m_cEntity.m_vMaxs = GetPlayerMaxs();
+	m_cEntity.m_iHealth = m_iHealth;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CHarnessPlayer::Move( float fInterval )
+{
+	if ( m_bDead )
+	{
+		if ( CHarness::fTime >= m_fRespawnTime )
+		{
+			Spawn();
+			m_bNeedSpawnEvent = true;
+		}
+		return;
+	}
+
+	if ( m_bBot || (m_aPath.size() == 0) ) // Bots move in RunPlayerMove().
+		return;
+
+	// Scripted human walks to next point of path, in 3D (path defines height).
+	Vector vDir = m_aPath[m_iPathPoint] - m_vOrigin;
+	float fDist = vDir.NormalizeInPlace();
+	float fStep = m_fSpeed * fInterval;
+	if ( fDist <= fStep )
+	{
+		m_vOrigin = m_aPath[m_iPathPoint];
+		m_iPathPoint = (m_iPathPoint + 1) % m_aPath.size();
+	}
+	else
+		m_vOrigin += vDir * fStep;
+
+	m_vVelocity = vDir * m_fSpeed;
+	if ( fDist > 0 )
+		VectorAngles(vDir, m_angAngles);
+	m_cLastCmd.viewangles = m_angAngles;
+	SyncEntity();
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CHarnessPlayer::RunPlayerMove( CBotCmd* pCmd )
+{
+	m_cLastCmd = *pCmd;
+	m_angAngles = pCmd->viewangles;
+	m_bDucking = FLAG_SOME_SET(IN_DUCK, pCmd->buttons);
+	if ( m_bDead || !m_bConnected )
+		return;
+
+	// Walk on the plane of yaw, like engine does for players on ground.
+	Vector vForward, vRight;
+	AngleVectors( QAngle(0, pCmd->viewangles.y, 0), &vForward, &vRight );
+	Vector vWish = vForward * pCmd->forwardmove + vRight * pCmd->sidemove;
+	vWish.z = 0;
+
+	float fMaxSpeed = m_bDucking ? CUtil::fMaxCrouchVelocity : CUtil::fMaxSprintVelocity;
+	float fWishSpeed = vWish.NormalizeInPlace();
+	if ( fWishSpeed > fMaxSpeed )
+		fWishSpeed = fMaxSpeed;
+
+	// Ground friction and acceleration with default sv_friction, sv_stopspeed and sv_accelerate, as in game
+	// movement. Bots steer by difference of needed and current velocity, so velocity can't change instantly.
+	const float fFriction = 4.0f, fStopSpeed = 100.0f, fAccelerate = 10.0f;
+	float fSpeed = m_vVelocity.Length();
+	if ( fSpeed > 0.1f )
+	{
+		float fDrop = MAX2(fSpeed, fStopSpeed) * fFriction * CHarness::fInterval;
+		m_vVelocity *= MAX2(fSpeed - fDrop, 0.0f) / fSpeed;
+	}
+	else
+		m_vVelocity.Init();
+
+	float fAddSpeed = fWishSpeed - m_vVelocity.Dot(vWish);
+	if ( fAddSpeed > 0 )
+		m_vVelocity += vWish * MIN2(fAddSpeed, fAccelerate * fWishSpeed * CHarness::fInterval);
+
+	Vector vPrevOrigin = m_vOrigin;
+	CHarness::MovePlayer(this, m_vVelocity * CHarness::fInterval);
+	m_vVelocity = (m_vOrigin - vPrevOrigin) / CHarness::fInterval; // Obstacles stop player.
+	m_vVelocity.z = 0;
+	SyncEntity();
+}
+
+
+//================================================================================================================
+// CHarness.
+//================================================================================================================
+void CHarness::Init( const char* szGameDir, int iMaxPlayers, float fInterval )
+{
+	sGameDir.assign(szGameDir, good::string::npos, true);
+	CHarness::iMaxPlayers = MIN2(iMaxPlayers, HARNESS_MAX_PLAYERS);
+	CHarness::fInterval = fInterval;
+
+	for ( int i = 0; i < MAX_EDICTS; ++i )
+	{
+		aEdicts[i].m_bFree = true;
+		aEdicts[i].m_pEntity = NULL;
+		m_aItemRespawns[i] = 0.0f;
+	}
+
+	strcpy(cWorldEntity.m_szClassName, "worldspawn");
+	aEdicts[0].m_bFree = false;
+	aEdicts[0].m_pEntity = &cWorldEntity;
+
+	for ( int i = 0; i < HARNESS_MAX_PLAYERS; ++i )
+	{
+		aPlayers[i].Reset();
+		aPlayers[i].m_pEdict = &aEdicts[i+1];
+		strcpy(aPlayers[i].m_cEntity.m_szClassName, "player");
+	}
+	iEdictCount = CHarness::iMaxPlayers + 1;
+
+	cGlobalVars.maxClients = CHarness::iMaxPlayers;
+	cGlobalVars.interval_per_tick = fInterval;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void* CHarness::Factory( const char* szName, int* pReturnCode )
+{
+	void* pResult = NULL;
+	if ( strcmp(szName, INTERFACEVERSION_VENGINESERVER) == 0 )
+		pResult = &cEngineServer;
+	else if ( strcmp(szName, INTERFACEVERSION_ENGINETRACE_SERVER) == 0 )
+		pResult = &cEngineTrace;
+	else if ( strcmp(szName, INTERFACEVERSION_ISERVERPLUGINHELPERS) == 0 )
+		pResult = &cPluginHelpers;
+	else if ( strcmp(szName, INTERFACEVERSION_GAMEEVENTSMANAGER) == 0 )
+		pResult = &cGameEventManager;
+	else if ( strcmp(szName, INTERFACEVERSION_GAMEEVENTSMANAGER2) == 0 )
+		pResult = &cGameEventManager2;
+	else if ( strcmp(szName, INTERFACEVERSION_PLAYERINFOMANAGER) == 0 )
+		pResult = &cPlayerInfoManager;
+	else if ( strcmp(szName, INTERFACEVERSION_PLAYERBOTMANAGER) == 0 )
+		pResult = &cBotManager;
+	else if ( strcmp(szName, INTERFACEVERSION_SERVERGAMECLIENTS) == 0 )
+		pResult = &cGameClients;
+	else if ( strcmp(szName, IEFFECTS_INTERFACE_VERSION) == 0 )
+		pResult = &cEffects;
+	else if ( strcmp(szName, VDEBUG_OVERLAY_INTERFACE_VERSION) == 0 )
+		pResult = &cDebugOverlay;
+	else if ( strcmp(szName, FILESYSTEM_INTERFACE_VERSION) == 0 )
+		pResult = &cFileSystem;
+	else if ( strcmp(szName, CVAR_INTERFACE_VERSION) == 0 )
+		pResult = &cCvar;
+
+	if ( pReturnCode )
+		*pReturnCode = pResult ? 0 : 1;
+	return pResult;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CHarness::LoadPlugin()
+{
+	return PLUGIN()->Load(Factory, Factory);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CHarness::UnloadPlugin()
+{
+	PLUGIN()->Unload();
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CHarness::LevelInit( const char* szMapName, void (*pMapCreated)() )
+{
+	sMapName.assign(szMapName, good::string::npos, true);
+	iFrame = 0;
+	fTime = 0.0f;
+	iEdictCount = iMaxPlayers + 1;
+	CHarnessWorld::Build();
+
+	PLUGIN()->LevelInit(szMapName);
+	if ( pMapCreated )
+		pMapCreated();
+	RunActions(-0.5f); // Entities of the map.
+	PLUGIN()->ServerActivate(aEdicts, iEdictCount, iMaxPlayers);
+	bMapLoaded = true;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CHarness::LevelShutdown()
+{
+	for ( int i = 0; i < iMaxPlayers; ++i )
+		if ( aPlayers[i].m_bConnected )
+			DisconnectPlayer(&aPlayers[i]);
+
+	for ( int i = iMaxPlayers + 1; i < iEdictCount; ++i )
+		if ( !aEdicts[i].IsFree() )
+			RemoveEntity(aEdicts[i].m_pEntity);
+
+	PLUGIN()->LevelShutdown();
+	bMapLoaded = false;
+
+	for ( int i = 0; i < m_aActions.size(); ++i )
+		m_aActions[i].bDone = false;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CHarness::Frame()
+{
+	iFrame++;
+	fTime = iFrame * fInterval;
+
+	cGlobalVars.framecount = cGlobalVars.tickcount = iFrame;
+	cGlobalVars.curtime = cGlobalVars.realtime = fTime;
+	cGlobalVars.frametime = cGlobalVars.absoluteframetime = fInterval;
+
+	RunActions(fTime);
+
+	for ( int i = 0; i < iMaxPlayers; ++i )
+	{
+		CHarnessPlayer& cPlayer = aPlayers[i];
+		if ( !cPlayer.m_bConnected )
+			continue;
+
+		cPlayer.Move(fInterval);
+		if ( cPlayer.m_bNeedSpawnEvent )
+		{
+			cPlayer.m_bNeedSpawnEvent = false;
+			KeyValues* pEvent = new KeyValues("player_spawn");
+			pEvent->SetInt("userid", cPlayer.m_iUserId);
+			FireEvent(pEvent);
+		}
+	}
+
+	UpdateItems();
+
+	PLUGIN()->GameFrame(true);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CHarness::ExecuteCommand( const char* szCommandLine )
+{
+	// Split line in arguments, double quotes group words.
+	static char szLine[1024];
+	const char* aArgv[COMMAND_MAX_ARGC];
+	int iArgc = 0;
+
+	Q_strncpy(szLine, szCommandLine, sizeof(szLine));
+	for ( char* szCurrent = szLine; *szCurrent && (iArgc < COMMAND_MAX_ARGC); )
+	{
+		while ( isspace(*szCurrent) )
+			*szCurrent++ = 0;
+		if ( *szCurrent == 0 )
+			break;
+
+		if ( *szCurrent == '"' )
+		{
+			aArgv[iArgc++] = ++szCurrent;
+			while ( *szCurrent && (*szCurrent != '"') )
+				szCurrent++;
+			if ( *szCurrent )
+				*szCurrent++ = 0;
+		}
+		else
+		{
+			aArgv[iArgc++] = szCurrent;
+			while ( *szCurrent && !isspace(*szCurrent) )
+				szCurrent++;
+		}
+	}
+
+	if ( iArgc == 0 )
+		return;
+
+	ConCommand* pCommand = cCvar.FindCommand(aArgv[0]);
+	if ( pCommand )
+		pCommand->Dispatch( CCommand(iArgc, aArgv) );
+	else
+		Warning("Unknown command: %s\n", aArgv[0]);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+CBaseEntity* CHarness::CreateEntity( const char* szClassName, const char* szModel, const Vector& vOrigin,
+                                     const Vector& vMins, const Vector& vMaxs )
+{
+	int iIndex = iMaxPlayers + 1;
+	while ( (iIndex < MAX_EDICTS) && !aEdicts[iIndex].IsFree() )
+		iIndex++;
+	if ( iIndex == MAX_EDICTS )
+		return NULL;
+
+	CBaseEntity* pEntity = new CBaseEntity();
+	Q_strncpy(pEntity->m_szClassName, szClassName, sizeof(pEntity->m_szClassName));
+	Q_strncpy(pEntity->m_szModelName, szModel, sizeof(pEntity->m_szModelName));
+	pEntity->m_vOrigin = vOrigin;
+	pEntity->m_vMins = vMins;
+	pEntity->m_vMaxs = vMaxs;
+
+	aEdicts[iIndex].m_bFree = false;
+	aEdicts[iIndex].m_pEntity = pEntity;
+	m_aItemRespawns[iIndex] = 0.0f;
+	if ( iIndex >= iEdictCount )
+		iEdictCount = iIndex + 1;
+
+	if ( bMapLoaded )
+		PLUGIN()->OnEdictAllocated(&aEdicts[iIndex]);
+	return pEntity;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CHarness::RemoveEntity( CBaseEntity* pEntity )
+{
+	for ( int i = iMaxPlayers + 1; i < iEdictCount; ++i )
+		if ( aEdicts[i].m_pEntity == pEntity )
+		{
+			if ( bMapLoaded )
+				PLUGIN()->OnEdictFreed(&aEdicts[i]);
+			aEdicts[i].m_bFree = true;
+			aEdicts[i].m_pEntity = NULL;
+			delete pEntity;
+			return;
+		}
+}
+
+//----------------------------------------------------------------------------------------------------------------
+CHarnessPlayer* CHarness::ConnectPlayer( const char* szName, bool bBot )
+{
+	int iIndex = 0;
+	while ( (iIndex < iMaxPlayers) && aPlayers[iIndex].m_bConnected )
+		iIndex++;
+	if ( iIndex == iMaxPlayers )
+		return NULL;
+
+	CHarnessPlayer* pPlayer = &aPlayers[iIndex];
+	pPlayer->Reset();
+	pPlayer->m_sName.assign(szName, good::string::npos, true);
+	pPlayer->m_iUserId = m_iNextUserId++;
+	sprintf(pPlayer->m_szNetworkId, "STEAM_0:0:%d", pPlayer->m_iUserId);
+	pPlayer->m_bBot = bBot;
+	pPlayer->m_bConnected = true;
+	pPlayer->m_pEdict->m_bFree = false;
+	pPlayer->m_pEdict->m_pEntity = &pPlayer->m_cEntity;
+	pPlayer->Spawn();
+
+	PLUGIN()->ClientPutInServer(pPlayer->m_pEdict, szName);
+	PLUGIN()->ClientActive(pPlayer->m_pEdict);
+
+	if ( !bBot )
+	{
+		KeyValues* pEvent = new KeyValues("player_activate");
+		pEvent->SetInt("userid", pPlayer->m_iUserId);
+		FireEvent(pEvent);
+	}
+	pPlayer->m_bNeedSpawnEvent = true; // Bot is not in plugin's players yet.
+	return pPlayer;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CHarness::DisconnectPlayer( CHarnessPlayer* pPlayer )
+{
+	PLUGIN()->ClientDisconnect(pPlayer->m_pEdict);
+	pPlayer->m_pEdict->m_bFree = true;
+	pPlayer->m_pEdict->m_pEntity = NULL;
+	pPlayer->Reset();
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CHarness::KillPlayer( CHarnessPlayer* pVictim, CHarnessPlayer* pAttacker )
+{
+	if ( pVictim->m_bDead )
+		return;
+
+	pVictim->m_bDead = true;
+	pVictim->m_iHealth = 0;
+	pVictim->m_iDeaths++;
+	pVictim->m_fRespawnTime = fTime + fPlayerRespawnTime;
+	pVictim->SyncEntity();
+	if ( pAttacker && (pAttacker != pVictim) )
+		pAttacker->m_iFrags++;
+
+	KeyValues* pEvent = new KeyValues("player_death");
+	pEvent->SetInt("userid", pVictim->m_iUserId);
+	pEvent->SetInt("attacker", pAttacker ? pAttacker->m_iUserId : 0);
+	pEvent->SetString("weapon", pAttacker ? pAttacker->GetWeaponName() : "world");
+	FireEvent(pEvent);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+CHarnessPlayer* CHarness::FindPlayer( const char* szNameOrUserId )
+{
+	int iUserId = isdigit(szNameOrUserId[0]) ? atoi(szNameOrUserId) : -1;
+	for ( int i = 0; i < iMaxPlayers; ++i )
+		if ( aPlayers[i].m_bConnected &&
+		     ( (aPlayers[i].m_iUserId == iUserId) || (Q_stricmp(aPlayers[i].m_sName.c_str(), szNameOrUserId) == 0) ) )
+			return &aPlayers[i];
+	return NULL;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+CHarnessPlayer* CHarness::GetPlayer( const edict_t* pEdict )
+{
+	int iIndex = pEdict ? (int)(pEdict - aEdicts) - 1 : -1;
+	return ( (0 <= iIndex) && (iIndex < iMaxPlayers) && aPlayers[iIndex].m_bConnected ) ? &aPlayers[iIndex] : NULL;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+int CHarness::Random( int iMax )
+{
+	iRandomSeed = iRandomSeed * 1103515245 + 12345; // Own generator, so plugin's rand() sequence is not changed.
+	return (int)( (iRandomSeed >> 16) % (unsigned int)iMax );
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CHarness::ClipRayToBox( const Ray_t& ray, const Vector& vBoxMins, const Vector& vBoxMaxs, float& fFraction,
+                             Vector& vNormal, bool& bStartSolid )
+{
+	// Slab test of ray center against box grown by ray extents.
+	float fEnter = -1.0f, fLeave = 1.0f;
+	int iEnterAxis = -1;
+	float fEnterSign = 0.0f;
+	for ( int i = 0; i < 3; ++i )
+	{
+		float fMin = vBoxMins[i] - ray.m_Extents[i], fMax = vBoxMaxs[i] + ray.m_Extents[i];
+		float fStart = ray.m_Start[i], fDelta = ray.m_Delta[i];
+		if ( fDelta == 0.0f )
+		{
+			if ( (fStart <= fMin) || (fStart >= fMax) ) // Touching surface is not inside.
+				return false;
+			continue;
+		}
+
+		float fInv = 1.0f / fDelta;
+		float t1 = (fMin - fStart) * fInv, t2 = (fMax - fStart) * fInv;
+		float fSign = -1.0f;
+		if ( t1 > t2 )
+		{
+			float t = t1; t1 = t2; t2 = t;
+			fSign = 1.0f;
+		}
+		if ( t1 > fEnter )
+		{
+			fEnter = t1;
+			iEnterAxis = i;
+			fEnterSign = fSign;
+		}
+		if ( t2 < fLeave )
+			fLeave = t2;
+		if ( (fEnter > fLeave) || (fLeave <= 0.0f) )
+			return false;
+	}
+
+	if ( fEnter < 0.0f ) // Ray starts inside box.
+	{
+		bStartSolid = true;
+		fFraction = 0.0f;
+		vNormal.Init();
+		return true;
+	}
+
+	if ( fEnter >= fFraction )
+		return false;
+
+	fFraction = fEnter;
+	vNormal.Init();
+	vNormal[iEnterAxis] = fEnterSign;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CHarness::GetGroundHeight( const Vector& vPos, float& fHeight )
+{
+	Ray_t ray;
+	ray.Init( vPos, Vector(vPos.x, vPos.y, vPos.z - CUtil::iMaxMapSize),
+	          Vector(-CUtil::iPlayerWidth/2, -CUtil::iPlayerWidth/2, 0), Vector(CUtil::iPlayerWidth/2, CUtil::iPlayerWidth/2, 0) );
+	trace_t cTrace;
+	CTraceFilterWorldAndPropsOnly cFilter;
+	cEngineTrace.TraceRay(ray, MASK_PLAYERSOLID, &cFilter, &cTrace);
+	if ( !cTrace.DidHit() || cTrace.startsolid )
+		return false;
+	fHeight = cTrace.endpos.z;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CHarness::MovePlayer( CHarnessPlayer* pPlayer, const Vector& vDelta )
+{
+	// Stop at obstacles higher than a step.
+	Vector vStep(0, 0, CUtil::iPlayerMaxObstacleHeight);
+	Vector vStart = pPlayer->m_vOrigin + vStep;
+	Ray_t ray;
+	ray.Init( vStart, vStart + vDelta, pPlayer->GetPlayerMins(), pPlayer->GetPlayerMaxs() - vStep );
+	trace_t cTrace;
+	CTraceFilterWorldAndPropsOnly cFilter;
+	cEngineTrace.TraceRay(ray, MASK_PLAYERSOLID, &cFilter, &cTrace);
+
+	Vector vNew = cTrace.startsolid ? pPlayer->m_vOrigin + vDelta : cTrace.endpos - vStep;
+
+	float fGround;
+	if ( GetGroundHeight(vNew + vStep, fGround) )
+		vNew.z = fGround; // Walk up steps and fall down instantly.
+	else if ( CWaypoints::Size() > 0 )
+	{
+		// There is no geometry below, follow height of nearest waypoint (waypoints are at eye level).
+		TWaypointId iWaypoint = CWaypoints::GetNearestWaypoint(vNew + Vector(0, 0, CUtil::iPlayerEyeLevel), NULL, false, 256.0f);
+		if ( iWaypoint != EWaypointIdInvalid )
+		{
+			float fTargetZ = CWaypoints::Get(iWaypoint).vOrigin.z - CUtil::iPlayerEyeLevel;
+			float fMaxDelta = CUtil::fMaxSprintVelocity * fInterval;
+			vNew.z += MAX2( -fMaxDelta, MIN2(fMaxDelta, fTargetZ - vNew.z) );
+		}
+	}
+	pPlayer->m_vOrigin = vNew;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CHarness::UpdateItems()
+{
+	for ( int i = iMaxPlayers + 1; i < iEdictCount; ++i )
+	{
+		CBaseEntity* pEntity = aEdicts[i].m_pEntity;
+		if ( aEdicts[i].IsFree() )
+			continue;
+
+		if ( m_aItemRespawns[i] > 0.0f )
+		{
+			if ( fTime >= m_aItemRespawns[i] )
+			{
+				FLAG_CLEAR(EF_NODRAW, pEntity->m_fEffects);
+				m_aItemRespawns[i] = 0.0f;
+			}
+			continue;
+		}
+
+		bool bItem = strncmp(pEntity->m_szClassName, "item_", 5) == 0;
+		if ( !bItem && (strncmp(pEntity->m_szClassName, "weapon_", 7) != 0) )
+			continue;
+
+		// Player takes item when touching it.
+		for ( int iPlayer = 0; iPlayer < iMaxPlayers; ++iPlayer )
+		{
+			CHarnessPlayer& cPlayer = aPlayers[iPlayer];
+			if ( !cPlayer.m_bConnected || cPlayer.m_bDead )
+				continue;
+
+			Vector vDiff = pEntity->m_vOrigin - cPlayer.m_vOrigin;
+			if ( (vDiff.Length2DSqr() > SQR(CUtil::iPlayerRadius + CUtil::iItemPickUpDistance)) ||
+			     (vDiff.z < -CUtil::iPlayerMaxObstacleHeight) || (vDiff.z > CUtil::iPlayerHeight) )
+				continue;
+
+			if ( strstr(pEntity->m_szClassName, "health") )
+				cPlayer.m_iHealth = MIN2(cPlayer.m_iHealth + 25, CUtil::iPlayerMaxHealth);
+			else if ( strstr(pEntity->m_szClassName, "battery") )
+				cPlayer.m_iArmor = MIN2(cPlayer.m_iArmor + 15, CUtil::iPlayerMaxArmor);
+			else if ( !bItem )
+				cPlayer.m_sWeapon.assign(pEntity->m_szClassName, good::string::npos, true);
+
+			FLAG_SET(EF_NODRAW, pEntity->m_fEffects);
+			m_aItemRespawns[i] = fTime + fItemRespawnTime;
+			break;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CHarness::FireEvent( KeyValues* pEvent )
+{
+	for ( int i = 0; i < aListeners.size(); ++i )
+		aListeners[i]->FireGameEvent(pEvent);
+
+	CHarnessGameEvent cEvent(pEvent, false);
+	for ( int i = 0; i < aListeners2.size(); ++i )
+		if ( aListeners2Events[i] == pEvent->GetName() )
+			aListeners2[i]->FireGameEvent(&cEvent);
+
+	pEvent->deleteThis();
+}
+
+
+//================================================================================================================
+// Script.
+//================================================================================================================
+bool CHarness::LoadScript( const char* szFileName )
+{
+	FILE* f = fopen(szFileName, "r");
+	if ( f == NULL )
+	{
+		fprintf(stderr, "Can't open script %s.\n", szFileName);
+		return false;
+	}
+
+	char szLine[1024], szWord[64];
+	good::string_buffer sbAction(256);
+	int iLine = 0;
+	bool bResult = true;
+	while ( bResult && fgets(szLine, sizeof(szLine), f) )
+	{
+		iLine++;
+		char* szComment = strchr(szLine, '#');
+		if ( szComment )
+			*szComment = 0;
+
+		int iRead = 0;
+		if ( sscanf(szLine, "%63s%n", szWord, &iRead) != 1 )
+			continue; // Empty line.
+
+		char* szArgs = &szLine[iRead];
+		while ( isspace(*szArgs) )
+			szArgs++;
+		for ( int i = strlen(szArgs) - 1; (i >= 0) && isspace(szArgs[i]); --i )
+			szArgs[i] = 0;
+
+		action_t cAction;
+		cAction.bDone = false;
+		cAction.fTime = -1.0f;
+		Vector v;
+		if ( strcmp(szWord, "map") == 0 )
+			sMapName.assign(szArgs, good::string::npos, true);
+		else if ( strcmp(szWord, "maxplayers") == 0 )
+			iMaxPlayers = MIN2(atoi(szArgs), HARNESS_MAX_PLAYERS);
+		else if ( strcmp(szWord, "ground") == 0 )
+		{
+			bGround = true;
+			fGroundHeight = (float)atof(szArgs);
+		}
+		else if ( strcmp(szWord, "world") == 0 )
+			bResult = CHarnessWorld::Load(szArgs);
+		else if ( (strcmp(szWord, "box") == 0) || (strcmp(szWord, "ramp") == 0) || (strcmp(szWord, "stairs") == 0) )
+			bResult = CHarnessWorld::ParseLine(szWord, szArgs);
+		else if ( strcmp(szWord, "item_respawn") == 0 )
+			fItemRespawnTime = (float)atof(szArgs);
+		else if ( strcmp(szWord, "player_respawn") == 0 )
+			fPlayerRespawnTime = (float)atof(szArgs);
+		else if ( strcmp(szWord, "spawn") == 0 )
+		{
+			if ( sscanf(szArgs, "%f %f %f", &v.x, &v.y, &v.z) != 3 )
+				bResult = false;
+			aSpawnPoints.push_back(v);
+		}
+		else if ( (strcmp(szWord, "entity") == 0) || (strcmp(szWord, "player") == 0) || (strcmp(szWord, "at") == 0) )
+		{
+			// Entities are created before map activation, players connect at first frame.
+			if ( strcmp(szWord, "at") == 0 )
+			{
+				if ( sscanf(szArgs, "%f%n", &cAction.fTime, &iRead) != 1 )
+					bResult = false;
+				szArgs += iRead;
+				while ( isspace(*szArgs) )
+					szArgs++;
+				sbAction = szArgs;
+			}
+			else if ( strcmp(szWord, "player") == 0 )
+			{
+				cAction.fTime = 0.0f;
+				sbAction = "connect ";
+				sbAction.append(szArgs);
+			}
+			else
+			{
+				sbAction = "entity ";
+				sbAction.append(szArgs);
+			}
+			cAction.sAction = sbAction.duplicate();
+			m_aActions.push_back(cAction);
+		}
+		else
+			bResult = false;
+	}
+	fclose(f);
+
+	if ( !bResult )
+		fprintf(stderr, "Script %s, line %d: invalid line.\n", szFileName, iLine);
+	return bResult;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CHarness::RunActions( float fUntilTime )
+{
+	for ( int i = 0; i < m_aActions.size(); ++i )
+		if ( !m_aActions[i].bDone && (m_aActions[i].fTime <= fUntilTime) )
+		{
+			m_aActions[i].bDone = true;
+			if ( !RunAction( m_aActions[i].sAction.c_str() ) )
+				Warning("Invalid script action: %s\n", m_aActions[i].sAction.c_str());
+		}
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CHarness::RunAction( const char* szAction )
+{
+	char szWord[64], szName[64], szOther[64];
+	int iRead = 0;
+	if ( sscanf(szAction, "%63s%n", szWord, &iRead) != 1 )
+		return false;
+
+	const char* szArgs = szAction + iRead;
+	while ( isspace(*szArgs) )
+		szArgs++;
+
+	if ( strcmp(szWord, "entity") == 0 )
+	{
+		// entity <class> <x> <y> <z> [model] [<mins x y z> <maxs x y z>]
+		char szModel[128] = "";
+		Vector vOrigin, vMins(-16, -16, 0), vMaxs(16, 16, 16);
+		int iArgs = sscanf(szArgs, "%63s %f %f %f %127s %f %f %f %f %f %f", szName, &vOrigin.x, &vOrigin.y, &vOrigin.z, szModel,
+		                   &vMins.x, &vMins.y, &vMins.z, &vMaxs.x, &vMaxs.y, &vMaxs.z);
+		if ( (iArgs != 4) && (iArgs != 5) && (iArgs != 11) )
+			return false;
+		return CreateEntity(szName, szModel, vOrigin, vMins, vMaxs) != NULL;
+	}
+	else if ( strcmp(szWord, "connect") == 0 )
+	{
+		// connect <name> <team> <speed> <x> <y> <z> [<x> <y> <z> ...]
+		int iTeam;
+		float fSpeed;
+		if ( sscanf(szArgs, "%63s %d %f%n", szName, &iTeam, &fSpeed, &iRead) != 3 )
+			return false;
+
+		CHarnessPlayer* pPlayer = ConnectPlayer(szName, false);
+		if ( pPlayer == NULL )
+			return false;
+		pPlayer->m_iTeam = iTeam;
+		pPlayer->m_fSpeed = fSpeed;
+		if ( !pPlayer->SetPath(szArgs + iRead) )
+			return false;
+		pPlayer->Spawn();
+		return true;
+	}
+	else if ( strcmp(szWord, "bot") == 0 )
+	{
+		// bot [count] [intelligence]
+		int iCount = 1, iIntelligence = -1;
+		sscanf(szArgs, "%d %d", &iCount, &iIntelligence);
+		for ( int i = 0; i < iCount; ++i )
+		{
+			TBotIntelligence iBotIntelligence = (iIntelligence >= 0) ? iIntelligence : Random(EBotIntelligenceTotal);
+			if ( CPlayers::AddBot(iBotIntelligence) == NULL )
+				return false;
+		}
+		return true;
+	}
+	else if ( strcmp(szWord, "kill") == 0 )
+	{
+		// kill <victim> [attacker]
+		int iArgs = sscanf(szArgs, "%63s %63s", szName, szOther);
+		CHarnessPlayer* pVictim = (iArgs >= 1) ? FindPlayer(szName) : NULL;
+		CHarnessPlayer* pAttacker = (iArgs == 2) ? FindPlayer(szOther) : NULL;
+		if ( (pVictim == NULL) || ((iArgs == 2) && (pAttacker == NULL)) )
+			return false;
+		KillPlayer(pVictim, pAttacker);
+		return true;
+	}
+	else if ( strcmp(szWord, "say") == 0 )
+	{
+		// say <player> <text>
+		if ( sscanf(szArgs, "%63s%n", szName, &iRead) != 1 )
+			return false;
+		CHarnessPlayer* pPlayer = FindPlayer(szName);
+		if ( pPlayer == NULL )
+			return false;
+
+		const char* szText = szArgs + iRead;
+		while ( isspace(*szText) )
+			szText++;
+		KeyValues* pEvent = new KeyValues("player_say");
+		pEvent->SetInt("userid", pPlayer->m_iUserId);
+		pEvent->SetString("text", szText);
+		pEvent->SetInt("teamonly", 0);
+		FireEvent(pEvent);
+		return true;
+	}
+	else if ( strcmp(szWord, "disconnect") == 0 )
+	{
+		CHarnessPlayer* pPlayer = FindPlayer(szArgs);
+		if ( pPlayer == NULL )
+			return false;
+		DisconnectPlayer(pPlayer);
+		return true;
+	}
+	else if ( strcmp(szWord, "cvar") == 0 )
+	{
+		if ( sscanf(szArgs, "%63s %63s", szName, szOther) != 2 )
+			return false;
+		ConVar* pVar = cCvar.FindVar(szName);
+		if ( pVar == NULL )
+			return false;
+		pVar->SetValue(szOther);
+		return true;
+	}
+	else if ( strcmp(szWord, "command") == 0 )
+	{
+		ExecuteCommand(szArgs);
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,229 @@
+//----------------------------------------------------------------------------------------------------------------
+// Headless engine stand-in: implements the engine and game interfaces that Botrix plugin uses, with scripted
+// entities and fake players, so plugin can be loaded and ticked without a game server.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#ifndef __HARNESS_ENGINE_H__
+#define __HARNESS_ENGINE_H__
+
+
+#include "good/string.h"
+#include "good/vector.h"
+
+#include "sdk/harness_sdk.h"
+
+#include "bsp_file.h"
+
+
+#define HARNESS_MAX_PLAYERS 32               ///< Max players slots, edicts 1..HARNESS_MAX_PLAYERS.
+
+
+//****************************************************************************************************************
+/// Player of harness: bot created with IBotManager::CreateBot() or scripted human that walks along path.
+//****************************************************************************************************************
+class CHarnessPlayer: public IPlayerInfo, public IBotController
+{
+public:
+	/// Constructor.
+	CHarnessPlayer(): m_pEdict(NULL) { Reset(); }
+
+	/// Clear all player data. Player slot is free after this.
+	void Reset();
+
+	/// Move player for one frame: bots by last command, scripted humans along their path.
+	void Move( float fInterval );
+
+	/// Put player on random spawn point with full health.
+	void Spawn();
+
+	/// Set path of scripted human from arguments "x y z [x y z ...]". Return false on error.
+	bool SetPath( const char* szPoints );
+
+	/// Copy position, angles and health to player's entity.
+	void SyncEntity();
+
+	// IPlayerInfo.
+	const char* GetName() { return m_sName.c_str(); }
+	int GetUserID() { return m_iUserId; }
+	const char* GetNetworkIDString() { return m_bBot ? "BOT" : m_szNetworkId; }
+	int GetTeamIndex() { return m_iTeam; }
+	void ChangeTeam( int iTeamNum ) { m_iTeam = iTeamNum; }
+	int GetFragCount() { return m_iFrags; }
+	int GetDeathCount() { return m_iDeaths; }
+	bool IsConnected() { return m_bConnected; }
+	int GetArmorValue() { return m_iArmor; }
+	bool IsHLTV() { return false; }
+	bool IsPlayer() { return true; }
+	bool IsFakeClient() { return m_bBot; }
+	bool IsDead() { return m_bDead; }
+	bool IsInAVehicle() { return false; }
+	bool IsObserver() { return false; }
+	const Vector GetAbsOrigin() { return m_vOrigin; }
+	const QAngle GetAbsAngles() { return m_angAngles; }
+	const Vector GetPlayerMins() { return Vector(-16, -16, 0); }
+	const Vector GetPlayerMaxs() { return m_bDucking ? Vector(16, 16, 36) : Vector(16, 16, 72); }
+	const char* GetWeaponName() { return m_sWeapon.c_str(); }
+	const char* GetModelName() { return "models/player.mdl"; }
+	const int GetHealth() { return m_iHealth; }
+	const int GetMaxHealth() { return 100; }
+	CBotCmd GetLastUserCommand() { return m_cLastCmd; }
+
+	// IBotController.
+	void SetAbsOrigin( Vector& vec ) { m_vOrigin = vec; }
+	void RemoveAllItems( bool removeSuit ) { m_sWeapon = ""; }
+	void SetActiveWeapon( const char* szWeaponName ) { m_sWeapon.assign(szWeaponName, good::string::npos, true); }
+	bool IsEFlagSet( int nEFlagMask ) { return false; }
+	void RunPlayerMove( CBotCmd* pCmd );
+	void SetLocalOrigin( const Vector& origin ) { m_vOrigin = origin; }
+	const Vector GetLocalOrigin() { return m_vOrigin; }
+	void SetLocalAngles( const QAngle& angles ) { m_angAngles = angles; }
+	const QAngle GetLocalAngles() { return m_angAngles; }
+	void PostClientMessagesSent() {}
+
+public:
+	edict_t* m_pEdict;                       ///< Player's edict.
+	CBaseEntity m_cEntity;                   ///< Player's entity, edict points to it while connected.
+	good::string m_sName;                    ///< Player's name.
+	char m_szNetworkId[32];                  ///< Steam id of scripted human.
+	int m_iUserId;                           ///< User id, unique for every connection.
+	int m_iTeam;                             ///< Team index.
+	bool m_bBot;                             ///< True if player was created by IBotManager::CreateBot().
+	bool m_bConnected;                       ///< True if slot is used.
+	bool m_bDead;                            ///< True if player is dead and waits for respawn.
+	bool m_bDucking;                         ///< True if last command had IN_DUCK.
+	int m_iHealth, m_iArmor, m_iFrags, m_iDeaths;
+	Vector m_vOrigin;                        ///< Foot position.
+	Vector m_vVelocity;                      ///< Current velocity.
+	QAngle m_angAngles;                      ///< View angles.
+	good::string m_sWeapon;                  ///< Active weapon name.
+	CBotCmd m_cLastCmd;                      ///< Last command given to RunPlayerMove().
+	float m_fRespawnTime;                    ///< Time when dead player spawns again.
+	bool m_bNeedSpawnEvent;                  ///< Fire player_spawn on next frame (bot is created inside plugin call).
+
+	good::vector<Vector> m_aPath;            ///< Path of scripted human, looped.
+	int m_iPathPoint;                        ///< Point of path player is going to.
+	float m_fSpeed;                          ///< Speed of scripted human.
+};
+
+
+//****************************************************************************************************************
+/// Harness world: edicts, players, entities and the time of the server. Also runs the timed actions of script.
+//****************************************************************************************************************
+class CHarness
+{
+public:
+	/// Create edicts and set game directory (plugin searches botrix folder in parent of game directory).
+	static void Init( const char* szGameDir, int iMaxPlayers, float fInterval );
+
+	/// Load script file with map, spawn points, entities, players and timed actions. Return false on error.
+	static bool LoadScript( const char* szFileName );
+
+	/// Load plugin, passing engine factory to it. Return false if plugin fails to load.
+	static bool LoadPlugin();
+
+	/// Unload plugin.
+	static void UnloadPlugin();
+
+	/// Start map: LevelInit(), ServerActivate() and connection of scripted humans. Optional pMapCreated is called
+	/// after plugin loads waypoints of the map and before entities are created (to make waypoints for example).
+	static void LevelInit( const char* szMapName, void (*pMapCreated)() = NULL );
+
+	/// End map: disconnect everybody, free entities and call LevelShutdown().
+	static void LevelShutdown();
+
+	/// Advance time one tick: run timed actions, move players, respawn items and call plugin's GameFrame().
+	static void Frame();
+
+	/// Execute console line, as typed in server console (e.g. "botrix bot add").
+	static void ExecuteCommand( const char* szCommandLine );
+
+
+	/// Create entity with given class name, model and bounding box. Plugin is notified if map is already loaded.
+	static CBaseEntity* CreateEntity( const char* szClassName, const char* szModel, const Vector& vOrigin,
+	                                  const Vector& vMins, const Vector& vMaxs );
+
+	/// Free entity.
+	static void RemoveEntity( CBaseEntity* pEntity );
+
+	/// Connect player. Return NULL if there are no free slots.
+	static CHarnessPlayer* ConnectPlayer( const char* szName, bool bBot );
+
+	/// Disconnect player.
+	static void DisconnectPlayer( CHarnessPlayer* pPlayer );
+
+	/// Kill player, pAttacker can be NULL or the same player (suicide).
+	static void KillPlayer( CHarnessPlayer* pVictim, CHarnessPlayer* pAttacker );
+
+	/// Find player by name or user id, NULL if not found.
+	static CHarnessPlayer* FindPlayer( const char* szNameOrUserId );
+
+	/// Get player of edict, NULL if edict is not a player.
+	static CHarnessPlayer* GetPlayer( const edict_t* pEdict );
+
+
+	/// Get random number in [0, iMax) from harness generator, so plugin's rand() sequence is not changed.
+	static int Random( int iMax );
+
+	/// Clip ray (or hull) against box. If hit is closer than fFraction, update fFraction and vNormal and return true.
+	static bool ClipRayToBox( const Ray_t& ray, const Vector& vBoxMins, const Vector& vBoxMaxs, float& fFraction,
+	                          Vector& vNormal, bool& bStartSolid );
+
+	/// Get ground height below position. Return false if there is no ground.
+	static bool GetGroundHeight( const Vector& vPos, float& fHeight );
+
+	/// Move player by vDelta, stopping at obstacles and standing on ground.
+	static void MovePlayer( CHarnessPlayer* pPlayer, const Vector& vDelta );
+
+	/// Fire game event to plugin (as KeyValues and IGameEvent listeners). Event is deleted.
+	static void FireEvent( KeyValues* pEvent );
+
+
+	/// Interface factory for plugin.
+	static void* Factory( const char* szName, int* pReturnCode );
+
+public:
+	static bool bQuiet;                      ///< Don't print plugin messages.
+	static good::string sGameDir;            ///< Game directory, "<root>/<game>/<mod>".
+	static good::string sMapName;            ///< Current map.
+
+	static int iMaxPlayers;                  ///< Max clients.
+	static int iFrame;                       ///< Current frame.
+	static float fInterval;                  ///< Time of one frame.
+	static float fTime;                      ///< Current time.
+	static bool bMapLoaded;                  ///< True between LevelInit() and LevelShutdown().
+	static unsigned int iRandomSeed;         ///< Seed of harness random generator.
+
+	static CBspFile cBsp;                    ///< World loaded from .bsp file.
+	static bool bUseBsp;                     ///< Trace against cBsp and use its PVS instead of ground and box world.
+
+	static float fGroundHeight;              ///< Height of ground plane.
+	static bool bGround;                     ///< True if there is ground plane.
+	static float fItemRespawnTime;           ///< Time for taken items to appear again.
+	static float fPlayerRespawnTime;         ///< Time for dead players to spawn again.
+
+	static edict_t aEdicts[MAX_EDICTS];      ///< Edicts, 0 is world, then players, then entities.
+	static int iEdictCount;                  ///< Edicts used (max index + 1).
+	static CHarnessPlayer aPlayers[HARNESS_MAX_PLAYERS];
+	static good::vector<Vector> aSpawnPoints;
+
+protected:
+	// Timed action of script. Actions with negative time are run when map starts, before ServerActivate().
+	typedef struct
+	{
+		float fTime;
+		bool bDone;
+		good::string sAction;
+	} action_t;
+
+	static bool RunAction( const char* szAction );
+	static void RunActions( float fUntilTime );
+	static void UpdateItems();
+
+	static good::vector<action_t> m_aActions;
+	static float m_aItemRespawns[MAX_EDICTS]; // Time to show taken item again, by edict index (0 if not taken).
+	static int m_iNextUserId;
+};
+
+
+#endif // __HARNESS_ENGINE_H__
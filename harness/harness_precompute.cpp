@@ -0,0 +1,186 @@
+//----------------------------------------------------------------------------------------------------------------
+// Offline precompute jobs, see harness_precompute.h.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#include "good/thread.h"
+
+#include "source_engine.h"
+#include "waypoint.h"
+
+#include "bsp_file.h"
+#include "harness_engine.h"
+#include "harness_precompute.h"
+
+
+//----------------------------------------------------------------------------------------------------------------
+// Get ground height below waypoint, with trace through current world of engine stand-in.
+//----------------------------------------------------------------------------------------------------------------
+static float GetWaypointGround( const Vector& vOrigin )
+{
+	CTraceFilterWorldAndPropsOnly cFilter;
+	CUtil::TraceLine(vOrigin, vOrigin - Vector(0, 0, CUtil::iHalfMaxMapSize), MASK_SOLID_BRUSHONLY, &cFilter);
+	return CUtil::TraceResult().endpos.z;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+int CHarnessPrecompute::CheckBsp( bool bVerbose )
+{
+	bool bUseBsp = CHarness::bUseBsp;
+	int iPairs = 0, iReachErrors = 0, iVisibleErrors = 0, iGroundErrors = 0;
+
+	for ( TWaypointId iFrom = 0; iFrom < CWaypoints::Size(); ++iFrom )
+	{
+		const Vector& vFrom = CWaypoints::Get(iFrom).vOrigin;
+
+		CHarness::bUseBsp = false;
+		float fGround = GetWaypointGround(vFrom);
+		CHarness::bUseBsp = true;
+		float fBspGround = GetWaypointGround(vFrom);
+		if ( fabsf(fGround - fBspGround) > 2 * BSP_DIST_EPSILON )
+		{
+			iGroundErrors++;
+			if ( bVerbose )
+				printf("Waypoint %d: ground %.3f, BSP ground %.3f.\n", iFrom, fGround, fBspGround);
+		}
+
+		for ( TWaypointId iTo = 0; iTo < CWaypoints::Size(); ++iTo )
+		{
+			const Vector& vTo = CWaypoints::Get(iTo).vOrigin;
+			if ( (iFrom == iTo) || (vFrom.DistToSqr(vTo) > SQR(CWaypoint::MAX_RANGE)) )
+				continue;
+			iPairs++;
+
+			CHarness::bUseBsp = false;
+			TReach iReach = CUtil::GetReachableInfoFromTo(vFrom, vTo);
+			bool bVisible = CUtil::IsVisible(vFrom, vTo);
+			CHarness::bUseBsp = true;
+			TReach iBspReach = CUtil::GetReachableInfoFromTo(vFrom, vTo);
+			bool bBspVisible = CUtil::IsVisible(vFrom, vTo);
+
+			if ( iReach != iBspReach )
+			{
+				iReachErrors++;
+				if ( bVerbose )
+					printf("Waypoints %d -> %d: reach %d, BSP reach %d.\n", iFrom, iTo, iReach, iBspReach);
+			}
+			if ( bVisible != bBspVisible )
+			{
+				iVisibleErrors++;
+				if ( bVerbose )
+					printf("Waypoints %d -> %d: visible %d, BSP visible %d.\n", iFrom, iTo, bVisible, bBspVisible);
+			}
+		}
+	}
+	CHarness::bUseBsp = bUseBsp;
+
+	printf("BSP check: %d waypoint pairs, %d reachability, %d visibility and %d ground height differences.\n",
+	       iPairs, iReachErrors, iVisibleErrors, iGroundErrors);
+	return iReachErrors + iVisibleErrors + iGroundErrors;
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+// Job of one thread for visibility table: rows iFirst, iFirst + iStep, ...
+//----------------------------------------------------------------------------------------------------------------
+typedef struct
+{
+	const CBspFile* pBsp;
+	const good::vector<Vector>* pOrigins;
+	unsigned char* pTable;
+	int iRowSize;
+	int iFirst, iStep;
+} visibility_job_t;
+
+static void VisibilityJob( void* pParameter )
+{
+	const visibility_job_t& cJob = *(const visibility_job_t*)pParameter;
+	const good::vector<Vector>& aOrigins = *cJob.pOrigins;
+
+	for ( int iFrom = cJob.iFirst; iFrom < aOrigins.size(); iFrom += cJob.iStep )
+	{
+		unsigned char* pRow = cJob.pTable + iFrom * cJob.iRowSize;
+		for ( int iTo = 0; iTo < aOrigins.size(); ++iTo )
+		{
+			Ray_t ray;
+			ray.Init(aOrigins[iFrom], aOrigins[iTo]);
+			float fFraction = 1.0f;
+			Vector vNormal;
+			int iContents;
+			bool bStartSolid = false;
+			cJob.pBsp->TraceRay(ray, MASK_SOLID_BRUSHONLY, fFraction, vNormal, iContents, bStartSolid);
+			if ( fFraction == 1.0f )
+				pRow[iTo >> 3] |= 1 << (iTo & 7);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------
+int CHarnessPrecompute::GetVisibilityRowSize()
+{
+	return (CWaypoints::Size() + 7) >> 3;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CHarnessPrecompute::MakeVisibilityTable( const CBspFile& cBsp, int iThreads, good::vector<unsigned char>& aTable )
+{
+	good::vector<Vector> aOrigins( CWaypoints::Size() );
+	for ( TWaypointId i = 0; i < CWaypoints::Size(); ++i )
+		aOrigins.push_back( CWaypoints::Get(i).vOrigin );
+
+	int iRowSize = GetVisibilityRowSize();
+	aTable.clear();
+	aTable.resize(aOrigins.size() * iRowSize, 0);
+	if ( aOrigins.size() == 0 )
+		return;
+
+	// Every thread writes its own rows, BSP is only read.
+	iThreads = MAX2(1, iThreads);
+	good::vector<visibility_job_t> aJobs(iThreads);
+	good::vector<good::thread*> aThreads(iThreads);
+	for ( int i = 0; i < iThreads; ++i )
+	{
+		visibility_job_t cJob = { &cBsp, &aOrigins, &aTable[0], iRowSize, i, iThreads };
+		aJobs.push_back(cJob);
+	}
+	for ( int i = 0; i < iThreads; ++i )
+	{
+		aThreads.push_back( new good::thread(VisibilityJob) );
+		aThreads[i]->launch(&aJobs[i], false);
+	}
+	for ( int i = 0; i < iThreads; ++i )
+	{
+		aThreads[i]->join();
+		delete aThreads[i];
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CHarnessPrecompute::SaveVisibilityTable( const char* szFileName, const good::vector<unsigned char>& aTable )
+{
+	FILE* f = fopen(szFileName, "wb");
+	if ( f == NULL )
+		return false;
+
+	int iCount = CWaypoints::Size();
+	bool bResult = (fwrite(&iCount, sizeof(int), 1, f) == 1);
+	if ( bResult && (aTable.size() > 0) )
+		bResult = (fwrite(&aTable[0], 1, aTable.size(), f) == (size_t)aTable.size());
+	fclose(f);
+	return bResult;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+int CHarnessPrecompute::CheckVisibilityTable( const good::vector<unsigned char>& aTable )
+{
+	int iRowSize = GetVisibilityRowSize(), iErrors = 0;
+	for ( TWaypointId iFrom = 0; iFrom < CWaypoints::Size(); ++iFrom )
+		for ( TWaypointId iTo = 0; iTo < CWaypoints::Size(); ++iTo )
+		{
+			bool bVisible = CUtil::IsVisible( CWaypoints::Get(iFrom).vOrigin, CWaypoints::Get(iTo).vOrigin );
+			bool bTable = ( aTable[iFrom * iRowSize + (iTo >> 3)] & (1 << (iTo & 7)) ) != 0;
+			if ( bVisible != bTable )
+				iErrors++;
+		}
+	return iErrors;
+}
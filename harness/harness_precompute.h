@@ -0,0 +1,43 @@
+//----------------------------------------------------------------------------------------------------------------
+// Offline precompute jobs over .bsp file: waypoint tables built with native BSP traces on several threads, and
+// cross-check of BSP traces against traces of the engine stand-in.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#ifndef __HARNESS_PRECOMPUTE_H__
+#define __HARNESS_PRECOMPUTE_H__
+
+
+#include "good/vector.h"
+
+
+class CBspFile;
+
+
+//****************************************************************************************************************
+/// Precompute jobs. Waypoints must be loaded.
+//****************************************************************************************************************
+class CHarnessPrecompute
+{
+public:
+	/// Compare CUtil::GetReachableInfoFromTo(), CUtil::IsVisible() and ground heights of waypoints within
+	/// CWaypoint::MAX_RANGE, traced through box world and through CHarness::cBsp. Return amount of differences.
+	static int CheckBsp( bool bVerbose );
+
+	/// Compute visibility between waypoints (at eye level) with traces against cBsp on iThreads threads. Row of
+	/// waypoint i has bit j set if waypoint j is visible from i.
+	static void MakeVisibilityTable( const CBspFile& cBsp, int iThreads, good::vector<unsigned char>& aTable );
+
+	/// Save table made by MakeVisibilityTable(): waypoints count (int), then rows. Return false on error.
+	static bool SaveVisibilityTable( const char* szFileName, const good::vector<unsigned char>& aTable );
+
+	/// Compare table made by MakeVisibilityTable() with CUtil::IsVisible() through engine stand-in. Return amount
+	/// of differences.
+	static int CheckVisibilityTable( const good::vector<unsigned char>& aTable );
+
+	/// Size of row of visibility table in bytes.
+	static int GetVisibilityRowSize();
+};
+
+
+#endif // __HARNESS_PRECOMPUTE_H__
@@ -0,0 +1,332 @@
+//----------------------------------------------------------------------------------------------------------------
+// Implementation of SDK functions declared in harness_sdk.h: output, time, math, key values and entities.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#include <stddef.h>
+#include <time.h>
+
+#include "good/string.h"
+#include "good/vector.h"
+
+#include "sdk/harness_sdk.h"
+#include "harness_engine.h"
+
+
+//================================================================================================================
+// tier0.
+//================================================================================================================
+double Plat_FloatTime()
+{
+	static timespec cStart = { 0, 0 };
+	timespec cNow;
+	clock_gettime(CLOCK_MONOTONIC, &cNow);
+	if ( (cStart.tv_sec == 0) && (cStart.tv_nsec == 0) )
+		cStart = cNow;
+	return (double)(cNow.tv_sec - cStart.tv_sec) + (double)(cNow.tv_nsec - cStart.tv_nsec) * 1e-9;
+}
+
+#define HARNESS_PRINT(stream, fmt) \
+	if ( CHarness::bQuiet ) return; \
+	va_list argptr; \
+	va_start(argptr, fmt); \
+	vfprintf(stream, fmt, argptr); \
+	va_end(argptr);
+
+void Msg( const char* szFormat, ... ) { HARNESS_PRINT(stdout, szFormat) }
+void DevMsg( const char* szFormat, ... ) { HARNESS_PRINT(stdout, szFormat) }
+void Warning( const char* szFormat, ... ) { HARNESS_PRINT(stderr, szFormat) }
+
+
+//================================================================================================================
+// mathlib.
+//================================================================================================================
+const Vector vec3_origin(0, 0, 0);
+const QAngle vec3_angle(0, 0, 0);
+
+//----------------------------------------------------------------------------------------------------------------
+void VectorAngles( const Vector& vForward, QAngle& angles )
+{
+	if ( (vForward.x == 0) && (vForward.y == 0) )
+	{
+		angles.y = 0;
+		angles.x = (vForward.z > 0) ? 270 : 90;
+	}
+	else
+	{
+		angles.y = RAD2DEG( atan2f(vForward.y, vForward.x) );
+		if ( angles.y < 0 )
+			angles.y += 360;
+
+		angles.x = RAD2DEG( atan2f(-vForward.z, vForward.Length2D()) );
+		if ( angles.x < 0 )
+			angles.x += 360;
+	}
+	angles.z = 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void AngleVectors( const QAngle& angles, Vector* pForward, Vector* pRight, Vector* pUp )
+{
+	float sp = sinf( DEG2RAD(angles.x) ), cp = cosf( DEG2RAD(angles.x) );
+	float sy = sinf( DEG2RAD(angles.y) ), cy = cosf( DEG2RAD(angles.y) );
+	float sr = sinf( DEG2RAD(angles.z) ), cr = cosf( DEG2RAD(angles.z) );
+
+	if ( pForward )
+		pForward->Init(cp*cy, cp*sy, -sp);
+	if ( pRight )
+		pRight->Init(-sr*sp*cy + cr*sy, -sr*sp*sy - cr*cy, -sr*cp);
+	if ( pUp )
+		pUp->Init(cr*sp*cy + sr*sy, cr*sp*sy - sr*cy, cr*cp);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void VectorVectors( const Vector& vForward, Vector& vRight, Vector& vUp )
+{
+	if ( (vForward.x == 0) && (vForward.y == 0) )
+	{
+		vRight.Init(0, -1, 0);
+		vUp.Init(-vForward.z, 0, 0);
+	}
+	else
+	{
+		vRight = vForward.Cross( Vector(0, 0, 1) );
+		vRight.NormalizeInPlace();
+		vUp = vRight.Cross(vForward);
+		vUp.NormalizeInPlace();
+	}
+}
+
+
+//================================================================================================================
+// Key values.
+//================================================================================================================
+//****************************************************************************************************************
+/// Symbol table of key names. There are only dozens of different keys, so search is linear.
+//****************************************************************************************************************
+class CHarnessKeyValuesSystem: public IKeyValuesSystem
+{
+public:
+	int GetSymbolForString( const char* szName, bool bCreate )
+	{
+		for ( int i = 0; i < m_aSymbols.size(); ++i )
+			if ( Q_stricmp(m_aSymbols[i].c_str(), szName) == 0 )
+				return i;
+		if ( !bCreate )
+			return -1;
+		m_aSymbols.push_back( good::string(szName).duplicate() );
+		return m_aSymbols.size() - 1;
+	}
+
+	const char* GetStringForSymbol( int iSymbol )
+	{
+		return ( (0 <= iSymbol) && (iSymbol < m_aSymbols.size()) ) ? m_aSymbols[iSymbol].c_str() : "";
+	}
+
+protected:
+	good::vector<good::string> m_aSymbols;
+};
+
+IKeyValuesSystem* KeyValuesSystem()
+{
+	static CHarnessKeyValuesSystem cKeyValuesSystem;
+	return &cKeyValuesSystem;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+KeyValues::KeyValues( const char* szName ): m_szValue(NULL), m_pPeer(NULL), m_pSub(NULL)
+{
+	m_iKeyName = KeyValuesSystem()->GetSymbolForString(szName);
+}
+
+KeyValues::~KeyValues()
+{
+	for ( KeyValues* pKey = m_pSub; pKey; )
+	{
+		KeyValues* pNext = pKey->m_pPeer;
+		delete pKey;
+		pKey = pNext;
+	}
+	free(m_szValue);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+const char* KeyValues::GetName() const
+{
+	return KeyValuesSystem()->GetStringForSymbol(m_iKeyName);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+KeyValues* KeyValues::FindKey( const char* szKeyName, bool bCreate )
+{
+	if ( szKeyName == NULL )
+		return this;
+
+	int iSymbol = KeyValuesSystem()->GetSymbolForString(szKeyName, bCreate);
+	KeyValues* pKey = (iSymbol == -1) ? NULL : FindKey(iSymbol);
+	if ( (pKey == NULL) && bCreate )
+	{
+		pKey = new KeyValues(szKeyName);
+		pKey->m_pPeer = m_pSub;
+		m_pSub = pKey;
+	}
+	return pKey;
+}
+
+KeyValues* KeyValues::FindKey( int iKeySymbol ) const
+{
+	for ( KeyValues* pKey = m_pSub; pKey; pKey = pKey->m_pPeer )
+		if ( pKey->m_iKeyName == iKeySymbol )
+			return pKey;
+	return NULL;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+int KeyValues::GetInt( const char* szKeyName, int iDefaultValue )
+{
+	KeyValues* pKey = FindKey(szKeyName);
+	return (pKey && pKey->m_szValue) ? atoi(pKey->m_szValue) : iDefaultValue;
+}
+
+float KeyValues::GetFloat( const char* szKeyName, float fDefaultValue )
+{
+	KeyValues* pKey = FindKey(szKeyName);
+	return (pKey && pKey->m_szValue) ? (float)atof(pKey->m_szValue) : fDefaultValue;
+}
+
+const char* KeyValues::GetString( const char* szKeyName, const char* szDefaultValue )
+{
+	KeyValues* pKey = FindKey(szKeyName);
+	return (pKey && pKey->m_szValue) ? pKey->m_szValue : szDefaultValue;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void KeyValues::SetString( const char* szKeyName, const char* szValue )
+{
+	KeyValues* pKey = FindKey(szKeyName, true);
+	free(pKey->m_szValue);
+	pKey->m_szValue = strdup(szValue);
+}
+
+void KeyValues::SetInt( const char* szKeyName, int iValue )
+{
+	char szValue[16];
+	sprintf(szValue, "%d", iValue);
+	SetString(szKeyName, szValue);
+}
+
+void KeyValues::SetFloat( const char* szKeyName, float fValue )
+{
+	char szValue[32];
+	sprintf(szValue, "%f", fValue);
+	SetString(szKeyName, szValue);
+}
+
+void KeyValues::SetColor( const char* szKeyName, Color cValue )
+{
+	char szValue[32];
+	sprintf(szValue, "%d %d %d %d", cValue.r(), cValue.g(), cValue.b(), cValue.a());
+	SetString(szKeyName, szValue);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+KeyValues* KeyValues::MakeCopy() const
+{
+	KeyValues* pCopy = new KeyValues( GetName() );
+	if ( m_szValue )
+		pCopy->m_szValue = strdup(m_szValue);
+
+	KeyValues** ppLast = &pCopy->m_pSub;
+	for ( KeyValues* pKey = m_pSub; pKey; pKey = pKey->m_pPeer )
+	{
+		*ppLast = pKey->MakeCopy();
+		ppLast = &(*ppLast)->m_pPeer;
+	}
+	return pCopy;
+}
+
+
+//================================================================================================================
+// Console.
+//================================================================================================================
+CCommand::CCommand( int iArgc, const char** aArgv )
+{
+	m_iArgc = min(iArgc, COMMAND_MAX_ARGC);
+	for ( int i = 0; i < m_iArgc; ++i )
+		m_aArgv[i] = aArgv[i];
+}
+
+ConVar::ConVar( const char* szName, const char* szDefaultValue, int iFlags, const char* szHelp ):
+	ConCommandBase(szName, szHelp, iFlags)
+{
+	SetValue(szDefaultValue);
+}
+
+
+//================================================================================================================
+// Entities.
+//================================================================================================================
+// Key fields of entity, as game's DEFINE_KEYFIELD() declares them. Like in SDK, offsetof() is used on class with
+// virtual functions, which GCC supports.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+static typedescription_t aEntityFields[] =
+{
+	{ FIELD_STRING,  "m_iClassname", { offsetof(CBaseEntity, m_szClassName), 0 }, 1, FTYPEDESC_KEY, "classname" },
+	{ FIELD_STRING,  "m_iName",      { offsetof(CBaseEntity, m_szName), 0 },      1, FTYPEDESC_KEY, "targetname" },
+	{ FIELD_INTEGER, "m_fEffects",   { offsetof(CBaseEntity, m_fEffects), 0 },    1, FTYPEDESC_KEY, "effects" },
+	{ FIELD_INTEGER, "m_iHealth",    { offsetof(CBaseEntity, m_iHealth), 0 },     1, FTYPEDESC_KEY, "health" },
+};
+#pragma GCC diagnostic pop
+
+datamap_t CBaseEntity::m_DataMap = { aEntityFields, sizeof(aEntityFields) / sizeof(aEntityFields[0]), "CBaseEntity", NULL };
+
+//----------------------------------------------------------------------------------------------------------------
+CBaseEntity::CBaseEntity(): m_vOrigin(0, 0, 0), m_vMins(0, 0, 0), m_vMaxs(0, 0, 0), m_angAngles(0, 0, 0),
+	m_fEffects(0), m_iHealth(0), m_iOwner(0)
+{
+	m_szClassName[0] = m_szName[0] = m_szModelName[0] = 0;
+	memset(&m_PVSInfo, 0, sizeof(m_PVSInfo));
+}
+
+//----------------------------------------------------------------------------------------------------------------
+PVSInfo_t* CBaseEntity::GetPVSInfo()
+{
+	Vector vCenter = m_vOrigin + (m_vMins + m_vMaxs) * 0.5f;
+	m_PVSInfo.m_vCenter[0] = vCenter.x;
+	m_PVSInfo.m_vCenter[1] = vCenter.y;
+	m_PVSInfo.m_vCenter[2] = vCenter.z;
+	return &m_PVSInfo;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CBaseEntity::GetKeyValue( const char* szKeyName, char* szValue, int iMaxLen )
+{
+	if ( Q_stricmp(szKeyName, "model") == 0 )
+	{
+		Q_strncpy(szValue, m_szModelName, iMaxLen);
+		return true;
+	}
+	if ( Q_stricmp(szKeyName, "origin") == 0 )
+	{
+		snprintf(szValue, iMaxLen, "%f %f %f", m_vOrigin.x, m_vOrigin.y, m_vOrigin.z);
+		return true;
+	}
+
+	for ( int i = 0; i < m_DataMap.dataNumFields; ++i )
+	{
+		const typedescription_t& cField = m_DataMap.dataDesc[i];
+		if ( Q_stricmp(cField.externalName, szKeyName) != 0 )
+			continue;
+
+		const char* pField = (const char*)this + cField.fieldOffset[TD_OFFSET_NORMAL];
+		if ( cField.fieldType == FIELD_INTEGER )
+			snprintf(szValue, iMaxLen, "%d", *(const int*)pField);
+		else
+			Q_strncpy(szValue, pField, iMaxLen);
+		return true;
+	}
+
+	szValue[0] = 0;
+	return false;
+}
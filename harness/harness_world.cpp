@@ -0,0 +1,701 @@
+//----------------------------------------------------------------------------------------------------------------
+// Harness world, see harness_world.h.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#include <ctype.h>
+
+#include "source_engine.h"
+
+#include "bsp_file.h"
+#include "harness_world.h"
+
+
+#define DIST_EPSILON 0.03125f                ///< Traces stop this far from surfaces, as in engine.
+#define BVH_LEAF_SIZE 4                      ///< Max brushes in BVH leaf.
+#define BVH_MAX_DEPTH 64                     ///< Size of traversal stack.
+
+
+//----------------------------------------------------------------------------------------------------------------
+// CHarnessWorld static members.
+//----------------------------------------------------------------------------------------------------------------
+unsigned int CHarnessWorld::iTraces = 0;
+unsigned int CHarnessWorld::iNodeTests = 0;
+unsigned int CHarnessWorld::iBrushTests = 0;
+
+good::vector<world_brush_t> CHarnessWorld::m_aBrushes;
+good::vector<int> CHarnessWorld::m_aBrushOrder;
+good::vector<CHarnessWorld::bvh_node_t> CHarnessWorld::m_aNodes;
+Vector CHarnessWorld::m_vMins(0, 0, 0);
+Vector CHarnessWorld::m_vMaxs(0, 0, 0);
+
+
+//----------------------------------------------------------------------------------------------------------------
+// Return true if segment [0, fMaxFraction] of ray, grown by its extents, touches the box.
+//----------------------------------------------------------------------------------------------------------------
+inline bool RayIntersectsBox( const Ray_t& ray, const Vector& vMins, const Vector& vMaxs, float fMaxFraction )
+{
+	float fEnter = 0.0f, fLeave = fMaxFraction;
+	for ( int i = 0; i < 3; ++i )
+	{
+		float fMin = vMins[i] - ray.m_Extents[i] - DIST_EPSILON, fMax = vMaxs[i] + ray.m_Extents[i] + DIST_EPSILON;
+		float fStart = ray.m_Start[i], fDelta = ray.m_Delta[i];
+		if ( fDelta == 0.0f )
+		{
+			if ( (fStart < fMin) || (fStart > fMax) )
+				return false;
+			continue;
+		}
+
+		float fInv = 1.0f / fDelta;
+		float t1 = (fMin - fStart) * fInv, t2 = (fMax - fStart) * fInv;
+		if ( t1 > t2 )
+		{
+			float t = t1; t1 = t2; t2 = t;
+		}
+		if ( t1 > fEnter )
+			fEnter = t1;
+		if ( t2 < fLeave )
+			fLeave = t2;
+		if ( fEnter > fLeave )
+			return false;
+	}
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+// Get plane i of brush: 6 planes of bounding box, then sloped plane.
+//----------------------------------------------------------------------------------------------------------------
+inline void GetBrushPlane( const world_brush_t& cBrush, int i, Vector& vNormal, float& fDist )
+{
+	if ( i == 6 )
+	{
+		vNormal = cBrush.vSlopeNormal;
+		fDist = cBrush.fSlopeDist;
+		return;
+	}
+
+	int iAxis = i >> 1;
+	vNormal.Init();
+	if ( i & 1 )
+	{
+		vNormal[iAxis] = 1.0f;
+		fDist = cBrush.vMaxs[iAxis];
+	}
+	else
+	{
+		vNormal[iAxis] = -1.0f;
+		fDist = -cBrush.vMins[iAxis];
+	}
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+bool CHarnessWorld::Load( const char* szFileName )
+{
+	FILE* f = fopen(szFileName, "r");
+	if ( f == NULL )
+	{
+		fprintf(stderr, "Can't open scene %s.\n", szFileName);
+		return false;
+	}
+
+	char szLine[256], szWord[64];
+	int iLine = 0;
+	bool bResult = true;
+	while ( bResult && fgets(szLine, sizeof(szLine), f) )
+	{
+		iLine++;
+		char* szComment = strchr(szLine, '#');
+		if ( szComment )
+			*szComment = 0;
+
+		int iRead = 0;
+		if ( sscanf(szLine, "%63s%n", szWord, &iRead) != 1 )
+			continue; // Empty line.
+
+		bResult = ParseLine(szWord, &szLine[iRead]);
+	}
+	fclose(f);
+
+	if ( !bResult )
+		fprintf(stderr, "Scene %s, line %d: invalid line.\n", szFileName, iLine);
+	return bResult;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CHarnessWorld::ParseLine( const char* szWord, const char* szArgs )
+{
+	Vector vMins, vMaxs;
+	char szDir[8] = "";
+	int iSteps = 0;
+	int iArgs = sscanf( szArgs, "%f %f %f %f %f %f %7s %d", &vMins.x, &vMins.y, &vMins.z,
+	                    &vMaxs.x, &vMaxs.y, &vMaxs.z, szDir, &iSteps );
+
+	if ( strcmp(szWord, "box") == 0 )
+		return (iArgs == 6) && AddBrush(vMins, vMaxs, NULL, 0);
+	else if ( strcmp(szWord, "ramp") == 0 )
+		return (iArgs == 7) && AddBrush(vMins, vMaxs, szDir, 0);
+	else if ( strcmp(szWord, "stairs") == 0 )
+		return (iArgs == 8) && (iSteps > 0) && AddBrush(vMins, vMaxs, szDir, iSteps);
+	return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CHarnessWorld::Clear()
+{
+	m_aBrushes.clear();
+	m_aBrushOrder.clear();
+	m_aNodes.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CHarnessWorld::AddBrush( const Vector& vMins, const Vector& vMaxs, const char* szDir, int iSteps )
+{
+	if ( (vMins.x >= vMaxs.x) || (vMins.y >= vMaxs.y) || (vMins.z >= vMaxs.z) )
+		return false;
+
+	world_brush_t cBrush;
+	cBrush.vMins = vMins;
+	cBrush.vMaxs = vMaxs;
+	cBrush.bSlope = false;
+	cBrush.vSlopeNormal.Init();
+	cBrush.fSlopeDist = 0.0f;
+
+	if ( szDir == NULL )
+	{
+		m_aBrushes.push_back(cBrush);
+		return true;
+	}
+
+	// Direction in which ramp or stairs go up: +x, -x, +y or -y.
+	if ( ((szDir[0] != '+') && (szDir[0] != '-')) || ((szDir[1] != 'x') && (szDir[1] != 'y')) || szDir[2] )
+		return false;
+	float fSign = (szDir[0] == '+') ? 1.0f : -1.0f;
+	int iAxis = szDir[1] - 'x';
+	float fLength = vMaxs[iAxis] - vMins[iAxis], fHeight = vMaxs.z - vMins.z;
+
+	if ( iSteps == 0 )
+	{
+		// Plane goes through low edge of ramp (at minz) and high edge (at maxz).
+		cBrush.bSlope = true;
+		cBrush.vSlopeNormal[iAxis] = -fSign * fHeight;
+		cBrush.vSlopeNormal.z = fLength;
+		cBrush.vSlopeNormal.NormalizeInPlace();
+		Vector vLowEdge = vMins;
+		if ( fSign < 0.0f )
+			vLowEdge[iAxis] = vMaxs[iAxis];
+		cBrush.fSlopeDist = cBrush.vSlopeNormal.Dot(vLowEdge);
+		m_aBrushes.push_back(cBrush);
+		return true;
+	}
+
+	// Stairs: one box per step, every box goes down to minz.
+	for ( int i = 0; i < iSteps; ++i )
+	{
+		float fFrom = fLength * i / iSteps, fTo = fLength * (i + 1) / iSteps;
+		if ( fSign > 0.0f )
+		{
+			cBrush.vMins[iAxis] = vMins[iAxis] + fFrom;
+			cBrush.vMaxs[iAxis] = vMins[iAxis] + fTo;
+		}
+		else
+		{
+			cBrush.vMins[iAxis] = vMaxs[iAxis] - fTo;
+			cBrush.vMaxs[iAxis] = vMaxs[iAxis] - fFrom;
+		}
+		cBrush.vMaxs.z = vMins.z + fHeight * (i + 1) / iSteps;
+		m_aBrushes.push_back(cBrush);
+	}
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CHarnessWorld::Build()
+{
+	m_aBrushOrder.clear();
+	m_aNodes.clear();
+	if ( m_aBrushes.size() == 0 )
+		return;
+
+	m_aBrushOrder.reserve( m_aBrushes.size() );
+	for ( int i = 0; i < m_aBrushes.size(); ++i )
+		m_aBrushOrder.push_back(i);
+
+	m_aNodes.reserve( 2 * m_aBrushes.size() );
+	m_aNodes.push_back( bvh_node_t() );
+	BuildNode(0, 0, m_aBrushes.size());
+
+	m_vMins = m_aNodes[0].vMins;
+	m_vMaxs = m_aNodes[0].vMaxs;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CHarnessWorld::BuildNode( int iNode, int iFirst, int iCount )
+{
+	// Bounds of brushes and of their centers.
+	Vector vMins = m_aBrushes[ m_aBrushOrder[iFirst] ].vMins, vMaxs = m_aBrushes[ m_aBrushOrder[iFirst] ].vMaxs;
+	Vector vCenterMins = (vMins + vMaxs) * 0.5f, vCenterMaxs = vCenterMins;
+	for ( int i = iFirst + 1; i < iFirst + iCount; ++i )
+	{
+		const world_brush_t& cBrush = m_aBrushes[ m_aBrushOrder[i] ];
+		Vector vCenter = (cBrush.vMins + cBrush.vMaxs) * 0.5f;
+		for ( int iAxis = 0; iAxis < 3; ++iAxis )
+		{
+			vMins[iAxis] = MIN2(vMins[iAxis], cBrush.vMins[iAxis]);
+			vMaxs[iAxis] = MAX2(vMaxs[iAxis], cBrush.vMaxs[iAxis]);
+			vCenterMins[iAxis] = MIN2(vCenterMins[iAxis], vCenter[iAxis]);
+			vCenterMaxs[iAxis] = MAX2(vCenterMaxs[iAxis], vCenter[iAxis]);
+		}
+	}
+
+	bvh_node_t& cNode = m_aNodes[iNode];
+	cNode.vMins = vMins;
+	cNode.vMaxs = vMaxs;
+	cNode.iFirst = iFirst;
+	cNode.iCount = iCount;
+	if ( iCount <= BVH_LEAF_SIZE )
+		return;
+
+	// Split at middle of centers along longest axis. If all centers are on one side, split in halves.
+	Vector vSize = vCenterMaxs - vCenterMins;
+	int iAxis = (vSize.x >= vSize.y) ? ( (vSize.x >= vSize.z) ? 0 : 2 ) : ( (vSize.y >= vSize.z) ? 1 : 2 );
+	float fSplit = (vCenterMins[iAxis] + vCenterMaxs[iAxis]) * 0.5f;
+
+	int iLeft = iFirst;
+	for ( int i = iFirst; i < iFirst + iCount; ++i )
+	{
+		const world_brush_t& cBrush = m_aBrushes[ m_aBrushOrder[i] ];
+		if ( (cBrush.vMins[iAxis] + cBrush.vMaxs[iAxis]) * 0.5f < fSplit )
+		{
+			int iTemp = m_aBrushOrder[i];
+			m_aBrushOrder[i] = m_aBrushOrder[iLeft];
+			m_aBrushOrder[iLeft++] = iTemp;
+		}
+	}
+	int iLeftCount = iLeft - iFirst;
+	if ( (iLeftCount == 0) || (iLeftCount == iCount) )
+		iLeftCount = iCount / 2;
+
+	int iChild = m_aNodes.size();
+	m_aNodes[iNode].iFirst = iChild; // cNode may be invalid after push_back().
+	m_aNodes[iNode].iCount = 0;
+	m_aNodes.push_back( bvh_node_t() );
+	m_aNodes.push_back( bvh_node_t() );
+	BuildNode(iChild, iFirst, iLeftCount);
+	BuildNode(iChild + 1, iFirst + iLeftCount, iCount - iLeftCount);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CHarnessWorld::TraceRay( const Ray_t& ray, float& fFraction, Vector& vNormal, bool& bStartSolid )
+{
+	iTraces++;
+	if ( m_aNodes.size() == 0 )
+		return false;
+
+	bool bHit = false;
+	int aStack[BVH_MAX_DEPTH];
+	int iStack = 0;
+	aStack[iStack++] = 0;
+	while ( iStack > 0 )
+	{
+		const bvh_node_t& cNode = m_aNodes[ aStack[--iStack] ];
+		iNodeTests++;
+		if ( !RayIntersectsBox(ray, cNode.vMins, cNode.vMaxs, fFraction) )
+			continue;
+
+		if ( cNode.iCount == 0 )
+		{
+			DebugAssert( iStack + 2 <= BVH_MAX_DEPTH );
+			aStack[iStack++] = cNode.iFirst + 1;
+			aStack[iStack++] = cNode.iFirst;
+			continue;
+		}
+
+		for ( int i = cNode.iFirst; i < cNode.iFirst + cNode.iCount; ++i )
+		{
+			iBrushTests++;
+			if ( ClipRayToBrush(ray, m_aBrushes[ m_aBrushOrder[i] ], fFraction, vNormal, bStartSolid) )
+				bHit = true;
+		}
+		if ( fFraction == 0.0f )
+			break;
+	}
+	return bHit;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CHarnessWorld::IsSolid( const Vector& vPos )
+{
+	if ( m_aNodes.size() == 0 )
+		return false;
+
+	int aStack[BVH_MAX_DEPTH];
+	int iStack = 0;
+	aStack[iStack++] = 0;
+	while ( iStack > 0 )
+	{
+		const bvh_node_t& cNode = m_aNodes[ aStack[--iStack] ];
+		if ( (vPos.x < cNode.vMins.x) || (vPos.x > cNode.vMaxs.x) || (vPos.y < cNode.vMins.y) ||
+		     (vPos.y > cNode.vMaxs.y) || (vPos.z < cNode.vMins.z) || (vPos.z > cNode.vMaxs.z) )
+			continue;
+
+		if ( cNode.iCount == 0 )
+		{
+			aStack[iStack++] = cNode.iFirst + 1;
+			aStack[iStack++] = cNode.iFirst;
+			continue;
+		}
+
+		for ( int i = cNode.iFirst; i < cNode.iFirst + cNode.iCount; ++i )
+		{
+			const world_brush_t& cBrush = m_aBrushes[ m_aBrushOrder[i] ];
+			int iPlane = 0;
+			for ( ; iPlane < (cBrush.bSlope ? 7 : 6); ++iPlane )
+			{
+				Vector vPlaneNormal;
+				float fDist;
+				GetBrushPlane(cBrush, iPlane, vPlaneNormal, fDist);
+				if ( vPlaneNormal.Dot(vPos) > fDist )
+					break;
+			}
+			if ( iPlane == (cBrush.bSlope ? 7 : 6) )
+				return true;
+		}
+	}
+	return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CHarnessWorld::ClipRayToBrush( const Ray_t& ray, const world_brush_t& cBrush, float& fFraction, Vector& vNormal,
+                                    bool& bStartSolid )
+{
+	// Clip ray center against brush planes moved out by ray extents, as engine's CM_ClipBoxToBrush() does. Box
+	// and ramp don't need bevel planes, as sloped plane's normal lies in plane of two axes.
+	float fEnter = -1.0f, fLeave = 1.0f;
+	bool bGetOut = false, bStartOut = false;
+	Vector vEnterNormal(0, 0, 0);
+	for ( int i = 0; i < (cBrush.bSlope ? 7 : 6); ++i )
+	{
+		Vector vPlaneNormal;
+		float fDist;
+		GetBrushPlane(cBrush, i, vPlaneNormal, fDist);
+		fDist += fabsf(vPlaneNormal.x) * ray.m_Extents.x + fabsf(vPlaneNormal.y) * ray.m_Extents.y +
+		         fabsf(vPlaneNormal.z) * ray.m_Extents.z;
+
+		float d1 = vPlaneNormal.Dot(ray.m_Start) - fDist;
+		float d2 = d1 + vPlaneNormal.Dot(ray.m_Delta);
+		if ( d2 > 0.0f )
+			bGetOut = true;
+		if ( d1 > 0.0f )
+			bStartOut = true;
+		if ( (d1 > 0.0f) && (d2 >= d1) ) // Whole move is in front of plane.
+			return false;
+		if ( (d1 <= 0.0f) && (d2 <= 0.0f) ) // Whole move is behind plane (touching surface is inside, as in engine).
+			continue;
+
+		if ( d1 > d2 ) // Entering.
+		{
+			float f = (d1 - DIST_EPSILON) / (d1 - d2);
+			if ( f > fEnter )
+			{
+				fEnter = f;
+				vEnterNormal = vPlaneNormal;
+			}
+		}
+		else // Leaving.
+		{
+			float f = (d1 + DIST_EPSILON) / (d1 - d2);
+			if ( f < fLeave )
+				fLeave = f;
+		}
+	}
+
+	if ( !bStartOut ) // Ray starts inside brush, it is stopped only if it doesn't get out.
+	{
+		bStartSolid = true;
+		if ( bGetOut )
+			return false;
+		fFraction = 0.0f;
+		vNormal.Init();
+		return true;
+	}
+
+	if ( (fEnter >= fLeave) || (fEnter <= -1.0f) || (fEnter >= fFraction) )
+		return false;
+
+	fFraction = MAX2(0.0f, fEnter);
+	vNormal = vEnterNormal;
+	return true;
+}
+
+
+//================================================================================================================
+// Saving world as .bsp file.
+//================================================================================================================
+// Data of .bsp file being written.
+typedef struct
+{
+	good::vector<bsp_plane_t> aPlanes;
+	good::vector<bsp_node_t> aNodes;
+	good::vector<char> aLeafs;               // Leafs in lump version 1 format.
+	good::vector<unsigned short> aLeafBrushes;
+	good::vector<bsp_brush_t> aBrushes;
+	good::vector<bsp_brushside_t> aBrushSides;
+	good::vector<world_brush_t> aWorldBrushes;
+	int iClusters;
+} bsp_writer_t;
+
+//----------------------------------------------------------------------------------------------------------------
+static int AddBspPlane( bsp_writer_t& cWriter, const Vector& vNormal, float fDist )
+{
+	for ( int i = 0; i < cWriter.aPlanes.size(); ++i )
+		if ( (cWriter.aPlanes[i].normal == vNormal) && (cWriter.aPlanes[i].dist == fDist) )
+			return i;
+
+	bsp_plane_t cPlane;
+	cPlane.normal = vNormal;
+	cPlane.dist = fDist;
+	cPlane.type = 0;
+	for ( int i = 1; i < 3; ++i )
+		if ( fabsf(vNormal[i]) > fabsf(vNormal[cPlane.type]) )
+			cPlane.type = i;
+	if ( fabsf(vNormal[cPlane.type]) != 1.0f )
+		cPlane.type += 3; // Non axial, major axis.
+	cWriter.aPlanes.push_back(cPlane);
+	return cWriter.aPlanes.size() - 1;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+inline short ClampToShort( float f )
+{
+	return (short)MAX2( -CUtil::iHalfMaxMapSize, MIN2(CUtil::iHalfMaxMapSize - 1, (int)f) );
+}
+
+//----------------------------------------------------------------------------------------------------------------
+// Make leaf or node for region with given brushes. Return node index or -(leaf + 1).
+//----------------------------------------------------------------------------------------------------------------
+static int BuildBspNode( bsp_writer_t& cWriter, const good::vector<int>& aBrushes, const Vector& vMins,
+                         const Vector& vMaxs, int iDepth )
+{
+	// Split at brush side nearest to the middle of region, relative to region size.
+	int iAxis = -1;
+	float fSplit = 0.0f, fBestScore = 1.0f;
+	if ( (aBrushes.size() > 2) && (iDepth < 32) )
+	{
+		for ( int iTryAxis = 0; iTryAxis < 3; ++iTryAxis )
+		{
+			float fMiddle = (vMins[iTryAxis] + vMaxs[iTryAxis]) * 0.5f, fSize = vMaxs[iTryAxis] - vMins[iTryAxis];
+			for ( int i = 0; i < aBrushes.size() * 2; ++i )
+			{
+				const world_brush_t& cBrush = cWriter.aWorldBrushes[ aBrushes[i >> 1] ];
+				float fCandidate = (i & 1) ? cBrush.vMaxs[iTryAxis] : cBrush.vMins[iTryAxis];
+				float fScore = fabsf(fCandidate - fMiddle) / fSize;
+				if ( (fCandidate <= vMins[iTryAxis]) || (fCandidate >= vMaxs[iTryAxis]) || (fScore >= fBestScore) )
+					continue;
+				iAxis = iTryAxis;
+				fSplit = fCandidate;
+				fBestScore = fScore;
+			}
+		}
+	}
+
+	if ( iAxis < 0 )
+	{
+		// Leaf. It is solid if it is inside of some box brush.
+		int iContents = 0;
+		for ( int i = 0; i < aBrushes.size(); ++i )
+		{
+			const world_brush_t& cBrush = cWriter.aWorldBrushes[ aBrushes[i] ];
+			if ( !cBrush.bSlope && (cBrush.vMins.x <= vMins.x) && (cBrush.vMins.y <= vMins.y) && (cBrush.vMins.z <= vMins.z) &&
+			     (cBrush.vMaxs.x >= vMaxs.x) && (cBrush.vMaxs.y >= vMaxs.y) && (cBrush.vMaxs.z >= vMaxs.z) )
+				iContents = CONTENTS_SOLID;
+		}
+
+		char aLeaf[BSP_LEAF_SIZE_V1];
+		memset(aLeaf, 0, sizeof(aLeaf));
+		*(int*)aLeaf = iContents;
+		*(short*)(aLeaf + 4) = iContents ? -1 : cWriter.iClusters++;
+		for ( int i = 0; i < 3; ++i )
+		{
+			*(short*)(aLeaf + 8 + 2*i) = ClampToShort(vMins[i]);
+			*(short*)(aLeaf + 14 + 2*i) = ClampToShort(vMaxs[i]);
+		}
+		*(unsigned short*)(aLeaf + 24) = cWriter.aLeafBrushes.size();
+		*(unsigned short*)(aLeaf + 26) = aBrushes.size();
+		*(short*)(aLeaf + 28) = -1; // Water data id.
+		for ( int i = 0; i < aBrushes.size(); ++i )
+			cWriter.aLeafBrushes.push_back(aBrushes[i]);
+
+		int iLeaf = cWriter.aLeafs.size() / BSP_LEAF_SIZE_V1;
+		for ( int i = 0; i < BSP_LEAF_SIZE_V1; ++i )
+			cWriter.aLeafs.push_back(aLeaf[i]);
+		return -1 - iLeaf;
+	}
+
+	// Node: front child is at positive side of plane.
+	bsp_node_t cNode;
+	memset(&cNode, 0, sizeof(cNode));
+	Vector vNormal(0, 0, 0);
+	vNormal[iAxis] = 1.0f;
+	cNode.planenum = AddBspPlane(cWriter, vNormal, fSplit);
+	for ( int i = 0; i < 3; ++i )
+	{
+		cNode.mins[i] = ClampToShort(vMins[i]);
+		cNode.maxs[i] = ClampToShort(vMaxs[i]);
+	}
+	int iNode = cWriter.aNodes.size();
+	cWriter.aNodes.push_back(cNode);
+
+	// Brushes touching plane go to both sides, so traces exactly on plane (which go to front) hit them.
+	good::vector<int> aFront, aBack;
+	for ( int i = 0; i < aBrushes.size(); ++i )
+	{
+		const world_brush_t& cBrush = cWriter.aWorldBrushes[ aBrushes[i] ];
+		if ( cBrush.vMaxs[iAxis] >= fSplit )
+			aFront.push_back(aBrushes[i]);
+		if ( cBrush.vMins[iAxis] <= fSplit )
+			aBack.push_back(aBrushes[i]);
+	}
+
+	Vector vFrontMins = vMins, vBackMaxs = vMaxs;
+	vFrontMins[iAxis] = vBackMaxs[iAxis] = fSplit;
+	int iFront = BuildBspNode(cWriter, aFront, vFrontMins, vMaxs, iDepth + 1);
+	int iBack = BuildBspNode(cWriter, aBack, vMins, vBackMaxs, iDepth + 1);
+	cWriter.aNodes[iNode].children[0] = iFront; // Node can be moved by push_back() in recursion.
+	cWriter.aNodes[iNode].children[1] = iBack;
+	return iNode;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+template <typename T>
+static void WriteBspLump( FILE* f, bsp_header_t& cHeader, int iLump, const good::vector<T>& aData, int iVersion = 0 )
+{
+	static const char aZeros[4] = { 0, 0, 0, 0 };
+	long iPos = ftell(f);
+	if ( iPos & 3 )
+	{
+		fwrite(aZeros, 1, 4 - (iPos & 3), f); // Lumps are aligned to 4 bytes.
+		iPos = ftell(f);
+	}
+	cHeader.lumps[iLump].fileofs = iPos;
+	cHeader.lumps[iLump].filelen = aData.size() * sizeof(T);
+	cHeader.lumps[iLump].version = iVersion;
+	if ( aData.size() > 0 )
+		fwrite(&aData[0], sizeof(T), aData.size(), f);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CHarnessWorld::SaveBsp( const char* szFileName, bool bGround, float fGroundHeight )
+{
+	bsp_writer_t cWriter;
+	cWriter.iClusters = 0;
+	for ( int i = 0; i < m_aBrushes.size(); ++i )
+		cWriter.aWorldBrushes.push_back(m_aBrushes[i]);
+
+	Vector vMins = m_vMins, vMaxs = m_vMaxs;
+	if ( m_aBrushes.size() == 0 )
+	{
+		vMins.Init(-4096, -4096, fGroundHeight);
+		vMaxs.Init(4096, 4096, fGroundHeight + 1024);
+	}
+	if ( bGround )
+	{
+		world_brush_t cGround;
+		cGround.vMins.Init( vMins.x - 1024, vMins.y - 1024, fGroundHeight - 1024 );
+		cGround.vMaxs.Init( vMaxs.x + 1024, vMaxs.y + 1024, fGroundHeight );
+		cGround.bSlope = false;
+		cGround.vSlopeNormal.Init();
+		cGround.fSlopeDist = 0.0f;
+		cWriter.aWorldBrushes.push_back(cGround);
+		vMins = cGround.vMins;
+		vMaxs.x = cGround.vMaxs.x;
+		vMaxs.y = cGround.vMaxs.y;
+		vMaxs.z = MAX2(vMaxs.z, fGroundHeight);
+	}
+	if ( cWriter.aWorldBrushes.size() == 0 )
+		return false;
+
+	// Brushes and their sides.
+	for ( int i = 0; i < cWriter.aWorldBrushes.size(); ++i )
+	{
+		const world_brush_t& cWorldBrush = cWriter.aWorldBrushes[i];
+		bsp_brush_t cBrush;
+		cBrush.firstside = cWriter.aBrushSides.size();
+		cBrush.numsides = cWorldBrush.bSlope ? 7 : 6;
+		cBrush.contents = CONTENTS_SOLID;
+		cWriter.aBrushes.push_back(cBrush);
+
+		for ( int iSide = 0; iSide < cBrush.numsides; ++iSide )
+		{
+			Vector vNormal;
+			float fDist;
+			GetBrushPlane(cWorldBrush, iSide, vNormal, fDist);
+			bsp_brushside_t cSide;
+			memset(&cSide, 0, sizeof(cSide));
+			cSide.planenum = AddBspPlane(cWriter, vNormal, fDist);
+			cSide.dispinfo = -1;
+			cWriter.aBrushSides.push_back(cSide);
+		}
+	}
+
+	// Tree. Head node must be a node, so a leaf alone is put in front of plane under the world.
+	good::vector<int> aAll;
+	for ( int i = 0; i < cWriter.aWorldBrushes.size(); ++i )
+		aAll.push_back(i);
+	vMins -= Vector(1, 1, 1);
+	vMaxs += Vector(1, 1, 1);
+	if ( BuildBspNode(cWriter, aAll, vMins, vMaxs, 0) < 0 )
+	{
+		bsp_node_t cNode;
+		memset(&cNode, 0, sizeof(cNode));
+		cNode.planenum = AddBspPlane(cWriter, Vector(0, 0, 1), vMins.z);
+		cNode.children[0] = -1;
+		good::vector<int> aNone;
+		cNode.children[1] = BuildBspNode(cWriter, aNone, vMins, vMaxs, 0);
+		cWriter.aNodes.push_back(cNode);
+	}
+
+	// Visibility: every cluster sees every cluster, all rows point to the same PVS (and PAS).
+	int iRowSize = (cWriter.iClusters + 7) >> 3;
+	good::vector<int> aVisibility;
+	aVisibility.push_back(cWriter.iClusters);
+	int iRowOffset = sizeof(int) * (1 + 2 * cWriter.iClusters);
+	for ( int i = 0; i < 2 * cWriter.iClusters; ++i )
+		aVisibility.push_back(iRowOffset);
+	for ( int i = 0; i < (iRowSize + 3) / 4; ++i )
+		aVisibility.push_back(-1);
+
+	good::vector<bsp_model_t> aModels;
+	bsp_model_t cModel;
+	memset(&cModel, 0, sizeof(cModel));
+	cModel.mins = vMins;
+	cModel.maxs = vMaxs;
+	cModel.headnode = 0;
+	aModels.push_back(cModel);
+
+	FILE* f = fopen(szFileName, "wb");
+	if ( f == NULL )
+		return false;
+
+	bsp_header_t cHeader;
+	memset(&cHeader, 0, sizeof(cHeader));
+	cHeader.ident = BSP_IDENT;
+	cHeader.version = 20;
+	cHeader.mapRevision = 1;
+	fwrite(&cHeader, sizeof(cHeader), 1, f);
+
+	WriteBspLump(f, cHeader, EBspLumpPlanes, cWriter.aPlanes);
+	WriteBspLump(f, cHeader, EBspLumpVisibility, aVisibility);
+	WriteBspLump(f, cHeader, EBspLumpNodes, cWriter.aNodes);
+	WriteBspLump(f, cHeader, EBspLumpLeafs, cWriter.aLeafs, 1);
+	WriteBspLump(f, cHeader, EBspLumpModels, aModels);
+	WriteBspLump(f, cHeader, EBspLumpLeafBrushes, cWriter.aLeafBrushes);
+	WriteBspLump(f, cHeader, EBspLumpBrushes, cWriter.aBrushes);
+	WriteBspLump(f, cHeader, EBspLumpBrushSides, cWriter.aBrushSides);
+
+	fseek(f, 0, SEEK_SET);
+	bool bResult = (fwrite(&cHeader, sizeof(cHeader), 1, f) == 1);
+	fclose(f);
+	return bResult;
+}
@@ -0,0 +1,91 @@
+//----------------------------------------------------------------------------------------------------------------
+// Harness world: static geometry of boxes, ramps and stairs loaded from a text scene, traced through a BVH.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#ifndef __HARNESS_WORLD_H__
+#define __HARNESS_WORLD_H__
+
+
+#include "good/vector.h"
+
+#include "sdk/harness_sdk.h"
+
+
+//****************************************************************************************************************
+/// Convex brush of world: axis aligned box, optionally cut by a sloped plane (ramp). Solid side is behind planes.
+//****************************************************************************************************************
+typedef struct
+{
+	Vector vMins, vMaxs;                     ///< Bounding box.
+	bool bSlope;                             ///< True if brush is a ramp.
+	Vector vSlopeNormal;                     ///< Normal of sloped plane, points up and out of ramp.
+	float fSlopeDist;                        ///< Distance of sloped plane from origin.
+} world_brush_t;
+
+
+//****************************************************************************************************************
+/// World geometry of harness. Scene lines (units are game units, # starts a comment):
+///   box <minx> <miny> <minz> <maxx> <maxy> <maxz>
+///   ramp <minx> <miny> <minz> <maxx> <maxy> <maxz> <+x|-x|+y|-y>            (rises from minz to maxz along axis)
+///   stairs <minx> <miny> <minz> <maxx> <maxy> <maxz> <+x|-x|+y|-y> <steps>  (steps up from minz to maxz)
+//****************************************************************************************************************
+class CHarnessWorld
+{
+public:
+	/// Load scene file and build BVH. Return false on error.
+	static bool Load( const char* szFileName );
+
+	/// Parse one scene line (word and its arguments). Return false if word is unknown or arguments are invalid.
+	static bool ParseLine( const char* szWord, const char* szArgs );
+
+	/// Remove all brushes.
+	static void Clear();
+
+	/// Build BVH over brushes. Must be called after brushes are added and before tracing.
+	static void Build();
+
+	/// Get amount of brushes.
+	static int Size() { return m_aBrushes.size(); }
+
+	/// Get bounding box of all brushes. Valid only if Size() > 0.
+	static const Vector& GetMins() { return m_vMins; }
+	static const Vector& GetMaxs() { return m_vMaxs; }
+
+	/// Clip ray (or hull) against world. If hit is closer than fFraction, update fFraction and vNormal and return true.
+	static bool TraceRay( const Ray_t& ray, float& fFraction, Vector& vNormal, bool& bStartSolid );
+
+	/// Return true if position is inside some brush.
+	static bool IsSolid( const Vector& vPos );
+
+	/// Save world as .bsp file: brush BSP over axial planes, one cluster per empty leaf and everything visible in
+	/// PVS. Ground plane is saved as a brush under the world. Return false on error.
+	static bool SaveBsp( const char* szFileName, bool bGround, float fGroundHeight );
+
+public:
+	static unsigned int iTraces;             ///< Amount of TraceRay() calls.
+	static unsigned int iNodeTests;          ///< Amount of BVH node boxes tested against rays.
+	static unsigned int iBrushTests;         ///< Amount of brushes clipped against rays.
+
+protected:
+	// Node of BVH. Leaf has iCount brushes starting at iFirst in m_aBrushOrder, inner node has iCount 0 and
+	// children at iFirst and iFirst + 1.
+	typedef struct
+	{
+		Vector vMins, vMaxs;
+		int iFirst, iCount;
+	} bvh_node_t;
+
+	static bool AddBrush( const Vector& vMins, const Vector& vMaxs, const char* szDir, int iSteps );
+	static void BuildNode( int iNode, int iFirst, int iCount );
+	static bool ClipRayToBrush( const Ray_t& ray, const world_brush_t& cBrush, float& fFraction, Vector& vNormal,
+	                            bool& bStartSolid );
+
+	static good::vector<world_brush_t> m_aBrushes;
+	static good::vector<int> m_aBrushOrder;   // Brush indices, ordered by BVH leaves.
+	static good::vector<bvh_node_t> m_aNodes; // Root is node 0.
+	static Vector m_vMins, m_vMaxs;
+};
+
+
+#endif // __HARNESS_WORLD_H__
@@ -0,0 +1,374 @@
+//----------------------------------------------------------------------------------------------------------------
+// Headless runner: loads Botrix plugin into engine stand-in, adds bots and ticks server frames.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#include "good/file.h"
+
+#include "item.h"
+#include "players.h"
+#include "source_engine.h"
+#include "waypoint.h"
+
+#include "chat_test.h"
+#include "harness_engine.h"
+#include "harness_precompute.h"
+#include "harness_world.h"
+
+
+//----------------------------------------------------------------------------------------------------------------
+static void Usage()
+{
+	printf(
+		"Usage: harness [options]\n"
+		"  -data <dir>      folder with botrix/config.ini and waypoints (default: data)\n"
+		"  -game <name>     game folder name (default: harness)\n"
+		"  -mod <name>      mod folder name (default: hl2mp)\n"
+		"  -script <file>   scene script with map, entities, players and timed actions\n"
+		"  -world <file>    world geometry: boxes, ramps and stairs (see harness_world.h)\n"
+		"  -bsp <file>      trace against .bsp file and use its PVS instead of ground and world, copied to game maps\n"
+		"  -savebsp <file>  save ground and world as .bsp file after map starts\n"
+		"  -checkbsp        compare reachability and visibility of waypoints through world and through .bsp file\n"
+		"  -vistable <n>    compute waypoints visibility table with .bsp traces on n threads, save beside waypoints\n"
+		"  -map <name>      map name (default: from .way file or script)\n"
+		"  -way <file>      waypoints file, copied to data folder for the map in its header\n"
+		"  -grid <n>        make grid of n x n waypoints on ground if map has no waypoints (and items without script)\n"
+		"  -bots <n>        amount of bots to add (default: 8)\n"
+		"  -frames <n>      amount of frames to run (default: 6600)\n"
+		"  -fps <n>         server frames per second (default: 66)\n"
+		"  -seed <n>        seed for random generators (default: 1)\n"
+		"  -chattest       test splitting of chat text in requests and exit\n"
+		"  -quiet           don't print plugin messages\n" );
+}
+
+//----------------------------------------------------------------------------------------------------------------
+// Copy waypoints file to where plugin will load it from. Return map name from file header in szMap.
+static bool InstallWaypoints( const good::string& sWayFile, const good::string& sData, const char* szGame,
+                              const char* szMod, char* szMap )
+{
+	size_t iSize = good::file::file_size( sWayFile.c_str() );
+	if ( (iSize == 0) || (iSize == (size_t)-1) )
+		return false;
+
+	char* pBuffer = (char*)malloc(iSize);
+	good::file::file_to_memory( sWayFile.c_str(), pBuffer, iSize );
+	Q_strncpy(szMap, &pBuffer[4], 64); // Map name is after file type id.
+
+	char szFile[MAX_PATH];
+	snprintf(szFile, sizeof(szFile), "%s/botrix/waypoints/%s/%s/%s.way", sData.c_str(), szGame, szMod, szMap);
+	good::file::make_folders(szFile);
+	FILE* f = fopen(szFile, "wb");
+	bool bResult = (f != NULL) && (fwrite(pBuffer, 1, iSize, f) == iSize);
+	if ( f )
+		fclose(f);
+	free(pBuffer);
+	return bResult;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+// Copy .bsp file to maps folder of game, plugin reads map checksum from there. Without .bsp file (sBspFile is
+// empty) file of previous run is removed.
+static bool InstallBsp( const good::string& sBspFile, const char* szGameDir, const char* szMap )
+{
+	char szFile[MAX_PATH];
+	snprintf(szFile, sizeof(szFile), "%s/maps/%s.bsp", szGameDir, szMap);
+	if ( sBspFile.size() == 0 )
+	{
+		remove(szFile);
+		return true;
+	}
+
+	size_t iSize = good::file::file_size( sBspFile.c_str() );
+	if ( (iSize == 0) || (iSize == (size_t)-1) )
+		return false;
+
+	char* pBuffer = (char*)malloc(iSize);
+	good::file::file_to_memory( sBspFile.c_str(), pBuffer, iSize );
+
+	good::file::make_folders(szFile);
+	FILE* f = fopen(szFile, "wb");
+	bool bResult = (f != NULL) && (fwrite(pBuffer, 1, iSize, f) == iSize);
+	if ( f )
+		fclose(f);
+	free(pBuffer);
+	return bResult;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+static int iGrid = 0;
+static bool bGridItems = false;
+
+// Return true if there is geometry besides ground plane: world brushes or .bsp file.
+static bool HasGeometry()
+{
+	return (CHarnessWorld::Size() > 0) || CHarness::bUseBsp;
+}
+
+// With world geometry paths are added only between reachable waypoints.
+static void ConnectGridWaypoints( TWaypointId iFrom, TWaypointId iTo )
+{
+	if ( (iFrom == EWaypointIdInvalid) || (iTo == EWaypointIdInvalid) )
+		return;
+	const Vector& vFrom = CWaypoints::Get(iFrom).vOrigin;
+	const Vector& vTo = CWaypoints::Get(iTo).vOrigin;
+	if ( !HasGeometry() || (CUtil::GetReachableInfoFromTo(vFrom, vTo) == EReachReachable) )
+		CWaypoints::AddPath(iFrom, iTo);
+	if ( !HasGeometry() || (CUtil::GetReachableInfoFromTo(vTo, vFrom) == EReachReachable) )
+		CWaypoints::AddPath(iTo, iFrom);
+}
+
+// Make grid of waypoints with paths to 4 neighbours, at eye level above ground, if map has no waypoints. Bots of
+// HL2DM choose tasks only on maps with items, so put health, armor, ammo and weapon at grid corners if required.
+// With world geometry waypoints are put on top of brushes, grid nodes without ground below are skipped.
+static void MakeWaypointsGrid()
+{
+	if ( (iGrid <= 0) || (CWaypoints::Size() > 0) )
+		return;
+
+	const float fSpacing = 128.0f;
+	float fStart = -fSpacing * (iGrid - 1) / 2;
+	good::vector<TWaypointId> aGrid(iGrid * iGrid);
+	for ( int y = 0; y < iGrid; ++y )
+		for ( int x = 0; x < iGrid; ++x )
+		{
+			Vector vOrigin( fStart + x * fSpacing, fStart + y * fSpacing, CHarness::fGroundHeight );
+			if ( HasGeometry() )
+			{
+				vOrigin.z = (CHarness::bUseBsp ? CHarness::cBsp.GetMaxs().z : CHarnessWorld::GetMaxs().z) + CUtil::iPlayerHeight;
+				if ( !CHarness::GetGroundHeight(vOrigin, vOrigin.z) )
+				{
+					aGrid.push_back(EWaypointIdInvalid);
+					continue;
+				}
+			}
+			vOrigin.z += CUtil::iPlayerEyeLevel;
+			aGrid.push_back( CWaypoints::Add(vOrigin) );
+
+			if ( x > 0 )
+				ConnectGridWaypoints(aGrid.back(), aGrid[aGrid.size() - 2]);
+			if ( y > 0 )
+				ConnectGridWaypoints(aGrid.back(), aGrid[aGrid.size() - 1 - iGrid]);
+		}
+
+	if ( !bGridItems )
+		return;
+
+	static const char* aItems[] = { "item_healthkit", "item_battery", "item_box_buckshot", "weapon_shotgun" };
+	float fEnd = -fStart;
+	Vector aCorners[4] = { Vector(fStart, fStart, 0), Vector(fEnd, fStart, 0), Vector(fStart, fEnd, 0), Vector(fEnd, fEnd, 0) };
+	for ( int i = 0; i < 4; ++i )
+	{
+		aCorners[i].z = CHarness::fGroundHeight;
+		CHarness::CreateEntity( aItems[i], "", aCorners[i], Vector(-8, -8, 0), Vector(8, 8, 16) );
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+	good::string sData("data"), sScript, sWay, sBsp, sSaveBsp;
+	bool bCheckBsp = false, bChatTest = false;
+	int iVisibilityThreads = 0;
+	const char* szGame = "harness";
+	const char* szMod = "hl2mp";
+	char szMap[64] = "";
+	int iBots = 8, iFrames = 6600, iFps = 66;
+	unsigned int iSeed = 1;
+
+	for ( int i = 1; i < argc; ++i )
+	{
+		bool bHasValue = (i + 1 < argc);
+		if ( strcmp(argv[i], "-quiet") == 0 )
+			CHarness::bQuiet = true;
+		else if ( strcmp(argv[i], "-checkbsp") == 0 )
+			bCheckBsp = true;
+		else if ( strcmp(argv[i], "-chattest") == 0 )
+			bChatTest = true;
+		else if ( !bHasValue )
+		{
+			Usage();
+			return 1;
+		}
+		else if ( strcmp(argv[i], "-data") == 0 )
+			sData = argv[++i];
+		else if ( strcmp(argv[i], "-game") == 0 )
+			szGame = argv[++i];
+		else if ( strcmp(argv[i], "-mod") == 0 )
+			szMod = argv[++i];
+		else if ( strcmp(argv[i], "-script") == 0 )
+			sScript = argv[++i];
+		else if ( strcmp(argv[i], "-world") == 0 )
+		{
+			if ( !CHarnessWorld::Load(argv[++i]) )
+				return 1;
+		}
+		else if ( strcmp(argv[i], "-bsp") == 0 )
+		{
+			sBsp = argv[++i];
+			if ( !CHarness::cBsp.Load(sBsp.c_str()) )
+				return 1;
+			CHarness::bUseBsp = true;
+		}
+		else if ( strcmp(argv[i], "-savebsp") == 0 )
+			sSaveBsp = argv[++i];
+		else if ( strcmp(argv[i], "-vistable") == 0 )
+			iVisibilityThreads = atoi(argv[++i]);
+		else if ( strcmp(argv[i], "-map") == 0 )
+			Q_strncpy(szMap, argv[++i], sizeof(szMap));
+		else if ( strcmp(argv[i], "-way") == 0 )
+			sWay = argv[++i];
+		else if ( strcmp(argv[i], "-grid") == 0 )
+			iGrid = atoi(argv[++i]);
+		else if ( strcmp(argv[i], "-bots") == 0 )
+			iBots = atoi(argv[++i]);
+		else if ( strcmp(argv[i], "-frames") == 0 )
+			iFrames = atoi(argv[++i]);
+		else if ( strcmp(argv[i], "-fps") == 0 )
+			iFps = atoi(argv[++i]);
+		else if ( strcmp(argv[i], "-seed") == 0 )
+			iSeed = atoi(argv[++i]);
+		else
+		{
+			Usage();
+			return 1;
+		}
+	}
+
+	if ( (sScript.size() > 0) && !CHarness::LoadScript( sScript.c_str() ) )
+		return 1;
+
+	if ( sWay.size() > 0 )
+	{
+		char szWayMap[64];
+		if ( !InstallWaypoints(sWay, sData, szGame, szMod, szWayMap) )
+		{
+			fprintf(stderr, "Can't install waypoints %s.\n", sWay.c_str());
+			return 1;
+		}
+		if ( szMap[0] == 0 )
+			strcpy(szMap, szWayMap);
+	}
+	if ( szMap[0] == 0 )
+		Q_strncpy(szMap, CHarness::sMapName.c_str(), sizeof(szMap));
+
+	char szGameDir[MAX_PATH];
+	snprintf(szGameDir, sizeof(szGameDir), "%s/%s/%s", sData.c_str(), szGame, szMod);
+	if ( !InstallBsp(sBsp, szGameDir, szMap) )
+	{
+		fprintf(stderr, "Can't install BSP file %s.\n", sBsp.c_str());
+		return 1;
+	}
+	CHarness::Init(szGameDir, CHarness::iMaxPlayers, 1.0f / iFps);
+	CHarness::iRandomSeed = iSeed;
+
+	if ( !CHarness::LoadPlugin() )
+	{
+		fprintf(stderr, "Plugin failed to load.\n");
+		return 1;
+	}
+	srand(iSeed); // Plugin seeds by time on load.
+
+	if ( bChatTest )
+	{
+		int iErrors = CHarnessChatTest::Run(!CHarness::bQuiet);
+		printf("Chat test: %d errors.\n", iErrors);
+		CHarness::UnloadPlugin();
+		return iErrors ? 3 : 0;
+	}
+
+	if ( iGrid > 0 )
+		CHarness::bGround = true;
+	bGridItems = (sScript.size() == 0);
+	CHarness::LevelInit(szMap, MakeWaypointsGrid);
+
+	// Offline jobs.
+	if ( sSaveBsp.size() > 0 )
+	{
+		if ( !CHarnessWorld::SaveBsp(sSaveBsp.c_str(), CHarness::bGround, CHarness::fGroundHeight) )
+		{
+			fprintf(stderr, "Can't save BSP file %s.\n", sSaveBsp.c_str());
+			return 1;
+		}
+		if ( !CHarness::cBsp.IsLoaded() && (bCheckBsp || (iVisibilityThreads > 0)) && !CHarness::cBsp.Load(sSaveBsp.c_str()) )
+			return 1;
+	}
+	if ( (bCheckBsp || (iVisibilityThreads > 0)) && !CHarness::cBsp.IsLoaded() )
+	{
+		fprintf(stderr, "No BSP file, use -bsp or -savebsp.\n");
+		return 1;
+	}
+	if ( bCheckBsp )
+		CHarnessPrecompute::CheckBsp(!CHarness::bQuiet);
+	if ( iVisibilityThreads > 0 )
+	{
+		good::vector<unsigned char> aTable;
+		double fTableStart = Plat_FloatTime();
+		CHarnessPrecompute::MakeVisibilityTable(CHarness::cBsp, iVisibilityThreads, aTable);
+		double fTableTime = Plat_FloatTime() - fTableStart;
+
+		const good::string& sTableFile = CUtil::BuildFileName("waypoints", szMap, "vis");
+		if ( !CHarnessPrecompute::SaveVisibilityTable(sTableFile.c_str(), aTable) )
+			fprintf(stderr, "Can't save visibility table %s.\n", sTableFile.c_str());
+
+		fTableStart = Plat_FloatTime();
+		int iErrors = CHarnessPrecompute::CheckVisibilityTable(aTable);
+		printf("Visibility table of %d waypoints: %.3f seconds on %d threads (%.3f seconds to check through engine), %d differences.\n",
+		       CWaypoints::Size(), fTableTime, iVisibilityThreads, Plat_FloatTime() - fTableStart, iErrors);
+	}
+
+	for ( int i = 0; i < iBots; ++i )
+		if ( CPlayers::AddBot( CHarness::Random(EBotIntelligenceTotal) ) == NULL )
+		{
+			fprintf(stderr, "Can't add bot %d.\n", i + 1);
+			break;
+		}
+
+	// Tick server.
+	double fMaxFrame = 0.0;
+	double fStart = Plat_FloatTime();
+	for ( int i = 0; i < iFrames; ++i )
+	{
+		double fFrameStart = Plat_FloatTime();
+		CHarness::Frame();
+		double fFrame = Plat_FloatTime() - fFrameStart;
+		if ( fFrame > fMaxFrame )
+			fMaxFrame = fFrame;
+	}
+	double fTotal = Plat_FloatTime() - fStart;
+
+	// State hash of players, to compare runs with the same seed.
+	unsigned int iHash = 2166136261u;
+	for ( int i = 0; i < CHarness::iMaxPlayers; ++i )
+	{
+		const CHarnessPlayer& cPlayer = CHarness::aPlayers[i];
+		if ( !cPlayer.m_bConnected )
+			continue;
+		if ( !CHarness::bQuiet )
+			printf("%-16s origin (%.0f %.0f %.0f), health %d, armor %d, frags %d, deaths %d, weapon %s.\n", cPlayer.m_sName.c_str(),
+			       cPlayer.m_vOrigin.x, cPlayer.m_vOrigin.y, cPlayer.m_vOrigin.z, cPlayer.m_iHealth, cPlayer.m_iArmor,
+			       cPlayer.m_iFrags, cPlayer.m_iDeaths, cPlayer.m_sWeapon.c_str());
+		int aValues[4] = { CUtil::Round(cPlayer.m_vOrigin.x), CUtil::Round(cPlayer.m_vOrigin.y), CUtil::Round(cPlayer.m_vOrigin.z), cPlayer.m_iHealth };
+		for ( int j = 0; j < 4; ++j )
+			iHash = (iHash ^ (unsigned int)aValues[j]) * 16777619u;
+	}
+
+	int iChecked;
+	int iFieldErrors = CItems::CheckFieldOffsets(iChecked);
+
+	printf("Map %s: %d waypoints, %d bots, %d entities.\n", szMap, CWaypoints::Size(), CPlayers::GetBotsCount(),
+	       CHarness::iEdictCount - CHarness::iMaxPlayers - 1);
+	printf("Frames: %d (%.1f game seconds) in %.3f seconds, %.4f ms per frame average, %.4f ms max.\n",
+	       iFrames, CHarness::fTime, fTotal, fTotal * 1000.0 / MAX2(iFrames, 1), fMaxFrame * 1000.0);
+	printf("Entity field offsets: %d checked, %d errors.\n", iChecked, iFieldErrors);
+	if ( CHarness::bUseBsp )
+		printf("BSP: %d brushes, %d clusters.\n", CHarness::cBsp.GetBrushesCount(), CHarness::cBsp.GetClusterCount());
+	else if ( CHarnessWorld::Size() > 0 )
+		printf("World: %d brushes, %u traces, %.1f BVH nodes and %.1f brushes tested per trace.\n", CHarnessWorld::Size(),
+		       CHarnessWorld::iTraces, (float)CHarnessWorld::iNodeTests / MAX2(CHarnessWorld::iTraces, 1u),
+		       (float)CHarnessWorld::iBrushTests / MAX2(CHarnessWorld::iTraces, 1u));
+	printf("State hash: %08x\n", iHash);
+
+	CHarness::LevelShutdown();
+	CHarness::UnloadPlugin();
+	return iFieldErrors ? 2 : 0;
+}
@@ -0,0 +1,2 @@
+// Harness stand-in for SDK header edict.h.
+#include "harness_sdk.h"
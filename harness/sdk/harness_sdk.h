@@ -0,0 +1,1049 @@
+//----------------------------------------------------------------------------------------------------------------
+// Stand-in for the slice of Source SDK 2013 that Botrix uses. Only declarations that plugin code touches are
+// here, with the same names and signatures as in the SDK, so plugin sources compile unchanged on Linux against
+// the headless harness. Engine interfaces are implemented in harness/harness_engine.cpp.
+// Copyright (c) 2012 Borzh.
+//----------------------------------------------------------------------------------------------------------------
+
+#ifndef __HARNESS_SDK_H__
+#define __HARNESS_SDK_H__
+
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+
+//================================================================================================================
+// tier0: platform and debug output.
+//================================================================================================================
+typedef unsigned char byte;
+typedef unsigned int uint;
+typedef long long int64;
+
+#define FORCEINLINE inline
+#define Assert(x)
+
+#define MAX_PATH 260
+
+template <typename T> inline T min( T a, T b ) { return (a < b) ? a : b; }
+template <typename T> inline T max( T a, T b ) { return (a > b) ? a : b; }
+
+/// Seconds since harness start, with high resolution.
+double Plat_FloatTime();
+
+void Msg( const char* szFormat, ... );
+void Warning( const char* szFormat, ... );
+void DevMsg( const char* szFormat, ... );
+
+#define Q_stricmp strcasecmp
+#define Q_strncpy(dst, src, size) ( strncpy(dst, src, size), (dst)[(size)-1] = 0 )
+#define Q_snprintf snprintf
+
+
+//================================================================================================================
+// mathlib.
+//================================================================================================================
+#ifndef M_PI
+#	define M_PI 3.14159265358979323846
+#endif
+#define DEG2RAD(x) ( (float)(x) * (float)(M_PI / 180.0f) )
+#define RAD2DEG(x) ( (float)(x) * (float)(180.0f / M_PI) )
+
+typedef float vec_t;
+
+/// Check that float is not NaN or infinity.
+inline bool IsFinite( vec_t f ) { return isfinite(f) != 0; }
+
+//****************************************************************************************************************
+class Vector
+{
+public:
+	vec_t x, y, z;
+
+	Vector() {}
+	Vector( vec_t X, vec_t Y, vec_t Z ): x(X), y(Y), z(Z) {}
+
+	void Init( vec_t X = 0.0f, vec_t Y = 0.0f, vec_t Z = 0.0f ) { x = X; y = Y; z = Z; }
+	void Zero() { x = y = z = 0.0f; }
+	void Negate() { x = -x; y = -y; z = -z; }
+
+	vec_t& operator[]( int i ) { return (&x)[i]; }
+	vec_t operator[]( int i ) const { return (&x)[i]; }
+	vec_t* Base() { return &x; }
+	const vec_t* Base() const { return &x; }
+
+	bool operator==( const Vector& v ) const { return (x == v.x) && (y == v.y) && (z == v.z); }
+	bool operator!=( const Vector& v ) const { return !(*this == v); }
+
+	Vector& operator+=( const Vector& v ) { x += v.x; y += v.y; z += v.z; return *this; }
+	Vector& operator-=( const Vector& v ) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+	Vector& operator*=( float f ) { x *= f; y *= f; z *= f; return *this; }
+	Vector& operator/=( float f ) { x /= f; y /= f; z /= f; return *this; }
+
+	Vector operator-() const { return Vector(-x, -y, -z); }
+	Vector operator+( const Vector& v ) const { return Vector(x + v.x, y + v.y, z + v.z); }
+	Vector operator-( const Vector& v ) const { return Vector(x - v.x, y - v.y, z - v.z); }
+	Vector operator*( const Vector& v ) const { return Vector(x * v.x, y * v.y, z * v.z); }
+	Vector operator*( float f ) const { return Vector(x * f, y * f, z * f); }
+	Vector operator/( float f ) const { return Vector(x / f, y / f, z / f); }
+
+	vec_t Dot( const Vector& v ) const { return x*v.x + y*v.y + z*v.z; }
+	Vector Cross( const Vector& v ) const { return Vector(y*v.z - z*v.y, z*v.x - x*v.z, x*v.y - y*v.x); }
+
+	vec_t LengthSqr() const { return x*x + y*y + z*z; }
+	vec_t Length() const { return sqrtf( LengthSqr() ); }
+	vec_t Length2DSqr() const { return x*x + y*y; }
+	vec_t Length2D() const { return sqrtf( Length2DSqr() ); }
+	vec_t DistToSqr( const Vector& v ) const { return (*this - v).LengthSqr(); }
+	vec_t DistTo( const Vector& v ) const { return (*this - v).Length(); }
+	bool IsValid() const { return IsFinite(x) && IsFinite(y) && IsFinite(z); }
+	bool IsZero( float fTolerance = 0.01f ) const
+	{
+		return (x > -fTolerance) && (x < fTolerance) && (y > -fTolerance) && (y < fTolerance) && (z > -fTolerance) && (z < fTolerance);
+	}
+
+	vec_t NormalizeInPlace()
+	{
+		vec_t fLength = Length();
+		if ( fLength > 0.0f )
+			*this /= fLength;
+		return fLength;
+	}
+};
+
+inline Vector operator*( float f, const Vector& v ) { return v * f; }
+inline vec_t DotProduct( const Vector& a, const Vector& b ) { return a.Dot(b); }
+inline void CrossProduct( const Vector& a, const Vector& b, Vector& result ) { result = a.Cross(b); }
+inline vec_t VectorNormalize( Vector& v ) { return v.NormalizeInPlace(); }
+inline vec_t VectorLength( const Vector& v ) { return v.Length(); }
+
+//****************************************************************************************************************
+class Vector2D
+{
+public:
+	vec_t x, y;
+
+	Vector2D() {}
+	Vector2D( vec_t X, vec_t Y ): x(X), y(Y) {}
+
+	vec_t& operator[]( int i ) { return (&x)[i]; }
+	vec_t operator[]( int i ) const { return (&x)[i]; }
+
+	Vector2D operator+( const Vector2D& v ) const { return Vector2D(x + v.x, y + v.y); }
+	Vector2D operator-( const Vector2D& v ) const { return Vector2D(x - v.x, y - v.y); }
+	Vector2D operator*( float f ) const { return Vector2D(x * f, y * f); }
+
+	vec_t LengthSqr() const { return x*x + y*y; }
+	vec_t Length() const { return sqrtf( LengthSqr() ); }
+};
+
+//****************************************************************************************************************
+class QAngle
+{
+public:
+	vec_t x, y, z; // Pitch, yaw, roll.
+
+	QAngle() {}
+	QAngle( vec_t X, vec_t Y, vec_t Z ): x(X), y(Y), z(Z) {}
+
+	void Init( vec_t X = 0.0f, vec_t Y = 0.0f, vec_t Z = 0.0f ) { x = X; y = Y; z = Z; }
+	bool IsValid() const { return IsFinite(x) && IsFinite(y) && IsFinite(z); }
+
+	vec_t& operator[]( int i ) { return (&x)[i]; }
+	vec_t operator[]( int i ) const { return (&x)[i]; }
+
+	bool operator==( const QAngle& a ) const { return (x == a.x) && (y == a.y) && (z == a.z); }
+	bool operator!=( const QAngle& a ) const { return !(*this == a); }
+
+	QAngle& operator+=( const QAngle& a ) { x += a.x; y += a.y; z += a.z; return *this; }
+	QAngle& operator-=( const QAngle& a ) { x -= a.x; y -= a.y; z -= a.z; return *this; }
+	QAngle& operator*=( float f ) { x *= f; y *= f; z *= f; return *this; }
+	QAngle& operator/=( float f ) { x /= f; y /= f; z /= f; return *this; }
+
+	QAngle operator+( const QAngle& a ) const { return QAngle(x + a.x, y + a.y, z + a.z); }
+	QAngle operator-( const QAngle& a ) const { return QAngle(x - a.x, y - a.y, z - a.z); }
+	QAngle operator*( float f ) const { return QAngle(x * f, y * f, z * f); }
+};
+
+extern const Vector vec3_origin;
+extern const QAngle vec3_angle;
+
+/// Get pitch and yaw of direction vector.
+void VectorAngles( const Vector& vForward, QAngle& angles );
+/// Get forward, right and up vectors for angles.
+void AngleVectors( const QAngle& angles, Vector* pForward, Vector* pRight = NULL, Vector* pUp = NULL );
+/// Get right and up vectors perpendicular to forward.
+void VectorVectors( const Vector& vForward, Vector& vRight, Vector& vUp );
+
+inline void MathLib_Init( float gamma = 2.2f, float texGamma = 2.2f, float brightness = 0.0f, int overbright = 2,
+                          bool bAllow3DNow = true, bool bAllowSSE = true, bool bAllowSSE2 = true, bool bAllowMMX = true ) {}
+
+
+//================================================================================================================
+// Color, strings.
+//================================================================================================================
+class Color
+{
+public:
+	Color() { m_aColor[0] = m_aColor[1] = m_aColor[2] = m_aColor[3] = 0; }
+	Color( int r, int g, int b, int a = 255 ) { m_aColor[0] = r; m_aColor[1] = g; m_aColor[2] = b; m_aColor[3] = a; }
+	int r() const { return m_aColor[0]; }
+	int g() const { return m_aColor[1]; }
+	int b() const { return m_aColor[2]; }
+	int a() const { return m_aColor[3]; }
+
+protected:
+	unsigned char m_aColor[4];
+};
+
+typedef const char* string_t;
+#define STRING(s) (s)
+#define MAKE_STRING(s) (s)
+#define NULL_STRING ((string_t)0)
+
+
+//================================================================================================================
+// Interfaces.
+//================================================================================================================
+typedef void* (*CreateInterfaceFn)( const char* szName, int* pReturnCode );
+
+#define EXPOSE_SINGLE_INTERFACE_GLOBALVAR(className, interfaceName, versionName, globalVarName) \
+	void* HarnessGetPluginInterface() { return static_cast<interfaceName*>(&globalVarName); }
+
+#define INTERFACEVERSION_VENGINESERVER          "VEngineServer023"
+#define INTERFACEVERSION_ENGINETRACE_SERVER     "EngineTraceServer003"
+#define INTERFACEVERSION_ISERVERPLUGINHELPERS   "ISERVERPLUGINHELPERS001"
+#define INTERFACEVERSION_ISERVERPLUGINCALLBACKS "ISERVERPLUGINCALLBACKS003"
+#define INTERFACEVERSION_GAMEEVENTSMANAGER      "GAMEEVENTSMANAGER001"
+#define INTERFACEVERSION_GAMEEVENTSMANAGER2     "GAMEEVENTSMANAGER002"
+#define INTERFACEVERSION_PLAYERINFOMANAGER      "PlayerInfoManager002"
+#define INTERFACEVERSION_PLAYERBOTMANAGER       "BotManager001"
+#define INTERFACEVERSION_SERVERGAMECLIENTS      "ServerGameClients004"
+#define IEFFECTS_INTERFACE_VERSION              "IEffects001"
+#define VDEBUG_OVERLAY_INTERFACE_VERSION        "VDebugOverlay003"
+#define FILESYSTEM_INTERFACE_VERSION            "VFileSystem022"
+#define CVAR_INTERFACE_VERSION                  "VEngineCvar004"
+
+
+//================================================================================================================
+// Entities.
+//================================================================================================================
+#define MAX_EDICT_BITS 11
+#define MAX_EDICTS     (1 << MAX_EDICT_BITS)
+
+class CBaseEntity;
+class IServerNetworkable;
+class IServerEntity;
+class ICollideable;
+
+//****************************************************************************************************************
+/// Base of everything that can be hit by trace.
+//****************************************************************************************************************
+class IHandleEntity
+{
+public:
+	virtual ~IHandleEntity() {}
+};
+
+//****************************************************************************************************************
+struct PVSInfo_t
+{
+	short m_nHeadNode;
+	short m_nClusterCount;
+	unsigned short* m_pClusters;
+	short m_nAreaNum;
+	short m_nAreaNum2;
+	float m_vCenter[3];
+};
+
+//****************************************************************************************************************
+class IServerNetworkable
+{
+public:
+	virtual IHandleEntity* GetEntityHandle() = 0;
+	virtual PVSInfo_t* GetPVSInfo() = 0;
+	virtual CBaseEntity* GetBaseEntity() = 0;
+};
+
+//****************************************************************************************************************
+class ICollideable
+{
+public:
+	virtual IHandleEntity* GetEntityHandle() = 0;
+	virtual const Vector& OBBMins() const = 0;
+	virtual const Vector& OBBMaxs() const = 0;
+	virtual const Vector& GetCollisionOrigin() const = 0;
+	virtual const QAngle& GetCollisionAngles() const = 0;
+	virtual void WorldSpaceSurroundingBounds( Vector* pVecMins, Vector* pVecMaxs ) = 0;
+};
+
+//****************************************************************************************************************
+class IServerEntity: public IHandleEntity
+{
+public:
+	virtual ICollideable* GetCollideable() = 0;
+	virtual IServerNetworkable* GetNetworkable() = 0;
+	virtual CBaseEntity* GetBaseEntity() = 0;
+	virtual string_t GetModelName() const = 0;
+};
+
+//----------------------------------------------------------------------------------------------------------------
+// Data description, so plugin can read entity fields by offset.
+//----------------------------------------------------------------------------------------------------------------
+enum fieldtype_t
+{
+	FIELD_VOID = 0,
+	FIELD_FLOAT,
+	FIELD_STRING,
+	FIELD_VECTOR,
+	FIELD_QUATERNION,
+	FIELD_INTEGER,
+	FIELD_BOOLEAN,
+};
+
+#define FTYPEDESC_SAVE   0x0001
+#define FTYPEDESC_KEY    0x0004
+
+enum
+{
+	TD_OFFSET_NORMAL = 0,
+	TD_OFFSET_PACKED = 1,
+	TD_OFFSET_COUNT,
+};
+
+struct datamap_t;
+
+struct typedescription_t
+{
+	fieldtype_t fieldType;
+	const char* fieldName;
+	int fieldOffset[TD_OFFSET_COUNT];
+	unsigned short fieldSize;
+	short flags;
+	const char* externalName;
+	void* pSaveRestoreOps;
+	void* inputFunc;
+	datamap_t* td;
+	int fieldSizeInBytes;
+	typedescription_t* override_field;
+	int override_count;
+	float fieldTolerance;
+};
+
+struct datamap_t
+{
+	typedescription_t* dataDesc;
+	int dataNumFields;
+	const char* dataClassName;
+	datamap_t* baseMap;
+	bool chains_validated;
+	bool packed_offsets_computed;
+	int packed_size;
+};
+
+#define EF_BONEMERGE  0x001
+#define EF_NODRAW     0x020
+
+//****************************************************************************************************************
+/// Scripted entity of the harness. Same name as game's class, so plugin code using CBaseEntity compiles, but
+/// only has what plugin uses: key values, data description with effects/health fields, model and bounding box.
+//****************************************************************************************************************
+class CBaseEntity: public IServerEntity, public IServerNetworkable, public ICollideable
+{
+public:
+	CBaseEntity();
+	virtual ~CBaseEntity() {}
+
+	// IServerEntity.
+	virtual ICollideable* GetCollideable() { return this; }
+	virtual IServerNetworkable* GetNetworkable() { return this; }
+	virtual CBaseEntity* GetBaseEntity() { return this; }
+	virtual string_t GetModelName() const { return m_szModelName; }
+
+	// IServerNetworkable.
+	virtual IHandleEntity* GetEntityHandle() { return this; }
+	virtual PVSInfo_t* GetPVSInfo();
+
+	// ICollideable.
+	virtual const Vector& OBBMins() const { return m_vMins; }
+	virtual const Vector& OBBMaxs() const { return m_vMaxs; }
+	virtual const Vector& GetCollisionOrigin() const { return m_vOrigin; }
+	virtual const QAngle& GetCollisionAngles() const { return m_angAngles; }
+	virtual void WorldSpaceSurroundingBounds( Vector* pVecMins, Vector* pVecMaxs ) { *pVecMins = m_vOrigin + m_vMins; *pVecMaxs = m_vOrigin + m_vMaxs; }
+
+	/// Get value of key field (as in map's entity lump). Return false if there is no such key.
+	bool GetKeyValue( const char* szKeyName, char* szValue, int iMaxLen );
+	/// Get data description of this entity class.
+	virtual datamap_t* GetDataDescMap() { return &m_DataMap; }
+	/// Get targetname.
+	string_t GetEntityName() { return m_szName; }
+
+public:
+	char m_szClassName[64];
+	char m_szName[64];
+	char m_szModelName[128];
+	Vector m_vOrigin, m_vMins, m_vMaxs;
+	QAngle m_angAngles;
+	int m_fEffects;
+	int m_iHealth;
+	int m_iOwner;                // Player index + 1 that owns this entity (weapons), or 0.
+
+	static datamap_t m_DataMap;
+
+protected:
+	PVSInfo_t m_PVSInfo;
+};
+
+//****************************************************************************************************************
+struct edict_t
+{
+public:
+	bool IsFree() const { return m_bFree; }
+	IServerEntity* GetIServerEntity() { return m_pEntity; }
+	const IServerEntity* GetIServerEntity() const { return m_pEntity; }
+	IServerNetworkable* GetNetworkable() { return m_pEntity; }
+	ICollideable* GetCollideable() { return m_pEntity; }
+	IServerEntity* GetUnknown() { return m_pEntity; }
+	const char* GetClassName() const { return m_pEntity ? m_pEntity->m_szClassName : ""; }
+
+public:
+	bool m_bFree;
+	CBaseEntity* m_pEntity;
+};
+
+
+//================================================================================================================
+// Traces.
+//================================================================================================================
+#define CONTENTS_EMPTY        0
+#define CONTENTS_SOLID        0x1
+#define CONTENTS_WINDOW       0x2
+#define CONTENTS_GRATE        0x8
+#define CONTENTS_WATER        0x20
+#define CONTENTS_MOVEABLE     0x4000
+#define CONTENTS_PLAYERCLIP   0x10000
+#define CONTENTS_MONSTERCLIP  0x20000
+#define CONTENTS_MONSTER      0x2000000
+#define CONTENTS_DEBRIS       0x4000000
+#define CONTENTS_HITBOX       0x40000000
+
+#define MASK_ALL              (0xFFFFFFFF)
+#define MASK_SOLID            (CONTENTS_SOLID|CONTENTS_MOVEABLE|CONTENTS_WINDOW|CONTENTS_MONSTER|CONTENTS_GRATE)
+#define MASK_PLAYERSOLID      (CONTENTS_SOLID|CONTENTS_MOVEABLE|CONTENTS_PLAYERCLIP|CONTENTS_WINDOW|CONTENTS_MONSTER|CONTENTS_GRATE)
+#define MASK_NPCSOLID         (CONTENTS_SOLID|CONTENTS_MOVEABLE|CONTENTS_MONSTERCLIP|CONTENTS_WINDOW|CONTENTS_MONSTER|CONTENTS_GRATE)
+#define MASK_OPAQUE           (CONTENTS_SOLID|CONTENTS_MOVEABLE)
+#define MASK_SOLID_BRUSHONLY  (CONTENTS_SOLID|CONTENTS_MOVEABLE|CONTENTS_WINDOW|CONTENTS_GRATE)
+
+#define MAX_MAP_CLUSTERS 65536
+
+enum TraceType_t
+{
+	TRACE_EVERYTHING = 0,
+	TRACE_WORLD_ONLY,
+	TRACE_ENTITIES_ONLY,
+	TRACE_EVERYTHING_FILTER_PROPS,
+};
+
+//****************************************************************************************************************
+class ITraceFilter
+{
+public:
+	virtual ~ITraceFilter() {}
+	virtual bool ShouldHitEntity( IHandleEntity* pEntity, int contentsMask ) = 0;
+	virtual TraceType_t GetTraceType() const = 0;
+};
+
+class CTraceFilter: public ITraceFilter
+{
+public:
+	virtual TraceType_t GetTraceType() const { return TRACE_EVERYTHING; }
+};
+
+class CTraceFilterHitAll: public CTraceFilter
+{
+public:
+	virtual bool ShouldHitEntity( IHandleEntity* pEntity, int contentsMask ) { return true; }
+};
+
+class CTraceFilterWorldOnly: public ITraceFilter
+{
+public:
+	bool ShouldHitEntity( IHandleEntity* pEntity, int contentsMask ) { return false; }
+	virtual TraceType_t GetTraceType() const { return TRACE_WORLD_ONLY; }
+};
+
+class CTraceFilterWorldAndPropsOnly: public ITraceFilter
+{
+public:
+	bool ShouldHitEntity( IHandleEntity* pEntity, int contentsMask ) { return false; }
+	virtual TraceType_t GetTraceType() const { return TRACE_EVERYTHING; }
+};
+
+//****************************************************************************************************************
+struct Ray_t
+{
+	Vector m_Start;       // Starting point, centered within the extents.
+	Vector m_Delta;       // Direction + length of the ray.
+	Vector m_StartOffset; // Add this to m_Start to get the actual ray start.
+	Vector m_Extents;     // Describes an axis aligned box extruded along a ray.
+	bool m_IsRay;         // Are the extents zero?
+	bool m_IsSwept;       // Is delta != 0?
+
+	void Init( const Vector& start, const Vector& end )
+	{
+		m_Delta = end - start;
+		m_IsSwept = (m_Delta.LengthSqr() != 0);
+		m_Extents.Init();
+		m_IsRay = true;
+		m_StartOffset.Init();
+		m_Start = start;
+	}
+
+	void Init( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs )
+	{
+		m_Delta = end - start;
+		m_IsSwept = (m_Delta.LengthSqr() != 0);
+		m_Extents = (maxs - mins) * 0.5f;
+		m_IsRay = (m_Extents.LengthSqr() < 1e-6);
+		m_StartOffset = (mins + maxs) * 0.5f;
+		m_Start = start + m_StartOffset;
+		m_StartOffset *= -1.0f;
+	}
+};
+
+struct cplane_t
+{
+	Vector normal;
+	float dist;
+	byte type;
+	byte signbits;
+	byte pad[2];
+};
+
+struct csurface_t
+{
+	const char* name;
+	short surfaceProps;
+	unsigned short flags;
+};
+
+//****************************************************************************************************************
+class CGameTrace
+{
+public:
+	bool DidHit() const { return (fraction < 1.0f) || allsolid || startsolid; }
+
+public:
+	Vector startpos;
+	Vector endpos;
+	cplane_t plane;
+	float fraction;
+	int contents;
+	unsigned short dispFlags;
+	bool allsolid;
+	bool startsolid;
+	float fractionleftsolid;
+	csurface_t surface;
+	int hitgroup;
+	short physicsbone;
+	CBaseEntity* m_pEnt;
+	int hitbox;
+};
+typedef CGameTrace trace_t;
+
+//****************************************************************************************************************
+class IEngineTrace
+{
+public:
+	virtual int GetPointContents( const Vector& vecAbsPosition, IHandleEntity** ppEntity = NULL ) = 0;
+	virtual void TraceRay( const Ray_t& ray, unsigned int fMask, ITraceFilter* pTraceFilter, trace_t* pTrace ) = 0;
+};
+
+
+//================================================================================================================
+// Key values and game events.
+//================================================================================================================
+//****************************************************************************************************************
+/// Flat key values: a named node with a string value and a list of sub keys. Key names are symbols of
+/// IKeyValuesSystem, as in the SDK, so plugin can search keys by symbol.
+//****************************************************************************************************************
+class KeyValues
+{
+public:
+	KeyValues( const char* szName );
+	~KeyValues();
+
+	void deleteThis() { delete this; }
+
+	const char* GetName() const;
+	int GetNameSymbol() const { return m_iKeyName; }
+
+	KeyValues* FindKey( const char* szKeyName, bool bCreate = false );
+	KeyValues* FindKey( int iKeySymbol ) const;
+
+	KeyValues* GetFirstSubKey() { return m_pSub; }
+	KeyValues* GetNextKey() { return m_pPeer; }
+	KeyValues* GetFirstTrueSubKey() { return NULL; } // All sub keys are values.
+	KeyValues* GetNextTrueSubKey() { return NULL; }
+	KeyValues* GetFirstValue() { return m_pSub; }
+	KeyValues* GetNextValue() { return m_pPeer; }
+
+	int GetInt( const char* szKeyName = NULL, int iDefaultValue = 0 );
+	float GetFloat( const char* szKeyName = NULL, float fDefaultValue = 0.0f );
+	const char* GetString( const char* szKeyName = NULL, const char* szDefaultValue = "" );
+	bool GetBool( const char* szKeyName = NULL, bool bDefaultValue = false ) { return GetInt(szKeyName, bDefaultValue) != 0; }
+
+	void SetInt( const char* szKeyName, int iValue );
+	void SetFloat( const char* szKeyName, float fValue );
+	void SetString( const char* szKeyName, const char* szValue );
+	void SetBool( const char* szKeyName, bool bValue ) { SetInt(szKeyName, bValue); }
+	void SetColor( const char* szKeyName, Color cValue );
+
+	KeyValues* MakeCopy() const;
+
+protected:
+	int m_iKeyName;
+	char* m_szValue;
+	KeyValues* m_pPeer;
+	KeyValues* m_pSub;
+};
+
+//****************************************************************************************************************
+class IKeyValuesSystem
+{
+public:
+	virtual int GetSymbolForString( const char* szName, bool bCreate = true ) = 0;
+	virtual const char* GetStringForSymbol( int iSymbol ) = 0;
+};
+
+IKeyValuesSystem* KeyValuesSystem();
+
+//****************************************************************************************************************
+class IGameEvent
+{
+public:
+	virtual ~IGameEvent() {}
+	virtual const char* GetName() const = 0;
+
+	virtual bool IsEmpty( const char* szKeyName = NULL ) = 0;
+	virtual bool GetBool( const char* szKeyName = NULL, bool bDefaultValue = false ) = 0;
+	virtual int GetInt( const char* szKeyName = NULL, int iDefaultValue = 0 ) = 0;
+	virtual float GetFloat( const char* szKeyName = NULL, float fDefaultValue = 0.0f ) = 0;
+	virtual const char* GetString( const char* szKeyName = NULL, const char* szDefaultValue = "" ) = 0;
+
+	virtual void SetBool( const char* szKeyName, bool bValue ) = 0;
+	virtual void SetInt( const char* szKeyName, int iValue ) = 0;
+	virtual void SetFloat( const char* szKeyName, float fValue ) = 0;
+	virtual void SetString( const char* szKeyName, const char* szValue ) = 0;
+};
+
+class IGameEventListener
+{
+public:
+	virtual ~IGameEventListener() {}
+	virtual void FireGameEvent( KeyValues* pEvent ) = 0;
+};
+
+class IGameEventListener2
+{
+public:
+	virtual ~IGameEventListener2() {}
+	virtual void FireGameEvent( IGameEvent* pEvent ) = 0;
+};
+
+//****************************************************************************************************************
+class IGameEventManager
+{
+public:
+	virtual bool AddListener( IGameEventListener* pListener, const char* szEvent, bool bIsServerSide ) = 0;
+	virtual bool AddListener( IGameEventListener* pListener, bool bIsServerSide ) = 0;
+	virtual void RemoveListener( IGameEventListener* pListener ) = 0;
+	virtual KeyValues* GetEvent( const char* szName ) = 0;
+	virtual bool FireEvent( KeyValues* pEvent ) = 0;
+};
+
+class IGameEventManager2
+{
+public:
+	virtual bool AddListener( IGameEventListener2* pListener, const char* szName, bool bServerSide ) = 0;
+	virtual void RemoveListener( IGameEventListener2* pListener ) = 0;
+	virtual IGameEvent* CreateEvent( const char* szName, bool bForce = false ) = 0;
+	virtual bool FireEvent( IGameEvent* pEvent, bool bDontBroadcast = false ) = 0;
+	virtual void FreeEvent( IGameEvent* pEvent ) = 0;
+};
+
+
+//================================================================================================================
+// Console variables and commands.
+//================================================================================================================
+#define FCVAR_NONE 0
+
+#define COMMAND_COMPLETION_MAXITEMS     64
+#define COMMAND_COMPLETION_ITEM_LENGTH  64
+#define COMMAND_MAX_ARGC                64
+
+//****************************************************************************************************************
+class CCommand
+{
+public:
+	CCommand(): m_iArgc(0) {}
+	CCommand( int iArgc, const char** aArgv );
+
+	int ArgC() const { return m_iArgc; }
+	const char** ArgV() const { return m_iArgc ? (const char**)m_aArgv : NULL; }
+	const char* Arg( int i ) const { return (i < m_iArgc) ? m_aArgv[i] : ""; }
+	const char* operator[]( int i ) const { return Arg(i); }
+
+protected:
+	int m_iArgc;
+	const char* m_aArgv[COMMAND_MAX_ARGC];
+};
+
+typedef void (*FnCommandCallback_t)( const CCommand& command );
+typedef int (*FnCommandCompletionCallback)( const char* szPartial, char aCommands[COMMAND_COMPLETION_MAXITEMS][COMMAND_COMPLETION_ITEM_LENGTH] );
+
+//****************************************************************************************************************
+class ConCommandBase
+{
+public:
+	ConCommandBase( const char* szName, const char* szHelp = NULL, int iFlags = 0 ): m_szName(szName), m_szHelp(szHelp), m_iFlags(iFlags) {}
+	virtual ~ConCommandBase() {}
+
+	const char* GetName() const { return m_szName; }
+	const char* GetHelpText() const { return m_szHelp; }
+
+protected:
+	const char* m_szName;
+	const char* m_szHelp;
+	int m_iFlags;
+};
+
+class ConCommand: public ConCommandBase
+{
+public:
+	ConCommand( const char* szName, FnCommandCallback_t fnCallback, const char* szHelp = NULL, int iFlags = 0,
+	            FnCommandCompletionCallback fnCompletion = NULL ):
+		ConCommandBase(szName, szHelp, iFlags), m_fnCallback(fnCallback), m_fnCompletion(fnCompletion) {}
+
+	void Dispatch( const CCommand& command ) { m_fnCallback(command); }
+
+protected:
+	FnCommandCallback_t m_fnCallback;
+	FnCommandCompletionCallback m_fnCompletion;
+};
+
+class ConVar: public ConCommandBase
+{
+public:
+	ConVar( const char* szName, const char* szDefaultValue, int iFlags = 0, const char* szHelp = NULL );
+
+	const char* GetString() const { return m_szValue; }
+	int GetInt() const { return atoi(m_szValue); }
+	float GetFloat() const { return (float)atof(m_szValue); }
+	bool GetBool() const { return GetInt() != 0; }
+
+	void SetValue( const char* szValue ) { Q_strncpy(m_szValue, szValue, sizeof(m_szValue)); }
+	void SetValue( int iValue ) { snprintf(m_szValue, sizeof(m_szValue), "%d", iValue); }
+
+protected:
+	char m_szValue[64];
+};
+
+//****************************************************************************************************************
+class ICvar
+{
+public:
+	virtual void RegisterConCommand( ConCommandBase* pCommandBase ) = 0;
+	virtual void UnregisterConCommand( ConCommandBase* pCommandBase ) = 0;
+	virtual ConVar* FindVar( const char* szVarName ) = 0;
+};
+
+
+//================================================================================================================
+// Players and bots.
+//================================================================================================================
+#define IN_ATTACK     (1 << 0)
+#define IN_JUMP       (1 << 1)
+#define IN_DUCK       (1 << 2)
+#define IN_FORWARD    (1 << 3)
+#define IN_BACK       (1 << 4)
+#define IN_USE        (1 << 5)
+#define IN_CANCEL     (1 << 6)
+#define IN_LEFT       (1 << 7)
+#define IN_RIGHT      (1 << 8)
+#define IN_MOVELEFT   (1 << 9)
+#define IN_MOVERIGHT  (1 << 10)
+#define IN_ATTACK2    (1 << 11)
+#define IN_RUN        (1 << 12)
+#define IN_RELOAD     (1 << 13)
+#define IN_ALT1       (1 << 14)
+#define IN_ALT2       (1 << 15)
+#define IN_SCORE      (1 << 16)
+#define IN_SPEED      (1 << 17)
+#define IN_WALK       (1 << 18)
+#define IN_ZOOM       (1 << 19)
+
+//****************************************************************************************************************
+class CBotCmd
+{
+public:
+	CBotCmd() { Reset(); }
+
+	void Reset()
+	{
+		command_number = tick_count = 0;
+		viewangles.Init();
+		forwardmove = sidemove = upmove = 0.0f;
+		buttons = 0;
+		impulse = 0;
+		weaponselect = weaponsubtype = 0;
+		random_seed = 0;
+		mousedx = mousedy = 0;
+		hasbeenpredicted = false;
+	}
+
+	int command_number;
+	int tick_count;
+	QAngle viewangles;
+	float forwardmove;
+	float sidemove;
+	float upmove;
+	int buttons;
+	byte impulse;
+	int weaponselect;
+	int weaponsubtype;
+	int random_seed;
+	short mousedx;
+	short mousedy;
+	bool hasbeenpredicted;
+};
+
+//****************************************************************************************************************
+class IPlayerInfo
+{
+public:
+	virtual const char* GetName() = 0;
+	virtual int GetUserID() = 0;
+	virtual const char* GetNetworkIDString() = 0;
+	virtual int GetTeamIndex() = 0;
+	virtual void ChangeTeam( int iTeamNum ) = 0;
+	virtual int GetFragCount() = 0;
+	virtual int GetDeathCount() = 0;
+	virtual bool IsConnected() = 0;
+	virtual int GetArmorValue() = 0;
+	virtual bool IsHLTV() = 0;
+	virtual bool IsPlayer() = 0;
+	virtual bool IsFakeClient() = 0;
+	virtual bool IsDead() = 0;
+	virtual bool IsInAVehicle() = 0;
+	virtual bool IsObserver() = 0;
+	virtual const Vector GetAbsOrigin() = 0;
+	virtual const QAngle GetAbsAngles() = 0;
+	virtual const Vector GetPlayerMins() = 0;
+	virtual const Vector GetPlayerMaxs() = 0;
+	virtual const char* GetWeaponName() = 0;
+	virtual const char* GetModelName() = 0;
+	virtual const int GetHealth() = 0;
+	virtual const int GetMaxHealth() = 0;
+	virtual CBotCmd GetLastUserCommand() = 0;
+};
+
+struct CGlobalVars
+{
+	float realtime;
+	int framecount;
+	float absoluteframetime;
+	float curtime;
+	float frametime;
+	int maxClients;
+	int tickcount;
+	float interval_per_tick;
+};
+
+class IPlayerInfoManager
+{
+public:
+	virtual IPlayerInfo* GetPlayerInfo( edict_t* pEdict ) = 0;
+	virtual CGlobalVars* GetGlobalVars() = 0;
+};
+
+//****************************************************************************************************************
+class IBotController
+{
+public:
+	virtual void SetAbsOrigin( Vector& vec ) = 0;
+	virtual void RemoveAllItems( bool removeSuit ) = 0;
+	virtual void SetActiveWeapon( const char* WeaponName ) = 0;
+	virtual bool IsEFlagSet( int nEFlagMask ) = 0;
+	virtual void RunPlayerMove( CBotCmd* ucmd ) = 0;
+	virtual void SetLocalOrigin( const Vector& origin ) = 0;
+	virtual const Vector GetLocalOrigin() = 0;
+	virtual void SetLocalAngles( const QAngle& angles ) = 0;
+	virtual const QAngle GetLocalAngles() = 0;
+	virtual void PostClientMessagesSent() = 0;
+};
+
+class IBotManager
+{
+public:
+	virtual IBotController* GetBotController( edict_t* pEdict ) = 0;
+	virtual edict_t* CreateBot( const char* szBotName ) = 0;
+};
+
+
+//================================================================================================================
+// Engine server.
+//================================================================================================================
+//****************************************************************************************************************
+/// Network message buffer, messages are dropped by harness.
+//****************************************************************************************************************
+class bf_write
+{
+public:
+	void WriteByte( int iValue ) {}
+	void WriteChar( int iValue ) {}
+	void WriteShort( int iValue ) {}
+	void WriteLong( long iValue ) {}
+	void WriteFloat( float fValue ) {}
+	void WriteString( const char* szValue ) {}
+};
+
+class IRecipientFilter
+{
+public:
+	virtual ~IRecipientFilter() {}
+	virtual bool IsReliable() const = 0;
+	virtual bool IsInitMessage() const = 0;
+	virtual int GetRecipientCount() const = 0;
+	virtual int GetRecipientIndex( int iSlot ) const = 0;
+};
+
+//****************************************************************************************************************
+class IVEngineServer
+{
+public:
+	virtual void ServerCommand( const char* szCommand ) = 0;
+	virtual int PrecacheModel( const char* szModel, bool bPreload = false ) = 0;
+	virtual int GetClusterCount() = 0;
+	virtual int GetClusterForOrigin( const Vector& vOrigin ) = 0;
+	virtual int GetPVSForCluster( int iCluster, int iOutputPvsLength, unsigned char* pOutputPvs ) = 0;
+	virtual bool CheckOriginInPVS( const Vector& vOrigin, const unsigned char* pCheckPvs, int iCheckPvsSize ) = 0;
+	virtual int GetPlayerUserId( const edict_t* pEdict ) = 0;
+	virtual bool IsDedicatedServer() = 0;
+	virtual int IndexOfEdict( const edict_t* pEdict ) = 0;
+	virtual edict_t* PEntityOfEntIndex( int iEntIndex ) = 0;
+	virtual int GetEntityCount() = 0;
+	virtual void ClientPrintf( edict_t* pEdict, const char* szMessage ) = 0;
+	virtual float Time() = 0;
+	virtual bf_write* UserMessageBegin( IRecipientFilter* pFilter, int iMsgType ) = 0;
+	virtual void MessageEnd() = 0;
+	virtual void GetGameDir( char* szGetGameDir, int iMaxLength ) = 0;
+	virtual const char* GetClientConVarValue( int iClientIndex, const char* szName ) = 0;
+	virtual void SetFakeClientConVarValue( edict_t* pEdict, const char* szCvar, const char* szValue ) = 0;
+	virtual int Cmd_Argc() = 0;
+	virtual const char* Cmd_Argv( int iArg ) = 0;
+};
+
+//****************************************************************************************************************
+class IServerGameClients
+{
+public:
+	virtual void ClientEarPosition( edict_t* pEdict, Vector* pEarOrigin ) = 0;
+};
+
+typedef enum
+{
+	DIALOG_MSG = 0,
+	DIALOG_MENU,
+	DIALOG_TEXT,
+	DIALOG_ENTRY,
+	DIALOG_ASKCONNECT,
+	DIALOG_TOTAL,
+} DIALOG_TYPE;
+
+typedef enum
+{
+	PLUGIN_CONTINUE = 0,
+	PLUGIN_OVERRIDE,
+	PLUGIN_STOP,
+} PLUGIN_RESULT;
+
+typedef enum
+{
+	eQueryCvarValueStatus_ValueIntact = 0,
+	eQueryCvarValueStatus_CvarNotFound = 1,
+	eQueryCvarValueStatus_NotACvar = 2,
+	eQueryCvarValueStatus_CvarProtected = 3,
+} EQueryCvarValueStatus;
+
+typedef int QueryCvarCookie_t;
+
+class IServerPluginCallbacks;
+
+class IServerPluginHelpers
+{
+public:
+	virtual void CreateMessage( edict_t* pEdict, DIALOG_TYPE iType, KeyValues* pData, IServerPluginCallbacks* pPlugin ) = 0;
+	virtual void ClientCommand( edict_t* pEdict, const char* szCmd ) = 0;
+};
+
+//****************************************************************************************************************
+class IServerPluginCallbacks
+{
+public:
+	virtual bool Load( CreateInterfaceFn interfaceFactory, CreateInterfaceFn gameServerFactory ) = 0;
+	virtual void Unload( void ) = 0;
+	virtual void Pause( void ) = 0;
+	virtual void UnPause( void ) = 0;
+	virtual const char* GetPluginDescription( void ) = 0;
+	virtual void LevelInit( char const* pMapName ) = 0;
+	virtual void ServerActivate( edict_t* pEdictList, int edictCount, int clientMax ) = 0;
+	virtual void GameFrame( bool simulating ) = 0;
+	virtual void LevelShutdown( void ) = 0;
+	virtual void ClientActive( edict_t* pEntity ) = 0;
+	virtual void ClientDisconnect( edict_t* pEntity ) = 0;
+	virtual void ClientPutInServer( edict_t* pEntity, char const* playername ) = 0;
+	virtual void SetCommandClient( int index ) = 0;
+	virtual void ClientSettingsChanged( edict_t* pEdict ) = 0;
+	virtual PLUGIN_RESULT ClientConnect( bool* bAllowConnect, edict_t* pEntity, const char* pszName, const char* pszAddress, char* reject, int maxrejectlen ) = 0;
+	virtual PLUGIN_RESULT ClientCommand( edict_t* pEntity, const CCommand& args ) = 0;
+	virtual PLUGIN_RESULT NetworkIDValidated( const char* pszUserName, const char* pszNetworkID ) = 0;
+	virtual void OnQueryCvarValueFinished( QueryCvarCookie_t iCookie, edict_t* pPlayerEntity, EQueryCvarValueStatus eStatus, const char* pCvarName, const char* pCvarValue ) = 0;
+	virtual void OnEdictAllocated( edict_t* edict ) = 0;
+	virtual void OnEdictFreed( const edict_t* edict ) = 0;
+};
+
+
+//================================================================================================================
+// File system, effects and debug overlay.
+//================================================================================================================
+class IFileSystem
+{
+public:
+	virtual bool GetCurrentDirectory( char* szDirectory, int iMaxLength ) = 0;
+};
+
+class IEffects
+{
+public:
+	virtual void Beam( const Vector& Start, const Vector& End, int nModelIndex, int nHaloIndex, unsigned char frameStart,
+	                   unsigned char frameRate, float flLife, unsigned char width, unsigned char endWidth,
+	                   unsigned char fadeLength, unsigned char noise, unsigned char red, unsigned char green,
+	                   unsigned char blue, unsigned char brightness, unsigned char speed ) = 0;
+};
+
+class IVDebugOverlay
+{
+public:
+	virtual void AddBoxOverlay( const Vector& origin, const Vector& mins, const Vector& max, QAngle const& orientation,
+	                            int r, int g, int b, int a, float duration ) = 0;
+	virtual void AddLineOverlay( const Vector& origin, const Vector& dest, int r, int g, int b, bool noDepthTest, float duration ) = 0;
+	virtual void AddTextOverlay( const Vector& origin, int line_offset, float duration, const char* format, ... ) = 0;
+};
+
+
+#endif // __HARNESS_SDK_H__
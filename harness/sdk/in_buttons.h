@@ -0,0 +1,2 @@
+// Harness stand-in for SDK header in_buttons.h.
+#include "harness_sdk.h"
@@ -0,0 +1,2 @@
+// Harness stand-in for SDK header public/tier1/convar.h.
+#include "../../harness_sdk.h"
@@ -0,0 +1 @@
+// Harness stand-in for SDK header tier0/memdbgon.h. Harness has no debug memory allocator.
@@ -0,0 +1,2 @@
+// Harness stand-in for SDK header tier0/platform.h.
+#include "../harness_sdk.h"
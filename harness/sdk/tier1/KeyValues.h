@@ -0,0 +1,2 @@
+// Harness stand-in for SDK header tier1/KeyValues.h.
+#include "../harness_sdk.h"
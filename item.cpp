@@ -4,6 +4,8 @@
 #include "clients.h"
 #include "item.h"
 #include "players.h"
+#include "profiler.h"
+#include "pvs.h"
 #include "server_plugin.h"
 #include "source_engine.h"
 #include "type2string.h"
@@ -35,47 +37,58 @@ extern IVDebugOverlay* pVDebugOverlay;
 extern char* szMainBuffer;
 extern int iMainBufferSize;
 
-char szValueBuffer[16];
-
-
 //================================================================================================================
-inline int GetEntityFlags( IServerEntity* pServerEntity )
+// Get offset of integer field with key name szKey in entity data description (same field that GetKeyValue() uses).
+int GetKeyFieldOffset( datamap_t* pMap, const char* szKey )
 {
-	// virtual bool GetKeyValue( const char *szKeyName, char *szValue, int iMaxLen );
-	// virtual int	ObjectCaps( void );
-	// GetMaxHealth
-	// IsAlive
-	CBaseEntity* pEntity = pServerEntity->GetBaseEntity();
-	pEntity->GetKeyValue("effects", szValueBuffer, 16);
-	int flags = atoi(szValueBuffer);
-	return flags;
-	//return pEntity->GetEffects();
+	for ( ; pMap; pMap = pMap->baseMap )
+		for ( int i = 0; i < pMap->dataNumFields; ++i )
+		{
+			const typedescription_t& cField = pMap->dataDesc[i];
+			if ( (cField.fieldType == FIELD_INTEGER) && FLAG_SOME_SET(FTYPEDESC_KEY, cField.flags) &&
+			     cField.externalName && (Q_stricmp(cField.externalName, szKey) == 0) )
+				return cField.fieldOffset[TD_OFFSET_NORMAL];
+		}
+	return EFieldOffsetNotFound;
 }
 
-inline int GetEntityHealth( IServerEntity* pServerEntity )
+// Get integer field value of entity, by offset if known, else formatted by GetKeyValue() and parsed back.
+inline int GetEntityIntField( IServerEntity* pServerEntity, int iOffset, const char* szKey )
 {
 	CBaseEntity* pEntity = pServerEntity->GetBaseEntity();
-	pEntity->GetKeyValue("health", szValueBuffer, 16);
-	int health = atoi(szValueBuffer);
-	return health;
-	//return pEntity->GetHealth();
+	if ( iOffset > 0 )
+		return *(int*)( (char*)pEntity + iOffset );
+
+	char szValue[16];
+	pEntity->GetKeyValue(szKey, szValue, sizeof(szValue));
+	return atoi(szValue);
+}
+
+inline int GetEntityFlags( IServerEntity* pServerEntity, const CEntityClass* pClass = NULL )
+{
+	return GetEntityIntField( pServerEntity, pClass ? pClass->iEffectsOffset : EFieldOffsetNotFound, "effects" );
 }
 
-inline bool IsEntityOnMap( IServerEntity* pServerEntity )
+inline int GetEntityHealth( IServerEntity* pServerEntity, const CEntityClass* pClass = NULL )
+{
+	return GetEntityIntField( pServerEntity, pClass ? pClass->iHealthOffset : EFieldOffsetNotFound, "health" );
+}
+
+inline bool IsEntityOnMap( IServerEntity* pServerEntity, const CEntityClass* pClass = NULL )
 {
 	 // EF_BONEMERGE is set for weapon, when picked up. Now appears that you don't need it.
-	return !FLAG_SOME_SET( EF_NODRAW | EF_BONEMERGE, GetEntityFlags(pServerEntity) );
+	return !FLAG_SOME_SET( EF_NODRAW | EF_BONEMERGE, GetEntityFlags(pServerEntity, pClass) );
 }
 
-inline bool IsEntityTaken( IServerEntity* pServerEntity )
+inline bool IsEntityTaken( IServerEntity* pServerEntity, const CEntityClass* pClass = NULL )
 {
 	 // EF_BONEMERGE is set for weapon, when picked up.
-	return FLAG_SOME_SET( EF_BONEMERGE, GetEntityFlags(pServerEntity) );
+	return FLAG_SOME_SET( EF_BONEMERGE, GetEntityFlags(pServerEntity, pClass) );
 }
 
-inline bool IsEntityBreakable( IServerEntity* pServerEntity )
+inline bool IsEntityBreakable( IServerEntity* pServerEntity, const CEntityClass* pClass = NULL )
 {
-	return GetEntityHealth(pServerEntity) != 0;
+	return GetEntityHealth(pServerEntity, pClass) != 0;
 }
 
 inline string_t GetEntityName( IServerEntity* pServerEntity )
@@ -88,21 +101,25 @@ inline string_t GetEntityName( IServerEntity* pServerEntity )
 //================================================================================================================
 bool CEntity::IsOnMap() const
 {
-	return IsEntityOnMap(pEdict->GetIServerEntity());
+	return IsEntityOnMap(pEdict->GetIServerEntity(), pItemClass);
 }
 
 //----------------------------------------------------------------------------------------------------------------
 bool CEntity::IsBreakable() const
 {
-	return IsEntityBreakable(pEdict->GetIServerEntity());
+	return IsEntityBreakable(pEdict->GetIServerEntity(), pItemClass);
 }
 
 
 //================================================================================================================
 good::vector<CEntity> CItems::m_aItems[EEntityTypeTotal];            // Array of items.
 good::vector<CEntityClass> CItems::m_aItemClasses[EEntityTypeTotal]; // Array of item classes.
+good::string_pool CItems::m_cClassNames;
+good::vector<CItems::TEntityClassRef> CItems::m_aClassRefs;
+good::hash_map<const char*, CItems::TEntityClassRef> CItems::m_cEngineNames;
 TEntityIndex CItems::m_iFreeIndex[EEntityTypeTotal];                 // First free weapon index.
 int CItems::m_iFreeEntityCount[EEntityTypeTotal];                    // Count of unused entities.
+CItems::TEdictSlot CItems::m_aEdictSlots[MAX_EDICTS];                // Slot of each edict.
 
 good::vector<edict_t*> CItems::m_aOthers(1024);                      // Array of other entities.
 
@@ -111,11 +128,37 @@ good::vector<edict_t*> CItems::m_aNewEntities(16);
 #endif
 
 good::vector<good::pair<good::string, TEntityFlags>> CItems::m_aObjectFlagsForModels(4);
+good::aho_corasick CItems::m_cModelMatcher;
 good::bitset CItems::m_aUsedItems(MAX_EDICTS);
+good::vector<Vector> CItems::m_aDoorOrigins;
+good::vector<QAngle> CItems::m_aDoorAngles;
+good::bitset CItems::m_cOpenedDoors;
+good::bitset CItems::m_cDoorsToTrace;
+good::vector<TEntityIndex> CItems::m_aChangedDoors;
+TEntityIndex CItems::m_iNextDoorToTrace;
 int CItems::m_iCurrentEntity;
 bool CItems::m_bMapLoaded = false;
 
 
+//----------------------------------------------------------------------------------------------------------------
+const CEntityClass* CItems::AddItemClassFor( TEntityType iEntityType, CEntityClass& cItemClass )
+{
+	// Class name is owned by pool, so it stays valid when array of item classes grows (short strings are stored
+	// inside string object and would move with it). Same class name for several types: use first type.
+	int iNameId = m_cClassNames.intern(cItemClass.sClassName);
+	cItemClass.sClassName = m_cClassNames[iNameId];
+	cItemClass.iNameId = iNameId;
+
+	m_aItemClasses[iEntityType].push_back(cItemClass);
+	TEntityClassRef cRef( iEntityType, m_aItemClasses[iEntityType].size() - 1 );
+	if ( iNameId == m_aClassRefs.size() )
+		m_aClassRefs.push_back(cRef);
+	else if ( iEntityType < m_aClassRefs[iNameId].first )
+		m_aClassRefs[iNameId] = cRef;
+	return &m_aItemClasses[iEntityType].back();
+}
+
+
 //----------------------------------------------------------------------------------------------------------------
 TEntityIndex CItems::GetNearestItem( TEntityType iEntityType, const Vector& vOrigin, const good::vector<CPickedItem>& aSkip, const CEntityClass* pClass )
 {
@@ -166,20 +209,8 @@ void CItems::Freed( const edict_t* pEdict )
 		return;
 
 	int iIndex = CBotrixPlugin::pEngineServer->IndexOfEdict(pEdict);
-	// Check only server entities.
-	if ( !m_aUsedItems.test(iIndex) )
-		return;
-
 	m_aUsedItems.reset(iIndex);
-	good::vector<CEntity>& aWeapons = m_aItems[EEntityTypeWeapon];
-	for ( TEntityIndex i=0; i < aWeapons.size(); ++i )
-		if ( aWeapons[i].pEdict == pEdict )
-		{
-			aWeapons[i].pEdict = NULL;
-			m_iFreeIndex[EEntityTypeWeapon] = i;
-			return;
-		}
-	DebugAssert(false); // Only weapons are allocated/deallocated while map is running.
+	ReleaseEdict(iIndex);
 }
 #endif // SOURCE_ENGINE_2006
 
@@ -193,14 +224,26 @@ void CItems::MapUnloaded()
 		
 		aItems.clear();
 		m_iFreeIndex[iEntityType] = -1;      // Invalidate free entity index.
+		m_iFreeEntityCount[iEntityType] = 0;
 
 		for ( int i = 0; i < aClasses.size(); ++i )
 		{
 			aClasses[i].szEngineName = NULL; // Invalidate class name, because it was loaded in previous map.
+			aClasses[i].iEffectsOffset = aClasses[i].iHealthOffset = EFieldOffsetUnknown;
 			aItems.reserve(64);              // At least.
 		}
 	}
 
+	m_cEngineNames.clear(); // Engine strings are from previous map.
+
+	m_aDoorOrigins.clear();
+	m_aDoorAngles.clear();
+	m_cOpenedDoors.resize(0);
+	m_cDoorsToTrace.resize(0);
+	m_aChangedDoors.clear();
+	m_iNextDoorToTrace = 0;
+	for ( int i = 0; i < MAX_EDICTS; ++i )
+		m_aEdictSlots[i].first = -1;
 	m_aOthers.clear();
 	m_aUsedItems.reset();
 	m_bMapLoaded = false;
@@ -210,6 +253,7 @@ void CItems::MapUnloaded()
 //----------------------------------------------------------------------------------------------------------------
 void CItems::MapLoaded()
 {
+	MapUnloaded(); // Free lists and edict slots are not initialized if no map was unloaded before.
 	m_iCurrentEntity = CPlayers::Size()+1;
 
 	// 0 is world, 1..max players are players. Other entities are from indexes above max players.
@@ -232,31 +276,33 @@ void CItems::MapLoaded()
 //----------------------------------------------------------------------------------------------------------------
 void CItems::Update()
 {
+	BOTRIX_PROFILE_SCOPE(EProfileItems);
+
+	UpdateDoors();
+
 #ifdef SOURCE_ENGINE_2006
 	// Source engine 2007 uses IServerPluginCallbacks::OnEdictAllocated instead of checking all array of edicts.
 
 	// Update weapons we have in items array.
 	good::vector<CEntity>& aWeapons = m_aItems[EEntityTypeWeapon];
+	BOTRIX_PROFILE_COUNT(EProfileCountItemsScanned, aWeapons.size());
 	for ( TEntityIndex i = 0; i < aWeapons.size(); ++i )
 	{
 		CEntity& cEntity = aWeapons[i];
 		edict_t* pEdict = cEntity.pEdict;
-		if ( pEdict == NULL )
-		{
-			m_iFreeIndex[EEntityTypeWeapon] = i;
+		if ( pEdict == NULL ) // Already in free list.
 			continue;
-		}
 
 		IServerEntity* pServerEntity = pEdict->GetIServerEntity();
 		if ( pEdict->IsFree() || (pServerEntity == NULL) )
 		{
-			cEntity.pEdict = NULL;
-			m_iFreeIndex[EEntityTypeWeapon] = i;
-			m_aUsedItems.clear( CBotrixPlugin::pEngineServer->IndexOfEdict(pEdict) );
+			int iEdict = CBotrixPlugin::pEngineServer->IndexOfEdict(pEdict);
+			m_aUsedItems.clear(iEdict);
+			ReleaseEdict(iEdict);
 		}
-		else if ( IsEntityTaken(pServerEntity) ) // Weapon still belongs to some player.
+		else if ( IsEntityTaken(pServerEntity, cEntity.pItemClass) ) // Weapon still belongs to some player.
 			FLAG_SET(FTaken, cEntity.iFlags);
-		else if ( FLAG_ALL_SET(FTaken, cEntity.iFlags) && IsEntityOnMap(pServerEntity) )
+		else if ( FLAG_ALL_SET(FTaken, cEntity.iFlags) && IsEntityOnMap(pServerEntity, cEntity.pItemClass) )
 		{
 			FLAG_CLEAR(FTaken, cEntity.iFlags);
 			cEntity.vOrigin = cEntity.CurrentPosition();
@@ -272,6 +318,7 @@ void CItems::Update()
 	if ( iTo > iCount )
 		iTo = iCount;
 
+	BOTRIX_PROFILE_COUNT(EProfileCountItemsScanned, iTo - m_iCurrentEntity);
 	for ( TEntityIndex i = m_iCurrentEntity; i < iTo; ++i )
 	{
 		if ( m_aUsedItems.test(i) ) 
@@ -291,10 +338,11 @@ void CItems::Update()
 		TEntityType iEntityType = GetEntityType(pEdict->GetClassName(), pWeaponClass, EEntityTypeWeapon, EEntityTypeWeapon+1);
 
 		if ( iEntityType == EEntityTypeWeapon )
-			AddItem( EEntityTypeWeapon, pEdict, pWeaponClass, pServerEntity );
+			SetEdictSlot( i, EEntityTypeWeapon, AddItem(EEntityTypeWeapon, pEdict, pWeaponClass, pServerEntity) );
 	}
 	m_iCurrentEntity = (iTo == iCount) ? CPlayers::Size()+1: iTo;
 #else
+	BOTRIX_PROFILE_COUNT(EProfileCountItemsScanned, m_aNewEntities.size());
 	for ( int i = 0; i < m_aNewEntities.size(); ++i )
 		CheckNewEntity( m_aNewEntities[i] );
 	m_aNewEntities.clear();
@@ -305,32 +353,34 @@ void CItems::Update()
 //----------------------------------------------------------------------------------------------------------------
 TEntityType CItems::GetEntityType( const char* szClassName, CEntityClass* & pEntityClass, TEntityType iFrom, TEntityType iTo, bool bFastCmp )
 {
-	for ( TEntityType iEntityType = iFrom; iEntityType < iTo; ++iEntityType )
+	// Engine class names are pooled strings, so all entities of one class share the same pointer. Every pointer is
+	// remembered (also for classes we don't care about), so string content is hashed only once per class and map.
+	TEntityClassRef cClass;
+	good::hash_map<const char*, TEntityClassRef>::iterator itEngine = m_cEngineNames.find(szClassName);
+	if ( itEngine != m_cEngineNames.end() )
+		cClass = itEngine->second;
+	else if ( bFastCmp )
+		return EOtherEntityType;
+	else
 	{
-		good::vector<CEntityClass>& aItemClasses = m_aItemClasses[iEntityType];
-
-		for ( int j = 0; j < aItemClasses.size(); ++j )
+		int iNameId = m_cClassNames.find(szClassName);
+		if ( iNameId == good::string_pool::invalid_id )
+			cClass = TEntityClassRef(EOtherEntityType, -1);
+		else
 		{
-			CEntityClass& cEntityClass = aItemClasses[j]; 
-
-			if ( cEntityClass.szEngineName ) // Fast compare?
-			{
-				if ( cEntityClass.szEngineName == szClassName ) // Compare by pointer, faster.
-				{
-					pEntityClass = &cEntityClass;
-					return iEntityType;
-				}
-			}
-			else if ( !bFastCmp && (cEntityClass.sClassName == szClassName) ) // Full string content comparison.
-			{
+			cClass = m_aClassRefs[iNameId];
+			CEntityClass& cEntityClass = m_aItemClasses[cClass.first][cClass.second];
+			if ( cEntityClass.szEngineName == NULL )
 				cEntityClass.szEngineName = szClassName; // Save engine string.
-				pEntityClass = &cEntityClass;
-				return iEntityType;
-			}
 		}
+		m_cEngineNames.insert( good::pair<const char*, TEntityClassRef>(szClassName, cClass) );
 	}
 
-	return EOtherEntityType;
+	if ( (cClass.first < iFrom) || (cClass.first >= iTo) )
+		return EOtherEntityType;
+
+	pEntityClass = &m_aItemClasses[cClass.first][cClass.second];
+	return cClass.first;
 }
 
 
@@ -345,13 +395,19 @@ void CItems::CheckNewEntity( edict_t* pEdict )
 	const char* szClassName = pEdict->GetClassName();
 	CEntityClass* pItemClass;
 	TEntityType iEntityType = GetEntityType(szClassName, pItemClass, 0, EEntityTypeTotal);
+	int iEdict = CBotrixPlugin::pEngineServer->IndexOfEdict(pEdict);
+	ReleaseEdict(iEdict); // In case edict was reused without being freed.
 	if ( iEntityType == EOtherEntityType )
+	{
 		m_aOthers.push_back(pEdict);
+		SetEdictSlot( iEdict, EOtherEntityType, m_aOthers.size() - 1 );
+	}
 	else if ( iEntityType == EEntityTypeObject )
-		AddObject( pEdict, pItemClass, pServerEntity );
+		SetEdictSlot( iEdict, EEntityTypeObject, AddObject(pEdict, pItemClass, pServerEntity) );
 	else
 	{
 		TEntityIndex iIndex = AddItem( iEntityType, pEdict, pItemClass, pServerEntity );
+		SetEdictSlot( iEdict, iEntityType, iIndex );
 		CEntity& cItem = m_aItems[iEntityType][iIndex];
 
 		const char* szWaypointFlags = CWaypoints::IsValid(cItem.iWaypoint) ? CTypeToString::WaypointFlagsToString( CWaypoints::Get(cItem.iWaypoint).iFlags ).c_str() : "";
@@ -367,7 +423,7 @@ void CItems::CheckNewEntity( edict_t* pEdict )
 				if ( CWaypoint::IsValid(iWaypoint) )
 					CUtil::Message(NULL, "\tNearest waypoint %d.", iWaypoint);
 			}
-			else if ( iEntityType == EEntityTypeDoor && !CWaypoint::IsValid((TWaypointId)cItem.pArguments) )
+			else if ( iEntityType == EEntityTypeDoor && !CWaypoint::IsValid((TWaypointId)(size_t)cItem.pArguments) )
 				CUtil::Message(NULL, "Door %d doesn't have 2 waypoints near.", iIndex);
 		}
 
@@ -375,10 +431,7 @@ void CItems::CheckNewEntity( edict_t* pEdict )
 		// Weapon entities are allocated / deallocated when respawned / owner killed.
 		if ( iEntityType != EEntityTypeWeapon )
 #endif
-		{
-			int iIndex = CBotrixPlugin::pEngineServer->IndexOfEdict(pEdict);
-			m_aUsedItems.set(iIndex);
-		}
+			m_aUsedItems.set(iEdict);
 	}
 
 }
@@ -389,28 +442,68 @@ TEntityIndex CItems::InsertEntity( int iEntityType, const CEntity& cEntity )
 {
 	good::vector<CEntity>& aItems = m_aItems[iEntityType];
 
-	if ( m_bMapLoaded ) // Check if there are free space in items array.
+	TEntityIndex iIndex = m_iFreeIndex[iEntityType];
+	if ( iIndex != -1 ) // Take first entity from free list.
 	{
-		if ( m_iFreeIndex[iEntityType] != -1 )
-		{
-			int iIndex = m_iFreeIndex[iEntityType];
-			m_iFreeIndex[iEntityType] = -1;
-			aItems[iIndex] = cEntity;
-			return iIndex;
-		}
-
-		for ( TEntityIndex i=0; i < aItems.size(); ++i ) // TODO: add free count.
-			if ( aItems[i].pEdict == NULL )
-			{
-				aItems[i] = cEntity;
-				return i;
-			}
+		m_iFreeIndex[iEntityType] = aItems[iIndex].iNextFree;
+		m_iFreeEntityCount[iEntityType]--;
+		aItems[iIndex] = cEntity;
+		return iIndex;
 	}
 
 	aItems.push_back( cEntity );
 	return aItems.size() - 1;
 }
 
+//----------------------------------------------------------------------------------------------------------------
+void CItems::ReleaseEntity( TEntityType iEntityType, TEntityIndex iIndex )
+{
+	CEntity& cEntity = m_aItems[iEntityType][iIndex];
+	DebugAssert( cEntity.pEdict );
+	cEntity.pEdict = NULL;
+	if ( iEntityType == EEntityTypeDoor )
+		m_cDoorsToTrace.reset(iIndex);
+	if ( !IsReusable(iEntityType) )
+		return; // Slot stays empty until map ends.
+
+	cEntity.iNextFree = m_iFreeIndex[iEntityType]; // Put at head of free list.
+	m_iFreeIndex[iEntityType] = iIndex;
+	m_iFreeEntityCount[iEntityType]++;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CItems::SetEdictSlot( int iEdict, TEntityType iEntityType, TEntityIndex iIndex )
+{
+	DebugAssert( (0 <= iEdict) && (iEdict < MAX_EDICTS) );
+	m_aEdictSlots[iEdict] = TEdictSlot(iEntityType, iIndex);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CItems::ReleaseEdict( int iEdict )
+{
+	TEdictSlot& cSlot = m_aEdictSlots[iEdict];
+	if ( cSlot.first == -1 )
+		return false;
+
+	if ( cSlot.first == EOtherEntityType )
+	{
+		// Order of other entities doesn't matter, move last one to the hole.
+		int iLast = m_aOthers.size() - 1;
+		if ( cSlot.second != iLast )
+		{
+			edict_t* pLast = m_aOthers[iLast];
+			m_aOthers[cSlot.second] = pLast;
+			m_aEdictSlots[ CBotrixPlugin::pEngineServer->IndexOfEdict(pLast) ].second = cSlot.second;
+		}
+		m_aOthers.pop_back();
+	}
+	else
+		ReleaseEntity( cSlot.first, cSlot.second );
+
+	cSlot.first = -1;
+	return true;
+}
+
 //----------------------------------------------------------------------------------------------------------------
 void CItems::AutoWaypointPathFlagsForEntity( TEntityType iEntityType, TEntityIndex iIndex, CEntity& cEntity )
 {
@@ -419,7 +512,7 @@ void CItems::AutoWaypointPathFlagsForEntity( TEntityType iEntityType, TEntityInd
 	{
 		// Set waypoint argument to button.
 		CWaypoint& cWaypoint = CWaypoints::Get(iWaypoint);
-		FLAG_SET(FWaypointButton, cWaypoint.iFlags);
+		CWaypoints::SetFlags(iWaypoint, cWaypoint.iFlags | FWaypointButton);
 		CWaypoint::SetButton( iIndex+1, cWaypoint.iArgument );
 	}
 
@@ -432,7 +525,7 @@ void CItems::AutoWaypointPathFlagsForEntity( TEntityType iEntityType, TEntityInd
 			cOmitWaypoints.set(iWaypoint);
 			iWaypoint = CWaypoints::GetNearestWaypoint( cEntity.vOrigin, &cOmitWaypoints, true, CEntity::iMaxDistToWaypoint );
 		}
-		cEntity.pArguments = (void*)iWaypoint;
+		cEntity.pArguments = (void*)(size_t)iWaypoint;
 
 		// Set door for paths between these two waypoints.
 		if ( iWaypoint != EWaypointIdInvalid )
@@ -450,6 +543,7 @@ void CItems::AutoWaypointPathFlagsForEntity( TEntityType iEntityType, TEntityInd
 				FLAG_SET(FPathDoor, pPath->iFlags);
 				pPath->iArgument = iIndex+1;
 			}
+			CWaypoints::PathChanged();
 		}
 	}
 }
@@ -475,10 +569,12 @@ TEntityIndex CItems::AddItem( TEntityType iEntityType, edict_t* pEdict, CEntityC
 		pItemClass->fRadiusSqr = fRadiusSqr;
 	}
 
+	ResolveFieldOffsets( pItemClass, pServerEntity );
+
 	int iFlags = pItemClass->iFlags;
 	TWaypointId iWaypoint = -1;
 
-	if ( !IsEntityOnMap(pServerEntity) || IsEntityTaken(pServerEntity) )
+	if ( !IsEntityOnMap(pServerEntity, pItemClass) || IsEntityTaken(pServerEntity, pItemClass) )
 		FLAG_SET(FTaken, iFlags);
 	else
 		iWaypoint = CWaypoints::GetNearestWaypoint( vItemOrigin, NULL, true, CEntity::iMaxDistToWaypoint );
@@ -487,14 +583,18 @@ TEntityIndex CItems::AddItem( TEntityType iEntityType, edict_t* pEdict, CEntityC
 
 	CEntity& cEntity = m_aItems[iEntityType][iIndex];
 	AutoWaypointPathFlagsForEntity( iEntityType, iIndex, cEntity );
+	if ( iEntityType == EEntityTypeDoor )
+		DoorAdded(iIndex);
 
 	return iIndex;
 }
 
 
 //----------------------------------------------------------------------------------------------------------------
-void CItems::AddObject( edict_t* pEdict, const CEntityClass* pObjectClass, IServerEntity* pServerEntity )
+TEntityIndex CItems::AddObject( edict_t* pEdict, CEntityClass* pObjectClass, IServerEntity* pServerEntity )
 {
+	ResolveFieldOffsets( pObjectClass, pServerEntity );
+
 	// Calculate object radius.
 	ICollideable* pCollidable = pServerEntity->GetCollideable();
 	
@@ -506,45 +606,146 @@ void CItems::AddObject( edict_t* pEdict, const CEntityClass* pObjectClass, IServ
 
 	int iFlags = pObjectClass->iFlags;
 
-	// Get object flags.
+	// Get object flags, using first model that is part of object's model.
 	if ( m_aObjectFlagsForModels.size() )
 	{
-		good::string sModel = STRING( pServerEntity->GetModelName() );
-		for ( int i = 0; i < m_aObjectFlagsForModels.size(); ++i )
-			if ( sModel.find( m_aObjectFlagsForModels[i].first ) != good::string::npos )
-			{
-				FLAG_SET(m_aObjectFlagsForModels[i].second, iFlags);
-				break;
-			}
+		if ( !m_cModelMatcher.is_built() )
+			m_cModelMatcher.build();
+
+		int iModel = m_cModelMatcher.find_first( STRING( pServerEntity->GetModelName() ) );
+		if ( iModel >= 0 )
+			FLAG_SET(m_aObjectFlagsForModels[iModel].second, iFlags);
 	}
 
-	good::vector<CEntity>& aItems = m_aItems[EEntityTypeObject];
 	CEntity cObject( pEdict, iFlags, fMaxsRadiusSqr, pObjectClass, pCollidable->GetCollisionOrigin(), -1 );
-	if ( m_bMapLoaded ) // Check if there are free space in items array.
+	return InsertEntity( EEntityTypeObject, cObject );
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CItems::ResolveFieldOffsets( CEntityClass* pEntityClass, IServerEntity* pServerEntity )
+{
+	if ( pEntityClass->iEffectsOffset != EFieldOffsetUnknown )
+		return;
+
+	datamap_t* pMap = pServerEntity->GetBaseEntity()->GetDataDescMap();
+	pEntityClass->iEffectsOffset = GetKeyFieldOffset(pMap, "effects");
+	pEntityClass->iHealthOffset = GetKeyFieldOffset(pMap, "health");
+	if ( (pEntityClass->iEffectsOffset == EFieldOffsetNotFound) || (pEntityClass->iHealthOffset == EFieldOffsetNotFound) )
+		CUtil::Message( NULL, "Warning: entity class %s doesn't have 'effects' or 'health' field, will use slower GetKeyValue().",
+		                pEntityClass->sClassName.c_str() );
+}
+
+//----------------------------------------------------------------------------------------------------------------
+int CItems::CheckFieldOffsets( int& iChecked )
+{
+	int iErrors = 0;
+	iChecked = 0;
+	for ( TEntityType iEntityType = 0; iEntityType < EEntityTypeTotal; ++iEntityType )
 	{
-		if ( m_iFreeIndex[EEntityTypeObject] != -1 )
+		good::vector<CEntity>& aItems = m_aItems[iEntityType];
+		for ( TEntityIndex i = 0; i < aItems.size(); ++i )
 		{
-			CEntity& cResult = aItems[m_iFreeIndex[EEntityTypeObject]];
-			m_iFreeIndex[EEntityTypeObject] = -1;
-			cResult = cObject;
-			return;
-		}
+			const CEntity& cEntity = aItems[i];
+			if ( cEntity.IsFree() || (cEntity.pItemClass == NULL) )
+				continue;
+
+			IServerEntity* pServerEntity = cEntity.pEdict->GetIServerEntity();
+			if ( pServerEntity == NULL )
+				continue;
 
-		for ( TEntityIndex i=0; i < aItems.size(); ++i )
-			if ( aItems[i].pEdict == NULL )
+			iChecked++;
+			int iFlags = GetEntityFlags(pServerEntity, cEntity.pItemClass), iKeyFlags = GetEntityFlags(pServerEntity);
+			int iHealth = GetEntityHealth(pServerEntity, cEntity.pItemClass), iKeyHealth = GetEntityHealth(pServerEntity);
+			if ( (iFlags != iKeyFlags) || (iHealth != iKeyHealth) )
 			{
-				aItems[i] = cObject;
-				return;
+				iErrors++;
+				CUtil::Message( NULL, "Entity %s %d (%s): effects %d / %d, health %d / %d.", CTypeToString::EntityTypeToString(iEntityType).c_str(),
+				                i, cEntity.pItemClass->sClassName.c_str(), iFlags, iKeyFlags, iHealth, iKeyHealth );
 			}
+		}
 	}
-	aItems.push_back( cObject );
+	return iErrors;
 }
 
 //----------------------------------------------------------------------------------------------------------------
-bool CItems::IsDoorOpened( TEntityIndex iDoor )
+void CItems::DoorAdded( TEntityIndex iDoor )
+{
+	int iSize = m_aItems[EEntityTypeDoor].size();
+	if ( m_aDoorOrigins.size() < iSize )
+	{
+		m_aDoorOrigins.resize(iSize);
+		m_aDoorAngles.resize(iSize);
+		m_cOpenedDoors.resize(iSize);
+		m_cDoorsToTrace.resize(iSize);
+	}
+
+	ICollideable* pCollide = m_aItems[EEntityTypeDoor][iDoor].pEdict->GetCollideable();
+	m_aDoorOrigins[iDoor] = pCollide->GetCollisionOrigin();
+	m_aDoorAngles[iDoor] = pCollide->GetCollisionAngles();
+	m_cOpenedDoors.set( iDoor, TraceDoorOpened(iDoor) );
+	m_cDoorsToTrace.reset(iDoor);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CItems::UpdateDoors()
+{
+	m_aChangedDoors.clear();
+
+	// Mark doors that moved since last frame. Door that is still moving will be marked again, so it is traced
+	// again after it stops.
+	good::vector<CEntity>& aDoors = m_aItems[EEntityTypeDoor];
+	for ( TEntityIndex i = 0; i < aDoors.size(); ++i )
+	{
+		edict_t* pEdict = aDoors[i].pEdict;
+		if ( (pEdict == NULL) || pEdict->IsFree() )
+			continue;
+
+		ICollideable* pCollide = pEdict->GetCollideable();
+		const Vector& vOrigin = pCollide->GetCollisionOrigin();
+		const QAngle& angAngles = pCollide->GetCollisionAngles();
+		if ( (vOrigin != m_aDoorOrigins[i]) || (angAngles != m_aDoorAngles[i]) )
+		{
+			m_aDoorOrigins[i] = vOrigin;
+			m_aDoorAngles[i] = angAngles;
+			m_cDoorsToTrace.set(i);
+		}
+	}
+
+	// Trace moved doors, continuing from where previous frame stopped. Bits are only cleared here, so after
+	// wrapping around only doors before first checked one can be found.
+	TEntityIndex iStart = m_iNextDoorToTrace;
+	int iTraces = 0;
+	while ( iTraces < m_iDoorTracesPerFrame )
+	{
+		TEntityIndex iDoor = m_cDoorsToTrace.find_next(m_iNextDoorToTrace - 1);
+		if ( iDoor == good::bitset::npos )
+			iDoor = m_cDoorsToTrace.find_first();
+		if ( iDoor == good::bitset::npos )
+		{
+			m_iNextDoorToTrace = iStart; // All doors checked.
+			break;
+		}
+		m_iNextDoorToTrace = (iDoor + 1) % aDoors.size();
+
+		m_cDoorsToTrace.reset(iDoor);
+		if ( aDoors[iDoor].pEdict == NULL )
+			continue;
+
+		iTraces++;
+		bool bOpened = TraceDoorOpened(iDoor);
+		if ( bOpened != m_cOpenedDoors.test(iDoor) )
+		{
+			m_cOpenedDoors.set(iDoor, bOpened);
+			m_aChangedDoors.push_back(iDoor);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CItems::TraceDoorOpened( TEntityIndex iDoor )
 {
 	const CEntity& cDoor = m_aItems[EEntityTypeDoor][iDoor];
-	TWaypointId w1 = cDoor.iWaypoint, w2 = (TWaypointId)cDoor.pArguments;
+	TWaypointId w1 = cDoor.iWaypoint, w2 = (TWaypointId)(size_t)cDoor.pArguments;
 	if ( CWaypoints::IsValid(w1) && CWaypoints::IsValid(w2) )
 	{
 		const Vector& v1 = CWaypoints::Get(w1).vOrigin;
@@ -562,16 +763,12 @@ bool CItems::IsDoorOpened( TEntityIndex iDoor )
 void CItems::Draw( CClient* pClient )
 {
 	static float fNextDrawTime = 0.0f;
-	static unsigned char pvs[MAX_MAP_CLUSTERS/8];
 
 	if ( (pClient->iItemDrawFlags == EItemDontDraw) || (pClient->iItemTypeFlags == 0) || (CBotrixPlugin::fTime < fNextDrawTime) )
 		return;
 
 	fNextDrawTime = CBotrixPlugin::fTime + 1.0f;
 
-	int iClusterIndex = CBotrixPlugin::pEngineServer->GetClusterForOrigin( pClient->GetHead() );
-	CBotrixPlugin::pEngineServer->GetPVSForCluster( iClusterIndex, sizeof(pvs), pvs );							
-
 	for ( TEntityType iEntityType = 0; iEntityType < EEntityTypeTotal+1; ++iEntityType )
 	{
 		if ( !FLAG_SOME_SET(1<<iEntityType, pClient->iItemTypeFlags) ) // Don't draw items of disabled item type.
@@ -588,17 +785,17 @@ void CItems::Draw( CClient* pClient )
 			IServerEntity* pServerEntity = pEdict->GetIServerEntity();
             DebugAssert( pServerEntity );
 
-			if ( IsEntityTaken(pServerEntity) )
+			const CEntity* pEntity = (iEntityType == EOtherEntityType) ? NULL : &m_aItems[iEntityType][i];
+			const CEntityClass* pClass = pEntity ? pEntity->pItemClass : NULL;
+			if ( IsEntityTaken(pServerEntity, pClass) )
 				continue;
 
 			ICollideable* pCollide = pServerEntity->GetCollideable();
 			const Vector& vOrigin = pCollide->GetCollisionOrigin();
 
-			if ( CBotrixPlugin::pEngineServer->CheckOriginInPVS( vOrigin, pvs, sizeof(pvs) ) &&
+			if ( CPvs::IsVisible( pClient->GetCluster(), CPvs::GetCluster(vOrigin) ) &&
 			     CUtil::IsVisible(pClient->GetHead(), vOrigin) )
 			{
-				const CEntity* pEntity = (iEntityType == EOtherEntityType) ? NULL : &m_aItems[iEntityType][i];
-
 				if ( FLAG_SOME_SET(EItemDrawStats, pClient->iItemDrawFlags) )
 				{
 					int pos = 0;
@@ -613,9 +810,9 @@ void CItems::Draw( CClient* pClient )
 					else if ( iEntityType == EEntityTypeObject )
 					{
 						sprintf( szMainBuffer, "%s %d", CTypeToString::EntityTypeToString(iEntityType).c_str(), i );
-						CUtil::DrawText( vOrigin, pos++, 1.0f, 0xFF, 0xFF, 0xFF, IsEntityOnMap(pServerEntity) ? "alive" : "dead" );
+						CUtil::DrawText( vOrigin, pos++, 1.0f, 0xFF, 0xFF, 0xFF, IsEntityOnMap(pServerEntity, pClass) ? "alive" : "dead" );
 						//CUtil::DrawText( vOrigin, pos++, 1.0f, 0xFF, 0xFF, 0xFF, IsEntityTaken(pServerEntity) ? "taken" : "not taken" ); // Taken not shown.
-						CUtil::DrawText( vOrigin, pos++, 1.0f, 0xFF, 0xFF, 0xFF, IsEntityBreakable(pServerEntity) ? "breakable" : "non breakable" );
+						CUtil::DrawText( vOrigin, pos++, 1.0f, 0xFF, 0xFF, 0xFF, IsEntityBreakable(pServerEntity, pClass) ? "breakable" : "non breakable" );
 						CUtil::DrawText( vOrigin, pos++, 1.0f, 0xFF, 0xFF, 0xFF, CTypeToString::EntityClassFlagsToString(pEntity->iFlags).c_str() );
 					}
 					//if ( iEntityType >= EEntityTypeButton ) // Draw entity name. Doesn't work.
@@ -636,14 +833,52 @@ void CItems::Draw( CClient* pClient )
 						CUtil::DrawLine(CWaypoints::Get(pEntity->iWaypoint).vOrigin, vOrigin, 1.0f, 0xFF, 0xFF, 0);
 
 					// Draw second waypoint for door.
-					if ( (iEntityType == EEntityTypeDoor) && CWaypoint::IsValid( (TWaypointId)pEntity->pArguments ) )
-						CUtil::DrawLine(CWaypoints::Get((TWaypointId)pEntity->pArguments).vOrigin, vOrigin, 1.0f, 0xFF, 0xFF, 0);
+					if ( (iEntityType == EEntityTypeDoor) && CWaypoint::IsValid( (TWaypointId)(size_t)pEntity->pArguments ) )
+						CUtil::DrawLine(CWaypoints::Get((TWaypointId)(size_t)pEntity->pArguments).vOrigin, vOrigin, 1.0f, 0xFF, 0xFF, 0);
 				}
 			}
 		}
 	}
 }
 
+//----------------------------------------------------------------------------------------------------------------
+float CItems::BenchmarkChurn( int iCycles, int iLive )
+{
+	DebugAssert( (0 < iLive) && (iLive <= MAX_EDICTS) );
+	if ( CBotrixPlugin::instance->bMapRunning )
+		return -1.0f; // Tables are used by entity events of running map.
+
+	// No map: weapons and edict slots are empty.
+	m_aItems[EEntityTypeWeapon].clear();
+	m_iFreeIndex[EEntityTypeWeapon] = -1;
+	m_iFreeEntityCount[EEntityTypeWeapon] = 0;
+
+	// Entities only need not NULL edict to be used.
+	CEntity cWeapon( CBotrixPlugin::pEngineServer->PEntityOfEntIndex(0), 0, 0.0f, NULL, Vector(0, 0, 0), -1 );
+	for ( int i = 0; i < iLive; ++i )
+		SetEdictSlot( i, EEntityTypeWeapon, InsertEntity(EEntityTypeWeapon, cWeapon) );
+
+	float fStart = Plat_FloatTime();
+	for ( int i = 0; i < iCycles; ++i )
+	{
+		int iEdict = rand() % iLive;
+		ReleaseEdict(iEdict);
+		SetEdictSlot( iEdict, EEntityTypeWeapon, InsertEntity(EEntityTypeWeapon, cWeapon) );
+	}
+	float fTime = Plat_FloatTime() - fStart;
+
+	DebugAssert( m_aItems[EEntityTypeWeapon].size() == iLive ); // Every free slot was reused.
+
+	// Leave tables empty for next map.
+	m_aItems[EEntityTypeWeapon].clear();
+	m_iFreeIndex[EEntityTypeWeapon] = -1;
+	m_iFreeEntityCount[EEntityTypeWeapon] = 0;
+	for ( int i = 0; i < iLive; ++i )
+		m_aEdictSlots[i].first = -1;
+
+	return fTime;
+}
+
 //----------------------------------------------------------------------------------------------------------------
 void CItems::WaypointDeleted( TWaypointId id )
 {
@@ -663,4 +898,6 @@ void CItems::WaypointDeleted( TWaypointId id )
 			//if ( iEntityType == EEntityTypeDoor )
 		}
 	}
+
+	m_cDoorsToTrace.set(); // Door state is traced between its waypoints, check all doors again.
 }
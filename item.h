@@ -6,28 +6,42 @@
 
 #include "types.h"
 
+#include "good/aho_corasick.h"
 #include "good/bitset.h"
+#include "good/hash_map.h"
+#include "good/string_pool.h"
 
 
 class CClient;
 class CPlayer;
 
 
+/// Offset of entity field, see CEntityClass::iEffectsOffset.
+enum TFieldOffsets
+{
+	EFieldOffsetUnknown = 0,                     ///< Offset is not resolved yet.
+	EFieldOffsetNotFound = -1,                   ///< Entity has no such field, use CBaseEntity::GetKeyValue().
+};
+
+
 //****************************************************************************************************************
 /// Class that represents class of entities.
 //****************************************************************************************************************
 class CEntityClass
 {
 public:
-	CEntityClass(): iFlags(0), fRadiusSqr(0.0f), szEngineName(NULL) {}
+	CEntityClass(): szEngineName(NULL), iNameId(-1), iFlags(0), fRadiusSqr(0.0f), iEffectsOffset(EFieldOffsetUnknown), iHealthOffset(EFieldOffsetUnknown) {}
 
 	void SetArgument( int iArgument ) { SET_2ND_WORD(iArgument, iFlags); }
 	int GetArgument() const { return GET_2ND_WORD(iFlags); }
 
 	good::string sClassName;            ///< Entity class name (like "prop_physics_multiplayer" or "item_healthkit").
 	const char* szEngineName;           ///< Can compare this string with edict_t::GetClassName() only by pointer. Faster.
+	int iNameId;                        ///< Id of class name in pool of class names, equal ids mean equal names.
 	TEntityFlags iFlags;                ///< Entity flags and argument (how much health/armor restore, or bullets gives etc.).
 	float fRadiusSqr;                   ///< Item's radius (to know if bot can pick it up).
+	int iEffectsOffset;                 ///< Offset of "effects" key field in entity of this class, resolved when first entity is found.
+	int iHealthOffset;                  ///< Offset of "health" key field in entity of this class, resolved when first entity is found.
 };
 
 
@@ -39,11 +53,11 @@ class CEntity
 {
 public:
 	/// Default constructor for array templates.
-	CEntity(): pEdict(NULL) {}
+	CEntity(): pEdict(NULL), iNextFree(-1) {}
 
 	/// Constructor with parameters.
 	CEntity( edict_t* pEdict, TEntityFlags iFlags, float fRadiusSqr, const CEntityClass* pItemClass, const Vector& vOrigin, TWaypointId iWaypoint ):
-		pEdict(pEdict), iFlags(iFlags), fRadiusSqr(fRadiusSqr), pItemClass(pItemClass), vOrigin(vOrigin), iWaypoint(iWaypoint), pArguments(NULL) {}
+		pEdict(pEdict), iFlags(iFlags), fRadiusSqr(fRadiusSqr), pItemClass(pItemClass), vOrigin(vOrigin), iWaypoint(iWaypoint), pArguments(NULL), iNextFree(-1) {}
 
 	/// Return true if item was freed, (for example broken, but not respawnable).
 	bool IsFree() const { return (pEdict == NULL) || pEdict->IsFree(); }
@@ -76,6 +90,7 @@ public:
 	Vector vOrigin;                     ///< Entity's respawn position on map (bots will be looking there).
 	const CEntityClass* pItemClass;     ///< Entity's class.
 	void* pArguments;                   ///< Entity's arguments. For example for door we have 2 waypoints.
+	TEntityIndex iNextFree;             ///< Next free entity index of same type, if this one is in free list.
 };
 
 
@@ -121,25 +136,25 @@ public:
 	/// Return true if at least one entity of this class exists on current map.
 	static bool ExistsOnMap( const CEntityClass* pEntityClass ) { return pEntityClass->szEngineName != NULL; }
 
-	/// Set size of entity classes for entity type.
+	/// Reserve space for iCount more entity classes of entity type.
 	/** This is done for one time allocation of array of entity classes, because pointers to entity classes will be used
 	 *  (and we don't want array to be reallocated, as it invalidates pointers). */
-	static void SetEntityClassesSizeForType( TEntityType iEntityType, int iSize )
+	static void ReserveEntityClassesForType( TEntityType iEntityType, int iCount )
 	{
-		m_aItemClasses[iEntityType].reserve(iSize);
+		m_aItemClasses[iEntityType].reserve( m_aItemClasses[iEntityType].size() + iCount );
 	}
 
 	/// Add item class (for example item_healthkit for health class).
-	static const CEntityClass* AddItemClassFor( TEntityType iEntityType, CEntityClass& cItemClass )
-	{
-		m_aItemClasses[iEntityType].push_back(cItemClass);
-		return &m_aItemClasses[iEntityType].back();
-	}
+	static const CEntityClass* AddItemClassFor( TEntityType iEntityType, CEntityClass& cItemClass );
+
+	/// Get id of class name (-1 if there is no item class with that name). Compare it with CEntityClass::iNameId.
+	static int GetClassNameId( const good::string& sClassName ) { return m_cClassNames.find(sClassName); }
 
 	/// Set object flags for given model.
 	static void SetObjectFlagForModel( TEntityFlags iItemFlag, const good::string& sModel )
 	{
 		m_aObjectFlagsForModels.push_back( good::pair<good::string, TEntityFlags>(sModel, iItemFlag) );
+		m_cModelMatcher.add(sModel);
 	}
 
 #ifndef SOURCE_ENGINE_2006
@@ -156,7 +171,10 @@ public:
 		MapUnloaded();
 		for ( int iType = 0; iType < EEntityTypeTotal; ++iType )
 			m_aItemClasses[iType].clear();
+		m_cClassNames.clear();
+		m_aClassRefs.clear();
 		m_aObjectFlagsForModels.clear();
+		m_cModelMatcher.clear();
 	}
 
 	/// Clear all loaded entities.
@@ -168,12 +186,22 @@ public:
 	/// Update items. Called when player is connected or picks up weapon (new one will be created to respawn later).
 	static void Update();
 	
-	/// Check if given door is opened.
-	static bool IsDoorOpened( TEntityIndex iDoor );
+	/// Check if given door is opened. State is cached, door is traced again only after it moves.
+	static bool IsDoorOpened( TEntityIndex iDoor ) { return m_cOpenedDoors.test(iDoor); }
+
+	/// Get doors that were opened or closed at this frame.
+	static const good::vector<TEntityIndex>& GetChangedDoors() { return m_aChangedDoors; }
 
 	/// Draw items for a given client.
 	static void Draw( CClient* pClient );
 
+	/// Compare entity fields read by offset with values of CBaseEntity::GetKeyValue() for all entities. Return mismatches count.
+	static int CheckFieldOffsets( int& iChecked );
+
+	/// Allocate and free iCycles entities in random order, keeping iLive entities allocated. Return time spent.
+	/** Benchmark uses weapons array and edicts table, so it is not run while map is running: -1 is returned. */
+	static float BenchmarkChurn( int iCycles, int iLive );
+
 
 protected:
 	static TEntityType GetEntityType( const char* szClassName, CEntityClass* & pEntityClass,
@@ -181,17 +209,44 @@ protected:
 
 	static void CheckNewEntity( edict_t* pEdict );
 	static TEntityIndex InsertEntity( int iEntityType, const CEntity& cEntity );
+	static void ReleaseEntity( TEntityType iEntityType, TEntityIndex iIndex );
+
+	// Return true if freed entities of this type give their slots to new ones. Only pickup items are reused: buttons
+	// and doors are referenced by index from waypoints and paths, and objects from bots, so they keep slots for whole map.
+	static bool IsReusable( TEntityType iEntityType ) { return iEntityType <= EEntityTypeAmmo; }
+	static void SetEdictSlot( int iEdict, TEntityType iEntityType, TEntityIndex iIndex );
+	static bool ReleaseEdict( int iEdict );
+	static void DoorAdded( TEntityIndex iDoor );
+	static void UpdateDoors();
+	static bool TraceDoorOpened( TEntityIndex iDoor );
 	static void AutoWaypointPathFlagsForEntity( TEntityType iEntityType, TEntityIndex iIndex, CEntity& cEntity );
 	static TEntityIndex AddItem( TEntityType iEntityType, edict_t* pEdict, CEntityClass* pItemClass, IServerEntity* pServerEntity );
-	static void AddObject( edict_t* pEdict, const CEntityClass* pObjectClass, IServerEntity* pServerEntity );
+	static TEntityIndex AddObject( edict_t* pEdict, CEntityClass* pObjectClass, IServerEntity* pServerEntity );
+	static void ResolveFieldOffsets( CEntityClass* pEntityClass, IServerEntity* pServerEntity );
 
-	friend class CWaypoints; // Give access to WaypointDeleted().
+	friend class CWaypoints; // Give access to WaypointDeleted() and WaypointsChanged().
 	static void WaypointDeleted( TWaypointId id );
 
+	// Called when waypoint is added or moved, or path is added, removed or can be modified. Door state is traced
+	// between its waypoints, so all doors are traced again. Doors added while map loads are traced anyway.
+	static void WaypointsChanged()
+	{
+		if ( m_bMapLoaded )
+			m_cDoorsToTrace.set();
+	}
+
 	static good::vector<CEntity> m_aItems[EEntityTypeTotal];            // Array of items.
 	static good::vector<CEntityClass> m_aItemClasses[EEntityTypeTotal]; // Array of item classes.
-	static TEntityIndex m_iFreeIndex[EEntityTypeTotal];                 // First free entity index.
-	static int m_iFreeEntityCount[EEntityTypeTotal];                    // Free entities count. TODO:
+
+	typedef good::pair<TEntityType, int> TEntityClassRef;               // Entity type and index in m_aItemClasses (-1 for other entities).
+	static good::string_pool m_cClassNames;                             // Pool of class names, owns names of item classes.
+	static good::vector<TEntityClassRef> m_aClassRefs;                  // Item class for each class name id.
+	static good::hash_map<const char*, TEntityClassRef> m_cEngineNames; // Map from engine class name pointer to item class, for current map.
+	static TEntityIndex m_iFreeIndex[EEntityTypeTotal];                 // First free entity index, -1 if none. Next free index is in iNextFree.
+	static int m_iFreeEntityCount[EEntityTypeTotal];                    // Free entities count.
+
+	typedef good::pair<TEntityType, TEntityIndex> TEdictSlot;           // Entity type and index in m_aItems / m_aOthers.
+	static TEdictSlot m_aEdictSlots[MAX_EDICTS];                        // Slot of each edict, type is -1 if edict is not stored.
 
 	static good::vector<edict_t*> m_aOthers;                            // Array of other entities.
 
@@ -200,9 +255,20 @@ protected:
 
 	// This one is to have models specific flags (for example car model with 'heavy' flag, or barrel model with 'explosive' flag).
 	static good::vector<good::pair<good::string, TEntityFlags>> m_aObjectFlagsForModels;
+	static good::aho_corasick m_cModelMatcher; // To search all models of m_aObjectFlagsForModels at once.
 
 	static good::bitset m_aUsedItems; // To know which items are already in m_aItems.
 
+	// Door state cache. Positions of doors are compared every frame, and doors that moved are traced again, but no
+	// more than m_iDoorTracesPerFrame doors per frame.
+	static good::vector<Vector> m_aDoorOrigins;        // Last origin of each door.
+	static good::vector<QAngle> m_aDoorAngles;         // Last angles of each door.
+	static good::bitset m_cOpenedDoors;                // Cached state of each door.
+	static good::bitset m_cDoorsToTrace;               // Doors that moved after last trace.
+	static good::vector<TEntityIndex> m_aChangedDoors; // Doors that were opened / closed at this frame.
+	static TEntityIndex m_iNextDoorToTrace;            // Door to start searching for moved doors at next frame.
+	static const int m_iDoorTracesPerFrame = 4;
+
 	static bool m_bMapLoaded; // Will be set to true at MapLoaded() and to false at Clear().
 	
 #ifndef SOURCE_ENGINE_2006
@@ -5,6 +5,9 @@
 #include "type2string.h"
 #include "waypoint.h"
 
+#include "tier0/platform.h" // Plat_FloatTime()
+#include "tier1/KeyValues.h"
+
 
 //----------------------------------------------------------------------------------------------------------------
 TModId CMod::m_iModId;
@@ -14,6 +17,7 @@ IMod* CMod::pCurrentMod = NULL;
 StringVector CMod::m_aBotNames;
 good::vector<StringVector> CMod::m_aModels;
 good::vector< good::auto_ptr<CEvent> > CMod::m_aEvents;
+good::hash_map<good::string, int> CMod::m_cEventIds;
 
 bool CMod::m_bMapHas[EEntityTypeTotal-1]; // Health, armor, weapon, ammo.
 
@@ -28,6 +32,7 @@ void CMod::Load( TModId iModId )
 {
 	m_iModId = iModId;
 	m_aEvents.clear();
+	m_cEventIds.clear();
 
 	switch ( iModId )
 	{
@@ -65,6 +70,7 @@ void CMod::AddEvent( CEvent* pEvent )
 		CBotrixPlugin::pGameEventManager->AddListener( CBotrixPlugin::instance, pEvent->GetName().c_str(), true );
 	if (CBotrixPlugin::pGameEventManager2)
 		CBotrixPlugin::pGameEventManager2->AddListener( CBotrixPlugin::instance, pEvent->GetName().c_str(), true );
+	m_cEventIds.insert( good::pair<good::string, int>(pEvent->GetName(), m_aEvents.size()), false );
 	m_aEvents.push_back(pEvent);
 }
 
@@ -100,20 +106,46 @@ void CMod::MapLoaded()
 //----------------------------------------------------------------------------------------------------------------
 void CMod::ExecuteEvent( void* pEvent, TEventType iType )
 {
-	IEventInterface *pInterface = CEvent::GetEventInterface(pEvent, iType);
-	if ( pInterface == NULL )
-		return;
+	// Interfaces are created on stack, so there is no allocation per event.
+	if ( iType == EEventTypeKeyValues )
+	{
+		CGameEventInterface1 cInterface( (KeyValues*)pEvent );
+		ExecuteEvent( &cInterface );
+	}
+	else if ( iType == EEventTypeIGameEvent )
+	{
+		CGameEventInterface2 cInterface( (IGameEvent*)pEvent );
+		ExecuteEvent( &cInterface );
+	}
+}
 
-	const char* szEventName = pInterface->GetName();
+//----------------------------------------------------------------------------------------------------------------
+void CMod::ExecuteEvent( IEventInterface* pInterface )
+{
+	good::string sEventName( pInterface->GetName() ); // Doesn't copy name.
+	good::hash_map<good::string, int>::iterator it = m_cEventIds.find(sEventName);
+	if ( it != m_cEventIds.end() )
+		m_aEvents[it->second]->Execute(pInterface);
+}
 
-	for (good::vector< good::auto_ptr<CEvent> >::iterator it = m_aEvents.begin(); it != m_aEvents.end(); ++it)
+//----------------------------------------------------------------------------------------------------------------
+float CMod::BenchmarkEvents( int iUserId, int iRepeat )
+{
+	KeyValues* pHurt = new KeyValues("player_hurt");
+	pHurt->SetInt("userid", iUserId);
+	pHurt->SetInt("attacker", iUserId);
+	pHurt->SetInt("health", 100);
+	KeyValues* pUnknown = new KeyValues("botrix_benchmark");
+
+	float fStart = Plat_FloatTime();
+	for ( int i = 0; i < iRepeat; ++i )
 	{
-		if ( (*it)->GetName() == szEventName )	
-		{
-			(*it)->Execute(pInterface);
-			break;
-		}
+		ExecuteEvent( (void*)pHurt, EEventTypeKeyValues );
+		ExecuteEvent( (void*)pUnknown, EEventTypeKeyValues );
 	}
+	float fTime = Plat_FloatTime() - fStart;
 
-	delete pInterface;
+	pHurt->deleteThis();
+	pUnknown->deleteThis();
+	return fTime;
 }
@@ -4,6 +4,8 @@
 
 #include <stdlib.h> // rand().
 
+#include "good/hash_map.h"
+
 #include "event.h"
 #include "item.h"
 
@@ -95,6 +97,7 @@ public: // Methods.
 		m_aBotNames.clear();
 		m_aModels.clear();
 		m_aEvents.clear();
+		m_cEventIds.clear();
 	}
 
 	/// Called when map finished loading items and waypoints.
@@ -128,9 +131,15 @@ public: // Methods.
 	/// Get random bot name from [General] section, key bot_names.
 	static const good::string& GetRandomBotName() { return m_aBotNames[rand() % m_aBotNames.size()]; }
 
-	/// Execute event.
+	/// Execute event. Doesn't allocate memory, event handler is found by hash of event name.
 	static void ExecuteEvent( void* pEvent, TEventType iType );
 
+	/// Execute event using given interface.
+	static void ExecuteEvent( IEventInterface* pInterface );
+
+	/// Dispatch iRepeat "player_hurt" events for player with iUserId and iRepeat unknown events. Return time spent.
+	static float BenchmarkEvents( int iUserId, int iRepeat );
+
 
 public: // Static members.
 	static good::string sModName;            ///< Mod name.
@@ -160,6 +169,7 @@ protected: // Members.
 	static StringVector m_aBotNames;                         // Available bot names.
 	static good::vector<StringVector> m_aModels;             // Available models for teams.
 	static good::vector< good::auto_ptr<CEvent> > m_aEvents; // Events this mod handles.
+	static good::hash_map<good::string, int> m_cEventIds;    // Map from event name to index in m_aEvents.
 	static bool m_bMapHas[EEntityTypeTotal-1];               // To check if map has items or waypoints of types: health, armor, weapon, ammo.
 };
 
@@ -6,6 +6,7 @@
 #include "server_plugin.h"
 #include "mods/borzh/types_borzh.h"
 #include "mods/borzh/mod_borzh.h"
+#include "type2string.h"
 
 
 class CAction; // Forward declaration.
@@ -45,6 +46,9 @@ public:
 	/// Called when chat request arrives from other player.
 	virtual void ReceiveChatRequest( const CBotChat& cRequest );
 
+	/// Get name of current task, for reports.
+	virtual const good::string& GetTaskName() const { return CTypeToString::BorzhTaskToString(m_cCurrentTask.iTask); }
+
 
 protected: // Inherited methods.
 
@@ -102,7 +106,7 @@ protected: // Methods.
 		if ( iArea == EAreaIdInvalid )
 			return false;
 		TWaypointId iWaypoint1 = cDoor.iWaypoint;
-		TWaypointId iWaypoint2 = (TWaypointId)cDoor.pArguments;
+		TWaypointId iWaypoint2 = (TWaypointId)(size_t)cDoor.pArguments;
 		DebugAssert( iWaypoint1 != EWaypointIdInvalid && iWaypoint2 != EWaypointIdInvalid );
 		TAreaId iArea1 = CWaypoints::Get(iWaypoint1).iAreaId;
 		TAreaId iArea2 = CWaypoints::Get(iWaypoint2).iAreaId;
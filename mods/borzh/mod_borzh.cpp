@@ -51,7 +51,6 @@ TChatVariableValue CModBorzh::iVarValueDoorStatusClosed;
 TChatVariableValue CModBorzh::iVarValueWeaponPhyscannon;
 TChatVariableValue CModBorzh::iVarValueWeaponCrossbow;
 
-good::vector< good::vector<TWaypointId> > CModBorzh::m_aAreasWaypoints;       // Waypoints for areas.
 good::vector< good::vector<TEntityIndex>  >CModBorzh::m_aAreasDoors;          // Doors for areas.
 good::vector< good::vector<TEntityIndex> > CModBorzh::m_aAreasButtons;        // Buttons for areas.
 good::vector< good::vector<TWaypointId> > CModBorzh::m_aShootButtonWaypoints; // Waypoints to shoot buttons.
@@ -128,15 +127,6 @@ void CModBorzh::MapLoaded()
 	for ( int i=0; i < CPlayers::Size(); ++i )
 		CChat::AddVariableValue( iVarPlayer, "" );
 
-	// Waypoints for areas.
-	m_aAreasWaypoints.clear();
-	if ( aAreas.size() > 0 )
-	{
-		m_aAreasWaypoints.resize( aAreas.size() );
-		for ( TWaypointId iWaypoint = 0; iWaypoint < CWaypoints::Size(); ++iWaypoint )
-			m_aAreasWaypoints[ CWaypoints::Get(iWaypoint).iAreaId ].push_back( iWaypoint );
-	}
-
 	// Doors for areas.
 	m_aAreasDoors.clear();
 	m_aAreasDoors.resize( aAreas.size() );
@@ -144,7 +134,7 @@ void CModBorzh::MapLoaded()
 	{
 		const CEntity& cDoor = aDoors[iDoor];
 		TWaypointId iDoorWaypoint1 = cDoor.iWaypoint;
-		TWaypointId iDoorWaypoint2 = (TWaypointId)cDoor.pArguments;
+		TWaypointId iDoorWaypoint2 = (TWaypointId)(size_t)cDoor.pArguments;
 		if ( iDoorWaypoint1 != EWaypointIdInvalid )
 			m_aAreasDoors[ CWaypoints::Get(iDoorWaypoint1).iAreaId ].push_back( iDoor );
 		if ( iDoorWaypoint2 != EWaypointIdInvalid )
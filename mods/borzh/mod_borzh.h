@@ -4,6 +4,7 @@
 
 #include "chat.h"
 #include "mod.h"
+#include "waypoint.h"
 
 
 /// Class to represent high area that needs a box to climb to.
@@ -91,7 +92,7 @@ public: // Static methods.
 	static TWaypointId GetRandomAreaWaypoint( TAreaId iArea );
 
 	/// Get waypoints that are in given area.
-	static const good::vector<TWaypointId>& GetWaypointsForArea( TAreaId iArea ) { return m_aAreasWaypoints[iArea]; }
+	static const good::vector<TWaypointId>& GetWaypointsForArea( TAreaId iArea ) { return CWaypoints::GetAreaWaypoints(iArea); }
 
 	/// Get doors that are in given area.
 	static const good::vector<TEntityIndex>& GetDoorsForArea( TAreaId iArea ) { return m_aAreasDoors[iArea]; }
@@ -142,7 +143,6 @@ protected:
 	static const int CHATS_COUNT = 23;
 	//static const good::string m_aChats[CHATS_COUNT];
 
-	static good::vector< good::vector<TWaypointId> > m_aAreasWaypoints;       // Waypoints for areas.
 	static good::vector< good::vector<TEntityIndex> > m_aAreasDoors;          // Doors for areas.
 	static good::vector< good::vector<TEntityIndex> > m_aAreasButtons;        // Buttons for areas.
 	static good::vector< good::vector<TWaypointId> > m_aShootButtonWaypoints; // Waypoints to shoot buttons.
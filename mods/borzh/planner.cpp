@@ -6,6 +6,7 @@
 #include "mods/borzh/mod_borzh.h"
 #include "mods/borzh/planner.h"
 #include "players.h"
+#include "profiler.h"
 #include "type2string.h"
 #include "waypoint.h"
 
@@ -253,7 +254,7 @@ void GeneratePddl( bool bFromBotBelief )
 		{
 			const CEntity& cDoor = cDoors[iDoor];
 			int iWaypoint1 = cDoor.iWaypoint;
-			int iWaypoint2 = (TWaypointId)cDoor.pArguments;
+			int iWaypoint2 = (TWaypointId)(size_t)cDoor.pArguments;
 			if ( CWaypoints::IsValid(iWaypoint1) && CWaypoints::IsValid(iWaypoint2) )
 			{
 				int iArea1 = CWaypoints::Get(iWaypoint1).iAreaId;
@@ -366,7 +367,7 @@ void GeneratePddl( bool bFromBotBelief )
 		{
 			const CEntity& cDoor = CItems::GetItems(EEntityTypeDoor)[iDoor];
 			TWaypointId iDoorWaypoint1 = cDoor.iWaypoint;
-			TWaypointId iDoorWaypoint2 = (TWaypointId)cDoor.pArguments;
+			TWaypointId iDoorWaypoint2 = (TWaypointId)(size_t)cDoor.pArguments;
 			DebugAssert( (iDoorWaypoint1 != EWaypointIdInvalid) && (iDoorWaypoint2 != EWaypointIdInvalid) );
 
 			TAreaId iDoorArea1 = CWaypoints::Get(iDoorWaypoint1).iAreaId;
@@ -509,6 +510,8 @@ bool TransformPlannerOutput()
 //----------------------------------------------------------------------------------------------------------------
 void PlannerThreadFunc( void* pParameter )
 {
+	BOTRIX_PROFILE_THREAD_SCOPE("planner", EProfileThreadPlanner);
+
 	const int iThreadSleepTime = 500;
 	const int iMaxTimeToRunProcess = 5000;
 	int iTotalRead = 0;
@@ -96,6 +96,12 @@ void CBot_HL2DM::ReceiveChat( int iPlayerIndex, CPlayer* pPlayer, bool bTeamOnly
 
 }
 
+//----------------------------------------------------------------------------------------------------------------
+const good::string& CBot_HL2DM::GetTaskName() const
+{
+	return CTypeToString::BotTaskToString(m_iCurrentTask);
+}
+
 //----------------------------------------------------------------------------------------------------------------
 bool CBot_HL2DM::DoWaypointAction()
 {
@@ -267,7 +273,8 @@ restart_find_task:
 
 			if ( iItemToSearch == -1 )
 			{
-				m_cSkipWeapons.set(iWeapon);
+				if ( iNewTask == EBotTaskFindWeapon ) // iWeapon is set only when searching for weapon.
+					m_cSkipWeapons.set(iWeapon);
 				m_iCurrentTask = EBotTaskInvalid;
 				goto restart_find_task;
 			}
@@ -285,7 +292,7 @@ restart_find_task:
 			if ( CWaypoints::Size() >= 2 )
 			{
 				do {
-					m_iTaskDestination = rand() % CWaypoints::Size();
+					m_iTaskDestination = CWaypoints::GetAnyWaypoint();
 				} while ( m_iTaskDestination == iCurrentWaypoint );
 			}
 		}
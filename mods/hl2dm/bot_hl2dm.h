@@ -36,6 +36,9 @@ public:
 	/// Called when chat arrives from other player.
 	virtual void ReceiveChat( int iPlayerIndex, CPlayer* pPlayer, bool bTeamOnly, const char* szText );
 
+	/// Get name of current task, for reports.
+	virtual const good::string& GetTaskName() const;
+
 
 protected:
 
@@ -2,6 +2,7 @@
 #include "clients.h"
 #include "mod.h"
 #include "players.h"
+#include "profiler.h"
 #include "server_plugin.h"
 #include "type2string.h"
 #include "waypoint.h"
@@ -21,6 +22,8 @@ CClient* CPlayers::m_pListenServerClient = NULL;
 int CPlayers::m_iClientsCount = 0;
 int CPlayers::m_iBotsCount = 0;
 
+good::hash_map<int, TPlayerIndex> CPlayers::m_cUserIds;
+
 #if defined(DEBUG) || defined(_DEBUG)
 	bool CPlayers::m_bClientDebuggingEvents = true;
 #else
@@ -47,6 +50,8 @@ void CPlayer::Respawned()
 	m_fNextDrawHullTime = 0.0f;
 #endif
 	CBotrixPlugin::pServerGameClients->ClientEarPosition(m_pEdict, &m_vHead);
+	m_vPrevHead = m_vHead; // Don't take respawn for a move.
+	m_iCluster = CPvs::GetCluster(m_vHead);
 	iCurrentWaypoint = CWaypoints::GetNearestWaypoint( m_vHead );
 	m_bAlive = true;
 }
@@ -71,6 +76,7 @@ void CPlayer::PreThink()
 
 	m_vPrevHead = m_vHead;
 	CBotrixPlugin::pServerGameClients->ClientEarPosition(m_pEdict, &m_vHead); // borzh
+	m_iCluster = CPvs::GetCluster(m_vHead);
 
 	// If waypoint is not valid or we are too far, recalculate current waypoint.
 	if ( !CWaypoint::IsValid(iCurrentWaypoint) ||                        
@@ -95,9 +101,10 @@ void CPlayer::PreThink()
 	}
 	else
 	{
-		for (int i = 0; i < (int)w.neighbours.size(); ++i)
+		const CWaypoints::WaypointNavGraph& cNavGraph = CWaypoints::GetNavGraph();
+		for ( int iArc = cNavGraph.arcs_begin(iCurrentWaypoint); iArc < cNavGraph.arcs_end(iCurrentWaypoint); ++iArc )
 		{
-			TWaypointId id = w.neighbours[i].target;
+			TWaypointId id = cNavGraph.target(iArc);
 			CWaypoint& n = CWaypoints::Get(id);
 			float fNewDist = m_vHead.DistToSqr(n.vOrigin);
 			if ( fNewDist < fDist )
@@ -141,6 +148,7 @@ void CPlayers::Clear()
 	for (int i = 0; i < CPlayers::Size(); ++i)
 		m_aPlayers[i].reset();
 	m_pListenServerClient = 0;
+	m_cUserIds.clear();
 
 	m_iClientsCount = m_iBotsCount = 0;
 	m_bClientDebuggingEvents = false;
@@ -196,6 +204,7 @@ CPlayer* CPlayers::AddBot( TBotIntelligence iIntelligence )
 	pPlayer->Activated(); // Event active is not created for bots.
 
 	m_aPlayers[iIdx] = pPlayer;
+	m_cUserIds[ CBotrixPlugin::pEngineServer->GetPlayerUserId(pEdict) ] = iIdx;
 	m_iBotsCount++;
 
 	if ( CChat::iPlayerVar != EChatVariableInvalid )
@@ -292,6 +301,7 @@ void CPlayers::PlayerConnected( edict_t* pEdict )
 		}
 
 		m_aPlayers[iIdx] = pPlayer;
+		m_cUserIds[ CBotrixPlugin::pEngineServer->GetPlayerUserId(pEdict) ] = iIdx;
 		m_iClientsCount++;
 
 		if ( CChat::iPlayerVar != EChatVariableInvalid )
@@ -328,7 +338,9 @@ void CPlayers::PlayerDisconnected( edict_t* pEdict )
 	}
 
 	bool bIsBot = pPlayer->IsBot();
+	m_cUserIds.erase( CBotrixPlugin::pEngineServer->GetPlayerUserId(pEdict) );
 	m_aPlayers[iIdx].reset();
+	CProfiler::ResetPlayer(iIdx);
 
 	if ( bIsBot )
 		m_iBotsCount--;
@@ -348,9 +360,14 @@ void CPlayers::PlayerDisconnected( edict_t* pEdict )
 //----------------------------------------------------------------------------------------------------------------
 void CPlayers::PreThink()
 {
+	BOTRIX_PROFILE_SCOPE(EProfilePlayers);
+
 	for (PlayersArray::iterator it = m_aPlayers.begin(); it != m_aPlayers.end(); ++it)
 		if ( it->get() )
+		{
+			BOTRIX_PROFILE_PLAYER_SCOPE(EProfilePlayers, it - m_aPlayers.begin());
 			it->get()->PreThink();
+		}
 }
 
 
@@ -388,58 +405,61 @@ void CPlayers::CheckForDebugging()
 }
 
 //----------------------------------------------------------------------------------------------------------------
-void CPlayers::DeliverChat( edict_t* pFrom, bool bTeamOnly, const char* szText )
+void CPlayers::DeliverChat( TPlayerIndex iIdx, bool bTeamOnly, const char* szText )
 {
 	int iTeam = 0;
 
-	int iIdx = CPlayers::Get(pFrom);
 	DebugAssert( iIdx >= 0 );
 	CPlayer* pSpeaker = CPlayers::Get(iIdx);
 
 	if ( bTeamOnly )
 		iTeam = pSpeaker->GetTeam();
 
-	// Get command from text.
+	// Get commands from text.
 	if ( GetBotsCount() > 0 )
 	{
-		static CBotChat cChat;
-		cChat.iBotChat = EBotChatUnknown;
-		cChat.iDirectedTo = EPlayerIndexInvalid;
-		cChat.iSpeaker = iIdx;
-
-		float fPercentage = CChat::ChatFromText( szText, cChat );
-		bool bIsRequest = (fPercentage >= 6.0f);
-
-/*
-		if ( cChat.iDirectedTo == -1 )
-			cChat.iDirectedTo = pSpeaker->iChatMate;
-		else
-			pSpeaker->iChatMate = cChat.iDirectedTo; // TODO: SetChatMate();
-*/
-		int iFrom = 0, iTo = CPlayers::Size();
-		if ( bIsRequest && (cChat.iDirectedTo != -1) )
+		static good::vector<CBotChat> aRequests;
+		aRequests.clear();
+		CChat::ChatsFromText( szText, aRequests );
+
+		// Not a request, deliver text to all bots.
+		if ( aRequests.size() == 0 )
 		{
-			DebugAssert( cChat.iDirectedTo != iIdx );
-			iFrom = cChat.iDirectedTo;
-			iTo = iFrom + 1;
+			for ( TPlayerIndex iPlayer = 0; iPlayer < CPlayers::Size(); ++iPlayer )
+			{
+				CPlayer* pReceiver = CPlayers::Get(iPlayer);
+				if ( pReceiver && pReceiver->IsBot() && (iIdx != iPlayer) )
+				{
+					CBot* pBot = (CBot*)pReceiver;
+					if ( !bTeamOnly || (pBot->GetTeam() == iTeam) ) // Should be on same iTeam if chat is for iTeam only.
+						pBot->ReceiveChat( iIdx, pSpeaker, bTeamOnly, szText );
+				}
+			}
+			return;
 		}
-		//else
-		//	DebugMessage("Can't detect player, chat is directed to.");
 
-
-		// Deliver chat for all bots.
-		for ( TPlayerIndex iPlayer = iFrom; iPlayer < iTo; ++iPlayer )
+		// Deliver requests in order they were said.
+		for ( int iRequest = 0; iRequest < aRequests.size(); ++iRequest )
 		{
-			CPlayer* pReceiver = CPlayers::Get(iPlayer);
-			if ( pReceiver && pReceiver->IsBot() && (iIdx != iPlayer) )
+			CBotChat& cChat = aRequests[iRequest];
+			cChat.iSpeaker = iIdx;
+
+			int iFrom = 0, iTo = CPlayers::Size();
+			if ( cChat.iDirectedTo != -1 )
 			{
-				CBot* pBot = (CBot*)pReceiver;
-				if ( !bTeamOnly || (pBot->GetTeam() == iTeam) ) // Should be on same iTeam if chat is for iTeam only.
+				DebugAssert( cChat.iDirectedTo != iIdx );
+				iFrom = cChat.iDirectedTo;
+				iTo = iFrom + 1;
+			}
+
+			for ( TPlayerIndex iPlayer = iFrom; iPlayer < iTo; ++iPlayer )
+			{
+				CPlayer* pReceiver = CPlayers::Get(iPlayer);
+				if ( pReceiver && pReceiver->IsBot() && (iIdx != iPlayer) )
 				{
-					if ( bIsRequest )
+					CBot* pBot = (CBot*)pReceiver;
+					if ( !bTeamOnly || (pBot->GetTeam() == iTeam) ) // Should be on same iTeam if chat is for iTeam only.
 						pBot->ReceiveChatRequest(cChat);
-					else
-						pBot->ReceiveChat( iIdx, pSpeaker, bTeamOnly, szText );
 				}
 			}
 		}
@@ -5,9 +5,12 @@
 #include "edict.h"
 #include "iplayerinfo.h"
 
+#include "pvs.h"
 #include "source_engine.h"
 #include "types.h"
 
+#include "good/hash_map.h"
+
 
 #if defined(DEBUG) || defined(_DEBUG)
 #	define DRAW_PLAYER_HULL 0
@@ -25,7 +28,8 @@ class CPlayer
 public:
 	/// Constructor.
 	CPlayer(edict_t* pEdict, TPlayerIndex iIndex, bool bIsBot): m_pEdict(pEdict), m_iIndex(iIndex), m_bBot(bIsBot), 
-		m_pPlayerInfo(NULL), iCurrentWaypoint(-1), iNextWaypoint(-1), iPrevWaypoint(-1), iChatMate(-1), m_bAlive(false) {}
+		m_pPlayerInfo(NULL), iCurrentWaypoint(-1), iNextWaypoint(-1), iPrevWaypoint(-1), iChatMate(-1), m_iCluster(-1),
+		m_bAlive(false) {}
 
 	/// Destructor.
 	virtual ~CPlayer() {}
@@ -61,6 +65,9 @@ public:
 	/// Get previous head position of player.
 	Vector const& GetPreviousHead() const { return m_vPrevHead; }
 
+	/// Get PVS cluster of player's head, updated once per frame.
+	int GetCluster() const { return m_iCluster; }
+
 	/// Get center position of player.
 	void GetCenter( Vector& v ) const { CUtil::EntityCenter(m_pEdict, v); }
 
@@ -113,6 +120,7 @@ protected:
 	good::string m_sName;            // Lowercased name of player.
 	Vector m_vHead;                  // Head position of player.
 	Vector m_vPrevHead;              // Previous position of player.
+	int m_iCluster;                  // PVS cluster of head position.
 
 	bool m_bBot:1;                   // This member will be set to true by bot.
 	bool m_bAlive:1;                 // IPlayerInfo::IsDead() returns true only when player is dead, not when becomes respawnable.
@@ -149,6 +157,13 @@ public:
 		return CBotrixPlugin::pEngineServer->IndexOfEdict(pPlayer)-1;
 	}
 
+	/// Get player index from user id (of game events), without calls to engine. Return -1 if there is no such player.
+	static TPlayerIndex GetIndexByUserId( int iUserId )
+	{
+		good::hash_map<int, TPlayerIndex>::const_iterator it = m_cUserIds.find(iUserId);
+		return ( it == m_cUserIds.end() ) ? EPlayerIndexInvalid : it->second;
+	}
+
 	/// Get client that created listen server (not dedicated server).
 	static CClient* GetListenServerClient() { return m_pListenServerClient; }
 
@@ -178,8 +193,8 @@ public:
 	/// Kick random bot on given team.
 	static bool KickRandomBotOnTeam( int team );
 
-	/// Deliver chat / voice command to bots.
-	static void DeliverChat( edict_t* pFrom, bool bTeamOnly, const char* szText );
+	/// Deliver chat / voice command of player iIdx to bots.
+	static void DeliverChat( TPlayerIndex iIdx, bool bTeamOnly, const char* szText );
 
 	/// Deliver message to all clients.
 	static void Message( const char* szFormat, ... );
@@ -219,6 +234,8 @@ protected:
 	static int m_iClientsCount;                             // Total amount of clients on this server.
 	static int m_iBotsCount;                                // Total amount of bots on this server.
 
+	static good::hash_map<int, TPlayerIndex> m_cUserIds;    // Map from user id to player index.
+
 	static good::vector< good::vector<bool> > m_iChatPairs; // 2D array representing who chats with whom. 
 };
 
@@ -0,0 +1,408 @@
+#include <stdio.h>
+#include <stdlib.h> // qsort()
+#include <string.h>
+
+#include "bot.h"
+#include "players.h"
+#include "profiler.h"
+#include "source_engine.h"
+
+// memdbgon must be the last include file in a .cpp file!!!
+#include "tier0/memdbgon.h"
+
+
+//----------------------------------------------------------------------------------------------------------------
+bool CProfiler::bEnabled = false;
+bool CProfiler::bActive = false;
+
+double CProfiler::m_aFrameTimes[EProfileSectionTotal];
+int CProfiler::m_aFrameCounts[EProfileCountTotal];
+long CProfiler::m_iAllocations = 0;
+
+float CProfiler::m_aTimes[EProfileSectionTotal][PROFILE_WINDOW];
+float CProfiler::m_aCounts[EProfileCountTotal][PROFILE_WINDOW];
+int CProfiler::m_iNextFrame = 0;
+int CProfiler::m_iFrames = 0;
+int CProfiler::m_iTotalFrames = 0;
+double CProfiler::m_fTotalTime = 0.0;
+
+float CProfiler::fOutlierShare = 0.25f;
+float CProfiler::fOutlierMinFrame = 1.0f;
+
+int CProfiler::m_iCurrentPlayer = -1;
+double CProfiler::m_aPlayerFrameTimes[PROFILE_MAX_PLAYERS];
+int CProfiler::m_aPlayerFrameCounts[PROFILE_MAX_PLAYERS][EProfileCountTotal];
+profile_player_t CProfiler::m_aPlayers[PROFILE_MAX_PLAYERS];
+float CProfiler::m_aNextOutlierMessage[PROFILE_MAX_PLAYERS];
+
+bool CProfiler::m_bCapturing = false;
+good::string CProfiler::m_sCaptureFile;
+good::vector<CProfiler::profile_event_t> CProfiler::m_aEvents;
+good::atomic_t CProfiler::m_iEvents = 0;
+good::vector<int> CProfiler::m_aCaptureCounts;
+good::vector<double> CProfiler::m_aCaptureFrameStarts;
+int CProfiler::m_iCaptureFrame = 0;
+int CProfiler::m_iCaptureFrames = 0;
+double CProfiler::m_fCaptureStart = 0.0;
+
+
+//----------------------------------------------------------------------------------------------------------------
+static const char* aSectionNames[EProfileSectionTotal] =
+{
+	"frame", "mod think", "items", "players", "navigation", "chat", "traces",
+};
+
+static const char* aCounterNames[EProfileCountTotal] =
+{
+	"traces", "A* nodes", "items scanned", "chat matched", "nav searches", "stuck moves",
+	"sight cached", "sight distance", "sight view", "sight pvs", "sight rays", "allocations",
+};
+
+static const char* aThreadNames[EProfileThreadTotal] =
+{
+	"server", "planner",
+};
+
+
+//----------------------------------------------------------------------------------------------------------------
+static int CompareFloats( const void* pFirst, const void* pSecond )
+{
+	float fFirst = *(const float*)pFirst, fSecond = *(const float*)pSecond;
+	return (fFirst < fSecond) ? -1 : ( (fFirst > fSecond) ? 1 : 0 );
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+void CProfiler::SetEnabled( bool bEnable )
+{
+	Reset();
+	bEnabled = bEnable;
+	bActive = bEnabled || m_bCapturing;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CProfiler::Reset()
+{
+	memset( m_aFrameTimes, 0, sizeof(m_aFrameTimes) );
+	memset( m_aFrameCounts, 0, sizeof(m_aFrameCounts) );
+	m_iAllocations = good::atomic_load( &good::allocations_count() );
+	m_iNextFrame = m_iFrames = m_iTotalFrames = 0;
+	m_fTotalTime = 0.0;
+
+	m_iCurrentPlayer = -1;
+	memset( m_aPlayerFrameTimes, 0, sizeof(m_aPlayerFrameTimes) );
+	memset( m_aPlayerFrameCounts, 0, sizeof(m_aPlayerFrameCounts) );
+	memset( m_aPlayers, 0, sizeof(m_aPlayers) );
+	memset( m_aNextOutlierMessage, 0, sizeof(m_aNextOutlierMessage) );
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CProfiler::ResetPlayer( int iPlayer )
+{
+	if ( iPlayer >= PROFILE_MAX_PLAYERS )
+		return;
+	m_aPlayerFrameTimes[iPlayer] = 0.0;
+	memset( m_aPlayerFrameCounts[iPlayer], 0, sizeof(m_aPlayerFrameCounts[iPlayer]) );
+	memset( &m_aPlayers[iPlayer], 0, sizeof(m_aPlayers[iPlayer]) );
+	m_aNextOutlierMessage[iPlayer] = 0.0f;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CProfiler::StartCapture( int iFrames, const good::string& sFile )
+{
+	if ( m_bCapturing )
+		return false;
+
+	// Memory is allocated here, recording events only writes to it.
+	if ( m_aEvents.size() == 0 )
+		m_aEvents.resize(PROFILE_CAPTURE_EVENTS);
+	m_aCaptureCounts.resize(iFrames * EProfileCountTotal);
+	m_aCaptureFrameStarts.resize(iFrames);
+	m_sCaptureFile.assign(sFile, true);
+
+	if ( !bEnabled ) // Counters and times of current frame are not collected.
+	{
+		memset( m_aFrameTimes, 0, sizeof(m_aFrameTimes) );
+		memset( m_aFrameCounts, 0, sizeof(m_aFrameCounts) );
+		m_iAllocations = good::atomic_load( &good::allocations_count() );
+	}
+
+	good::atomic_store(&m_iEvents, 0);
+	m_iCaptureFrame = 0;
+	m_iCaptureFrames = iFrames;
+	m_fCaptureStart = Plat_FloatTime();
+	m_bCapturing = bActive = true;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CProfiler::StopCapture()
+{
+	if ( !m_bCapturing )
+		return false;
+
+	m_bCapturing = false;
+	bActive = bEnabled;
+	return SaveCapture();
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CProfiler::EndScope( TProfileSection iSection, int iPlayer, double fStart )
+{
+	double fEnd = Plat_FloatTime();
+	if ( iPlayer == -1 )
+		m_aFrameTimes[iSection] += fEnd - fStart;
+	else
+	{
+		if ( iPlayer < PROFILE_MAX_PLAYERS )
+			m_aPlayerFrameTimes[iPlayer] += fEnd - fStart;
+		m_iCurrentPlayer = -1;
+	}
+
+	if ( m_bCapturing )
+	{
+		if ( iSection == EProfileFrame )
+			m_aCaptureFrameStarts[m_iCaptureFrame] = fStart;
+		if ( iSection != EProfileTraces ) // Too many spans, capture has counter of traces instead.
+			AddEvent( (iPlayer == -1) ? aSectionNames[iSection] : NULL, iPlayer, EProfileThreadMain, fStart, fEnd );
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CProfiler::AddThreadEvent( const char* szName, TProfileThread iThread, double fStart, double fEnd )
+{
+	AddEvent( szName, -1, iThread, fStart, fEnd );
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CProfiler::AddEvent( const char* szName, int iPlayer, TProfileThread iThread, double fStart, double fEnd )
+{
+	// Slot is reserved atomically, as other threads record events too. Capture is saved after recording stops, so
+	// only an event of other thread that is being written at that moment can be lost.
+	long iEvent = good::atomic_increment(&m_iEvents) - 1;
+	profile_event_t& cEvent = m_aEvents[iEvent % PROFILE_CAPTURE_EVENTS];
+	cEvent.fStart = fStart;
+	cEvent.fDuration = (float)(fEnd - fStart);
+	cEvent.szName = szName;
+	cEvent.iFrame = m_iCaptureFrame;
+	cEvent.iPlayer = iPlayer;
+	cEvent.iThread = iThread;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CProfiler::EndFrame()
+{
+	long iAllocations = good::atomic_load( &good::allocations_count() );
+	m_aFrameCounts[EProfileCountAllocations] += iAllocations - m_iAllocations;
+	m_iAllocations = iAllocations;
+
+	if ( m_bCapturing )
+	{
+		memcpy( &m_aCaptureCounts[m_iCaptureFrame * EProfileCountTotal], m_aFrameCounts, sizeof(m_aFrameCounts) );
+		if ( ++m_iCaptureFrame == m_iCaptureFrames )
+			StopCapture();
+	}
+
+	if ( !bEnabled )
+	{
+		memset( m_aFrameTimes, 0, sizeof(m_aFrameTimes) );
+		memset( m_aFrameCounts, 0, sizeof(m_aFrameCounts) );
+		memset( m_aPlayerFrameTimes, 0, sizeof(m_aPlayerFrameTimes) );
+		memset( m_aPlayerFrameCounts, 0, sizeof(m_aPlayerFrameCounts) );
+		return;
+	}
+
+	m_fTotalTime += m_aFrameTimes[EProfileFrame];
+	EndPlayersFrame( m_aFrameTimes[EProfileFrame] );
+
+	for ( TProfileSection iSection = 0; iSection < EProfileSectionTotal; ++iSection )
+	{
+		m_aTimes[iSection][m_iNextFrame] = (float)(m_aFrameTimes[iSection] * 1000.0);
+		m_aFrameTimes[iSection] = 0.0;
+	}
+	for ( TProfileCounter iCounter = 0; iCounter < EProfileCountTotal; ++iCounter )
+	{
+		m_aCounts[iCounter][m_iNextFrame] = (float)m_aFrameCounts[iCounter];
+		m_aFrameCounts[iCounter] = 0;
+	}
+
+	if ( ++m_iNextFrame == PROFILE_WINDOW )
+		m_iNextFrame = 0;
+	if ( m_iFrames < PROFILE_WINDOW )
+		++m_iFrames;
+	++m_iTotalFrames;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CProfiler::EndPlayersFrame( double fFrameTime )
+{
+	float fFrameMSecs = (float)(fFrameTime * 1000.0);
+	bool bCheckOutliers = (fOutlierShare > 0.0f) && (fFrameMSecs >= fOutlierMinFrame);
+	for ( int iPlayer = 0; iPlayer < PROFILE_MAX_PLAYERS; ++iPlayer )
+	{
+		double fTime = m_aPlayerFrameTimes[iPlayer];
+		if ( fTime == 0.0 )
+			continue;
+
+		profile_player_t& cPlayer = m_aPlayers[iPlayer];
+		float fMSecs = (float)(fTime * 1000.0);
+		cPlayer.fTime += fTime;
+		if ( cPlayer.fMaxTime < fMSecs )
+			cPlayer.fMaxTime = fMSecs;
+		for ( TProfileCounter iCounter = 0; iCounter < EProfileCountTotal; ++iCounter )
+			cPlayer.aCounts[iCounter] += m_aPlayerFrameCounts[iPlayer][iCounter];
+		cPlayer.iFrames++;
+
+		if ( bCheckOutliers && (fMSecs > fOutlierShare * fFrameMSecs) )
+		{
+			cPlayer.iOutlierFrames++;
+
+			// Flag at most once in 5 seconds for each player.
+			float fNow = (float)Plat_FloatTime();
+			CPlayer* pPlayer = (iPlayer < CPlayers::Size()) ? CPlayers::Get(iPlayer) : NULL;
+			if ( pPlayer && pPlayer->IsBot() && (m_aNextOutlierMessage[iPlayer] <= fNow) )
+			{
+				m_aNextOutlierMessage[iPlayer] = fNow + 5.0f;
+				CBot* pBot = (CBot*)pPlayer;
+				CUtil::Message( NULL, "Bot %s took %.0f%% of frame (%.3f of %.3f ms), %d traces, %d nav searches: "
+				                "task %s, waypoint %d, destination %d.", pBot->GetName(), fMSecs * 100.0f / fFrameMSecs,
+				                fMSecs, fFrameMSecs, m_aPlayerFrameCounts[iPlayer][EProfileCountTraces],
+				                m_aPlayerFrameCounts[iPlayer][EProfileCountNavSearches], pBot->GetTaskName().c_str(),
+				                pBot->iCurrentWaypoint, pBot->GetDestinationWaypoint() );
+			}
+		}
+
+		m_aPlayerFrameTimes[iPlayer] = 0.0;
+		memset( m_aPlayerFrameCounts[iPlayer], 0, sizeof(m_aPlayerFrameCounts[iPlayer]) );
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------
+float CProfiler::GetTimePercentile( TProfileSection iSection, float fPercentile )
+{
+	return GetPercentile( m_aTimes[iSection], fPercentile );
+}
+
+//----------------------------------------------------------------------------------------------------------------
+float CProfiler::GetCountPercentile( TProfileCounter iCounter, float fPercentile )
+{
+	return GetPercentile( m_aCounts[iCounter], fPercentile );
+}
+
+//----------------------------------------------------------------------------------------------------------------
+float CProfiler::GetTimeAverage( TProfileSection iSection )
+{
+	if ( m_iFrames == 0 )
+		return 0.0f;
+	double fSum = 0.0;
+	for ( int i = 0; i < m_iFrames; ++i )
+		fSum += m_aTimes[iSection][i];
+	return (float)(fSum / m_iFrames);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+float CProfiler::GetCountAverage( TProfileCounter iCounter )
+{
+	if ( m_iFrames == 0 )
+		return 0.0f;
+	double fSum = 0.0;
+	for ( int i = 0; i < m_iFrames; ++i )
+		fSum += m_aCounts[iCounter][i];
+	return (float)(fSum / m_iFrames);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+const char* CProfiler::GetSectionName( TProfileSection iSection )
+{
+	return aSectionNames[iSection];
+}
+
+//----------------------------------------------------------------------------------------------------------------
+const char* CProfiler::GetCounterName( TProfileCounter iCounter )
+{
+	return aCounterNames[iCounter];
+}
+
+//----------------------------------------------------------------------------------------------------------------
+float CProfiler::GetPercentile( const float* aValues, float fPercentile )
+{
+	if ( m_iFrames == 0 )
+		return 0.0f;
+
+	// Window is filled from start, so first m_iFrames values are valid. Sort a copy (not called every frame).
+	static float aSorted[PROFILE_WINDOW];
+	memcpy( aSorted, aValues, sizeof(float) * m_iFrames );
+	qsort( aSorted, m_iFrames, sizeof(float), CompareFloats );
+
+	int iIndex = (int)( fPercentile * (m_iFrames - 1) / 100.0f + 0.5f );
+	if ( iIndex < 0 )
+		iIndex = 0;
+	else if ( iIndex >= m_iFrames )
+		iIndex = m_iFrames - 1;
+	return aSorted[iIndex];
+}
+
+//----------------------------------------------------------------------------------------------------------------
+bool CProfiler::SaveCapture()
+{
+	FILE* f = CUtil::OpenFile(m_sCaptureFile, "w");
+	if ( f == NULL )
+	{
+		CUtil::Message(NULL, "Error, can't write capture to %s.", m_sCaptureFile.c_str());
+		return false;
+	}
+
+	long iEvents = good::atomic_load(&m_iEvents);
+	int iDropped = (iEvents > PROFILE_CAPTURE_EVENTS) ? iEvents - PROFILE_CAPTURE_EVENTS : 0;
+
+	fprintf( f, "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"frames\":%d,\"events\":%ld,\"dropped\":%d},\n",
+	         m_iCaptureFrame, iEvents - iDropped, iDropped );
+	fprintf( f, "\"traceEvents\":[" );
+	for ( TProfileThread iThread = 0; iThread < EProfileThreadTotal; ++iThread )
+		fprintf( f, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+		         iThread ? "," : "", iThread, aThreadNames[iThread] );
+
+	// Counters at start of every frame.
+	for ( int iFrame = 0; iFrame < m_iCaptureFrame; ++iFrame )
+	{
+		const int* aCounts = &m_aCaptureCounts[iFrame * EProfileCountTotal];
+		fprintf( f, ",\n{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1,\"tid\":0,\"ts\":%.3f,\"args\":{",
+		         (m_aCaptureFrameStarts[iFrame] - m_fCaptureStart) * 1000000.0 );
+		for ( TProfileCounter iCounter = 0; iCounter < EProfileCountTotal; ++iCounter )
+			fprintf( f, "%s\"%s\":%d", iCounter ? "," : "", aCounterNames[iCounter], aCounts[iCounter] );
+		fprintf( f, "}}" );
+	}
+
+	// Spans. Player spans are named after player, without quotes, backslashes and control characters.
+	char szPlayerName[64];
+	for ( long i = iDropped; i < iEvents; ++i )
+	{
+		const profile_event_t& cEvent = m_aEvents[i % PROFILE_CAPTURE_EVENTS];
+		const char* szName = cEvent.szName;
+		if ( szName == NULL )
+		{
+			CPlayer* pPlayer = (cEvent.iPlayer < CPlayers::Size()) ? CPlayers::Get(cEvent.iPlayer) : NULL;
+			const char* szPlayer = pPlayer ? pPlayer->GetName() : NULL;
+			int iPos = 0;
+			for ( ; szPlayer && *szPlayer && (iPos < (int)sizeof(szPlayerName) - 1); ++szPlayer )
+				if ( (*szPlayer != '"') && (*szPlayer != '\\') && ((unsigned char)*szPlayer >= ' ') )
+					szPlayerName[iPos++] = *szPlayer;
+			szPlayerName[iPos] = 0;
+			if ( iPos == 0 )
+				sprintf(szPlayerName, "player %d", cEvent.iPlayer);
+			szName = szPlayerName;
+		}
+
+		fprintf( f, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,"
+		         "\"args\":{\"frame\":%d,\"player\":%d}}",
+		         szName, (cEvent.szName == NULL) ? "player" : "section", cEvent.iThread,
+		         (cEvent.fStart - m_fCaptureStart) * 1000000.0, cEvent.fDuration * 1000000.0,
+		         cEvent.iFrame, cEvent.iPlayer );
+	}
+	fprintf( f, "\n]}\n" );
+	fclose(f);
+
+	CUtil::Message( NULL, "Capture of %d frames saved to %s (%ld events, %d dropped).", m_iCaptureFrame,
+	                m_sCaptureFile.c_str(), iEvents - iDropped, iDropped );
+	return true;
+}
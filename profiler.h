@@ -0,0 +1,332 @@
+#ifndef __BOTRIX_PROFILER_H__
+#define __BOTRIX_PROFILER_H__
+
+
+#include "tier0/platform.h" // Plat_FloatTime()
+
+#include "good/atomic.h"
+#include "good/string.h"
+#include "good/vector.h"
+
+
+// Define BOTRIX_NO_PROFILE to compile profiler out: scoped timers and counters become empty macros.
+#ifndef BOTRIX_NO_PROFILE
+#	define BOTRIX_PROFILE
+#endif
+
+
+//****************************************************************************************************************
+/// Timed parts of server frame. Times are inclusive, i.e. traces are counted also in navigation and players.
+//****************************************************************************************************************
+enum TProfileSections
+{
+	EProfileFrame = 0,                           ///< Whole CBotrixPlugin::GameFrame().
+	EProfileModThink,                            ///< CMod::Think().
+	EProfileItems,                               ///< CItems::Update().
+	EProfilePlayers,                             ///< CPlayers::PreThink().
+	EProfileNavigation,                          ///< A* search setup and steps.
+	EProfileChat,                                ///< Matching of chat text to bot commands.
+	EProfileTraces,                              ///< Engine traces.
+
+	EProfileSectionTotal                         ///< Amount of profiled sections.
+};
+typedef int TProfileSection;                     ///< Timed part of server frame.
+
+
+//****************************************************************************************************************
+/// Counted events of server frame.
+//****************************************************************************************************************
+enum TProfileCounters
+{
+	EProfileCountTraces = 0,                     ///< Traces issued.
+	EProfileCountAStarNodes,                     ///< A* nodes expanded.
+	EProfileCountItemsScanned,                   ///< Entities checked by items update and by bots for near items.
+	EProfileCountChatMatched,                    ///< Chat messages matched against phrases.
+	EProfileCountNavSearches,                    ///< Path searches started by bots (navigation restarts).
+	EProfileCountStuckMoves,                     ///< Attempts of bots to resolve stuck move.
+	EProfileCountSightCached,                    ///< Sight checks of bots answered by result of same frame.
+	EProfileCountSightDistance,                  ///< Sight rays saved because player is too far.
+	EProfileCountSightView,                      ///< Sight rays saved because player is outside of view cone.
+	EProfileCountSightPvs,                       ///< Sight rays saved because player is outside of PVS.
+	EProfileCountSightRays,                      ///< Sight rays traced after all cheap checks passed.
+	EProfileCountAllocations,                    ///< Heap allocations of good containers (since previous frame).
+
+	EProfileCountTotal                           ///< Amount of counters.
+};
+typedef int TProfileCounter;                     ///< Counted event of server frame.
+
+
+//****************************************************************************************************************
+/// Threads that record events of capture.
+//****************************************************************************************************************
+enum TProfileThreads
+{
+	EProfileThreadMain = 0,                      ///< Server thread, calls plugin callbacks.
+	EProfileThreadPlanner,                       ///< Planner thread of BorzhMod.
+
+	EProfileThreadTotal                          ///< Amount of threads.
+};
+typedef int TProfileThread;                      ///< Thread that records events of capture.
+
+
+//****************************************************************************************************************
+/// Accounting of one player (bot), summed since profiler was enabled / reset.
+//****************************************************************************************************************
+typedef struct
+{
+	double fTime;                                ///< Think time, seconds.
+	float fMaxTime;                              ///< Max think time in one frame, milliseconds.
+	int aCounts[EProfileCountTotal];             ///< Counters while thinking.
+	int iFrames;                                 ///< Frames player was thinking.
+	int iOutlierFrames;                          ///< Frames player took more than outlier share of frame.
+} profile_player_t;
+
+
+//****************************************************************************************************************
+/// Frame profiler. Sections and counters are summed during a frame, and at the end of frame stored in a window of
+/// last PROFILE_WINDOW frames, from which percentiles are calculated on demand.
+///
+/// Capture records spans of sections, bots and threads of next frames in a ring of PROFILE_CAPTURE_EVENTS events
+/// (oldest events are overwritten), and saves them as Chrome Trace Event Format JSON (chrome://tracing).
+//****************************************************************************************************************
+class CProfiler
+{
+public:
+	static const int PROFILE_WINDOW = 1024;      ///< Amount of last frames to keep.
+	static const int PROFILE_CAPTURE_EVENTS = 64*1024; ///< Size of events ring of capture.
+	static const int PROFILE_CAPTURE_FRAMES = 4096;    ///< Max amount of frames to capture.
+	static const int PROFILE_MAX_PLAYERS = 64;   ///< Players with higher index are not accounted.
+
+	/// Return true if profiler is compiled in.
+	static bool IsCompiled()
+	{
+#ifdef BOTRIX_PROFILE
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/// Enable or disable collecting of frames. Enabling clears collected frames.
+	static void SetEnabled( bool bEnabled );
+
+	/// Clear collected frames.
+	static void Reset();
+
+	/// Start capture of next iFrames frames to file sFile. Return false if capture is already running.
+	static bool StartCapture( int iFrames, const good::string& sFile );
+
+	/// Stop capture and save it to file. Return false if file can't be written.
+	static bool StopCapture();
+
+	/// Return true if capture is running.
+	static bool IsCapturing() { return m_bCapturing; }
+
+	/// End span of section started at fStart (by Plat_FloatTime()). iPlayer is -1 for span of whole section.
+	static void EndScope( TProfileSection iSection, int iPlayer, double fStart );
+
+	/// Record span of thread other than main one. Only capture uses it.
+	static void AddThreadEvent( const char* szName, TProfileThread iThread, double fStart, double fEnd );
+
+	/// Start accounting time and counters to player, until EndScope() of player span.
+	static void BeginPlayer( int iPlayer ) { m_iCurrentPlayer = (iPlayer < PROFILE_MAX_PLAYERS) ? iPlayer : -1; }
+
+	/// Add to counter of current frame (and of player, which is thinking now).
+	static void Count( TProfileCounter iCounter, int iAmount )
+	{
+		if ( bActive )
+		{
+			m_aFrameCounts[iCounter] += iAmount;
+			if ( m_iCurrentPlayer != -1 )
+				m_aPlayerFrameCounts[m_iCurrentPlayer][iCounter] += iAmount;
+		}
+	}
+
+	/// Store current frame in window and start next one.
+	static void EndFrame();
+
+	/// Get amount of frames in window.
+	static int GetFramesCount() { return m_iFrames; }
+
+	/// Get total amount of frames collected since enabled / reset.
+	static int GetTotalFramesCount() { return m_iTotalFrames; }
+
+	/// Get percentile (0..100) of section time in milliseconds over frames in window.
+	static float GetTimePercentile( TProfileSection iSection, float fPercentile );
+
+	/// Get percentile (0..100) of counter over frames in window.
+	static float GetCountPercentile( TProfileCounter iCounter, float fPercentile );
+
+	/// Get average section time in milliseconds over frames in window.
+	static float GetTimeAverage( TProfileSection iSection );
+
+	/// Get average counter over frames in window.
+	static float GetCountAverage( TProfileCounter iCounter );
+
+	/// Get name of section.
+	static const char* GetSectionName( TProfileSection iSection );
+
+	/// Get name of counter.
+	static const char* GetCounterName( TProfileCounter iCounter );
+
+	/// Get accounting of player.
+	static const profile_player_t& GetPlayer( int iPlayer ) { return m_aPlayers[iPlayer]; }
+
+	/// Clear accounting of player (called when player disconnects).
+	static void ResetPlayer( int iPlayer );
+
+	/// Get sum of frame times since enabled / reset, milliseconds.
+	static double GetTotalTime() { return m_fTotalTime * 1000.0; }
+
+public:
+	static float fOutlierShare;                  ///< Player taking more than this share of frame is flagged, 0 to disable.
+	static float fOutlierMinFrame;               ///< Don't flag players in frames shorter than this, milliseconds.
+
+public:
+	static bool bEnabled;                        ///< True if frames are collected.
+	static bool bActive;                         ///< True if frames are collected or captured, scopes check it.
+
+protected:
+	// Span of capture. Time is in seconds.
+	typedef struct
+	{
+		double fStart;
+		float fDuration;
+		const char* szName;                      // Name of section or thread span, NULL for player span.
+		int iFrame;
+		short iPlayer;
+		short iThread;
+	} profile_event_t;
+
+	static float GetPercentile( const float* aValues, float fPercentile );
+	static void AddEvent( const char* szName, int iPlayer, TProfileThread iThread, double fStart, double fEnd );
+	static bool SaveCapture();
+	static void EndPlayersFrame( double fFrameTime );
+
+	static double m_aFrameTimes[EProfileSectionTotal];              // Times of current frame.
+	static int m_aFrameCounts[EProfileCountTotal];                  // Counters of current frame.
+	static long m_iAllocations;                                     // Allocations count at end of previous frame.
+
+	static float m_aTimes[EProfileSectionTotal][PROFILE_WINDOW];    // Times of last frames, milliseconds.
+	static float m_aCounts[EProfileCountTotal][PROFILE_WINDOW];     // Counters of last frames.
+	static int m_iNextFrame;                                        // Position of next frame in window.
+	static int m_iFrames;                                           // Amount of frames in window.
+	static int m_iTotalFrames;                                      // Amount of frames since enabled / reset.
+	static double m_fTotalTime;                                     // Sum of frame times since enabled / reset.
+
+	static int m_iCurrentPlayer;                                    // Player that is thinking, -1 if none.
+	static double m_aPlayerFrameTimes[PROFILE_MAX_PLAYERS];         // Think times of players in current frame.
+	static int m_aPlayerFrameCounts[PROFILE_MAX_PLAYERS][EProfileCountTotal]; // Counters of players in current frame.
+	static profile_player_t m_aPlayers[PROFILE_MAX_PLAYERS];        // Accounting of players.
+	static float m_aNextOutlierMessage[PROFILE_MAX_PLAYERS];        // To not flood console with outlier messages.
+
+	static bool m_bCapturing;                                       // True if capture is running.
+	static good::string m_sCaptureFile;                             // File to save capture to.
+	static good::vector<profile_event_t> m_aEvents;                 // Ring of captured events, allocated once.
+	static good::atomic_t m_iEvents;                                // Amount of events recorded since start.
+	static good::vector<int> m_aCaptureCounts;                      // Counters of captured frames.
+	static good::vector<double> m_aCaptureFrameStarts;              // Start times of captured frames.
+	static int m_iCaptureFrame, m_iCaptureFrames;                   // Current captured frame and amount of frames.
+	static double m_fCaptureStart;                                  // Time of capture start.
+};
+
+
+//****************************************************************************************************************
+/// Adds time from construction to destruction to section of current frame (or to player if iPlayer is not -1),
+/// if profiler is enabled or capturing.
+//****************************************************************************************************************
+class CProfileScope
+{
+public:
+	/// Constructor, starts timer.
+	CProfileScope( TProfileSection iSection, int iPlayer = -1 ): m_iSection(iSection), m_iPlayer(iPlayer)
+	{
+		m_fStart = 0.0;
+		if ( CProfiler::bActive )
+		{
+			if ( iPlayer != -1 )
+				CProfiler::BeginPlayer(iPlayer);
+			m_fStart = Plat_FloatTime();
+		}
+	}
+
+	/// Destructor, stops timer.
+	~CProfileScope()
+	{
+		if ( CProfiler::bActive && (m_fStart != 0.0) )
+			CProfiler::EndScope( m_iSection, m_iPlayer, m_fStart );
+	}
+
+protected:
+	TProfileSection m_iSection;
+	int m_iPlayer;
+	double m_fStart;
+};
+
+
+//****************************************************************************************************************
+/// Records span of thread other than main one from construction to destruction, if capture is running.
+//****************************************************************************************************************
+class CProfileThreadScope
+{
+public:
+	/// Constructor, starts timer.
+	CProfileThreadScope( const char* szName, TProfileThread iThread ): m_szName(szName), m_iThread(iThread)
+	{
+		m_fStart = Plat_FloatTime();
+	}
+
+	/// Destructor, stops timer.
+	~CProfileThreadScope()
+	{
+		if ( CProfiler::IsCapturing() )
+			CProfiler::AddThreadEvent( m_szName, m_iThread, m_fStart, Plat_FloatTime() );
+	}
+
+protected:
+	const char* m_szName;
+	TProfileThread m_iThread;
+	double m_fStart;
+};
+
+
+//****************************************************************************************************************
+/// Times whole server frame and ends it on destruction.
+//****************************************************************************************************************
+class CProfileFrameScope: public CProfileScope
+{
+public:
+	/// Constructor, starts frame timer.
+	CProfileFrameScope(): CProfileScope(EProfileFrame) {}
+
+	/// Destructor, stops frame timer and ends frame.
+	~CProfileFrameScope()
+	{
+		if ( CProfiler::bActive && (m_fStart != 0.0) )
+		{
+			CProfiler::EndScope( m_iSection, m_iPlayer, m_fStart );
+			CProfiler::EndFrame();
+		}
+		m_fStart = 0.0; // Don't end scope again in base destructor.
+	}
+};
+
+
+#ifdef BOTRIX_PROFILE
+#	define BOTRIX_PROFILE_JOIN2(a, b)           a##b
+#	define BOTRIX_PROFILE_JOIN(a, b)            BOTRIX_PROFILE_JOIN2(a, b)
+#	define BOTRIX_PROFILE_FRAME()               CProfileFrameScope cProfileFrameScope
+#	define BOTRIX_PROFILE_SCOPE(iSection)       CProfileScope BOTRIX_PROFILE_JOIN(cProfileScope, __LINE__)(iSection)
+#	define BOTRIX_PROFILE_PLAYER_SCOPE(iSection, iPlayer) CProfileScope BOTRIX_PROFILE_JOIN(cProfileScope, __LINE__)(iSection, iPlayer)
+#	define BOTRIX_PROFILE_THREAD_SCOPE(szName, iThread) CProfileThreadScope BOTRIX_PROFILE_JOIN(cProfileScope, __LINE__)(szName, iThread)
+#	define BOTRIX_PROFILE_COUNT(iCounter, iAmount) CProfiler::Count(iCounter, iAmount)
+#else
+#	define BOTRIX_PROFILE_FRAME()
+#	define BOTRIX_PROFILE_SCOPE(iSection)
+#	define BOTRIX_PROFILE_PLAYER_SCOPE(iSection, iPlayer)
+#	define BOTRIX_PROFILE_THREAD_SCOPE(szName, iThread)
+#	define BOTRIX_PROFILE_COUNT(iCounter, iAmount)
+#endif
+
+
+#endif // __BOTRIX_PROFILER_H__
@@ -0,0 +1,79 @@
+#include "good/file.h"
+#include "good/string_buffer.h"
+
+#include "pvs.h"
+
+// memdbgon must be the last include file in a .cpp file!!!
+#include "tier0/memdbgon.h"
+
+
+//----------------------------------------------------------------------------------------------------------------
+extern char* szMainBuffer;
+extern int iMainBufferSize;
+
+
+//----------------------------------------------------------------------------------------------------------------
+int CPvs::m_iClusters = 0;
+int CPvs::m_iRowSize = 0;
+unsigned int CPvs::m_iMapChecksum = 0;
+good::bitset CPvs::m_aLoadedRows;
+good::vector<unsigned char> CPvs::m_aMatrix;
+
+
+//----------------------------------------------------------------------------------------------------------------
+void CPvs::MapLoaded()
+{
+	Clear();
+	m_iMapChecksum = ReadMapChecksum();
+	m_iClusters = CBotrixPlugin::pEngineServer->GetClusterCount();
+	if ( m_iClusters <= 0 )
+	{
+		m_iClusters = 0;
+		return;
+	}
+
+	m_iRowSize = (m_iClusters + 7) >> 3;
+	m_aLoadedRows.resize(m_iClusters);
+	m_aLoadedRows.reset();
+	m_aMatrix.resize(m_iClusters * m_iRowSize);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CPvs::Clear()
+{
+	m_iClusters = m_iRowSize = 0;
+	m_iMapChecksum = 0;
+	m_aLoadedRows.resize(0);
+	m_aMatrix.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------
+void CPvs::LoadRow( int iCluster )
+{
+	unsigned char* pRow = &m_aMatrix[iCluster * m_iRowSize];
+	int iSize = CBotrixPlugin::pEngineServer->GetPVSForCluster(iCluster, m_iRowSize, pRow);
+	if ( iSize < m_iRowSize ) // Not written part is not visible.
+		memset(pRow + iSize, 0, m_iRowSize - iSize);
+	m_aLoadedRows.set(iCluster);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+unsigned int CPvs::ReadMapChecksum()
+{
+	static const int BSP_HEADER_SIZE = 1036; // dheader_t: id, version, 64 lumps of 16 bytes and map revision.
+
+	CBotrixPlugin::pEngineServer->GetGameDir(szMainBuffer, iMainBufferSize);
+	good::string_buffer sbFile(szMainBuffer, iMainBufferSize, false, true);
+	good::file::append_path(sbFile, "maps");
+	good::file::append_path(sbFile, CBotrixPlugin::instance->sMapName);
+	sbFile.append(".bsp");
+
+	unsigned char aHeader[BSP_HEADER_SIZE];
+	if ( good::file::file_to_memory(sbFile.c_str(), aHeader, BSP_HEADER_SIZE) != BSP_HEADER_SIZE )
+		return 0;
+
+	unsigned int iHash = 2166136261U; // FNV-1a, doesn't depend on endianness.
+	for ( int i = 0; i < BSP_HEADER_SIZE; ++i )
+		iHash = (iHash ^ aHeader[i]) * 16777619U;
+	return (iHash == 0) ? 1 : iHash; // 0 means no file.
+}
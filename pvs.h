@@ -0,0 +1,63 @@
+#ifndef __BOTRIX_PVS_H__
+#define __BOTRIX_PVS_H__
+
+
+#include "good/bitset.h"
+#include "good/vector.h"
+
+#include "server_plugin.h"
+
+
+//****************************************************************************************************************
+/// Cache of potentially visible sets of current map.
+/** Each row of cluster-to-cluster bit matrix is decompressed through engine once, first time it is needed. After
+  * that PVS check of two clusters is a bit test. Clusters outside of map (-1) see and are seen from everywhere. */
+//****************************************************************************************************************
+class CPvs
+{
+public:
+	static const int CLUSTER_UNKNOWN = -2;       ///< Cluster of point is not computed yet.
+
+	/// Get amount of clusters and checksum of current map and clear cached rows. Called at map start, before
+	/// waypoints load.
+	static void MapLoaded();
+
+	/// Free cached rows.
+	static void Clear();
+
+	/// Get amount of clusters of current map.
+	static int GetClusterCount() { return m_iClusters; }
+
+	/// Get checksum of header of current map's .bsp file, 0 if file can't be read (for example map is in .vpk).
+	/** Header has offsets and sizes of all lumps and map revision, so checksum changes when map is recompiled. */
+	static unsigned int GetMapChecksum() { return m_iMapChecksum; }
+
+	/// Get cluster of point v, -1 if point is outside of map.
+	static int GetCluster( const Vector& v ) { return CBotrixPlugin::pEngineServer->GetClusterForOrigin(v); }
+
+	/// Return true if cluster iTo is in PVS of cluster iFrom.
+	static bool IsVisible( int iFrom, int iTo )
+	{
+		if ( (iFrom < 0) || (iTo < 0) || (iFrom >= m_iClusters) || (iTo >= m_iClusters) )
+			return true;
+		if ( !m_aLoadedRows.test(iFrom) )
+			LoadRow(iFrom);
+		return ( m_aMatrix[iFrom * m_iRowSize + (iTo >> 3)] & (1 << (iTo & 7)) ) != 0;
+	}
+
+	/// Return true if point vTo is in PVS of point vFrom.
+	static bool IsVisible( const Vector& vFrom, const Vector& vTo ) { return IsVisible( GetCluster(vFrom), GetCluster(vTo) ); }
+
+protected:
+	static void LoadRow( int iCluster );
+	static unsigned int ReadMapChecksum();
+
+	static int m_iClusters;                      // Amount of clusters of current map.
+	static unsigned int m_iMapChecksum;          // Checksum of header of .bsp file of current map.
+	static int m_iRowSize;                       // Size of one row of matrix in bytes.
+	static good::bitset m_aLoadedRows;           // Rows that are already decompressed.
+	static good::vector<unsigned char> m_aMatrix; // Cluster-to-cluster matrix, m_iClusters rows.
+};
+
+
+#endif // __BOTRIX_PVS_H__
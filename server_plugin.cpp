@@ -13,9 +13,12 @@
 #include "server_plugin.h"
 #include "source_engine.h"
 #include "mod.h"
+#include "profiler.h"
+#include "pvs.h"
 #include "waypoint.h"
 
 // Good headers.
+#include "good/arena.h"
 #include "good/file.h"
 
 // Source headers.
@@ -79,18 +82,18 @@ IVDebugOverlay* pVDebugOverlay = NULL;
 //----------------------------------------------------------------------------------------------------------------
 #define LOAD_INTERFACE(var,type,version) \
 	if ((var =(type*)pInterfaceFactory(version, NULL)) == NULL ) {\
-		Warning("[Botrix] Cannot open interface "## #version ##" "## #type ##" "## #var ##"\n");\
+		Warning("[Botrix] Cannot open interface " #version " " #type " " #var "\n");\
 		return false;\
 	}
 
 #define LOAD_INTERFACE_IGNORE_ERROR(var,type,version) \
 	if ((var =(type*)pInterfaceFactory(version, NULL)) == NULL ) {\
-		Warning("[Botrix] Cannot open interface "## #version ##" "## #type ##" "## #var ##"\n");\
+		Warning("[Botrix] Cannot open interface " #version " " #type " " #var "\n");\
 	}
 
 #define LOAD_GAME_SERVER_INTERFACE(var, type, version) \
 	if ((var =(type*)pGameServerFactory(version, NULL)) == NULL ) {\
-		Warning("[Botrix] Cannot open game server interface "## #version ##" "## #type ##" "## #var ##"\n");\
+		Warning("[Botrix] Cannot open game server interface " #version " " #type " " #var "\n");\
 		return false;\
 	}
 
@@ -224,6 +227,7 @@ void CBotrixPlugin::LevelInit( const char* pMapName )
 
 	pGameEventManager->AddListener( this, true );	
 
+	CPvs::MapLoaded();
 	CWaypoints::Load();
 	CWaypoint::iWaypointTexture = CBotrixPlugin::pEngineServer->PrecacheModel( "sprites/lgtning.vmt" );
 }
@@ -247,6 +251,8 @@ void CBotrixPlugin::ServerActivate( edict_t* pEdictList, int edictCount, int cli
 //----------------------------------------------------------------------------------------------------------------
 void CBotrixPlugin::GameFrame( bool simulating )
 {
+	BOTRIX_PROFILE_FRAME();
+
 	CUtil::PrintMessagesInQueue();
 
 	float fPrevEngineTime = fEngineTime;
@@ -271,7 +277,10 @@ void CBotrixPlugin::GameFrame( bool simulating )
 	if ( bMapRunning )
 	{
 		if ( CMod::pCurrentMod )
+		{
+			BOTRIX_PROFILE_SCOPE(EProfileModThink);
 			CMod::pCurrentMod->Think();
+		}
 
 		// Show fps.
 		//m_iFramesCount++;
@@ -290,6 +299,9 @@ void CBotrixPlugin::GameFrame( bool simulating )
 		//if ( CWaypoints::NeedToWorkVisibility() )
 		//	CWaypoints::WorkVisibility();
 	}
+
+	// Release temporaries of this frame.
+	good::frame_arena().reset();
 }
 
 //----------------------------------------------------------------------------------------------------------------
@@ -302,6 +314,7 @@ void CBotrixPlugin::LevelShutdown( void ) // !!!!this can get called multiple ti
 	CPlayers::Clear();
 	CWaypoints::Clear();
 	CItems::MapUnloaded();
+	CPvs::Clear();
 
 	pGameEventManager->RemoveListener( this );
 	if ( pGameEventManager2 )
@@ -456,7 +469,7 @@ void CBotrixPlugin::FireGameEvent( KeyValues* event )
 
 void CBotrixPlugin::FireGameEvent( IGameEvent * event )
 {
-	CMod::ExecuteEvent( (void*)event, EEventTypeKeyValues );
+	CMod::ExecuteEvent( (void*)event, EEventTypeIGameEvent );
 }
 
 void CBotrixPlugin::GenerateSayEvent( edict_t* pEntity, const char* szText, bool bTeamOnly )
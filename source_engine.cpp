@@ -1,5 +1,6 @@
 #include "clients.h"
 #include "console_commands.h"
+#include "profiler.h"
 #include "server_plugin.h"
 #include "source_engine.h"
 #include "waypoint.h"
@@ -360,39 +361,15 @@ TReach CUtil::GetReachableInfoFromTo( Vector const& vSrc, Vector const& vDest, f
 //----------------------------------------------------------------------------------------------------------------
 void CUtil::TraceLine(Vector const& vSrc, Vector const& vDest, int mask, ITraceFilter *pFilter)
 {
+	BOTRIX_PROFILE_SCOPE(EProfileTraces);
+	BOTRIX_PROFILE_COUNT(EProfileCountTraces, 1);
+
 	Ray_t ray;
 	memset(&m_TraceResult, 0, sizeof(trace_t));
 	ray.Init( vSrc, vDest );
 	CBotrixPlugin::pEngineTrace->TraceRay( ray, mask, pFilter, &m_TraceResult );
 }
 
-//----------------------------------------------------------------------------------------------------------------
-edict_t* CUtil::GetEntityByUserId( int iUserId )
-{
-	for ( int i = 1; i <= CPlayers::Size(); i ++ )
-	{
-		edict_t* pEdict = CBotrixPlugin::pEngineServer->PEntityOfEntIndex(i);
-
-		if ( pEdict && (CBotrixPlugin::pEngineServer->GetPlayerUserId(pEdict) == iUserId) )
-			return pEdict;
-	}
-	return NULL;
-}
-
-//----------------------------------------------------------------------------------------------------------------
-unsigned char pvs[MAX_MAP_CLUSTERS/8];
-
-void CUtil::SetPVSForVector( const Vector& v )
-{
-	// Get visible clusters from player's position.
-	int iClusterIndex = CBotrixPlugin::pEngineServer->GetClusterForOrigin( v );
-	CBotrixPlugin::pEngineServer->GetPVSForCluster( iClusterIndex, sizeof(pvs), pvs );							
-}
-
-bool CUtil::IsVisiblePVS( const Vector& v )
-{
-	return CBotrixPlugin::pEngineServer->CheckOriginInPVS( v, pvs, sizeof(pvs) );
-}
 
 //----------------------------------------------------------------------------------------------------------------
 bool CUtil::IsNetworkable( edict_t* pEntity )
@@ -479,9 +456,15 @@ void CUtil::Message( edict_t* pEntity, const char* fmt, ... )
 	va_list argptr;
 
 	va_start(argptr, fmt);
-	int iTotal = vsprintf(szMessageString, fmt, argptr); 
+	int iTotal = vsnprintf(szMessageString, sizeof(szMessageString), fmt, argptr); 
 	va_end(argptr); 
 
+	if ( (iTotal < 0) || (iTotal >= sizeof(szMessageString)) ) // Message too long.
+	{
+		iTotal = sizeof(szMessageString) - 1;
+		szMessageString[iTotal] = 0;
+	}
+
 	static char sTime[24];
 	if ( pEntity )
 	{
@@ -529,11 +512,11 @@ void CUtil::Message( edict_t* pEntity, const char* fmt, ... )
 			{
 				char c = szMessageString[iEnd];
 				szMessageString[iEnd] = 0;
-				Msg(&szMessageString[i]);
+				Msg("%s", &szMessageString[i]);
 				szMessageString[iEnd] = c;
 			}
 			else
-				Msg(&szMessageString[i]);
+				Msg("%s", &szMessageString[i]);
 			i = iEnd;
 		}
 		Msg("\n");
@@ -541,39 +524,46 @@ void CUtil::Message( edict_t* pEntity, const char* fmt, ... )
 }
 
 //----------------------------------------------------------------------------------------------------------------
-good::mutex cMessagesMutex;
-int iQueueMessageStringSize = 0;
-char szQueueMessageString[64*1024];
+good::log_ring CUtil::m_cMessagesQueue(1024);
+int CUtil::iMessagesBytesPerFrame = 4*1024;
 
 void CUtil::PutMessageInQueue( const char* fmt, ... )
 {
-	va_list argptr;
+	char szMessage[LOG_RING_RECORD_SIZE+1]; // One more to know if message is truncated.
 
+	va_list argptr;
 	va_start(argptr, fmt);
-	cMessagesMutex.lock();
-
-	int iSize = vsprintf( &szQueueMessageString[iQueueMessageStringSize], fmt, argptr ); 
-	DebugAssert( iSize >= 0 );
-	iQueueMessageStringSize += iSize;
-
-	cMessagesMutex.unlock();
+	int iSize = vsnprintf( szMessage, sizeof(szMessage), fmt, argptr ); 
 	va_end(argptr); 
+
+	if ( (iSize < 0) || (iSize >= sizeof(szMessage)) )
+		iSize = sizeof(szMessage) - 1;
+	m_cMessagesQueue.push(szMessage, iSize);
 }
 
 
 //----------------------------------------------------------------------------------------------------------------
 void CUtil::PrintMessagesInQueue()
 {
-	if ( (iQueueMessageStringSize > 0) && cMessagesMutex.try_lock() )
+	static char szMessage[LOG_RING_RECORD_SIZE];
+
+	int iBytes = 0, iSize;
+	while ( (iBytes < iMessagesBytesPerFrame) && ((iSize = m_cMessagesQueue.pop(szMessage)) >= 0) )
+	{
+		Message(NULL, "%s", szMessage);
+		iBytes += iSize;
+	}
+
+	int iDropped = m_cMessagesQueue.dropped(), iTruncated = m_cMessagesQueue.truncated();
+	if ( iDropped || iTruncated )
 	{
-		Message(NULL, szQueueMessageString);
-		iQueueMessageStringSize = 0;
-		cMessagesMutex.unlock();
+		Message(NULL, "Message queue: %d messages dropped, %d truncated.", iDropped, iTruncated);
+		m_cMessagesQueue.reset_counters(iDropped, iTruncated);
 	}
 }
 
 //----------------------------------------------------------------------------------------------------------------
-FILE *CUtil::OpenFile( const good::string& szFile, char *szMode )
+FILE *CUtil::OpenFile( const good::string& szFile, const char *szMode )
 {
 	FILE *fp = fopen(szFile.c_str(), szMode);
 
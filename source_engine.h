@@ -6,7 +6,7 @@
 #include "public/eiface.h"
 #include "public/engine/IEngineTrace.h"
 
-#include "good/mutex.h"
+#include "good/log_ring.h"
 
 #include "types.h"
 
@@ -47,7 +47,7 @@ class CUtil
 
 public:
 	/// First make folders in file path, then open that file.
-	static FILE* OpenFile( const good::string& szFile, char *szMode );
+	static FILE* OpenFile( const good::string& szFile, const char *szMode );
 
 	/// Util function to get path inside Botrix folder.
 	static const good::string& BuildFileName( const good::string& sFolder, const good::string& sFile, const good::string& sExtension );
@@ -60,9 +60,10 @@ public:
 	static void Message( edict_t* pEntity, const char* fmt, ... );	
 
 	/// Put message in message queue. It must be done when called from thread != game thread, to avoid incorrect behaviour.
+	/** Queue is lock-free, message is dropped if queue is full and truncated if longer than LOG_RING_RECORD_SIZE. */
 	static void PutMessageInQueue( const char* fmt, ... );	
 
-	/// Print messages in queue.
+	/// Print messages in queue, up to iMessagesBytesPerFrame bytes. Must be called from game thread.
 	static void PrintMessagesInQueue();	
 
 	/// Return true if given entity is server networkable.
@@ -72,14 +73,6 @@ public:
 	static void EntityHead( edict_t* pEntity, Vector& v ) { CBotrixPlugin::pServerGameClients->ClientEarPosition(pEntity, &v); }
 	/// Get entity center.
 	static void EntityCenter( edict_t* pEntity, Vector& v );
-	
-	/// Get player's entity by user ID.
-	static edict_t* GetEntityByUserId( int iUserId );
-
-	/// Set internal PVS (potentially visible set of clusters) for given vector vFrom.
-	static void SetPVSForVector( const Vector& vFrom );
-	/// Check if point v is in potentially visible set.
-	static bool IsVisiblePVS( const Vector& v );
 
 	/// Return true given ray hits given entity.
 	static bool IsRayHitsEntity( edict_t* pDoor, Vector const& vSrc, Vector const& vDest );
@@ -131,6 +124,18 @@ public:
 	static bool IsTouchBoundingBox3d( Vector const& a1, Vector const& a2, Vector const& bmins, Vector const& bmaxs );
 	static bool IsOnOppositeSides3d( Vector const& amins, Vector const& amaxs, Vector const& bmins, Vector const& bmaxs );
 	static bool IsLineTouch3d( Vector const& amins, Vector const& amaxs, Vector const& bmins, Vector const& bmaxs );
+
+	/// Extend bounding box to contain point v.
+	static void AddPointToBounds( Vector const& v, Vector& vMins, Vector& vMaxs )
+	{
+		for ( int i = 0; i < 3; ++i )
+		{
+			if ( v[i] < vMins[i] )
+				vMins[i] = v[i];
+			if ( v[i] > vMaxs[i] )
+				vMaxs[i] = v[i];
+		}
+	}
 	
 	/// Useful math round function.
 	static int Round( float fNum )
@@ -212,6 +217,8 @@ public: // Members.
 	static int iPointTouchSquaredZ;          ///< Z distance to consider that we are touching waypoint. Should be no more than player can jump.
 	static int iPointTouchLadderSquaredZ;    ///< Z distance to consider that we are touching waypoint while on ladder.
 
+	static int iMessagesBytesPerFrame;       ///< Max amount of bytes of queued messages to print in one frame.
+
 	static const Vector vZero;               ///< Zero vector.
 	static const QAngle angZero;             ///< Zero angle.
 
@@ -219,9 +226,7 @@ protected:
 	static bool m_bMessageUseTag;
 	static trace_t m_TraceResult;
 	
-	static good::mutex m_cMessagesMutex;
-	static good::vector<char*> m_aMessages;
-	static good::vector<edict_t*> m_aMessagesEntities;
+	static good::log_ring m_cMessagesQueue; // Messages put from other threads, printed at game frame.
 
 };
 
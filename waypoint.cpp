@@ -35,6 +35,7 @@ static const char WAYPOINT_FILE_HEADER_ID[4] = {'B','t','x','W'}; // Botrix's Wa
 static const int WAYPOINT_VERSION = 1;                            // Waypoints file version.
 static const int WAYPOINT_FILE_FLAG_VISIBILITY = 1<<0;            // Flag for waypoint visibility table.
 static const int WAYPOINT_FILE_FLAG_AREAS = 2<<0;                 // Flag for area names.
+static const int WAYPOINT_FILE_FLAG_CLUSTERS = 4<<0;              // Flag for PVS clusters of waypoints.
 
 
 //----------------------------------------------------------------------------------------------------------------
@@ -52,9 +53,15 @@ const TWaypointFlags CWaypoint::m_aFlagsForEntityType[EEntityTypeTotal-1] =
 
 // CWaypoints static members.
 StringVector CWaypoints::m_cAreas;
+good::hash_map<good::string, TAreaId> CWaypoints::m_cAreaIds;
 CWaypoints::WaypointGraph CWaypoints::m_cGraph;
+CWaypoints::WaypointNavGraph CWaypoints::m_cNavGraph;
+bool CWaypoints::m_bNavGraphChanged = true;
 float CWaypoints::m_fNextDrawWaypointsTime = 0.0f;
 CWaypoints::Bucket CWaypoints::m_cBuckets[CWaypoints::BUCKETS_SIZE_X][CWaypoints::BUCKETS_SIZE_Y][CWaypoints::BUCKETS_SIZE_Z];
+CWaypoints::WaypointSet CWaypoints::m_aFlagSets[FWaypointTotal];
+good::vector<CWaypoints::area_sets_t> CWaypoints::m_aAreaSets;
+const CWaypoints::WaypointSet CWaypoints::m_aEmptySet;
 
 
 //----------------------------------------------------------------------------------------------------------------
@@ -151,7 +158,7 @@ bool CWaypoints::Save()
 		return false;
 
 	waypoint_header header;
-	header.iFlags = 0;
+	header.iFlags = WAYPOINT_FILE_FLAG_CLUSTERS;
 	if ( m_cAreas.size() > 1 )
 		FLAG_SET(WAYPOINT_FILE_FLAG_AREAS, header.iFlags);
 	//if ( bVisiblityMade )
@@ -198,6 +205,14 @@ bool CWaypoints::Save()
 		fwrite(m_cAreas[i].c_str(), sizeof(char), iSize+1, f); // Write string & trailing 0.
 	}
 
+	// Write clusters of waypoints, with checksum and amount of clusters of map to know if map was recompiled since.
+	unsigned int iMapChecksum = CPvs::GetMapChecksum();
+	fwrite(&iMapChecksum, sizeof(unsigned int), 1, f);
+	int iClusters = CPvs::GetClusterCount();
+	fwrite(&iClusters, sizeof(int), 1, f);
+	for (WaypointNodeIt it = m_cGraph.begin(); it != m_cGraph.end(); ++it)
+		fwrite(&it->vertex.iCluster, sizeof(int), 1, f);
+
 	fclose(f);
 
 	return true;
@@ -254,7 +269,7 @@ bool CWaypoints::Load()
 			iAreaId = 0;
 		fread(&iArgument, sizeof(int), 1, f);
 
-		Add(vOrigin, iFlags, iArgument, iAreaId);
+		Add(vOrigin, iFlags, iArgument, iAreaId, -1); // Cluster is read or computed below.
 	}
 
 	// Read waypoints paths.
@@ -280,7 +295,8 @@ bool CWaypoints::Load()
 		}
 	}
 
-	if ( FLAG_SOME_SET(WAYPOINT_FILE_FLAG_AREAS, header.iFlags) )
+	// Area names are always written before clusters.
+	if ( FLAG_SOME_SET(WAYPOINT_FILE_FLAG_AREAS | WAYPOINT_FILE_FLAG_CLUSTERS, header.iFlags) )
 	{
 		// Read area names.
 		int iAreaNamesSize = 0;
@@ -303,6 +319,26 @@ bool CWaypoints::Load()
 				m_cAreas.push_back(sArea);
 			}
 		}
+		UpdateAreaIds();
+	}
+
+	// Read clusters of waypoints, compute them if file has none or map was recompiled. If .bsp file can't be read
+	// checksum is 0 both when saving and loading, then only amount of clusters is compared.
+	unsigned int iMapChecksum = 0;
+	int iClusters = -1;
+	if ( FLAG_SOME_SET(WAYPOINT_FILE_FLAG_CLUSTERS, header.iFlags) )
+	{
+		fread(&iMapChecksum, sizeof(unsigned int), 1, f);
+		fread(&iClusters, sizeof(int), 1, f);
+	}
+	bool bHasClusters = (iMapChecksum == CPvs::GetMapChecksum()) && (iClusters == CPvs::GetClusterCount());
+	for (TWaypointId i = 0; i < iSize; ++i)
+	{
+		CWaypoint& w = m_cGraph[i].vertex;
+		if ( bHasClusters )
+			fread(&w.iCluster, sizeof(int), 1, f);
+		else
+			w.iCluster = CPvs::GetCluster(w.vOrigin);
 	}
 /*
 	bool bHasVisibility = header.iFlags & WAYPOINT_FILE_FLAG_VISIBILITY;
@@ -331,28 +367,170 @@ CWaypointPath* CWaypoints::GetPath(TWaypointId iFrom, TWaypointId iTo)
 
 
 //----------------------------------------------------------------------------------------------------------------
-TWaypointId CWaypoints::Add( Vector const& vOrigin, TWaypointFlags iFlags, int iArgument, int iAreaId )
+void CWaypoints::PathChanged()
+{
+	m_bNavGraphChanged = true;
+	CItems::WaypointsChanged();
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+TWaypointId CWaypoints::Add( Vector const& vOrigin, TWaypointFlags iFlags, int iArgument, int iAreaId, int iCluster )
 {
-	CWaypoint w(vOrigin, iFlags, iArgument, iAreaId);
+	if ( iCluster == CPvs::CLUSTER_UNKNOWN )
+		iCluster = CPvs::GetCluster(vOrigin);
+	CWaypoint w(vOrigin, iFlags, iArgument, iAreaId, iCluster);
 
 	// lol, this is not working because m_cGraph.begin() is called first. wtf?
 	// TWaypointId id = m_cGraph.add_node(w) - m_cGraph.begin();
 	CWaypoints::WaypointNodeIt it = m_cGraph.add_node(w);
 	TWaypointId id = it - m_cGraph.begin();
+	m_bNavGraphChanged = true;
+	CItems::WaypointsChanged();
 
 	AddLocation(id, vOrigin);
+	AddToSets(id, iFlags, iAreaId);
 	//AddVisibility(id, vOrigin);
 	return id;
 }
 
 
+//----------------------------------------------------------------------------------------------------------------
+void CWaypoints::Move( TWaypointId id, Vector const& vOrigin )
+{
+	CWaypoint& w = m_cGraph[id].vertex;
+	Bucket& bucket = m_cBuckets[GetBucketX(w.vOrigin.x)][GetBucketY(w.vOrigin.y)][GetBucketZ(w.vOrigin.z)];
+	bucket.erase(find(bucket.begin(), bucket.end(), id));
+
+	w.vOrigin = vOrigin;
+	w.iCluster = CPvs::GetCluster(vOrigin);
+	AddLocation(id, vOrigin);
+	UpdateAreaBounds(w.iAreaId);
+	CItems::WaypointsChanged();
+}
+
+
 //----------------------------------------------------------------------------------------------------------------
 void CWaypoints::Remove( TWaypointId id )
 {
 	CItems::WaypointDeleted(id);
 	RemoveLocation(id);
+
+	CWaypoint& w = m_cGraph[id].vertex;
+	RemoveFromSets(id, w.iFlags, w.iAreaId);
+
+	// Shift waypoints indexes in sets, all waypoints with index > id.
+	for ( int iFlag = 0; iFlag < FWaypointTotal; ++iFlag )
+		for ( WaypointSet::iterator it = m_aFlagSets[iFlag].begin(); it != m_aFlagSets[iFlag].end(); ++it )
+			if ( *it > id )
+				--(*it);
+	for ( int iArea = 0; iArea < m_aAreaSets.size(); ++iArea )
+	{
+		area_sets_t& cArea = m_aAreaSets[iArea];
+		for ( WaypointSet::iterator it = cArea.aAll.begin(); it != cArea.aAll.end(); ++it )
+			if ( *it > id )
+				--(*it);
+		for ( int iFlag = 0; iFlag < FWaypointTotal; ++iFlag )
+			for ( WaypointSet::iterator it = cArea.aFlags[iFlag].begin(); it != cArea.aFlags[iFlag].end(); ++it )
+				if ( *it > id )
+					--(*it);
+	}
+
 	//RemoveVisibility(id);
 	m_cGraph.delete_node( m_cGraph.begin() + id );
+	m_bNavGraphChanged = true;
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+void CWaypoints::SetFlags( TWaypointId id, TWaypointFlags iFlags )
+{
+	CWaypoint& w = m_cGraph[id].vertex;
+	RemoveFromSets(id, w.iFlags, w.iAreaId);
+	w.iFlags = iFlags;
+	AddToSets(id, w.iFlags, w.iAreaId);
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+void CWaypoints::SetArea( TWaypointId id, TAreaId iAreaId )
+{
+	CWaypoint& w = m_cGraph[id].vertex;
+	RemoveFromSets(id, w.iFlags, w.iAreaId);
+	w.iAreaId = iAreaId;
+	AddToSets(id, w.iFlags, w.iAreaId);
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+TAreaId CWaypoints::AddAreaName( const good::string& sName )
+{
+	const good::string* pOldAreas = m_cAreas.data();
+	m_cAreas.push_back(sName);
+	TAreaId iAreaId = m_cAreas.size() - 1;
+
+	// Keys don't own area names, they point to strings in m_cAreas. Short names are stored inside string objects,
+	// so if array was reallocated, all keys must be updated.
+	if ( m_cAreas.data() != pOldAreas )
+	{
+		UpdateAreaIds();
+		return iAreaId;
+	}
+	const good::string& sArea = m_cAreas.back();
+	m_cAreaIds.insert( good::pair<good::string, TAreaId>( good::string(sArea.c_str(), false, false, sArea.size()), iAreaId ), false );
+	return iAreaId;
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+void CWaypoints::RenameArea( TAreaId iAreaId, const good::string& sName )
+{
+	m_cAreas[iAreaId] = sName;
+	UpdateAreaIds();
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+bool CWaypoints::GetAreaBounds( TAreaId iAreaId, Vector& vMins, Vector& vMaxs )
+{
+	if ( (iAreaId >= m_aAreaSets.size()) || (m_aAreaSets[iAreaId].aAll.size() == 0) )
+		return false;
+	vMins = m_aAreaSets[iAreaId].vMins;
+	vMaxs = m_aAreaSets[iAreaId].vMaxs;
+	return true;
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+void CWaypoints::RemoveArea( TAreaId iAreaId )
+{
+	DebugAssert( (0 < iAreaId) && (iAreaId < m_cAreas.size()) ); // Default area can't be removed.
+
+	for ( WaypointNodeIt it = m_cGraph.begin(); it != m_cGraph.end(); ++it )
+	{
+		CWaypoint& w = it->vertex;
+		if ( w.iAreaId > iAreaId )
+			--w.iAreaId;
+		else if ( w.iAreaId == iAreaId )
+			w.iAreaId = 0; // Set to default.
+	}
+
+	// Move waypoints of removed area to default area, sets of next areas are shifted.
+	if ( iAreaId < m_aAreaSets.size() )
+	{
+		area_sets_t& cRemoved = m_aAreaSets[iAreaId];
+		area_sets_t& cDefault = m_aAreaSets[0];
+		for ( WaypointSet::const_iterator it = cRemoved.aAll.begin(); it != cRemoved.aAll.end(); ++it )
+			cDefault.aAll.push_back(*it);
+		for ( int iFlag = 0; iFlag < FWaypointTotal; ++iFlag )
+			for ( WaypointSet::const_iterator it = cRemoved.aFlags[iFlag].begin(); it != cRemoved.aFlags[iFlag].end(); ++it )
+				cDefault.aFlags[iFlag].push_back(*it);
+		m_aAreaSets.erase(iAreaId);
+		UpdateAreaBounds(0);
+	}
+
+	m_cAreas.erase(iAreaId);
+	UpdateAreaIds();
 }
 
 
@@ -369,6 +547,8 @@ bool CWaypoints::AddPath( TWaypointId iFrom, TWaypointId iTo, float fDistance, T
 		fDistance = from->vertex.vOrigin.DistTo(to->vertex.vOrigin);
 
 	m_cGraph.add_arc( from, to, CWaypointPath(fDistance, iFlags) );
+	m_bNavGraphChanged = true;
+	CItems::WaypointsChanged();
 	return true;
 }
 
@@ -380,10 +560,49 @@ bool CWaypoints::RemovePath( TWaypointId iFrom, TWaypointId iTo )
 		return false;
 
 	m_cGraph.delete_arc( m_cGraph.begin() + iFrom, m_cGraph.begin() + iTo );
+	m_bNavGraphChanged = true;
+	CItems::WaypointsChanged();
 	return true;
 }
 
 
+//----------------------------------------------------------------------------------------------------------------
+// Length of waypoint path, to build frozen arcs.
+class CPathLength
+{
+public:
+	float operator ()( CWaypointPath const& cPath ) const { return cPath.fLength; }
+};
+
+void CWaypoints::UpdateNavGraph()
+{
+	m_cNavGraph.build( m_cGraph, CPathLength() );
+	m_bNavGraphChanged = false;
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+void CWaypoints::BenchmarkArcs( int iTimes, float& fGraphTime, float& fNavGraphTime )
+{
+	const WaypointNavGraph& cNavGraph = GetNavGraph();
+	volatile float fSum = 0.0f; // Don't let compiler skip loops.
+
+	float fStart = Plat_FloatTime();
+	for ( int i = 0; i < iTimes; ++i )
+		for ( WaypointNodeIt it = m_cGraph.begin(); it != m_cGraph.end(); ++it )
+			for ( WaypointArcIt arcIt = it->neighbours.begin(); arcIt != it->neighbours.end(); ++arcIt )
+				fSum += arcIt->edge.fLength + arcIt->target;
+	fGraphTime = Plat_FloatTime() - fStart;
+
+	fStart = Plat_FloatTime();
+	for ( int i = 0; i < iTimes; ++i )
+		for ( TWaypointId id = 0; id < cNavGraph.size(); ++id )
+			for ( int iArc = cNavGraph.arcs_begin(id); iArc < cNavGraph.arcs_end(id); ++iArc )
+				fSum += cNavGraph.length(iArc) + cNavGraph.target(iArc);
+	fNavGraphTime = Plat_FloatTime() - fStart;
+}
+
+
 //----------------------------------------------------------------------------------------------------------------
 void CWaypoints::CreatePathsWithAutoFlags( TWaypointId iWaypoint1, TWaypointId iWaypoint2, bool bIsCrouched )
 {
@@ -518,19 +737,148 @@ TWaypointId CWaypoints::GetNearestWaypoint(Vector const& vOrigin, const good::bi
 
 
 //----------------------------------------------------------------------------------------------------------------
-TWaypointId CWaypoints::GetAnyWaypoint(Vector const& vOrigin, TWaypointFlags iFlags)
+TWaypointId CWaypoints::GetAnyWaypoint( TWaypointFlags iFlags, TAreaId iAreaId )
 {
-	if ( CWaypoints::Size() == 0 )
+	if ( iFlags == FWaypointNone )
+	{
+		if ( iAreaId == EAreaIdInvalid )
+			return ( Size() == 0 ) ? EWaypointIdInvalid : rand() % Size();
+		if ( iAreaId >= m_aAreaSets.size() )
+			return EWaypointIdInvalid;
+		const WaypointSet& aAll = m_aAreaSets[iAreaId].aAll;
+		return ( aAll.size() == 0 ) ? EWaypointIdInvalid : aAll[ rand() % aAll.size() ];
+	}
+
+	const WaypointSet* aSets = GetFlagSets(iAreaId);
+	if ( aSets == NULL )
 		return EWaypointIdInvalid;
 
-	TWaypointId id = rand() % CWaypoints::Size();
-	for ( TWaypointId i = id; i >= 0; --i )
-		if ( FLAG_SOME_SET(iFlags, CWaypoints::Get(i).iFlags) )
-			return i;
-	for ( TWaypointId i = id+1; i < CWaypoints::Size(); ++i )
-		if ( FLAG_SOME_SET(iFlags, CWaypoints::Get(i).iFlags) )
-			return i;
-	return EWaypointIdInvalid;
+	int iTotal = 0;
+	for ( int iFlag = 0; iFlag < FWaypointTotal; ++iFlag )
+		if ( FLAG_SOME_SET(1 << iFlag, iFlags) )
+			iTotal += aSets[iFlag].size();
+	if ( iTotal == 0 )
+		return EWaypointIdInvalid;
+
+	// Pick random element of all sets of iFlags. Waypoint that is in several of them is accepted only from set of
+	// its lowest flag, otherwise pick again. So each waypoint has the same probability, and there are at most as many
+	// tries in average as there are flags in iFlags.
+	for (;;)
+	{
+		int iPick = rand() % iTotal;
+		for ( int iFlag = 0; iFlag < FWaypointTotal; ++iFlag )
+		{
+			if ( FLAG_CLEARED(1 << iFlag, iFlags) )
+				continue;
+			const WaypointSet& aSet = aSets[iFlag];
+			if ( iPick < aSet.size() )
+			{
+				TWaypointId id = aSet[iPick];
+				if ( IsLowestFlag(id, iFlag, iFlags) )
+					return id;
+				break;
+			}
+			iPick -= aSet.size();
+		}
+	}
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+void CWaypoints::GetWaypoints( good::vector<TWaypointId>& aResult, TWaypointFlags iFlags, TAreaId iAreaId )
+{
+	if ( iFlags == FWaypointNone )
+	{
+		if ( iAreaId == EAreaIdInvalid )
+		{
+			for ( TWaypointId id = 0; id < Size(); ++id )
+				aResult.push_back(id);
+		}
+		else if ( iAreaId < m_aAreaSets.size() )
+		{
+			const WaypointSet& aAll = m_aAreaSets[iAreaId].aAll;
+			for ( WaypointSet::const_iterator it = aAll.begin(); it != aAll.end(); ++it )
+				aResult.push_back(*it);
+		}
+		return;
+	}
+
+	const WaypointSet* aSets = GetFlagSets(iAreaId);
+	if ( aSets == NULL )
+		return;
+
+	for ( int iFlag = 0; iFlag < FWaypointTotal; ++iFlag )
+	{
+		if ( FLAG_CLEARED(1 << iFlag, iFlags) )
+			continue;
+		const WaypointSet& aSet = aSets[iFlag];
+		for ( WaypointSet::const_iterator it = aSet.begin(); it != aSet.end(); ++it )
+			if ( IsLowestFlag(*it, iFlag, iFlags) )
+				aResult.push_back(*it);
+	}
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+void CWaypoints::AddToSets( TWaypointId id, TWaypointFlags iFlags, TAreaId iAreaId )
+{
+	if ( iAreaId >= m_aAreaSets.size() )
+		m_aAreaSets.resize(iAreaId + 1);
+
+	area_sets_t& cArea = m_aAreaSets[iAreaId];
+	const Vector& vOrigin = m_cGraph[id].vertex.vOrigin;
+	if ( cArea.aAll.size() == 0 )
+		cArea.vMins = cArea.vMaxs = vOrigin;
+	else
+		CUtil::AddPointToBounds(vOrigin, cArea.vMins, cArea.vMaxs);
+
+	cArea.aAll.push_back(id);
+	for ( int iFlag = 0; iFlag < FWaypointTotal; ++iFlag )
+		if ( FLAG_SOME_SET(1 << iFlag, iFlags) )
+		{
+			m_aFlagSets[iFlag].push_back(id);
+			cArea.aFlags[iFlag].push_back(id);
+		}
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+void CWaypoints::RemoveFromSets( TWaypointId id, TWaypointFlags iFlags, TAreaId iAreaId )
+{
+	area_sets_t& cArea = m_aAreaSets[iAreaId];
+	cArea.aAll.erase( good::find(cArea.aAll.begin(), cArea.aAll.end(), id) );
+	for ( int iFlag = 0; iFlag < FWaypointTotal; ++iFlag )
+		if ( FLAG_SOME_SET(1 << iFlag, iFlags) )
+		{
+			m_aFlagSets[iFlag].erase( good::find(m_aFlagSets[iFlag].begin(), m_aFlagSets[iFlag].end(), id) );
+			cArea.aFlags[iFlag].erase( good::find(cArea.aFlags[iFlag].begin(), cArea.aFlags[iFlag].end(), id) );
+		}
+	UpdateAreaBounds(iAreaId);
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+void CWaypoints::UpdateAreaBounds( TAreaId iAreaId )
+{
+	area_sets_t& cArea = m_aAreaSets[iAreaId];
+	if ( cArea.aAll.size() == 0 )
+		return;
+
+	cArea.vMins = cArea.vMaxs = m_cGraph[ cArea.aAll[0] ].vertex.vOrigin;
+	for ( int i = 1; i < cArea.aAll.size(); ++i )
+		CUtil::AddPointToBounds(m_cGraph[ cArea.aAll[i] ].vertex.vOrigin, cArea.vMins, cArea.vMaxs);
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+void CWaypoints::UpdateAreaIds()
+{
+	m_cAreaIds.clear();
+	for ( TAreaId iAreaId = 0; iAreaId < m_cAreas.size(); ++iAreaId )
+	{
+		const good::string& sArea = m_cAreas[iAreaId];
+		m_cAreaIds.insert( good::pair<good::string, TAreaId>( good::string(sArea.c_str(), false, false, sArea.size()), iAreaId ), false );
+	}
 }
 
 
@@ -555,9 +903,6 @@ void CWaypoints::Draw( CClient* pClient )
 		int minX, minY, minZ, maxX, maxY, maxZ;
 		GetBuckets(x, y, z, minX, minY, minZ, maxX, maxY, maxZ);
 
-		// Get visible clusters from player's position.
-		CUtil::SetPVSForVector(vOrigin);
-
 		for (x = minX; x <= maxX; ++x)
 			for (y = minY; y <= maxY; ++y)
 				for (z = minZ; z <= maxZ; ++z)
@@ -568,7 +913,7 @@ void CWaypoints::Draw( CClient* pClient )
 						WaypointNode& node = m_cGraph[*it];
 
 						// Check if waypoint is in pvs from player's position.
-						if ( CUtil::IsVisiblePVS(node.vertex.vOrigin) )
+						if ( CPvs::IsVisible(pClient->GetCluster(), node.vertex.iCluster) )
 							node.vertex.Draw(*it, pClient->iWaypointDrawFlags, fDrawTime);
 					}
 				}
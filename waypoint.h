@@ -4,10 +4,13 @@
 
 #include "vector.h"
 
+#include "pvs.h"
 #include "source_engine.h"
 #include "types.h"
 
 #include "good/astar.h"
+#include "good/csr_graph.h"
+#include "good/hash_map.h"
 
 
 //****************************************************************************************************************
@@ -22,11 +25,11 @@ public: // Methods.
 
 public: // Methods.
 	/// Default constructor.
-	CWaypoint(): vOrigin(), iArgument(0), iFlags(0), iAreaId(0) {}
+	CWaypoint(): vOrigin(), iArgument(0), iFlags(0), iAreaId(0), iCluster(-1) {}
 
 	/// Constructor with parameters.
-	CWaypoint( Vector const& vOrigin, int iFlags = FWaypointNone, int iArgument = 0, TAreaId iAreaId = 0 ):
-		iArgument(iArgument), iAreaId(iAreaId), vOrigin(vOrigin), iFlags(iFlags) {}
+	CWaypoint( Vector const& vOrigin, int iFlags = FWaypointNone, int iArgument = 0, TAreaId iAreaId = 0, int iCluster = -1 ):
+		iArgument(iArgument), iAreaId(iAreaId), vOrigin(vOrigin), iFlags(iFlags), iCluster(iCluster) {}
 
 	/// Get waypoint flags for needed entity type (health, armor, weapon, ammo).
 	static TWaypointFlags GetFlagsFor( TEntityType iEntityType ) { return m_aFlagsForEntityType[iEntityType]; }
@@ -136,6 +139,7 @@ public: // Members and constants.
 	TWaypointFlags iFlags;                   ///< Waypoint flags.
 	TAreaId iAreaId;                         ///< Area id where waypoint belongs to (like "Bombsite A" / "Base CT" in counter-strike).
 	int iArgument;                           ///< Waypoint argument.
+	int iCluster;                            ///< PVS cluster of waypoint, -1 if it is outside of map.
 	
 	//unsigned char iPlayersCount;             ///< Count of players that reached this waypoint.
 
@@ -175,11 +179,12 @@ class CWaypoints
 
 public: // Types and constants.
 	/// Graph that represents graph of waypoints.
-	typedef good::graph< CWaypoint, CWaypointPath, good::vector, good::vector > WaypointGraph;
+	typedef good::graph< CWaypoint, CWaypointPath, good::vector, good::arcs_vector > WaypointGraph;
 	typedef WaypointGraph::node_t WaypointNode;     ///< Node of waypoint graph.
 	typedef WaypointGraph::arc_t WaypointArc;       ///< Graph arc, i.e. path between two waypoints.
 	typedef WaypointGraph::node_it WaypointNodeIt;  ///< Node iterator.
 	typedef WaypointGraph::arc_it WaypointArcIt;    ///< Arc iterator.
+	typedef good::csr_graph<CWaypointPath, float> WaypointNavGraph; ///< Frozen arcs of waypoint graph, for navigation.
 	//typedef WaypointGraph::node_id TWaypointId;     ///< Type for node identifier.
 
 
@@ -197,6 +202,9 @@ public: // Methods.
 			ClearLocations();
 		m_cGraph.clear();
 		m_cAreas.clear();
+		m_cAreaIds.clear();
+		ClearSets();
+		m_bNavGraphChanged = true;
 	}
 
 	/// Save waypoints to a file.
@@ -216,18 +224,50 @@ public: // Methods.
 		return w.find_arc_to(dest) != w.neighbours.end();
 	}
 
-	/// Get waypoint path.
+	/// Get waypoint path. Call PathChanged() after modifying it.
 	static CWaypointPath* GetPath( TWaypointId iFrom, TWaypointId iTo );
 
+	/// Must be called after flags or argument of path, returned by GetPath(), were modified.
+	static void PathChanged();
+
+	/// Get frozen arcs of waypoint graph. They are built again here if waypoints or paths were changed.
+	static const WaypointNavGraph& GetNavGraph()
+	{
+		if ( m_bNavGraphChanged )
+			UpdateNavGraph();
+		return m_cNavGraph;
+	}
+
+	/// Get waypoint path from frozen arcs, to use while bot navigates. Return NULL if there is no path.
+	static const CWaypointPath* GetNavPath( TWaypointId iFrom, TWaypointId iTo )
+	{
+		const WaypointNavGraph& cNavGraph = GetNavGraph();
+		int iArc = cNavGraph.find_arc(iFrom, iTo);
+		return ( iArc < 0 ) ? NULL : &cNavGraph.edge(iArc);
+	}
+
+	/// Measure time of iTimes walks over all arcs of waypoint graph, through graph nodes and through frozen arcs.
+	static void BenchmarkArcs( int iTimes, float& fGraphTime, float& fNavGraphTime );
+
 	/// Get waypoint node (waypoint + neighbours).
 	static WaypointNode& GetNode( TWaypointId id ) { return m_cGraph[id]; }
 
-	/// Add waypoint.
-	static TWaypointId Add( Vector const& vOrigin, TWaypointFlags iFlags = FWaypointNone, int iArgument = 0, int iAreaId = 0 );
+	/// Add waypoint. Cluster of waypoint is computed if iCluster is CPvs::CLUSTER_UNKNOWN.
+	static TWaypointId Add( Vector const& vOrigin, TWaypointFlags iFlags = FWaypointNone, int iArgument = 0, int iAreaId = 0,
+	                        int iCluster = CPvs::CLUSTER_UNKNOWN );
+
+	/// Move waypoint to new position.
+	static void Move( TWaypointId id, Vector const& vOrigin );
 
 	/// Remove waypoint.
 	static void Remove( TWaypointId id );
 
+	/// Set waypoint flags. Use it instead of changing CWaypoint::iFlags, to keep waypoints sets updated.
+	static void SetFlags( TWaypointId id, TWaypointFlags iFlags );
+
+	/// Set waypoint area. Use it instead of changing CWaypoint::iAreaId, to keep waypoints sets updated.
+	static void SetArea( TWaypointId id, TAreaId iAreaId );
+
 	/// Add path from waypoint iFrom to waypoint iTo.
 	static bool AddPath( TWaypointId iFrom, TWaypointId iTo, float fDistance = 0.0f, TPathFlags iFlags = FPathNone );
 
@@ -245,22 +285,43 @@ public: // Methods.
 	static TWaypointId GetNearestWaypoint( Vector const& vOrigin, const good::bitset* aOmit = NULL, bool bNeedVisible = true, 
 	                                       float fMaxDistance = CWaypoint::MAX_RANGE, TWaypointFlags iFlags = FWaypointNone );
 
-	/// Get any waypoint with some of the given flags set.
-	static TWaypointId GetAnyWaypoint( Vector const& vOrigin, TWaypointFlags iFlags = FWaypointNone );
+	/// Get random waypoint with some of the given flags set (any waypoint if iFlags is FWaypointNone), in given area
+	/// (any area if iAreaId is EAreaIdInvalid). All such waypoints have the same probability.
+	static TWaypointId GetAnyWaypoint( TWaypointFlags iFlags = FWaypointNone, TAreaId iAreaId = EAreaIdInvalid );
+
+	/// Append to aResult waypoints with some of the given flags set (all waypoints if iFlags is FWaypointNone), in
+	/// given area (any area if iAreaId is EAreaIdInvalid). Each waypoint is appended once.
+	static void GetWaypoints( good::vector<TWaypointId>& aResult, TWaypointFlags iFlags = FWaypointNone,
+	                          TAreaId iAreaId = EAreaIdInvalid );
 
 
 	/// Get areas names for current map.
-	static StringVector& GetAreas() { return m_cAreas; }
+	static const StringVector& GetAreas() { return m_cAreas; }
 
 	/// Get area id from name.
 	static TAreaId GetAreaId( const good::string& sName )
 	{
-		StringVector::const_iterator it( good::find(m_cAreas.begin(), m_cAreas.end(), sName) );
-		return ( it == m_cAreas.end() )  ?  EAreaIdInvalid  :  ( it - m_cAreas.begin() );
+		good::hash_map<good::string, TAreaId>::const_iterator it = m_cAreaIds.find(sName);
+		return ( it == m_cAreaIds.end() )  ?  EAreaIdInvalid  :  it->second;
 	}
 
 	/// Add new area name.
-	static TAreaId AddAreaName( const good::string& sName ) { m_cAreas.push_back(sName); return m_cAreas.size()-1; }
+	static TAreaId AddAreaName( const good::string& sName );
+
+	/// Rename area.
+	static void RenameArea( TAreaId iAreaId, const good::string& sName );
+
+	/// Remove area. Its waypoints are moved to default area.
+	static void RemoveArea( TAreaId iAreaId );
+
+	/// Get waypoints of area.
+	static const good::vector<TWaypointId>& GetAreaWaypoints( TAreaId iAreaId )
+	{
+		return ( iAreaId < m_aAreaSets.size() ) ? m_aAreaSets[iAreaId].aAll : m_aEmptySet;
+	}
+
+	/// Get bounding box of waypoints origins of area. Return false if area has no waypoints.
+	static bool GetAreaBounds( TAreaId iAreaId, Vector& vMins, Vector& vMaxs );
 
 
 	/// Draw nearest waypoints around player.
@@ -324,9 +385,64 @@ protected:
 	typedef good::vector<TWaypointId> Bucket;
 	static Bucket m_cBuckets[BUCKETS_SIZE_X][BUCKETS_SIZE_Y][BUCKETS_SIZE_Z]; // 3D hash table of arrays of waypoint IDs.
 
+	// Waypoints sets, to pick random waypoint with flags / in area without searching all waypoints.
+	typedef good::vector<TWaypointId> WaypointSet;
+	typedef struct
+	{
+		WaypointSet aAll;                      // All waypoints of area.
+		WaypointSet aFlags[FWaypointTotal];    // Waypoints of area that have flag (1 << index) set.
+		Vector vMins, vMaxs;                   // Bounding box of origins of all waypoints of area.
+	} area_sets_t;
+
+	// Add waypoint to sets of its flags and area.
+	static void AddToSets( TWaypointId id, TWaypointFlags iFlags, TAreaId iAreaId );
+
+	// Remove waypoint from sets of its flags and area.
+	static void RemoveFromSets( TWaypointId id, TWaypointFlags iFlags, TAreaId iAreaId );
+
+	// Recompute bounding box of area from its waypoints.
+	static void UpdateAreaBounds( TAreaId iAreaId );
+
+	// Fill map from area name to area id.
+	static void UpdateAreaIds();
+
+	// Clear all sets.
+	static void ClearSets()
+	{
+		for ( int iFlag = 0; iFlag < FWaypointTotal; ++iFlag )
+			m_aFlagSets[iFlag].clear();
+		m_aAreaSets.clear();
+	}
+
+	// Get sets of flags for area (for all map if iAreaId is EAreaIdInvalid), NULL if area has no waypoints.
+	static const WaypointSet* GetFlagSets( TAreaId iAreaId )
+	{
+		if ( iAreaId == EAreaIdInvalid )
+			return m_aFlagSets;
+		return ( iAreaId < m_aAreaSets.size() ) ? m_aAreaSets[iAreaId].aFlags : NULL;
+	}
+
+	// Return true if waypoint from set of flag iFlag must be taken in account for flags iFlags. Waypoint with several
+	// of iFlags set is in several sets, it is taken only from set of lowest of those flags.
+	static bool IsLowestFlag( TWaypointId id, int iFlag, TWaypointFlags iFlags )
+	{
+		TWaypointFlags iCommon = m_cGraph[id].vertex.iFlags & iFlags;
+		return (iCommon & -iCommon) == (1 << iFlag);
+	}
+
+	static WaypointSet m_aFlagSets[FWaypointTotal]; // Waypoints that have flag (1 << index) set.
+	static good::vector<area_sets_t> m_aAreaSets;  // Waypoints sets for each area.
+	static const WaypointSet m_aEmptySet;          // Waypoints of area that has none.
+
 	static StringVector m_cAreas;      // Areas names.
+	static good::hash_map<good::string, TAreaId> m_cAreaIds; // Map from area name to area id, keys point to m_cAreas.
+
+	// Build frozen arcs from waypoint graph.
+	static void UpdateNavGraph();
 
 	static WaypointGraph m_cGraph;         // Waypoints graph.
+	static WaypointNavGraph m_cNavGraph;   // Frozen arcs of waypoints graph, built again after changes.
+	static bool m_bNavGraphChanged;        // True if waypoints graph changed after m_cNavGraph was built.
 	static float m_fNextDrawWaypointsTime; // Next draw time of waypoints (draw once per second).
 };
 
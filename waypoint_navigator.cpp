@@ -14,8 +14,9 @@ TPathDrawFlags CWaypointNavigator::iPathDrawFlags = FPathDrawNone;
 bool CWaypointNavigator::SearchSetup( TWaypointId iFrom, TWaypointId iTo, good::vector<TAreaId> const& aAvoidAreas, int iMaxWaypointsInLoop )
 {
 	DebugAssert( CWaypoint::IsValid(iFrom) && CWaypoint::IsValid(iTo) );
+	BOTRIX_PROFILE_SCOPE(EProfileNavigation);
 
-	m_cAstar.set_graph(CWaypoints::m_cGraph);
+	m_cAstar.set_graph(CWaypoints::m_cGraph, CWaypoints::GetNavGraph());
 	m_cAstar.setup_search(iFrom, iTo, CCanUseWaypoint(aAvoidAreas), iMaxWaypointsInLoop);
 
 	m_bSearchStarted = true;
@@ -26,6 +27,35 @@ bool CWaypointNavigator::SearchSetup( TWaypointId iFrom, TWaypointId iTo, good::
 }
 
 
+//----------------------------------------------------------------------------------------------------------------
+float CWaypointNavigator::Benchmark( int iSearches, int& iNodes, int& iFound )
+{
+	DebugAssert( CWaypoints::Size() >= 2 );
+
+	CWaypointNavigator cNavigator;
+	good::vector<TAreaId> aAvoidAreas;
+	iNodes = iFound = 0;
+
+	float fStart = Plat_FloatTime();
+	for ( int i = 0; i < iSearches; ++i )
+	{
+		TWaypointId iFrom = rand() % CWaypoints::Size(), iTo;
+		do {
+			iTo = rand() % CWaypoints::Size();
+		} while ( iTo == iFrom );
+
+		cNavigator.SearchSetup( iFrom, iTo, aAvoidAreas );
+		do {
+			cNavigator.SearchStep();
+			iNodes += cNavigator.m_cAstar.last_step_nodes();
+		} while ( !cNavigator.SearchEnded() );
+		if ( cNavigator.PathFound() )
+			iFound++;
+	}
+	return Plat_FloatTime() - fStart;
+}
+
+
 //----------------------------------------------------------------------------------------------------------------
 void CWaypointNavigator::DrawPath( unsigned char r, unsigned char g, unsigned char b, Vector const& vOrigin )
 {
@@ -2,6 +2,7 @@
 #define __BOTRIX_WAYPOINT_NAVIGATOR_H__
 
 
+#include "profiler.h"
 #include "waypoint.h"
 
 #include "good/astar.h"
@@ -28,7 +29,9 @@ public:
 	{
 		if (m_bSearchStarted)
 		{
+			BOTRIX_PROFILE_SCOPE(EProfileNavigation);
 			m_bSearchEnded = m_cAstar.step(); 
+			BOTRIX_PROFILE_COUNT(EProfileCountAStarNodes, m_cAstar.last_step_nodes());
 			if ( m_bSearchEnded )
 			{
 				DebugAssert( !m_cAstar.has_path() || (m_cAstar.path().size() >= 2) );
@@ -67,6 +70,9 @@ public:
 			m_iPathIndex--;
 	}
 
+	/// Find paths between iSearches random pairs of waypoints. Return time spent, expanded nodes and found paths.
+	static float Benchmark( int iSearches, int& iNodes, int& iFound );
+
 	/// Drawpath.
 	void DrawPath( unsigned char r, unsigned char g, unsigned char b, Vector  const& vOrigin );
 
@@ -329,9 +329,16 @@ public:
 
 	/// Get weapon from weapon name.
 	static TWeaponId GetIdFromWeaponName( const good::string& sName )
+	{
+		int iNameId = CItems::GetClassNameId(sName);
+		return ( iNameId < 0 ) ? -1 : GetIdFromWeaponNameId(iNameId);
+	}
+
+	/// Get weapon from id of weapon class name (CEntityClass::iNameId). Compares integers instead of strings.
+	static TWeaponId GetIdFromWeaponNameId( int iNameId )
 	{
 		for ( int i=0; i < m_aWeapons.size(); ++i )
-			if ( m_aWeapons[i].GetName() == sName )
+			if ( m_aWeapons[i].GetBaseWeapon()->pWeaponClass->iNameId == iNameId )
 				return i;
 		return -1;
 	}